@@ -32,25 +32,31 @@ static state_t topA = {.itsInitialState  = &subA1,
                        .itsTransitionNum = 0,
                        .itsName          = " topA"};
 
-static state_t subA1 = {.itsInitialState = NULL,
-                        .itsParentState  = &topA,
-                        .onEntry         = NULL,
-                        .during          = NULL,
-                        .onExit          = NULL,
-                        .itsTransition =
-                            (hsm_transition_t[]){{NULL, NULL, &subA2}},
-                        .itsTransitionNum = 1,
-                        .itsName          = "subA1"};
-
-static state_t subA2 = {.itsInitialState = NULL,
-                        .itsParentState  = &topA,
-                        .onEntry         = NULL,
-                        .during          = NULL,
-                        .onExit          = NULL,
-                        .itsTransition =
-                            (hsm_transition_t[]){{NULL, NULL, &subB1}},
-                        .itsTransitionNum = 1,
-                        .itsName          = "subA2"};
+static state_t subA1 = {
+    .itsInitialState = NULL,
+    .itsParentState  = &topA,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition   = (hsm_transition_t[]){{.guard       = NULL,
+                                             .action      = NULL,
+                                             .targetState = &subA2,
+                                             .eventType   = HSM_EVENT_ANY}},
+    .itsTransitionNum = 1,
+    .itsName          = "subA1"};
+
+static state_t subA2 = {
+    .itsInitialState = NULL,
+    .itsParentState  = &topA,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition   = (hsm_transition_t[]){{.guard       = NULL,
+                                             .action      = NULL,
+                                             .targetState = &subB1,
+                                             .eventType   = HSM_EVENT_ANY}},
+    .itsTransitionNum = 1,
+    .itsName          = "subA2"};
 
 static state_t topB = {.itsInitialState  = &subB1,
                        .itsParentState   = NULL,
@@ -61,15 +67,18 @@ static state_t topB = {.itsInitialState  = &subB1,
                        .itsTransitionNum = 0,
                        .itsName          = " topB"};
 
-static state_t subB1 = {.itsInitialState = NULL,
-                        .itsParentState  = &topB,
-                        .onEntry         = NULL,
-                        .during          = NULL,
-                        .onExit          = NULL,
-                        .itsTransition =
-                            (hsm_transition_t[]){{NULL, NULL, &subA1}},
-                        .itsTransitionNum = 1,
-                        .itsName          = "subB1"};
+static state_t subB1 = {
+    .itsInitialState = NULL,
+    .itsParentState  = &topB,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition   = (hsm_transition_t[]){{.guard       = NULL,
+                                             .action      = NULL,
+                                             .targetState = &subA1,
+                                             .eventType   = HSM_EVENT_ANY}},
+    .itsTransitionNum = 1,
+    .itsName          = "subB1"};
 
 static state_t* stateList[] = {&topA, &subA1, &subA2, &topB, &subB1};
 
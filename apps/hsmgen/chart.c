@@ -0,0 +1,1412 @@
+/******************************************************************************
+	Code
+******************************************************************************/
+
+/******************************************************************************
+	Include files
+******************************************************************************/
+
+#include "chart.h"
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/******************************************************************************
+	Definitions
+******************************************************************************/
+
+/* Size of a token, labels hold a whole transition */
+#define CHART_TEXT_SIZE (256U)
+
+/******************************************************************************
+	Types
+******************************************************************************/
+
+/**
+ * \brief The kinds of tokens.
+ */
+typedef enum
+{
+	CHART_TK_END = 0u, /**< End of the file. */
+	CHART_TK_ID,       /**< Identifier, number or quoted string. */
+	CHART_TK_ARROW,    /**< The -> of an edge. */
+	CHART_TK_PUNCT,    /**< One of { } [ ] = ; , */
+	CHART_TK_ERROR     /**< Invalid input. */
+} chart_tokenType_t;
+
+/**
+ * \brief The parser's state.
+ */
+typedef struct
+{
+	/* Initialize and do not change again */
+	chart_t*    itsChart; /**< The chart being read. */
+	const char* itsPath;  /**< The file, for the errors. */
+	char*       itsText;  /**< The file's contents. */
+
+	/* Private data */
+	const char*       itsCursor;         /**< The next character. */
+	uint32_t          itsLine;           /**< The line of the cursor. */
+	chart_tokenType_t itsType;           /**< The current token. */
+	char itsToken[CHART_TEXT_SIZE];      /**< The current token's text. */
+	uint32_t itsStateSize;      /**< Capacity of the chart's states. */
+	uint32_t itsTransitionSize; /**< Capacity of the transitions. */
+	uint32_t itsEventSize;      /**< Capacity of the events. */
+	bool     hasFailed;         /**< If an error was reported. */
+} chart_parser_t;
+
+/******************************************************************************
+	Function definitions
+******************************************************************************/
+
+/**
+ * \brief Reports an error, only the first one is printed.
+ *
+ * \param[in,out] me      The parser.
+ * \param[in]     message The error.
+ * \param[in]     detail  What it is about.
+ *
+ * \return -1
+ */
+static int chart_error(chart_parser_t* const me,
+                       const char* const     message,
+                       const char* const     detail)
+{
+	if (!me->hasFailed)
+	{
+		(void)fprintf(stderr,
+		              "%s:%u: error: %s '%s'\n",
+		              me->itsPath,
+		              (unsigned)me->itsLine,
+		              message,
+		              detail);
+		me->hasFailed = true;
+	}
+
+	return -1;
+}
+
+/**
+ * \brief Reads a whole file.
+ *
+ * \param[in] path The file.
+ *
+ * \return The terminated contents, NULL on failure.
+ */
+static char* chart_load(const char* const path)
+{
+	char* text = NULL;
+	FILE* file = fopen(path, "rb");
+
+	if (file != NULL)
+	{
+		long size = -1;
+
+		if (fseek(file, 0, SEEK_END) == 0)
+		{
+			size = ftell(file);
+		}
+
+		if ((size >= 0) && (fseek(file, 0, SEEK_SET) == 0))
+		{
+			// cppcheck-suppress misra-c2012-21.3
+			text = (char*)malloc((size_t)size + 1U);
+		}
+
+		if (text != NULL)
+		{
+			const size_t num = fread(text, 1U, (size_t)size, file);
+
+			if (num == (size_t)size)
+			{
+				text[size] = '\0';
+			}
+			else
+			{
+				// cppcheck-suppress misra-c2012-21.3
+				free(text);
+				text = NULL;
+			}
+		}
+
+		(void)fclose(file);
+	}
+
+	return text;
+}
+
+/**
+ * \brief Grows an array if it is full.
+ *
+ * \param[in,out] items    The array.
+ * \param[in,out] capacity The number of items it holds.
+ * \param[in]     num      The number of items in use.
+ * \param[in]     size     The size of an item.
+ *
+ * \retval  0 Success.
+ * \retval -1 Out of memory.
+ */
+static int chart_grow(void** const     items,
+                      uint32_t* const  capacity,
+                      const uint32_t   num,
+                      const size_t     size)
+{
+	int errorCode = 0;
+
+	if (num == *capacity)
+	{
+		const uint32_t newCapacity =
+		    (*capacity == 0U) ? 16U : (*capacity * 2U);
+		// cppcheck-suppress misra-c2012-21.3
+		void* const aux = realloc(*items, (size_t)newCapacity * size);
+
+		if (aux == NULL)
+		{
+			/* Out of memory */
+			errorCode = -1;
+		}
+		else
+		{
+			*items    = aux;
+			*capacity = newCapacity;
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Copies a name.
+ *
+ * \param[out] name The copy, CHART_NAME_SIZE characters.
+ * \param[in]  text The name.
+ *
+ * \retval  0 Success.
+ * \retval -1 Too long.
+ */
+static int chart_copyName(char* const name, const char* const text)
+{
+	int errorCode = 0;
+
+	if (strlen(text) >= CHART_NAME_SIZE)
+	{
+		/* Does not fit */
+		errorCode = -1;
+	}
+	else
+	{
+		(void)strcpy(name, text);
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Checks a C identifier.
+ *
+ * \param[in] text The identifier.
+ *
+ * \return True if valid, False otherwise.
+ */
+static bool chart_isIdentifier(const char* const text)
+{
+	bool isValid = (isalpha((unsigned char)text[0]) != 0) ||
+	               (text[0] == '_');
+
+	for (size_t i = 1U; isValid && (text[i] != '\0'); i++)
+	{
+		isValid = (isalnum((unsigned char)text[i]) != 0) ||
+		          (text[i] == '_');
+	}
+
+	return isValid;
+}
+
+/**
+ * \brief Skips white space and comments.
+ *
+ * \param[in,out] me The parser.
+ */
+static void chart_skip(chart_parser_t* const me)
+{
+	bool isSkipping = true;
+
+	while (isSkipping)
+	{
+		const char* const c = me->itsCursor;
+
+		if (*c == '\n')
+		{
+			me->itsLine++;
+			me->itsCursor++;
+		}
+		else if (isspace((unsigned char)*c) != 0)
+		{
+			me->itsCursor++;
+		}
+		else if ((c[0] == '/') && (c[1] == '/'))
+		{
+			me->itsCursor += strcspn(c, "\n");
+		}
+		else if ((c[0] == '#') &&
+		         ((c == me->itsText) || (c[-1] == '\n')))
+		{
+			me->itsCursor += strcspn(c, "\n");
+		}
+		else if ((c[0] == '/') && (c[1] == '*'))
+		{
+			const char* const end = strstr(&c[2], "*/");
+			const char*       aux = c;
+
+			me->itsCursor =
+			    (end != NULL) ? &end[2] : &c[strlen(c)];
+
+			for (; aux < me->itsCursor; aux++)
+			{
+				me->itsLine += (*aux == '\n') ? 1U : 0U;
+			}
+		}
+		else
+		{
+			isSkipping = false;
+		}
+	}
+}
+
+/**
+ * \brief Reads the next token.
+ *
+ * \param[in,out] me The parser.
+ */
+static void chart_next(chart_parser_t* const me)
+{
+	const char* c   = NULL;
+	size_t      num = 0U;
+
+	chart_skip(me);
+	c = me->itsCursor;
+
+	me->itsToken[0] = '\0';
+
+	if (*c == '\0')
+	{
+		me->itsType = CHART_TK_END;
+	}
+	else if ((c[0] == '-') && (c[1] == '>'))
+	{
+		me->itsType = CHART_TK_ARROW;
+		me->itsCursor += 2;
+	}
+	else if (strchr("{}[]=;,", *c) != NULL)
+	{
+		me->itsType     = CHART_TK_PUNCT;
+		me->itsToken[0] = *c;
+		me->itsToken[1] = '\0';
+		me->itsCursor++;
+	}
+	else if (*c == '"')
+	{
+		me->itsType = CHART_TK_ID;
+		c++;
+
+		while ((*c != '"') && (*c != '\0') &&
+		       (num < (CHART_TEXT_SIZE - 1U)))
+		{
+			char aux = *c;
+
+			if ((aux == '\\') && (c[1] != '\0'))
+			{
+				c++;
+				/* Line breaks of labels */
+				aux = (strchr("nlr", *c) != NULL) ? ' ' : *c;
+			}
+
+			me->itsLine += (*c == '\n') ? 1U : 0U;
+			me->itsToken[num] = aux;
+			num++;
+			c++;
+		}
+
+		me->itsToken[num] = '\0';
+
+		if (*c != '"')
+		{
+			/* Unterminated or too long */
+			me->itsType = CHART_TK_ERROR;
+		}
+		else
+		{
+			me->itsCursor = &c[1];
+		}
+	}
+	else if ((isalnum((unsigned char)*c) != 0) || (*c == '_') ||
+	         (*c == '.'))
+	{
+		me->itsType = CHART_TK_ID;
+
+		while (((isalnum((unsigned char)*c) != 0) || (*c == '_') ||
+		        (*c == '.')) &&
+		       (num < (CHART_TEXT_SIZE - 1U)))
+		{
+			me->itsToken[num] = *c;
+			num++;
+			c++;
+		}
+
+		me->itsToken[num] = '\0';
+		me->itsCursor     = c;
+	}
+	else
+	{
+		me->itsType     = CHART_TK_ERROR;
+		me->itsToken[0] = *c;
+		me->itsToken[1] = '\0';
+	}
+}
+
+/**
+ * \brief Checks if the current token is a punctuation character.
+ */
+static bool chart_isPunct(const chart_parser_t* const me, const char c)
+{
+	return (me->itsType == CHART_TK_PUNCT) && (me->itsToken[0] == c);
+}
+
+/**
+ * \brief Checks if the current token is a keyword, in any case.
+ */
+static bool chart_isKeyword(const chart_parser_t* const me,
+                            const char* const           word)
+{
+	bool isEqual = (me->itsType == CHART_TK_ID);
+
+	for (size_t i = 0U; isEqual && (word[i] != '\0'); i++)
+	{
+		isEqual = (tolower((unsigned char)me->itsToken[i]) == word[i]);
+	}
+
+	return isEqual && (me->itsToken[strlen(word)] == '\0');
+}
+
+/**
+ * \brief Consumes a punctuation character.
+ *
+ * \retval  0 Success.
+ * \retval -1 Something else is there.
+ */
+static int chart_expect(chart_parser_t* const me, const char c)
+{
+	int errorCode = 0;
+
+	if (chart_isPunct(me, c))
+	{
+		chart_next(me);
+	}
+	else
+	{
+		const char expected[2] = {c, '\0'};
+
+		errorCode = chart_error(me, "expected", expected);
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Finds a state by name.
+ *
+ * \return The state, CHART_NONE if not found.
+ */
+static uint32_t chart_findState(const chart_t* const me,
+                                const char* const    name)
+{
+	uint32_t state = CHART_NONE;
+
+	for (uint32_t i = 0U; (i < me->itsStateNum) && (state == CHART_NONE);
+	     i++)
+	{
+		if (strcmp(me->itsStates[i].itsName, name) == 0)
+		{
+			state = i;
+		}
+	}
+
+	return state;
+}
+
+/**
+ * \brief Adds a state.
+ *
+ * \param[in,out] me     The parser.
+ * \param[in]     name   The state's name.
+ * \param[in]     parent The parent, CHART_NONE at the top.
+ *
+ * \return The state, CHART_NONE on failure.
+ */
+static uint32_t chart_addState(chart_parser_t* const me,
+                               const char* const     name,
+                               const uint32_t        parent)
+{
+	chart_t* const chart = me->itsChart;
+	uint32_t       state = CHART_NONE;
+
+	if (chart_grow((void**)&chart->itsStates,
+	               &me->itsStateSize,
+	               chart->itsStateNum,
+	               sizeof(chart_state_t)) != 0)
+	{
+		(void)chart_error(me, "out of memory at", name);
+	}
+	else
+	{
+		chart_state_t* const aux =
+		    &chart->itsStates[chart->itsStateNum];
+
+		(void)memset(aux, 0, sizeof(*aux));
+		aux->itsParent  = parent;
+		aux->itsInitial = CHART_NONE;
+		aux->itsLine    = me->itsLine;
+
+		if (chart_copyName(aux->itsName, name) != 0)
+		{
+			(void)chart_error(me, "name too long", name);
+		}
+		else
+		{
+			state = chart->itsStateNum;
+			chart->itsStateNum++;
+		}
+	}
+
+	/* The first child is the initial one */
+	if (state != CHART_NONE)
+	{
+		if (parent == CHART_NONE)
+		{
+			if (chart->itsInitial == CHART_NONE)
+			{
+				chart->itsInitial = state;
+			}
+		}
+		else if (chart->itsStates[parent].itsInitial == CHART_NONE)
+		{
+			chart->itsStates[parent].itsInitial = state;
+		}
+		else
+		{
+			/* Not the first */
+		}
+	}
+
+	return state;
+}
+
+/**
+ * \brief Finds a state by name or adds it.
+ *
+ * \return The state, CHART_NONE on failure.
+ */
+static uint32_t chart_getState(chart_parser_t* const me,
+                               const char* const     name,
+                               const uint32_t        parent)
+{
+	uint32_t state = chart_findState(me->itsChart, name);
+
+	if (state == CHART_NONE)
+	{
+		state = chart_addState(me, name, parent);
+	}
+
+	return state;
+}
+
+/**
+ * \brief Finds an event by name or adds it.
+ *
+ * \return The event's index + 1, 0 for any event, CHART_NONE on failure.
+ */
+static uint32_t chart_getEvent(chart_parser_t* const me,
+                               const char* const     name)
+{
+	chart_t* const chart = me->itsChart;
+	uint32_t       event = CHART_NONE;
+
+	if ((name[0] == '\0') || (strcmp(name, "ANY") == 0))
+	{
+		event = 0U;
+	}
+	else if (!chart_isIdentifier(name))
+	{
+		(void)chart_error(me, "invalid event", name);
+	}
+	else
+	{
+		for (uint32_t i = 0U;
+		     (i < chart->itsEventNum) && (event == CHART_NONE);
+		     i++)
+		{
+			if (strcmp(chart->itsEvents[i], name) == 0)
+			{
+				event = i + 1U;
+			}
+		}
+	}
+
+	if ((event == CHART_NONE) && !me->hasFailed)
+	{
+		if (chart_grow((void**)&chart->itsEvents,
+		               &me->itsEventSize,
+		               chart->itsEventNum,
+		               CHART_NAME_SIZE) != 0)
+		{
+			(void)chart_error(me, "out of memory at", name);
+		}
+		else if (chart_copyName(chart->itsEvents[chart->itsEventNum],
+		                        name) != 0)
+		{
+			(void)chart_error(me, "name too long", name);
+		}
+		else
+		{
+			chart->itsEventNum++;
+			event = chart->itsEventNum;
+		}
+	}
+
+	return event;
+}
+
+/**
+ * \brief Copies an action's name.
+ *
+ * \param[in,out] me   The parser.
+ * \param[out]    name The copy, "" for none.
+ * \param[in]     text The name.
+ *
+ * \retval  0 Success.
+ * \retval -1 Invalid name.
+ */
+static int chart_setAction(chart_parser_t* const me,
+                           char* const           name,
+                           const char* const     text)
+{
+	int errorCode = 0;
+
+	if ((text[0] != '\0') && !chart_isIdentifier(text))
+	{
+		errorCode = chart_error(me, "invalid function", text);
+	}
+	else if (chart_copyName(name, text) != 0)
+	{
+		errorCode = chart_error(me, "name too long", text);
+	}
+	else
+	{
+		/* Copied */
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Removes the leading and trailing white space.
+ *
+ * \param[in,out] text The text.
+ *
+ * \return The trimmed text, inside the original.
+ */
+static char* chart_trim(char* text)
+{
+	size_t num = 0U;
+
+	while (isspace((unsigned char)*text) != 0)
+	{
+		text++;
+	}
+
+	num = strlen(text);
+
+	while ((num > 0U) && (isspace((unsigned char)text[num - 1U]) != 0))
+	{
+		num--;
+	}
+
+	text[num] = '\0';
+
+	return text;
+}
+
+/**
+ * \brief Reads the label of an edge: "EVENT [ guard ] / action".
+ *
+ * \param[in,out] me         The parser.
+ * \param[out]    transition The transition.
+ * \param[in,out] label      The label, it gets split.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int chart_parseLabel(chart_parser_t* const     me,
+                            chart_transition_t* const transition,
+                            char* const               label)
+{
+	char* action = strchr(label, '/');
+	char* guard  = strchr(label, '[');
+	int   errorCode = 0;
+
+	if (action != NULL)
+	{
+		*action = '\0';
+		action  = chart_trim(&action[1]);
+	}
+
+	if (guard != NULL)
+	{
+		char* const end = strchr(guard, ']');
+
+		if (end == NULL)
+		{
+			errorCode = chart_error(me, "missing ']' in", guard);
+		}
+		else
+		{
+			*guard = '\0';
+			*end   = '\0';
+			guard  = chart_trim(&guard[1]);
+		}
+	}
+
+	if (errorCode == 0)
+	{
+		transition->itsEvent = chart_getEvent(me, chart_trim(label));
+		errorCode = (transition->itsEvent == CHART_NONE) ? -1 : 0;
+	}
+
+	if ((errorCode == 0) && (guard != NULL))
+	{
+		errorCode = chart_setAction(me, transition->itsGuard, guard);
+	}
+
+	if ((errorCode == 0) && (action != NULL))
+	{
+		errorCode = chart_setAction(me, transition->itsAction, action);
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Sets an attribute of a node or an edge.
+ *
+ * Nodes take entry, during, exit and initial, edges take label. Any other
+ * attribute is only drawing and is ignored.
+ *
+ * \param[in,out] me         The parser.
+ * \param[in]     state      The node's state, or CHART_NONE.
+ * \param[out]    transition The edge's transition, or NULL.
+ * \param[in]     key        The attribute.
+ * \param[in,out] value      The attribute's value.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int chart_setAttribute(chart_parser_t* const     me,
+                              const uint32_t            state,
+                              chart_transition_t* const transition,
+                              const char* const         key,
+                              char* const               value)
+{
+	chart_t* const chart     = me->itsChart;
+	int            errorCode = 0;
+
+	if (state != CHART_NONE)
+	{
+		chart_state_t* const aux    = &chart->itsStates[state];
+		const uint32_t       parent = aux->itsParent;
+
+		if (strcmp(key, "entry") == 0)
+		{
+			errorCode = chart_setAction(me, aux->itsEntry, value);
+		}
+		else if (strcmp(key, "during") == 0)
+		{
+			errorCode = chart_setAction(me, aux->itsDuring, value);
+		}
+		else if (strcmp(key, "exit") == 0)
+		{
+			errorCode = chart_setAction(me, aux->itsExit, value);
+		}
+		else if ((strcmp(key, "initial") == 0) &&
+		         (strcmp(value, "false") != 0))
+		{
+			if (parent == CHART_NONE)
+			{
+				chart->itsInitial = state;
+			}
+			else
+			{
+				chart->itsStates[parent].itsInitial = state;
+			}
+		}
+		else
+		{
+			/* Drawing only */
+		}
+	}
+	else if ((transition != NULL) && (strcmp(key, "label") == 0))
+	{
+		errorCode = chart_parseLabel(me, transition, value);
+	}
+	else
+	{
+		/* Drawing only */
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Reads an attribute, key = value.
+ *
+ * \param[in,out] me         The parser.
+ * \param[in]     state      The node's state, or CHART_NONE.
+ * \param[out]    transition The edge's transition, or NULL.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int chart_parseAttribute(chart_parser_t* const     me,
+                                const uint32_t            state,
+                                chart_transition_t* const transition)
+{
+	char key[CHART_NAME_SIZE] = "";
+	int  errorCode            = 0;
+
+	if ((me->itsType != CHART_TK_ID) ||
+	    (chart_copyName(key, me->itsToken) != 0))
+	{
+		errorCode =
+		    chart_error(me, "expected attribute at", me->itsToken);
+	}
+
+	if (errorCode == 0)
+	{
+		chart_next(me);
+		errorCode = chart_expect(me, '=');
+	}
+
+	if ((errorCode == 0) && (me->itsType != CHART_TK_ID))
+	{
+		errorCode = chart_error(me, "expected value at", me->itsToken);
+	}
+
+	if (errorCode == 0)
+	{
+		errorCode = chart_setAttribute(me,
+		                               state,
+		                               transition,
+		                               key,
+		                               me->itsToken);
+	}
+
+	if (errorCode == 0)
+	{
+		chart_next(me);
+
+		if (chart_isPunct(me, ',') || chart_isPunct(me, ';'))
+		{
+			chart_next(me);
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Reads attribute lists, [ key = value, ... ].
+ *
+ * \param[in,out] me         The parser.
+ * \param[in]     state      The node's state, or CHART_NONE.
+ * \param[out]    transition The edge's transition, or NULL.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int chart_parseAttributes(chart_parser_t* const     me,
+                                 const uint32_t            state,
+                                 chart_transition_t* const transition)
+{
+	int errorCode = 0;
+
+	while ((errorCode == 0) && chart_isPunct(me, '['))
+	{
+		chart_next(me);
+
+		while ((errorCode == 0) && !chart_isPunct(me, ']'))
+		{
+			errorCode =
+			    chart_parseAttribute(me, state, transition);
+		}
+
+		if (errorCode == 0)
+		{
+			errorCode = chart_expect(me, ']');
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Reads the rest of an edge, after its source.
+ *
+ * \param[in,out] me     The parser.
+ * \param[in]     source The source state.
+ * \param[in]     parent The enclosing cluster's state, or CHART_NONE.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int chart_parseEdge(chart_parser_t* const me,
+                           const uint32_t        source,
+                           const uint32_t        parent)
+{
+	chart_t* const     chart     = me->itsChart;
+	uint32_t           target    = CHART_NONE;
+	chart_transition_t aux       = {0};
+	int                errorCode = 0;
+
+	/* Skip the arrow */
+	chart_next(me);
+
+	if (me->itsType != CHART_TK_ID)
+	{
+		errorCode =
+		    chart_error(me, "expected target at", me->itsToken);
+	}
+	else
+	{
+		target = chart_getState(me, me->itsToken, parent);
+		errorCode = (target == CHART_NONE) ? -1 : 0;
+	}
+
+	if (errorCode == 0)
+	{
+		chart_next(me);
+
+		aux.itsSource = source;
+		aux.itsTarget = (target == source) ? CHART_NONE : target;
+		aux.itsEvent  = 0U;
+
+		errorCode = chart_parseAttributes(me, CHART_NONE, &aux);
+	}
+
+	if ((errorCode == 0) && (me->itsType == CHART_TK_ARROW))
+	{
+		errorCode = chart_error(me, "chained edges, split", "->");
+	}
+
+	if (errorCode == 0)
+	{
+		if (chart_grow((void**)&chart->itsTransitions,
+		               &me->itsTransitionSize,
+		               chart->itsTransitionNum,
+		               sizeof(chart_transition_t)) != 0)
+		{
+			errorCode = chart_error(me, "out of memory at", "->");
+		}
+		else
+		{
+			chart->itsTransitions[chart->itsTransitionNum] = aux;
+			chart->itsTransitionNum++;
+		}
+	}
+
+	return errorCode;
+}
+
+static int chart_parseStatements(chart_parser_t* const me,
+                                 const uint32_t        parent);
+
+/**
+ * \brief Reads a subgraph, after the subgraph keyword.
+ *
+ * \param[in,out] me     The parser.
+ * \param[in]     parent The enclosing cluster's state, or CHART_NONE.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int chart_parseSubgraph(chart_parser_t* const me,
+                               const uint32_t        parent)
+{
+	static const char prefix[]  = "cluster_";
+	uint32_t          state     = parent;
+	int               errorCode = 0;
+
+	if (me->itsType == CHART_TK_ID)
+	{
+		/* Only clusters are states */
+		if (strncmp(me->itsToken, prefix, sizeof(prefix) - 1U) == 0)
+		{
+			const char* const name =
+			    &me->itsToken[sizeof(prefix) - 1U];
+
+			state = chart_addState(me, name, parent);
+			errorCode = (state == CHART_NONE) ? -1 : 0;
+		}
+
+		chart_next(me);
+	}
+
+	if (errorCode == 0)
+	{
+		errorCode = chart_expect(me, '{');
+	}
+
+	if (errorCode == 0)
+	{
+		errorCode = chart_parseStatements(me, state);
+	}
+
+	if (errorCode == 0)
+	{
+		errorCode = chart_expect(me, '}');
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Reads an attribute of a subgraph, after its key.
+ *
+ * The label of a cluster is the name of its state.
+ *
+ * \param[in,out] me     The parser.
+ * \param[in]     parent The enclosing cluster's state, or CHART_NONE.
+ * \param[in]     key    The attribute.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int chart_parseAssignment(chart_parser_t* const me,
+                                 const uint32_t        parent,
+                                 const char* const     key)
+{
+	chart_t* const chart     = me->itsChart;
+	int            errorCode = 0;
+
+	/* Skip the = */
+	chart_next(me);
+
+	if (me->itsType != CHART_TK_ID)
+	{
+		errorCode = chart_error(me, "expected value at", me->itsToken);
+	}
+	else if ((strcmp(key, "label") != 0) || (parent == CHART_NONE))
+	{
+		/* Drawing only */
+	}
+	else if ((chart_findState(chart, me->itsToken) != CHART_NONE) &&
+	         (chart_findState(chart, me->itsToken) != parent))
+	{
+		errorCode = chart_error(me, "duplicate state", me->itsToken);
+	}
+	else if (chart_copyName(chart->itsStates[parent].itsName,
+	                        me->itsToken) != 0)
+	{
+		errorCode = chart_error(me, "name too long", me->itsToken);
+	}
+	else
+	{
+		/* Renamed */
+	}
+
+	if (errorCode == 0)
+	{
+		chart_next(me);
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Reads a node or an edge, after the first name.
+ *
+ * \param[in,out] me     The parser.
+ * \param[in]     parent The enclosing cluster's state, or CHART_NONE.
+ * \param[in]     name   The node.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int chart_parseNode(chart_parser_t* const me,
+                           const uint32_t        parent,
+                           const char* const     name)
+{
+	const uint32_t state     = chart_getState(me, name, parent);
+	int            errorCode = 0;
+
+	if (state == CHART_NONE)
+	{
+		errorCode = -1;
+	}
+	else if (me->itsType == CHART_TK_ARROW)
+	{
+		errorCode = chart_parseEdge(me, state, parent);
+	}
+	else
+	{
+		errorCode = chart_parseAttributes(me, state, NULL);
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Reads a statement.
+ *
+ * \param[in,out] me     The parser.
+ * \param[in]     parent The enclosing cluster's state, or CHART_NONE.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int chart_parseStatement(chart_parser_t* const me,
+                                const uint32_t        parent)
+{
+	int errorCode = 0;
+
+	if (chart_isKeyword(me, "subgraph"))
+	{
+		chart_next(me);
+		errorCode = chart_parseSubgraph(me, parent);
+	}
+	else if (chart_isPunct(me, '{'))
+	{
+		errorCode = chart_parseSubgraph(me, parent);
+	}
+	else if (chart_isKeyword(me, "graph") || chart_isKeyword(me, "node") ||
+	         chart_isKeyword(me, "edge"))
+	{
+		/* Drawing defaults */
+		chart_next(me);
+		errorCode = chart_parseAttributes(me, CHART_NONE, NULL);
+	}
+	else if (me->itsType == CHART_TK_ID)
+	{
+		char name[CHART_TEXT_SIZE];
+
+		(void)strcpy(name, me->itsToken);
+		chart_next(me);
+
+		if (chart_isPunct(me, '='))
+		{
+			errorCode = chart_parseAssignment(me, parent, name);
+		}
+		else
+		{
+			errorCode = chart_parseNode(me, parent, name);
+		}
+	}
+	else
+	{
+		errorCode = chart_error(me, "unexpected", me->itsToken);
+	}
+
+	if ((errorCode == 0) &&
+	    (chart_isPunct(me, ';') || chart_isPunct(me, ',')))
+	{
+		chart_next(me);
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Reads statements up to the closing brace.
+ *
+ * \param[in,out] me     The parser.
+ * \param[in]     parent The enclosing cluster's state, or CHART_NONE.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int chart_parseStatements(chart_parser_t* const me,
+                                 const uint32_t        parent)
+{
+	int errorCode = 0;
+
+	while ((errorCode == 0) && !chart_isPunct(me, '}'))
+	{
+		if (me->itsType == CHART_TK_END)
+		{
+			errorCode = chart_error(me, "expected", "}");
+		}
+		else
+		{
+			errorCode = chart_parseStatement(me, parent);
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Reads the graph: [strict] digraph [name] { statements }.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int chart_parseGraph(chart_parser_t* const me)
+{
+	int errorCode = 0;
+
+	chart_next(me);
+
+	if (chart_isKeyword(me, "strict"))
+	{
+		chart_next(me);
+	}
+
+	if (chart_isKeyword(me, "digraph"))
+	{
+		chart_next(me);
+	}
+	else
+	{
+		errorCode = chart_error(me, "expected", "digraph");
+	}
+
+	if ((errorCode == 0) && (me->itsType == CHART_TK_ID))
+	{
+		chart_next(me);
+	}
+
+	if (errorCode == 0)
+	{
+		errorCode = chart_expect(me, '{');
+	}
+
+	if (errorCode == 0)
+	{
+		errorCode = chart_parseStatements(me, CHART_NONE);
+	}
+
+	if (errorCode == 0)
+	{
+		errorCode = chart_expect(me, '}');
+	}
+
+	if ((errorCode == 0) && (me->itsType != CHART_TK_END))
+	{
+		errorCode = chart_error(me, "unexpected", me->itsToken);
+	}
+
+	if ((errorCode == 0) && (me->itsChart->itsStateNum == 0U))
+	{
+		errorCode = chart_error(me, "no states in", me->itsPath);
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Gives the states their depth first order.
+ *
+ * \param[in]     me    The chart.
+ * \param[in]     state The state to visit.
+ * \param[out]    order The new index of each state.
+ * \param[in,out] num   The states ordered so far.
+ */
+static void chart_visit(const chart_t* const me,
+                        const uint32_t       state,
+                        uint32_t* const      order,
+                        uint32_t* const      num)
+{
+	order[state] = *num;
+	(*num)++;
+
+	for (uint32_t i = 0U; i < me->itsStateNum; i++)
+	{
+		if (me->itsStates[i].itsParent == state)
+		{
+			chart_visit(me, i, order, num);
+		}
+	}
+}
+
+/**
+ * \brief Puts the states in depth first order and groups the transitions
+ *        by source state.
+ *
+ * Parents come before their children and siblings are together, so the
+ * states of a path and the transitions checked for an event are close.
+ *
+ * \retval  0 Success.
+ * \retval -1 Out of memory.
+ */
+static int chart_sort(chart_t* const me)
+{
+	const size_t stateSize = me->itsStateNum * sizeof(chart_state_t);
+	const size_t transitionSize =
+	    me->itsTransitionNum * sizeof(chart_transition_t);
+	// cppcheck-suppress misra-c2012-21.3
+	uint32_t* const order =
+	    (uint32_t*)malloc(me->itsStateNum * sizeof(uint32_t));
+	// cppcheck-suppress misra-c2012-21.3
+	chart_state_t* const states = (chart_state_t*)malloc(stateSize);
+	// cppcheck-suppress misra-c2012-21.3
+	chart_transition_t* const transitions =
+	    (chart_transition_t*)malloc(transitionSize + 1U);
+	int errorCode = 0;
+
+	if ((order == NULL) || (states == NULL) || (transitions == NULL))
+	{
+		/* Out of memory */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		uint32_t num = 0U;
+
+		for (uint32_t i = 0U; i < me->itsStateNum; i++)
+		{
+			if (me->itsStates[i].itsParent == CHART_NONE)
+			{
+				chart_visit(me, i, order, &num);
+			}
+		}
+
+		for (uint32_t i = 0U; i < me->itsStateNum; i++)
+		{
+			chart_state_t* const aux = &states[order[i]];
+
+			*aux = me->itsStates[i];
+
+			if (aux->itsParent != CHART_NONE)
+			{
+				aux->itsParent = order[aux->itsParent];
+			}
+
+			if (aux->itsInitial != CHART_NONE)
+			{
+				aux->itsInitial = order[aux->itsInitial];
+			}
+		}
+
+		/* Stable, in the order they were declared */
+		num = 0U;
+
+		for (uint32_t i = 0U; i < me->itsStateNum; i++)
+		{
+			for (uint32_t j = 0U; j < me->itsTransitionNum; j++)
+			{
+				const chart_transition_t* const aux =
+				    &me->itsTransitions[j];
+
+				if (order[aux->itsSource] == i)
+				{
+					transitions[num] = *aux;
+					transitions[num].itsSource = i;
+
+					if (aux->itsTarget != CHART_NONE)
+					{
+						transitions[num].itsTarget =
+						    order[aux->itsTarget];
+					}
+
+					num++;
+				}
+			}
+		}
+
+		(void)memcpy(me->itsStates, states, stateSize);
+		(void)memcpy(me->itsTransitions, transitions, transitionSize);
+		me->itsInitial = order[me->itsInitial];
+	}
+
+	// cppcheck-suppress misra-c2012-21.3
+	free(order);
+	// cppcheck-suppress misra-c2012-21.3
+	free(states);
+	// cppcheck-suppress misra-c2012-21.3
+	free(transitions);
+
+	return errorCode;
+}
+
+/**
+ * \brief Reads a state chart from a DOT file.
+ *
+ * Errors are printed to stderr.
+ *
+ * \param[out] me   The chart.
+ * \param[in]  path The DOT file.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int chart_read(chart_t* const me, const char* const path)
+{
+	chart_parser_t parser;
+	int            errorCode = 0;
+
+	(void)memset(me, 0, sizeof(*me));
+	me->itsInitial = CHART_NONE;
+
+	(void)memset(&parser, 0, sizeof(parser));
+	parser.itsChart  = me;
+	parser.itsPath   = path;
+	parser.itsText   = chart_load(path);
+	parser.itsCursor = parser.itsText;
+	parser.itsLine   = 1U;
+
+	if (parser.itsText == NULL)
+	{
+		errorCode = chart_error(&parser, "can not read", path);
+	}
+
+	if (errorCode == 0)
+	{
+		errorCode = chart_parseGraph(&parser);
+	}
+
+	if (errorCode == 0)
+	{
+		errorCode = chart_sort(me);
+	}
+
+	if (errorCode != 0)
+	{
+		chart_destroy(me);
+	}
+
+	// cppcheck-suppress misra-c2012-21.3
+	free(parser.itsText);
+
+	return errorCode;
+}
+
+/**
+ * \brief Frees a chart.
+ *
+ * \param[in,out] me The chart.
+ */
+void chart_destroy(chart_t* const me)
+{
+	// cppcheck-suppress misra-c2012-21.3
+	free(me->itsStates);
+	// cppcheck-suppress misra-c2012-21.3
+	free(me->itsTransitions);
+	// cppcheck-suppress misra-c2012-21.3
+	free(me->itsEvents);
+
+	(void)memset(me, 0, sizeof(*me));
+	me->itsInitial = CHART_NONE;
+}
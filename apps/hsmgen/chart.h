@@ -0,0 +1,102 @@
+/******************************************************************************
+	About
+******************************************************************************/
+
+/**
+ * \file     chart.h
+ *
+ * \brief    State chart read from a DOT description.
+ *
+ * The chart is the subset of DOT used by the diagrams of the tests:
+ *
+ * - A "cluster_" subgraph is a state with children, named by its label.
+ *   Its initial state is its first child, or the child marked initial.
+ *   The same goes for the initial state of the chart.
+ * - Any other node is a leaf state. The attributes entry, during and exit
+ *   name its actions.
+ * - An edge is a transition, its label is "EVENT [ guard ] / action". An
+ *   empty or ANY event matches every event and a self loop is internal.
+ *
+ * Created:  18/10/2026
+ */
+
+/******************************************************************************
+	Code
+******************************************************************************/
+
+#ifndef CHART_H_ONLY_ONE_INCLUDE_SAFETY
+#define CHART_H_ONLY_ONE_INCLUDE_SAFETY
+
+/******************************************************************************
+	Include files
+******************************************************************************/
+
+#include <stdint.h>
+
+/******************************************************************************
+	Definitions
+******************************************************************************/
+
+/* Size of the names, including the terminator */
+#define CHART_NAME_SIZE (64U)
+
+/* No state */
+#define CHART_NONE (0xFFFFFFFFU)
+
+/******************************************************************************
+	Types
+******************************************************************************/
+
+/**
+ * \brief A state of the chart.
+ */
+typedef struct
+{
+	char     itsName[CHART_NAME_SIZE];   /**< The state's name. */
+	char     itsEntry[CHART_NAME_SIZE];  /**< On entry action, or "". */
+	char     itsDuring[CHART_NAME_SIZE]; /**< During action, or "". */
+	char     itsExit[CHART_NAME_SIZE];   /**< On exit action, or "". */
+	uint32_t itsParent;  /**< The parent, CHART_NONE at the top. */
+	uint32_t itsInitial; /**< The initial child, CHART_NONE if leaf. */
+	uint32_t itsLine;    /**< Where it was declared. */
+} chart_state_t;
+
+/**
+ * \brief A transition of the chart.
+ */
+typedef struct
+{
+	char     itsGuard[CHART_NAME_SIZE];  /**< The guard, or "". */
+	char     itsAction[CHART_NAME_SIZE]; /**< The action, or "". */
+	uint32_t itsSource; /**< The source state. */
+	uint32_t itsTarget; /**< The target state, CHART_NONE: internal. */
+	uint32_t itsEvent;  /**< 0: any event, else the event's index + 1. */
+} chart_transition_t;
+
+/**
+ * \brief A state chart.
+ *
+ * After \see chart_read the states are in depth first order, so every
+ * state comes after its parent and the children of a state are together.
+ * The transitions are grouped by source state in the same order.
+ */
+typedef struct
+{
+	chart_state_t*      itsStates;      /**< The states. */
+	chart_transition_t* itsTransitions; /**< The transitions. */
+	char (*itsEvents)[CHART_NAME_SIZE]; /**< The events' names. */
+	uint32_t itsStateNum;      /**< The number of states. */
+	uint32_t itsTransitionNum; /**< The number of transitions. */
+	uint32_t itsEventNum;      /**< The number of events. */
+	uint32_t itsInitial;       /**< The first state to enter. */
+} chart_t;
+
+/******************************************************************************
+	Function declarations
+******************************************************************************/
+
+int chart_read(chart_t* const me, const char* const path);
+
+void chart_destroy(chart_t* const me);
+
+#endif /* CHART_H_ONLY_ONE_INCLUDE_SAFETY */
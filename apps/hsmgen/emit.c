@@ -0,0 +1,1140 @@
+/******************************************************************************
+	Code
+******************************************************************************/
+
+/******************************************************************************
+	Include files
+******************************************************************************/
+
+#include "emit.h"
+
+#include "chart.h"
+#include "hsm.h"
+#include "hsm_def.h"
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/******************************************************************************
+	Definitions
+******************************************************************************/
+
+/* Numbers per line of the tables */
+#define EMIT_COLUMNS (8U)
+
+/******************************************************************************
+	Types
+******************************************************************************/
+
+/**
+ * \brief The chart being written.
+ */
+typedef struct
+{
+	/* Initialize and do not change again */
+	const chart_t* itsChart;         /**< The chart. */
+	const char*    itsSource;        /**< The chart's file. */
+	const char*    itsName;          /**< The output, no directory. */
+	char itsPrefix[CHART_NAME_SIZE]; /**< Prefix of the variables. */
+	char itsMacro[CHART_NAME_SIZE];  /**< Prefix of the constants. */
+
+	/* Private data */
+	state_t*          itsStates;      /**< The chart's states. */
+	hsm_transition_t* itsTransitions; /**< The chart's transitions. */
+	const state_t**   itsStateList;   /**< The states, by id. */
+	hsm_def_t         itsDef;         /**< Their definition. */
+} emit_t;
+
+/******************************************************************************
+	Function definitions
+******************************************************************************/
+
+/**
+ * \brief Stands for the user's entry, during, exit and guard functions.
+ */
+static bool emit_isTrue(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	(void)event;
+	return true;
+}
+
+/**
+ * \brief Stands for the user's actions.
+ */
+static void emit_doNothing(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	(void)event;
+}
+
+/**
+ * \brief Makes the upper case identifier of a name.
+ *
+ * \param[out] macro The identifier, CHART_NAME_SIZE characters.
+ * \param[in]  name  The name.
+ */
+static void emit_getMacro(char* const macro, const char* const name)
+{
+	size_t i = 0U;
+
+	for (; (name[i] != '\0') && (i < (CHART_NAME_SIZE - 1U)); i++)
+	{
+		const unsigned char c = (unsigned char)name[i];
+
+		macro[i] = (isalnum(c) != 0) ? (char)toupper(c) : '_';
+	}
+
+	macro[i] = '\0';
+}
+
+/**
+ * \brief Gets the number of transitions of a state.
+ *
+ * \param[in] me    The chart.
+ * \param[in] first The state's first transition.
+ * \param[in] state The state.
+ */
+static uint32_t emit_getTransitionNum(const chart_t* const me,
+                                      const uint32_t       first,
+                                      const uint32_t       state)
+{
+	uint32_t num = 0U;
+
+	while (((first + num) < me->itsTransitionNum) &&
+	       (me->itsTransitions[first + num].itsSource == state))
+	{
+		num++;
+	}
+
+	return num;
+}
+
+/**
+ * \brief Builds the definition of the chart with hsm_def_build.
+ *
+ * The states get stand-in functions, only whether they have one matters
+ * to the tables.
+ *
+ * \param[in,out] me The chart being written.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int emit_build(emit_t* const me)
+{
+	const chart_t* const chart     = me->itsChart;
+	const uint32_t       stateNum  = chart->itsStateNum;
+	uint32_t             first     = 0U;
+	int                  errorCode = 0;
+
+	// cppcheck-suppress misra-c2012-21.3
+	me->itsStates = (state_t*)calloc(stateNum, sizeof(state_t));
+	// cppcheck-suppress misra-c2012-21.3
+	me->itsTransitions = (hsm_transition_t*)calloc(
+	    chart->itsTransitionNum + 1U, sizeof(hsm_transition_t));
+	// cppcheck-suppress misra-c2012-21.3
+	me->itsStateList =
+	    (const state_t**)calloc(stateNum, sizeof(const state_t*));
+
+	if ((me->itsStates == NULL) || (me->itsTransitions == NULL) ||
+	    (me->itsStateList == NULL))
+	{
+		(void)fprintf(stderr, "error: out of memory\n");
+		errorCode = -1;
+	}
+
+	for (uint32_t i = 0U;
+	     (errorCode == 0) && (i < chart->itsTransitionNum);
+	     i++)
+	{
+		const chart_transition_t* const aux =
+		    &chart->itsTransitions[i];
+		const uint32_t         target    = aux->itsTarget;
+		const bool             hasGuard  = (aux->itsGuard[0] != '\0');
+		const bool             hasAction = (aux->itsAction[0] != '\0');
+		const hsm_transition_t transition = {
+		    .guard  = hasGuard ? emit_isTrue : NULL,
+		    .action = hasAction ? emit_doNothing : NULL,
+		    .targetState =
+		        (target != CHART_NONE) ? &me->itsStates[target] : NULL,
+		    .eventType = aux->itsEvent};
+
+		(void)memcpy(&me->itsTransitions[i],
+		             &transition,
+		             sizeof(transition));
+	}
+
+	for (uint32_t i = 0U; (errorCode == 0) && (i < stateNum); i++)
+	{
+		const chart_state_t* const aux = &chart->itsStates[i];
+		const uint32_t initial   = aux->itsInitial;
+		const uint32_t parent    = aux->itsParent;
+		const bool     hasEntry  = (aux->itsEntry[0] != '\0');
+		const bool     hasDuring = (aux->itsDuring[0] != '\0');
+		const bool     hasExit   = (aux->itsExit[0] != '\0');
+		const uint32_t num = emit_getTransitionNum(chart, first, i);
+		state_t* const states = me->itsStates;
+		const state_t  state  = {
+		      .itsInitialState =
+		          (initial != CHART_NONE) ? &states[initial] : NULL,
+		      .itsParentState =
+		          (parent != CHART_NONE) ? &states[parent] : NULL,
+		      .onEntry = hasEntry ? emit_isTrue : NULL,
+		      .during  = hasDuring ? emit_isTrue : NULL,
+		      .onExit  = hasExit ? emit_isTrue : NULL,
+		      .itsTransition =
+		          (num != 0U) ? &me->itsTransitions[first] : NULL,
+		      .itsTransitionNum = num,
+		      .itsMode          = HSM_ST_M_ON_ENTRY,
+		      .itsHistoryState  = NULL,
+		      .itsName          = aux->itsName};
+
+		(void)memcpy(&me->itsStates[i], &state, sizeof(state));
+		me->itsStateList[i] = &me->itsStates[i];
+		first += num;
+	}
+
+	if (errorCode == 0)
+	{
+		errorCode = _hsm_def_build(&me->itsDef,
+		                           me->itsStateList[chart->itsInitial],
+		                           me->itsStateList,
+		                           stateNum);
+
+		if (errorCode == 0)
+		{
+			const uint32_t eventTypeNum = chart->itsEventNum + 1U;
+
+			errorCode = hsm_def_compile(&me->itsDef, eventTypeNum);
+		}
+
+		if (errorCode != 0)
+		{
+			(void)fprintf(stderr,
+			              "%s: error: invalid chart, nested "
+			              "deeper than %u?\n",
+			              me->itsSource,
+			              (unsigned)HSM_MAX_DEPTH);
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Checks that two states do not get the same constant.
+ *
+ * \param[in] me The chart being written.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int emit_checkStates(const emit_t* const me)
+{
+	const chart_t* const chart     = me->itsChart;
+	int                  errorCode = 0;
+
+	for (uint32_t i = 0U; i < chart->itsStateNum; i++)
+	{
+		char a[CHART_NAME_SIZE];
+
+		emit_getMacro(a, chart->itsStates[i].itsName);
+
+		for (uint32_t j = i + 1U;
+		     (errorCode == 0) && (j < chart->itsStateNum);
+		     j++)
+		{
+			const chart_state_t* const aux = &chart->itsStates[j];
+			char                       b[CHART_NAME_SIZE];
+
+			emit_getMacro(b, aux->itsName);
+
+			if (strcmp(a, b) == 0)
+			{
+				(void)fprintf(stderr,
+				              "%s:%u: error: '%s' is also "
+				              "%s_ST_%s\n",
+				              me->itsSource,
+				              (unsigned)aux->itsLine,
+				              aux->itsName,
+				              me->itsMacro,
+				              b);
+				errorCode = -1;
+			}
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Checks if a function returns bool.
+ *
+ * \param[in] me   The chart.
+ * \param[in] name The function.
+ *
+ * \return True if it is a guard or a state's function, False otherwise.
+ */
+static bool emit_isBool(const chart_t* const me, const char* const name)
+{
+	bool isBool = false;
+
+	for (uint32_t i = 0U; (!isBool) && (i < me->itsStateNum); i++)
+	{
+		const chart_state_t* const aux = &me->itsStates[i];
+
+		isBool = (strcmp(name, aux->itsEntry) == 0) ||
+		         (strcmp(name, aux->itsDuring) == 0) ||
+		         (strcmp(name, aux->itsExit) == 0);
+	}
+
+	for (uint32_t i = 0U; (!isBool) && (i < me->itsTransitionNum); i++)
+	{
+		isBool = (strcmp(name, me->itsTransitions[i].itsGuard) == 0);
+	}
+
+	return isBool;
+}
+
+/**
+ * \brief Checks that the chart's names make valid C.
+ *
+ * \param[in] me The chart being written.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int emit_check(const emit_t* const me)
+{
+	const chart_t* const chart     = me->itsChart;
+	int                  errorCode = emit_checkStates(me);
+
+	/* Actions return nothing, the rest return bool */
+	for (uint32_t i = 0U;
+	     (errorCode == 0) && (i < chart->itsTransitionNum);
+	     i++)
+	{
+		const char* const action = chart->itsTransitions[i].itsAction;
+
+		if ((action[0] != '\0') && emit_isBool(chart, action))
+		{
+			(void)fprintf(stderr,
+			              "%s: error: '%s' is an action and "
+			              "returns bool elsewhere\n",
+			              me->itsSource,
+			              action);
+			errorCode = -1;
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Writes the declaration of a user's function once.
+ *
+ * \param[in]     file     The header.
+ * \param[in]     name     The function, or "".
+ * \param[in]     isAction If it returns nothing.
+ * \param[in,out] names    The functions written so far.
+ * \param[in,out] num      Their number.
+ */
+static void emit_function(FILE* const        file,
+                          const char* const  name,
+                          const bool         isAction,
+                          const char** const names,
+                          uint32_t* const    num)
+{
+	bool isWritten = (name[0] == '\0');
+
+	for (uint32_t i = 0U; (!isWritten) && (i < *num); i++)
+	{
+		isWritten = (strcmp(names[i], name) == 0);
+	}
+
+	if (!isWritten)
+	{
+		(void)fprintf(file,
+		              "%s %s(const state_t* me, "
+		              "const hsm_event_t* event);\n",
+		              isAction ? "void" : "bool",
+		              name);
+		names[*num] = name;
+		(*num)++;
+	}
+}
+
+/**
+ * \brief Writes an enumeration of names.
+ *
+ * \param[in] me    The chart being written.
+ * \param[in] file  The header.
+ * \param[in] kind  The constants' infix, EV or ST.
+ * \param[in] first The first constant's value.
+ * \param[in] names The names.
+ * \param[in] size  The size of an element of names.
+ * \param[in] num   The number of names.
+ */
+static void emit_enum(const emit_t* const me,
+                      FILE* const         file,
+                      const char* const   kind,
+                      const uint32_t      first,
+                      const char* const   names,
+                      const size_t        size,
+                      const uint32_t      num)
+{
+	(void)fprintf(file, "enum\n{\n");
+
+	for (uint32_t i = 0U; i < num; i++)
+	{
+		char macro[CHART_NAME_SIZE];
+
+		emit_getMacro(macro, &names[i * size]);
+		(void)fprintf(file, "\t%s_%s_%s", me->itsMacro, kind, macro);
+
+		if (i == 0U)
+		{
+			(void)fprintf(file, " = %u", (unsigned)first);
+		}
+
+		(void)fprintf(file, ",\n");
+	}
+
+	(void)fprintf(file, "\t%s_%s_NUM", me->itsMacro, kind);
+
+	if (num == 0U)
+	{
+		(void)fprintf(file, " = %u", (unsigned)first);
+	}
+
+	(void)fprintf(file, "\n};\n\n");
+}
+
+/**
+ * \brief Writes the header.
+ *
+ * \param[in] me   The chart being written.
+ * \param[in] file The header.
+ *
+ * \retval  0 Success.
+ * \retval -1 Out of memory.
+ */
+static int emit_header(const emit_t* const me, FILE* const file)
+{
+	const chart_t* const chart = me->itsChart;
+	const uint32_t       functionNum =
+	    (chart->itsStateNum * 3U) + (chart->itsTransitionNum * 2U);
+	// cppcheck-suppress misra-c2012-21.3
+	const char** const names =
+	    (const char**)calloc(functionNum, sizeof(const char*));
+	uint32_t num = 0U;
+
+	(void)fprintf(file,
+	              "/* Generated by hsmgen from %s, do not edit. */\n\n"
+	              "#ifndef %s_H_ONLY_ONE_INCLUDE_SAFETY\n"
+	              "#define %s_H_ONLY_ONE_INCLUDE_SAFETY\n\n"
+	              "#ifdef __cplusplus\nextern \"C\"\n{\n#endif\n\n"
+	              "#include \"hsm.h\"\n#include \"hsm_def.h\"\n\n"
+	              "#include <stdbool.h>\n\n",
+	              me->itsSource,
+	              me->itsMacro,
+	              me->itsMacro);
+
+	(void)fprintf(file, "/* Events, HSM_EVENT_ANY matches them all */\n");
+	emit_enum(me,
+	          file,
+	          "EV",
+	          1U,
+	          &chart->itsEvents[0][0],
+	          CHART_NAME_SIZE,
+	          chart->itsEventNum);
+
+	(void)fprintf(file, "/* States, by id */\n");
+	emit_enum(me,
+	          file,
+	          "ST",
+	          0U,
+	          chart->itsStates[0].itsName,
+	          sizeof(chart_state_t),
+	          chart->itsStateNum);
+
+	(void)fprintf(file,
+	              "/* The definition, see hsm_inst_init */\n"
+	              "extern const hsm_def_t %s_def;\n\n"
+	              "/* The states, by id */\n"
+	              "extern state_t %s_states[%s_ST_NUM];\n\n"
+	              "/* Implemented by the user */\n",
+	              me->itsPrefix,
+	              me->itsPrefix,
+	              me->itsMacro);
+
+	for (uint32_t i = 0U; (names != NULL) && (i < chart->itsStateNum); i++)
+	{
+		const chart_state_t* const aux = &chart->itsStates[i];
+
+		emit_function(file, aux->itsEntry, false, names, &num);
+		emit_function(file, aux->itsDuring, false, names, &num);
+		emit_function(file, aux->itsExit, false, names, &num);
+	}
+
+	for (uint32_t i = 0U;
+	     (names != NULL) && (i < chart->itsTransitionNum);
+	     i++)
+	{
+		const chart_transition_t* const aux =
+		    &chart->itsTransitions[i];
+
+		emit_function(file, aux->itsGuard, false, names, &num);
+		emit_function(file, aux->itsAction, true, names, &num);
+	}
+
+	(void)fprintf(file,
+	              "\n#ifdef __cplusplus\n}\n#endif\n\n"
+	              "#endif /* %s_H_ONLY_ONE_INCLUDE_SAFETY */\n",
+	              me->itsMacro);
+
+	// cppcheck-suppress misra-c2012-21.3
+	free((void*)names);
+
+	return (names != NULL) ? 0 : -1;
+}
+
+/**
+ * \brief Writes a state id.
+ */
+static void emit_id(FILE* const file, const uint32_t id)
+{
+	if (id == HSM_STATE_ID_NONE)
+	{
+		(void)fprintf(file, "HSM_STATE_ID_NONE");
+	}
+	else
+	{
+		(void)fprintf(file, "%uU", (unsigned)id);
+	}
+}
+
+/**
+ * \brief Writes a table of numbers.
+ *
+ * \param[in] me     The chart being written.
+ * \param[in] file   The source.
+ * \param[in] name   The table's name.
+ * \param[in] ids    The state ids, or NULL.
+ * \param[in] values The numbers if not ids.
+ * \param[in] num    Their number.
+ */
+static void emit_table(const emit_t* const         me,
+                       FILE* const                 file,
+                       const char* const           name,
+                       const hsm_state_id_t* const ids,
+                       const uint32_t* const       values,
+                       const uint32_t              num)
+{
+	(void)fprintf(file,
+	              "static const %s %s_%s[%u] = {",
+	              (ids != NULL) ? "hsm_state_id_t" : "uint32_t",
+	              me->itsPrefix,
+	              name,
+	              (unsigned)num);
+
+	for (uint32_t i = 0U; i < num; i++)
+	{
+		(void)fprintf(file, ((i % EMIT_COLUMNS) == 0U) ? "\n\t" : " ");
+
+		if (ids != NULL)
+		{
+			emit_id(file, ids[i]);
+		}
+		else
+		{
+			(void)fprintf(file, "%uU", (unsigned)values[i]);
+		}
+
+		(void)fprintf(file, ",");
+	}
+
+	(void)fprintf(file, "\n};\n\n");
+}
+
+/**
+ * \brief Writes the actions of the states.
+ *
+ * \param[in] me   The chart being written.
+ * \param[in] file The source.
+ */
+static void emit_actions(const emit_t* const me, FILE* const file)
+{
+	const hsm_def_t* const def = &me->itsDef;
+
+	(void)fprintf(file,
+	              "static const uint8_t %s_actions[%u] = {",
+	              me->itsPrefix,
+	              (unsigned)def->itsStateNum);
+
+	for (uint32_t i = 0U; i < def->itsStateNum; i++)
+	{
+		(void)fprintf(file, ((i % EMIT_COLUMNS) == 0U) ? "\n\t" : " ");
+		(void)fprintf(file, "%uU,", (unsigned)def->itsActions[i]);
+	}
+
+	(void)fprintf(file, "\n};\n\n");
+}
+
+/**
+ * \brief Writes a pointer to a state or NULL.
+ *
+ * \param[in] me    The chart being written.
+ * \param[in] file  The source.
+ * \param[in] state The state, or CHART_NONE.
+ */
+static void emit_state(const emit_t* const me,
+                       FILE* const         file,
+                       const uint32_t      state)
+{
+	if (state == CHART_NONE)
+	{
+		(void)fprintf(file, "NULL");
+	}
+	else
+	{
+		char macro[CHART_NAME_SIZE];
+
+		emit_getMacro(macro, me->itsChart->itsStates[state].itsName);
+		(void)fprintf(file,
+		              "&%s_states[%s_ST_%s]",
+		              me->itsPrefix,
+		              me->itsMacro,
+		              macro);
+	}
+}
+
+/**
+ * \brief Writes a user's function or NULL.
+ */
+static void emit_name(FILE* const file, const char* const name)
+{
+	(void)fprintf(file, "%s", (name[0] != '\0') ? name : "NULL");
+}
+
+/**
+ * \brief Writes a name as a C string literal.
+ *
+ * A quoted DOT ID may hold any character, the quotes, backslashes, question
+ * marks (trigraphs) and the characters that are not printable are escaped.
+ *
+ * \param[in] file The source.
+ * \param[in] text The name.
+ */
+static void emit_string(FILE* const file, const char* const text)
+{
+	(void)fputc('"', file);
+
+	for (size_t i = 0U; text[i] != '\0'; i++)
+	{
+		const unsigned char c = (unsigned char)text[i];
+
+		if ((c == (unsigned char)'"') || (c == (unsigned char)'\\') ||
+		    (c == (unsigned char)'?'))
+		{
+			(void)fprintf(file, "\\%c", (char)c);
+		}
+		else if (isprint(c) == 0)
+		{
+			/* 3 octal digits, a digit after it is not taken */
+			(void)fprintf(file, "\\%03o", (unsigned)c);
+		}
+		else
+		{
+			(void)fputc((int)c, file);
+		}
+	}
+
+	(void)fputc('"', file);
+}
+
+/**
+ * \brief Writes the user's transitions.
+ *
+ * \param[in] me   The chart being written.
+ * \param[in] file The source.
+ */
+static void emit_transitions(const emit_t* const me, FILE* const file)
+{
+	const chart_t* const chart = me->itsChart;
+
+	(void)fprintf(file,
+	              "static const hsm_transition_t %s_transitions[%u] = {\n",
+	              me->itsPrefix,
+	              (unsigned)chart->itsTransitionNum);
+
+	for (uint32_t i = 0U; i < chart->itsTransitionNum; i++)
+	{
+		const chart_transition_t* const aux =
+		    &chart->itsTransitions[i];
+
+		(void)fprintf(file, "    {.guard       = ");
+		emit_name(file, aux->itsGuard);
+		(void)fprintf(file, ",\n     .action      = ");
+		emit_name(file, aux->itsAction);
+		(void)fprintf(file, ",\n     .targetState = ");
+		emit_state(me, file, aux->itsTarget);
+		(void)fprintf(file, ",\n     .eventType   = ");
+
+		if (aux->itsEvent == 0U)
+		{
+			(void)fprintf(file, "HSM_EVENT_ANY},\n");
+		}
+		else
+		{
+			const uint32_t event = aux->itsEvent - 1U;
+			char           macro[CHART_NAME_SIZE];
+
+			emit_getMacro(macro, chart->itsEvents[event]);
+			(void)fprintf(file,
+			              "%s_EV_%s},\n",
+			              me->itsMacro,
+			              macro);
+		}
+	}
+
+	(void)fprintf(file, "};\n\n");
+}
+
+/**
+ * \brief Writes the user's states.
+ *
+ * \param[in] me   The chart being written.
+ * \param[in] file The source.
+ */
+static void emit_states(const emit_t* const me, FILE* const file)
+{
+	const chart_t* const chart = me->itsChart;
+	uint32_t             first = 0U;
+
+	(void)fprintf(file,
+	              "state_t %s_states[%s_ST_NUM] = {\n",
+	              me->itsPrefix,
+	              me->itsMacro);
+
+	for (uint32_t i = 0U; i < chart->itsStateNum; i++)
+	{
+		const chart_state_t* const aux = &chart->itsStates[i];
+		const uint32_t num = emit_getTransitionNum(chart, first, i);
+
+		(void)fprintf(file, "    {.itsInitialState  = ");
+		emit_state(me, file, aux->itsInitial);
+		(void)fprintf(file, ",\n     .itsParentState   = ");
+		emit_state(me, file, aux->itsParent);
+		(void)fprintf(file, ",\n     .onEntry          = ");
+		emit_name(file, aux->itsEntry);
+		(void)fprintf(file, ",\n     .during           = ");
+		emit_name(file, aux->itsDuring);
+		(void)fprintf(file, ",\n     .onExit           = ");
+		emit_name(file, aux->itsExit);
+
+		if (num != 0U)
+		{
+			(void)fprintf(file,
+			              ",\n     .itsTransition    = "
+			              "&%s_transitions[%u]",
+			              me->itsPrefix,
+			              (unsigned)first);
+		}
+		else
+		{
+			(void)fprintf(file,
+			              ",\n     .itsTransition    = NULL");
+		}
+
+		(void)fprintf(file,
+		              ",\n     .itsTransitionNum = %uU"
+		              ",\n     .itsName          = ",
+		              (unsigned)num);
+		emit_string(file, aux->itsName);
+		(void)fprintf(file, "},\n");
+
+		first += num;
+	}
+
+	(void)fprintf(file, "};\n\n");
+}
+
+/**
+ * \brief Writes the definition's transitions.
+ *
+ * \param[in] me   The chart being written.
+ * \param[in] file The source.
+ */
+static void emit_defTransitions(const emit_t* const me, FILE* const file)
+{
+	const hsm_def_t* const def = &me->itsDef;
+
+	(void)fprintf(file,
+	              "static const hsm_def_transition_t "
+	              "%s_defTransitions[%u] = {\n",
+	              me->itsPrefix,
+	              (unsigned)def->itsTransitionNum);
+
+	for (uint32_t i = 0U; i < def->itsTransitionNum; i++)
+	{
+		const hsm_def_transition_t* const aux =
+		    &def->itsTransitions[i];
+		const uint32_t transition =
+		    (uint32_t)(aux->itsTransition - me->itsTransitions);
+
+		(void)fprintf(file,
+		              "    {.itsTransition = &%s_transitions[%u],\n"
+		              "     .itsSource     = ",
+		              me->itsPrefix,
+		              (unsigned)transition);
+		emit_id(file, aux->itsSource);
+		(void)fprintf(file, ",\n     .itsTarget     = ");
+		emit_id(file, aux->itsTarget);
+		(void)fprintf(file, ",\n     .itsLca        = ");
+		emit_id(file, aux->itsLca);
+		(void)fprintf(file,
+		              ",\n     .itsLcaLevel   = %uU"
+		              ",\n     .itsEntryNum   = %uU"
+		              ",\n     .itsEntryFirst = %uU},\n",
+		              (unsigned)aux->itsLcaLevel,
+		              (unsigned)aux->itsEntryNum,
+		              (unsigned)aux->itsEntryFirst);
+	}
+
+	(void)fprintf(file, "};\n\n");
+}
+
+/**
+ * \brief Writes the definition's tables.
+ *
+ * \param[in] me   The chart being written.
+ * \param[in] file The source.
+ */
+static void emit_def(const emit_t* const me, FILE* const file)
+{
+	const hsm_def_t* const def      = &me->itsDef;
+	const char* const      prefix   = me->itsPrefix;
+	const uint32_t         stateNum = def->itsStateNum;
+	const uint32_t         cellNum  = stateNum * def->itsEventTypeNum;
+	const uint32_t         candidateNum = def->itsTable[cellNum];
+	const bool             hasTransitions = (def->itsTransitionNum != 0U);
+	uint32_t               entryNum       = 0U;
+
+	for (uint32_t i = 0U; i < def->itsTransitionNum; i++)
+	{
+		entryNum += def->itsTransitions[i].itsEntryNum;
+	}
+
+	(void)fprintf(file,
+	              "static const state_t* const %s_stateList[%s_ST_NUM] = "
+	              "{\n",
+	              prefix,
+	              me->itsMacro);
+
+	for (uint32_t i = 0U; i < stateNum; i++)
+	{
+		(void)fprintf(file, "    ");
+		emit_state(me, file, i);
+		(void)fprintf(file, ",\n");
+	}
+
+	(void)fprintf(file, "};\n\n");
+
+	emit_table(me, file, "parent", def->itsParent, NULL, stateNum);
+	emit_table(me, file, "initial", def->itsInitial, NULL, stateNum);
+	emit_table(me,
+	           file,
+	           "historySlot",
+	           def->itsHistorySlot,
+	           NULL,
+	           stateNum);
+	emit_actions(me, file);
+	emit_table(me,
+	           file,
+	           "transitionFirst",
+	           NULL,
+	           def->itsTransitionFirst,
+	           stateNum + 1U);
+	emit_table(me,
+	           file,
+	           "pathFirst",
+	           NULL,
+	           def->itsPathFirst,
+	           stateNum + 1U);
+	emit_table(me,
+	           file,
+	           "paths",
+	           def->itsPaths,
+	           NULL,
+	           def->itsPathFirst[stateNum]);
+
+	/* Empty tables would not be valid C */
+	if (entryNum != 0U)
+	{
+		emit_table(me,
+		           file,
+		           "entries",
+		           def->itsEntries,
+		           NULL,
+		           entryNum);
+	}
+
+	if (hasTransitions)
+	{
+		emit_defTransitions(me, file);
+	}
+
+	emit_table(me, file, "table", NULL, def->itsTable, cellNum + 1U);
+
+	if (candidateNum != 0U)
+	{
+		emit_table(me,
+		           file,
+		           "candidates",
+		           NULL,
+		           def->itsCandidates,
+		           candidateNum);
+	}
+
+	emit_table(me, file, "active", NULL, def->itsActive, cellNum);
+
+	(void)fprintf(file,
+	              "const hsm_def_t %s_def = {\n"
+	              "    .itsStates          = %s_stateList,\n"
+	              "    .itsParent          = %s_parent,\n"
+	              "    .itsInitial         = %s_initial,\n"
+	              "    .itsHistorySlot     = %s_historySlot,\n"
+	              "    .itsActions         = %s_actions,\n"
+	              "    .itsTransitionFirst = %s_transitionFirst,\n",
+	              prefix,
+	              prefix,
+	              prefix,
+	              prefix,
+	              prefix,
+	              prefix,
+	              prefix);
+	(void)fprintf(file,
+	              "    .itsTransitions     = %s%s,\n"
+	              "    .itsStateNum        = %uU,\n"
+	              "    .itsTransitionNum   = %uU,\n"
+	              "    .itsHistoryNum      = %uU,\n"
+	              "    .itsInitialState    = %uU,\n"
+	              "    .itsMemory          = NULL,\n",
+	              hasTransitions ? prefix : "NULL",
+	              hasTransitions ? "_defTransitions" : "",
+	              (unsigned)stateNum,
+	              (unsigned)def->itsTransitionNum,
+	              (unsigned)def->itsHistoryNum,
+	              (unsigned)def->itsInitialState);
+	(void)fprintf(file,
+	              "    .itsPathFirst       = %s_pathFirst,\n"
+	              "    .itsPaths           = %s_paths,\n"
+	              "    .itsEntries         = %s%s,\n"
+	              "    .itsPathMemory      = NULL,\n",
+	              prefix,
+	              prefix,
+	              (entryNum != 0U) ? prefix : "NULL",
+	              (entryNum != 0U) ? "_entries" : "");
+	(void)fprintf(file,
+	              "    .itsTable           = %s_table,\n"
+	              "    .itsCandidates      = %s%s,\n"
+	              "    .itsActive          = %s_active,\n"
+	              "    .itsEventTypeNum    = %s_EV_NUM,\n"
+	              "    .itsTableMemory     = NULL};\n",
+	              prefix,
+	              (candidateNum != 0U) ? prefix : "NULL",
+	              (candidateNum != 0U) ? "_candidates" : "",
+	              prefix,
+	              me->itsMacro);
+}
+
+/**
+ * \brief Writes the source.
+ *
+ * \param[in] me   The chart being written.
+ * \param[in] file The source.
+ *
+ * \retval  0 Success.
+ */
+static int emit_source(const emit_t* const me, FILE* const file)
+{
+	(void)fprintf(file,
+	              "/* Generated by hsmgen from %s, do not edit. */\n\n"
+	              "#include \"%s.h\"\n\n"
+	              "#include <stddef.h>\n#include <stdint.h>\n\n",
+	              me->itsSource,
+	              me->itsName);
+
+	/* The ids do not fit in 8 bits */
+	if (me->itsChart->itsStateNum >= 0xFFU)
+	{
+		(void)fprintf(file,
+		              "#if HSM_STATE_ID_BITS < 16\n"
+		              "#error \"Too many states for the state ids\"\n"
+		              "#endif\n\n");
+	}
+
+	if (me->itsChart->itsTransitionNum != 0U)
+	{
+		emit_transitions(me, file);
+	}
+
+	emit_states(me, file);
+	emit_def(me, file);
+
+	return 0;
+}
+
+/**
+ * \brief Writes a file.
+ *
+ * \param[in] me        The chart being written.
+ * \param[in] output    The file without extension.
+ * \param[in] extension The file's extension.
+ * \param[in] write     Writes the contents.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int emit_file(const emit_t* const me,
+                     const char* const   output,
+                     const char* const   extension,
+                     int (*const write)(const emit_t* const me,
+                                        FILE* const         file))
+{
+	const size_t size = strlen(output) + strlen(extension) + 1U;
+	// cppcheck-suppress misra-c2012-21.3
+	char* const path      = (char*)malloc(size);
+	FILE*       file      = NULL;
+	int         errorCode = 0;
+
+	if (path != NULL)
+	{
+		(void)snprintf(path, size, "%s%s", output, extension);
+		file = fopen(path, "w");
+	}
+
+	if (file == NULL)
+	{
+		(void)fprintf(stderr,
+		              "%s%s: error: can not write\n",
+		              output,
+		              extension);
+		errorCode = -1;
+	}
+	else
+	{
+		errorCode = write(me, file);
+
+		if ((ferror(file) != 0) || (fclose(file) != 0))
+		{
+			(void)fprintf(stderr,
+			              "%s: error: can not write\n",
+			              path);
+			errorCode = -1;
+		}
+	}
+
+	// cppcheck-suppress misra-c2012-21.3
+	free(path);
+
+	return errorCode;
+}
+
+/**
+ * \brief Checks a prefix.
+ *
+ * \return True if it is a C identifier, False otherwise.
+ */
+static bool emit_isPrefix(const char* const prefix)
+{
+	const size_t num = strlen(prefix);
+	bool         isValid =
+	    (num > 0U) && (num < CHART_NAME_SIZE) &&
+	    ((isalpha((unsigned char)prefix[0]) != 0) || (prefix[0] == '_'));
+
+	for (size_t i = 1U; isValid && (i < num); i++)
+	{
+		isValid = (isalnum((unsigned char)prefix[i]) != 0) ||
+		          (prefix[i] == '_');
+	}
+
+	return isValid;
+}
+
+/**
+ * \brief Writes a state chart as a C definition, output.h and output.c.
+ *
+ * The definition is built and compiled here, so its tables are constant
+ * and its instances need no hsm_def_build at run time. The states keep
+ * the depth first order of the chart.
+ *
+ * \param[in] me     The chart.
+ * \param[in] source The chart's file.
+ * \param[in] output The files without extension.
+ * \param[in] prefix The prefix of the generated names.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int emit_write(const chart_t* const me,
+               const char* const    source,
+               const char* const    output,
+               const char* const    prefix)
+{
+	const char* const slash = strrchr(output, '/');
+	emit_t            emit;
+	int               errorCode = 0;
+
+	(void)memset(&emit, 0, sizeof(emit));
+	emit.itsChart  = me;
+	emit.itsSource = source;
+	emit.itsName   = (slash != NULL) ? &slash[1] : output;
+
+	if (!emit_isPrefix(prefix))
+	{
+		(void)fprintf(stderr, "error: invalid prefix '%s'\n", prefix);
+		errorCode = -1;
+	}
+	else
+	{
+		(void)strcpy(emit.itsPrefix, prefix);
+		emit_getMacro(emit.itsMacro, prefix);
+	}
+
+	if (errorCode == 0)
+	{
+		errorCode = emit_check(&emit);
+	}
+
+	if (errorCode == 0)
+	{
+		errorCode = emit_build(&emit);
+	}
+
+	if (errorCode == 0)
+	{
+		errorCode = emit_file(&emit, output, ".h", emit_header);
+	}
+
+	if (errorCode == 0)
+	{
+		errorCode = emit_file(&emit, output, ".c", emit_source);
+	}
+
+	hsm_def_destroy(&emit.itsDef);
+	// cppcheck-suppress misra-c2012-21.3
+	free(emit.itsStates);
+	// cppcheck-suppress misra-c2012-21.3
+	free(emit.itsTransitions);
+	// cppcheck-suppress misra-c2012-21.3
+	free((void*)emit.itsStateList);
+
+	return errorCode;
+}
@@ -0,0 +1,35 @@
+/******************************************************************************
+	About
+******************************************************************************/
+
+/**
+ * \file     emit.h
+ *
+ * \brief    Writes a state chart as a C definition with static tables.
+ *
+ * Created:  18/10/2026
+ */
+
+/******************************************************************************
+	Code
+******************************************************************************/
+
+#ifndef EMIT_H_ONLY_ONE_INCLUDE_SAFETY
+#define EMIT_H_ONLY_ONE_INCLUDE_SAFETY
+
+/******************************************************************************
+	Include files
+******************************************************************************/
+
+#include "chart.h"
+
+/******************************************************************************
+	Function declarations
+******************************************************************************/
+
+int emit_write(const chart_t* const me,
+               const char* const    source,
+               const char* const    output,
+               const char* const    prefix);
+
+#endif /* EMIT_H_ONLY_ONE_INCLUDE_SAFETY */
@@ -0,0 +1,53 @@
+/******************************************************************************
+	Code
+******************************************************************************/
+
+/******************************************************************************
+	Include files
+******************************************************************************/
+
+#include "chart.h"
+#include "emit.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/******************************************************************************
+	Function definitions
+******************************************************************************/
+
+/**
+ * \brief Generates a state machine's C definition from a DOT state chart.
+ *
+ * hsmgen <chart.dot> <output> [prefix]
+ *
+ * Writes output.h and output.c. The generated names begin with the prefix,
+ * by default the output's file name.
+ */
+int main(int argc, char* argv[])
+{
+	chart_t chart;
+	int     errorCode = 0;
+
+	if ((argc < 3) || (argc > 4))
+	{
+		(void)fprintf(stderr,
+		              "usage: hsmgen <chart.dot> <output> [prefix]\n");
+		return 1;
+	}
+
+	const char* const slash  = strrchr(argv[2], '/');
+	const char* const prefix = (argc == 4) ? argv[3]
+	                           : (slash != NULL) ? &slash[1]
+	                                             : argv[2];
+
+	errorCode = chart_read(&chart, argv[1]);
+
+	if (errorCode == 0)
+	{
+		errorCode = emit_write(&chart, argv[1], argv[2], prefix);
+		chart_destroy(&chart);
+	}
+
+	return (errorCode == 0) ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+/******************************************************************************
+	Code
+******************************************************************************/
+
+/******************************************************************************
+	Include files
+******************************************************************************/
+
+#include "hsm.h"
+#include "hsm_trace.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/******************************************************************************
+	Variables
+******************************************************************************/
+
+/* The names of hsm_st_mode_t */
+static const char* const modeNames[] =
+    {"onEntry", "during", "guard", "action", "onExit", "ERROR"};
+
+/******************************************************************************
+	Function definitions
+******************************************************************************/
+
+/**
+ * \brief Gets the name of a mode.
+ */
+static const char* getModeName(const uint8_t mode)
+{
+	return (mode < (sizeof(modeNames) / sizeof(modeNames[0])))
+	           ? modeNames[mode]
+	           : "?";
+}
+
+/**
+ * \brief Writes a state id, or - for none.
+ */
+static void printState(const uint16_t state)
+{
+	if (state == HSM_TRACE_STATE_NONE)
+	{
+		(void)printf("-");
+	}
+	else
+	{
+		(void)printf("%u", (unsigned)state);
+	}
+}
+
+/**
+ * \brief Writes a record as text, the time relative to the first record.
+ */
+static void printRecord(const hsm_trace_record_t* const record,
+                        const uint64_t                  start)
+{
+	const uint64_t time = record->itsTime - start;
+
+	(void)printf("%10llu.%03llu us  0x%012llx  event %-5u ",
+	             (unsigned long long)(time / 1000U),
+	             (unsigned long long)(time % 1000U),
+	             (unsigned long long)record->itsMachine,
+	             (unsigned)record->itsEventType);
+	printState(record->itsFrom);
+	(void)printf(".%s ---> ", getModeName(record->itsFromMode));
+	printState(record->itsTo);
+	(void)printf(".%s\n", getModeName(record->itsToMode));
+}
+
+/**
+ * \brief Writes a record as a line of CSV.
+ */
+static void printCsv(const hsm_trace_record_t* const record)
+{
+	(void)printf("%llu,0x%llx,%u,",
+	             (unsigned long long)record->itsTime,
+	             (unsigned long long)record->itsMachine,
+	             (unsigned)record->itsEventType);
+	printState(record->itsFrom);
+	(void)printf(",");
+	printState(record->itsTo);
+	(void)printf(",%s,%s\n",
+	             getModeName(record->itsFromMode),
+	             getModeName(record->itsToMode));
+}
+
+/**
+ * \brief Decodes the trace records written by hsm_trace_read.
+ *
+ * hsmtrace [-c] <trace.bin>
+ *
+ * The file holds the records as they are, one after the other. They are
+ * printed as text, or as CSV with -c.
+ */
+int main(int argc, char* argv[])
+{
+	const bool csv = (argc == 3) && (strcmp(argv[1], "-c") == 0);
+	const char* const path      = argv[argc - 1];
+	FILE*             file      = NULL;
+	int               errorCode = 0;
+
+	if ((argc != 2) && !csv)
+	{
+		(void)fprintf(stderr, "usage: hsmtrace [-c] <trace.bin>\n");
+		return 1;
+	}
+
+	file = fopen(path, "rb");
+
+	if (file == NULL)
+	{
+		(void)fprintf(stderr, "%s: error: can not read\n", path);
+		errorCode = -1;
+	}
+	else
+	{
+		hsm_trace_record_t record;
+		uint64_t           start = 0U;
+		uint32_t           num   = 0U;
+		size_t             size  = sizeof(record);
+
+		if (csv)
+		{
+			(void)printf("time_ns,machine,event,from,to,"
+			             "from_mode,to_mode\n");
+		}
+
+		while (size == sizeof(record))
+		{
+			size = fread(&record, 1U, sizeof(record), file);
+
+			if (size == sizeof(record))
+			{
+				start = (num == 0U) ? record.itsTime : start;
+				num++;
+
+				if (csv)
+				{
+					printCsv(&record);
+				}
+				else
+				{
+					printRecord(&record, start);
+				}
+			}
+			else if (size != 0U)
+			{
+				(void)fprintf(stderr,
+				              "%s: error: truncated record"
+				              " %u\n",
+				              path,
+				              (unsigned)num);
+				errorCode = -1;
+			}
+			else
+			{
+				/* End of file */
+			}
+		}
+
+		(void)fclose(file);
+	}
+
+	return (errorCode == 0) ? 0 : 1;
+}
@@ -0,0 +1,208 @@
+/******************************************************************************
+	Code
+******************************************************************************/
+
+/******************************************************************************
+	Include files
+******************************************************************************/
+
+/* For syscall and clock_gettime */
+#define _GNU_SOURCE
+
+#include "bench.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__linux__)
+#	include <linux/perf_event.h>
+#	include <sys/ioctl.h>
+#	include <sys/syscall.h>
+#	include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#	include <x86intrin.h>
+#endif
+
+/******************************************************************************
+	Function definitions
+******************************************************************************/
+
+/**
+ * \brief Reads the monotonic clock.
+ *
+ * \return The time in nanoseconds.
+ */
+static uint64_t bench_getNs(void)
+{
+	struct timespec now;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return ((uint64_t)now.tv_sec * 1000000000U) + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * \brief Reads the time stamp counter.
+ *
+ * \return The counter, 0 where there is none.
+ */
+static uint64_t bench_getTsc(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return (uint64_t)__rdtsc();
+#else
+	return 0U;
+#endif
+}
+
+/**
+ * \brief Opens and starts a hardware counter of the calling thread.
+ *
+ * \param[in] config The PERF_COUNT_HW_* counter.
+ *
+ * \return The counter, -1 where perf is not available.
+ */
+static int bench_openCounter(const uint64_t config)
+{
+	int fd = -1;
+
+#if defined(__linux__)
+	struct perf_event_attr attr;
+
+	(void)memset(&attr, 0, sizeof(attr));
+	attr.type           = PERF_TYPE_HARDWARE;
+	attr.size           = sizeof(attr);
+	attr.config         = config;
+	attr.disabled       = 1U;
+	attr.exclude_kernel = 1U;
+	attr.exclude_hv     = 1U;
+
+	fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0UL);
+
+	if (fd >= 0)
+	{
+		(void)ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+		(void)ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+	}
+#else
+	(void)config;
+#endif
+
+	return fd;
+}
+
+/**
+ * \brief Stops, reads and closes a hardware counter.
+ *
+ * \param[in]  fd    The counter.
+ * \param[out] value The counted events.
+ *
+ * \return True on success, False if not available.
+ */
+static bool bench_closeCounter(const int fd, uint64_t* const value)
+{
+	bool success = false;
+
+#if defined(__linux__)
+	if (fd >= 0)
+	{
+		(void)ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+		success = (read(fd, value, sizeof(*value)) ==
+		           (ssize_t)sizeof(*value));
+		(void)close(fd);
+	}
+#else
+	(void)fd;
+	(void)value;
+#endif
+
+	return success;
+}
+
+/**
+ * \brief Prints the header of the results' table.
+ */
+void bench_printHeader(void)
+{
+	(void)printf("%-44s %10s %9s %10s %9s %9s\n",
+	             "benchmark",
+	             "events",
+	             "ns/event",
+	             "Mevents/s",
+	             "cyc/event",
+	             "miss/evt");
+}
+
+/**
+ * \brief Starts measuring.
+ *
+ * Hardware cycles and cache misses are counted with perf where available,
+ * otherwise cycles are time stamp counter ticks.
+ *
+ * \param[out] me   The measurement.
+ * \param[in]  name The benchmark's name.
+ */
+void bench_begin(bench_t* const me, const char* const name)
+{
+	me->itsName = name;
+#if defined(__linux__)
+	me->itsCyclesFd = bench_openCounter(PERF_COUNT_HW_CPU_CYCLES);
+	me->itsMissesFd = bench_openCounter(PERF_COUNT_HW_CACHE_MISSES);
+#else
+	me->itsCyclesFd = -1;
+	me->itsMissesFd = -1;
+#endif
+	me->itsStartTsc = bench_getTsc();
+	me->itsStartNs  = bench_getNs();
+}
+
+/**
+ * \brief Stops measuring and prints a row of the results' table.
+ *
+ * \param[in,out] me       The measurement.
+ * \param[in]     eventNum The number of events dispatched.
+ */
+void bench_end(bench_t* const me, const uint64_t eventNum)
+{
+	const uint64_t ns     = bench_getNs() - me->itsStartNs;
+	uint64_t       cycles = bench_getTsc() - me->itsStartTsc;
+	uint64_t       misses = 0U;
+	const bool     hasCycles =
+	    bench_closeCounter(me->itsCyclesFd, &cycles) || (cycles != 0U);
+	const bool hasMisses = bench_closeCounter(me->itsMissesFd, &misses);
+	const double events  = (eventNum != 0U) ? (double)eventNum : 1.0;
+	char         cyclesText[16];
+	char         missesText[16];
+
+	(void)snprintf(cyclesText, sizeof(cyclesText), "n/a");
+	(void)snprintf(missesText, sizeof(missesText), "n/a");
+
+	if (hasCycles)
+	{
+		(void)snprintf(cyclesText,
+		               sizeof(cyclesText),
+		               "%.1f",
+		               (double)cycles / events);
+	}
+
+	if (hasMisses)
+	{
+		(void)snprintf(missesText,
+		               sizeof(missesText),
+		               "%.3f",
+		               (double)misses / events);
+	}
+
+	(void)printf("%-44s %10llu %9.2f %10.2f %9s %9s\n",
+	             me->itsName,
+	             (unsigned long long)eventNum,
+	             (double)ns / events,
+	             (ns != 0U) ? ((events * 1000.0) / (double)ns) : 0.0,
+	             cyclesText,
+	             missesText);
+}
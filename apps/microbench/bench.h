@@ -0,0 +1,52 @@
+/******************************************************************************
+	About
+******************************************************************************/
+
+/**
+ * \file     bench.h
+ *
+ * \brief    Measures a run of events: time, cycles and cache misses.
+ *
+ * Created:  18/10/2026
+ */
+
+/******************************************************************************
+	Code
+******************************************************************************/
+
+#ifndef BENCH_H_ONLY_ONE_INCLUDE_SAFETY
+#define BENCH_H_ONLY_ONE_INCLUDE_SAFETY
+
+/******************************************************************************
+	Include files
+******************************************************************************/
+
+#include <stdint.h>
+
+/******************************************************************************
+	Types
+******************************************************************************/
+
+/**
+ * \brief A measurement in progress.
+ */
+typedef struct
+{
+	const char* itsName;     /**< The benchmark's name. */
+	uint64_t    itsStartNs;  /**< Monotonic time at the start. */
+	uint64_t    itsStartTsc; /**< Time stamp counter at the start. */
+	int         itsCyclesFd; /**< Perf cycles counter, -1 if none. */
+	int         itsMissesFd; /**< Perf cache misses counter, -1 if none. */
+} bench_t;
+
+/******************************************************************************
+	Function declarations
+******************************************************************************/
+
+void bench_printHeader(void);
+
+void bench_begin(bench_t* const me, const char* const name);
+
+void bench_end(bench_t* const me, const uint64_t eventNum);
+
+#endif /* BENCH_H_ONLY_ONE_INCLUDE_SAFETY */
@@ -0,0 +1,891 @@
+/******************************************************************************
+	Code
+******************************************************************************/
+
+/******************************************************************************
+	Include files
+******************************************************************************/
+
+/* For mkstemp */
+#define _GNU_SOURCE
+
+#include "bench.h"
+#include "hsm.h"
+#include "hsm_def.h"
+#include "hsm_fleet.h"
+#include "hsm_journal.h"
+#include "hsm_snapshot.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/******************************************************************************
+	Definitions
+******************************************************************************/
+
+/* Default number of events per benchmark */
+#define BENCH_EVENT_NUM (1000000U)
+
+/* Number of instances of the multi-instance benchmarks */
+#define BENCH_INST_NUM (1024U)
+
+/* Depth of each branch of the deep hierarchy */
+#define DEEP_DEPTH (8U)
+
+/* Number of leaves of the wide fan-out */
+#define FAN_NUM (64U)
+
+/* Number of transitions of the guard heavy state, only the last passes */
+#define GUARD_NUM (16U)
+
+/* Number of events per call of the batch handler */
+#define BENCH_BATCH_NUM (1024U)
+
+/* Size of the journal's write buffer */
+#define JOURNAL_BUFFER_SIZE (64U * 1024U)
+
+/* Number of records replayed per batch */
+#define JOURNAL_BATCH_NUM (1024U)
+
+/* Repeats a macro taking an index */
+#define BENCH_X8(m, i)                                        \
+	m(i), m((i) + 1U), m((i) + 2U), m((i) + 3U), m((i) + 4U), \
+	    m((i) + 5U), m((i) + 6U), m((i) + 7U)
+
+#define BENCH_X64(m)                                          \
+	BENCH_X8(m, 0U), BENCH_X8(m, 8U), BENCH_X8(m, 16U),   \
+	    BENCH_X8(m, 24U), BENCH_X8(m, 32U), BENCH_X8(m, 40U), \
+	    BENCH_X8(m, 48U), BENCH_X8(m, 56U)
+
+/* A transition, by designated initializers */
+#define BENCH_TRANSITION(guardFn, actionFn, target, type)   \
+	{                                                   \
+		.guard = (guardFn), .action = (actionFn),   \
+		.targetState = (target), .eventType = (type) \
+	}
+
+/* A transition on any event, without guard or action */
+#define BENCH_ANY(target) BENCH_TRANSITION(NULL, NULL, target, HSM_EVENT_ANY)
+
+/******************************************************************************
+	Variables
+******************************************************************************/
+
+/* Keeps the compiler from dropping the work */
+static volatile uint32_t sink;
+
+/******************************************************************************
+	Function definitions
+******************************************************************************/
+
+static bool guardFalse(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	(void)event;
+	return sink == 0xFFFFFFFFU;
+}
+
+static void countAction(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	(void)event;
+	sink++;
+}
+
+/******************************************************************************
+	Flat toggle
+
+	off <-> on on every event
+******************************************************************************/
+
+static state_t flatOff;
+static state_t flatOn;
+
+static state_t flatOff = {.itsInitialState = NULL,
+                          .itsParentState  = NULL,
+                          .onEntry         = NULL,
+                          .during          = NULL,
+                          .onExit          = NULL,
+                          .itsTransition =
+                              (hsm_transition_t[]){BENCH_ANY(&flatOn)},
+                          .itsTransitionNum = 1,
+                          .itsName          = "flatOff"};
+
+static state_t flatOn = {.itsInitialState = NULL,
+                         .itsParentState  = NULL,
+                         .onEntry         = NULL,
+                         .during          = NULL,
+                         .onExit          = NULL,
+                         .itsTransition =
+                             (hsm_transition_t[]){BENCH_ANY(&flatOff)},
+                         .itsTransitionNum = 1,
+                         .itsName          = "flatOn"};
+
+static state_t* flatStates[] = {&flatOff, &flatOn};
+
+/******************************************************************************
+	2 layer topology
+
+	topA(subA1 -> subA2) -> topB(subB1) -> topA
+******************************************************************************/
+
+static state_t topA;
+static state_t subA1;
+static state_t subA2;
+static state_t topB;
+static state_t subB1;
+
+static state_t topA = {.itsInitialState  = &subA1,
+                       .itsParentState   = NULL,
+                       .onEntry          = NULL,
+                       .during           = NULL,
+                       .onExit           = NULL,
+                       .itsTransition    = NULL,
+                       .itsTransitionNum = 0,
+                       .itsName          = " topA"};
+
+static state_t subA1 = {.itsInitialState = NULL,
+                        .itsParentState  = &topA,
+                        .onEntry         = NULL,
+                        .during          = NULL,
+                        .onExit          = NULL,
+                        .itsTransition =
+                            (hsm_transition_t[]){BENCH_ANY(&subA2)},
+                        .itsTransitionNum = 1,
+                        .itsName          = "subA1"};
+
+static state_t subA2 = {.itsInitialState = NULL,
+                        .itsParentState  = &topA,
+                        .onEntry         = NULL,
+                        .during          = NULL,
+                        .onExit          = NULL,
+                        .itsTransition =
+                            (hsm_transition_t[]){BENCH_ANY(&subB1)},
+                        .itsTransitionNum = 1,
+                        .itsName          = "subA2"};
+
+static state_t topB = {.itsInitialState  = &subB1,
+                       .itsParentState   = NULL,
+                       .onEntry          = NULL,
+                       .during           = NULL,
+                       .onExit           = NULL,
+                       .itsTransition    = NULL,
+                       .itsTransitionNum = 0,
+                       .itsName          = " topB"};
+
+static state_t subB1 = {.itsInitialState = NULL,
+                        .itsParentState  = &topB,
+                        .onEntry         = NULL,
+                        .during          = NULL,
+                        .onExit          = NULL,
+                        .itsTransition =
+                            (hsm_transition_t[]){BENCH_ANY(&subA1)},
+                        .itsTransitionNum = 1,
+                        .itsName          = "subB1"};
+
+static state_t* layerStates[] = {&topA, &subA1, &subA2, &topB, &subB1};
+
+/******************************************************************************
+	Deep hierarchy
+
+	Two branches of DEEP_DEPTH states under a root, the leaves transition
+	to each other so every event exits and enters a whole branch.
+******************************************************************************/
+
+static state_t deepRoot;
+static state_t deepA[DEEP_DEPTH];
+static state_t deepB[DEEP_DEPTH];
+
+#define DEEP_NODE(branch, i)                                 \
+	{                                                    \
+		.itsInitialState = &branch[(i) + 1U],        \
+		.itsParentState = &branch[(i) - 1U],         \
+		.onEntry = NULL, .during = NULL, .onExit = NULL, \
+		.itsTransition = NULL, .itsTransitionNum = 0, \
+		.itsName = #branch                           \
+	}
+
+#define DEEP_BRANCH(branch, other)                                    \
+	{                                                             \
+		{.itsInitialState  = &branch[1],                      \
+		 .itsParentState   = &deepRoot,                       \
+		 .onEntry          = NULL,                            \
+		 .during           = NULL,                            \
+		 .onExit           = NULL,                            \
+		 .itsTransition    = NULL,                            \
+		 .itsTransitionNum = 0,                               \
+		 .itsName          = #branch},                        \
+		    DEEP_NODE(branch, 1U), DEEP_NODE(branch, 2U),     \
+		    DEEP_NODE(branch, 3U), DEEP_NODE(branch, 4U),     \
+		    DEEP_NODE(branch, 5U), DEEP_NODE(branch, 6U),     \
+		{                                                     \
+			.itsInitialState = NULL,                      \
+			.itsParentState  = &branch[DEEP_DEPTH - 2U],  \
+			.onEntry         = NULL,                      \
+			.during          = NULL,                      \
+			.onExit          = NULL,                      \
+			.itsTransition   = (hsm_transition_t[]){      \
+			    BENCH_ANY(&other[DEEP_DEPTH - 1U])},    \
+			.itsTransitionNum = 1,                        \
+			.itsName          = #branch                   \
+		}                                                     \
+	}
+
+static state_t deepRoot = {.itsInitialState  = &deepA[0],
+                           .itsParentState   = NULL,
+                           .onEntry          = NULL,
+                           .during           = NULL,
+                           .onExit           = NULL,
+                           .itsTransition    = NULL,
+                           .itsTransitionNum = 0,
+                           .itsName          = "deepRoot"};
+
+static state_t deepA[DEEP_DEPTH] = DEEP_BRANCH(deepA, deepB);
+static state_t deepB[DEEP_DEPTH] = DEEP_BRANCH(deepB, deepA);
+
+static const state_t* deepStates[1U + (2U * DEEP_DEPTH)];
+
+/******************************************************************************
+	Wide fan-out
+
+	A hub with FAN_NUM transitions, event type i + 1 goes to leaf i. Every
+	leaf goes back to the hub on any event.
+******************************************************************************/
+
+static state_t fanRoot;
+static state_t fanHub;
+static state_t fanLeaves[FAN_NUM];
+
+#define FAN_TRANSITION(i) \
+	BENCH_TRANSITION(NULL, NULL, &fanLeaves[i], (i) + 1U)
+
+#define FAN_LEAF(i)                                              \
+	{                                                        \
+		.itsInitialState = NULL, .itsParentState = &fanRoot, \
+		.onEntry = NULL, .during = NULL, .onExit = NULL, \
+		.itsTransition =                                 \
+		    (hsm_transition_t[]){BENCH_ANY(&fanHub)}, \
+		.itsTransitionNum = 1, .itsName = "fanLeaf"      \
+	}
+
+static state_t fanRoot = {.itsInitialState  = &fanHub,
+                          .itsParentState   = NULL,
+                          .onEntry          = NULL,
+                          .during           = NULL,
+                          .onExit           = NULL,
+                          .itsTransition    = NULL,
+                          .itsTransitionNum = 0,
+                          .itsName          = "fanRoot"};
+
+static state_t fanHub = {
+    .itsInitialState  = NULL,
+    .itsParentState   = &fanRoot,
+    .onEntry          = NULL,
+    .during           = NULL,
+    .onExit           = NULL,
+    .itsTransition    = (hsm_transition_t[]){BENCH_X64(FAN_TRANSITION)},
+    .itsTransitionNum = FAN_NUM,
+    .itsName          = "fanHub"};
+
+static state_t fanLeaves[FAN_NUM] = {BENCH_X64(FAN_LEAF)};
+
+static const state_t* fanStates[2U + FAN_NUM];
+
+/******************************************************************************
+	Guard heavy
+
+	A state with GUARD_NUM transitions, all but the last guard fail.
+******************************************************************************/
+
+#define GUARD_FALSE BENCH_TRANSITION(guardFalse, NULL, NULL, HSM_EVENT_ANY)
+
+static state_t guardState = {
+    .itsInitialState = NULL,
+    .itsParentState  = NULL,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){GUARD_FALSE, GUARD_FALSE, GUARD_FALSE,
+                             GUARD_FALSE, GUARD_FALSE, GUARD_FALSE,
+                             GUARD_FALSE, GUARD_FALSE, GUARD_FALSE,
+                             GUARD_FALSE, GUARD_FALSE, GUARD_FALSE,
+                             GUARD_FALSE, GUARD_FALSE, GUARD_FALSE,
+                             BENCH_TRANSITION(
+                                 NULL, countAction, NULL, HSM_EVENT_ANY)},
+    .itsTransitionNum = GUARD_NUM,
+    .itsName          = "guard"};
+
+static state_t* guardStates[] = {&guardState};
+
+/******************************************************************************
+	Runners
+******************************************************************************/
+
+/**
+ * \brief Gets the event type of the n-th event of a benchmark.
+ *
+ * Alternates the fan-out's hub event types with an event for the leaf.
+ */
+static uint32_t bench_getEventType(const uint32_t n)
+{
+	return ((n / 2U) % FAN_NUM) + 1U;
+}
+
+/**
+ * \brief Runs the legacy micro step handler.
+ */
+static void bench_handleEvent(const char* const    name,
+                              const state_t* const initialState,
+                              const state_t* const allStates[],
+                              const uint32_t       allStatesSize,
+                              const uint32_t       eventNum)
+{
+	hsm_t       sys   = _hsm_build(initialState, allStates, allStatesSize);
+	hsm_event_t event = {HSM_EVENT_ANY, NULL};
+	bench_t     bench;
+	int         errorCode = 0;
+
+	bench_begin(&bench, name);
+
+	for (uint32_t n = 0U; n < eventNum; n++)
+	{
+		event.eventType = bench_getEventType(n);
+		errorCode |= hsm_handleEvent(&sys, &event);
+	}
+
+	bench_end(&bench, eventNum);
+
+	if (errorCode != 0)
+	{
+		(void)printf("%-44s failed\n", name);
+	}
+}
+
+/**
+ * \brief Runs the batch micro step handler, BENCH_BATCH_NUM events a call.
+ */
+static void bench_handleEvents(const char* const    name,
+                               const state_t* const initialState,
+                               const state_t* const allStates[],
+                               const uint32_t       allStatesSize,
+                               const uint32_t       eventNum)
+{
+	hsm_t   sys = _hsm_build(initialState, allStates, allStatesSize);
+	bench_t bench;
+	int     errorCode = 0;
+
+	// cppcheck-suppress misra-c2012-21.3
+	hsm_event_t* const events =
+	    (hsm_event_t*)calloc(BENCH_BATCH_NUM, sizeof(hsm_event_t));
+
+	if (events == NULL)
+	{
+		/* Out of memory */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		/* The same events as one by one, the batch is a period */
+		for (uint32_t n = 0U; n < BENCH_BATCH_NUM; n++)
+		{
+			events[n].eventType = bench_getEventType(n);
+		}
+
+		bench_begin(&bench, name);
+
+		for (uint32_t n = 0U; n < eventNum; n += BENCH_BATCH_NUM)
+		{
+			const uint32_t num = ((eventNum - n) < BENCH_BATCH_NUM)
+			                         ? (eventNum - n)
+			                         : BENCH_BATCH_NUM;
+
+			errorCode |= hsm_handleEvents(&sys, events, num, NULL);
+		}
+
+		bench_end(&bench, eventNum);
+	}
+
+	if (errorCode != 0)
+	{
+		(void)printf("%-44s failed\n", name);
+	}
+
+	// cppcheck-suppress misra-c2012-21.3
+	free(events);
+}
+
+/**
+ * \brief Runs the run to completion handler.
+ */
+static void bench_dispatch(const char* const    name,
+                           const state_t* const initialState,
+                           const state_t* const allStates[],
+                           const uint32_t       allStatesSize,
+                           const uint32_t       eventNum)
+{
+	hsm_t       sys   = _hsm_build(initialState, allStates, allStatesSize);
+	hsm_event_t event = {HSM_EVENT_ANY, NULL};
+	bench_t     bench;
+	int         errorCode = 0;
+
+	bench_begin(&bench, name);
+
+	for (uint32_t n = 0U; n < eventNum; n++)
+	{
+		event.eventType = bench_getEventType(n);
+		errorCode |= hsm_dispatch(&sys, &event);
+	}
+
+	bench_end(&bench, eventNum);
+
+	if (errorCode != 0)
+	{
+		(void)printf("%-44s failed\n", name);
+	}
+}
+
+/**
+ * \brief Records the micro step handler in a journal, then replays it.
+ *
+ * The replay starts from a snapshot taken before the recording, and goes
+ * through the batch handler.
+ */
+static void bench_journal(const char* const    recordName,
+                          const char* const    replayName,
+                          const state_t* const initialState,
+                          const state_t* const allStates[],
+                          const uint32_t       allStatesSize,
+                          const uint32_t       eventNum)
+{
+	hsm_t sys = _hsm_build(initialState, allStates, allStatesSize);
+	hsm_event_t   event     = {HSM_EVENT_ANY, NULL};
+	hsm_journal_t journal;
+	bench_t       bench;
+	char          path[]    = "/tmp/microbench_XXXXXX";
+	const size_t  blobSize  = hsm_snapshot_getSize(&sys);
+	uint64_t      doneNum   = 0U;
+	const int     file      = mkstemp(path);
+	int           errorCode = (file >= 0) ? 0 : -1;
+
+	// cppcheck-suppress misra-c2012-21.3
+	uint8_t* const blob = (uint8_t*)malloc(blobSize);
+	// cppcheck-suppress misra-c2012-21.3
+	uint8_t* const buffer = (uint8_t*)malloc(JOURNAL_BUFFER_SIZE);
+	// cppcheck-suppress misra-c2012-21.3
+	hsm_journal_record_t* const records = (hsm_journal_record_t*)malloc(
+	    sizeof(hsm_journal_record_t) * JOURNAL_BATCH_NUM);
+
+	if ((blob == NULL) || (buffer == NULL) || (records == NULL))
+	{
+		/* Out of memory */
+		errorCode = -1;
+	}
+
+	if (file >= 0)
+	{
+		(void)close(file);
+	}
+
+	if (errorCode == 0)
+	{
+		errorCode = hsm_snapshot(&sys, blob, blobSize);
+	}
+
+	if (errorCode == 0)
+	{
+		errorCode = hsm_journal_open(&journal,
+		                             path,
+		                             buffer,
+		                             JOURNAL_BUFFER_SIZE);
+	}
+
+	if (errorCode == 0)
+	{
+		hsm_journal_attach(&sys, &journal);
+
+		bench_begin(&bench, recordName);
+
+		for (uint32_t n = 0U; n < eventNum; n++)
+		{
+			event.eventType = bench_getEventType(n);
+			errorCode |= hsm_handleEvent(&sys, &event);
+		}
+
+		errorCode |= hsm_journal_close(&journal);
+
+		bench_end(&bench, eventNum);
+
+		hsm_journal_attach(&sys, NULL);
+	}
+
+	if (errorCode == 0)
+	{
+		errorCode = hsm_reset(&sys);
+	}
+
+	if (errorCode == 0)
+	{
+		errorCode = hsm_restore(&sys, blob, blobSize);
+	}
+
+	if (errorCode == 0)
+	{
+		bench_begin(&bench, replayName);
+
+		errorCode = hsm_journal_replay(&sys,
+		                               path,
+		                               records,
+		                               JOURNAL_BATCH_NUM,
+		                               &doneNum);
+
+		bench_end(&bench, doneNum);
+	}
+
+	if ((errorCode != 0) || (doneNum != eventNum))
+	{
+		(void)printf("%-44s failed\n", replayName);
+	}
+
+	(void)unlink(path);
+	// cppcheck-suppress misra-c2012-21.3
+	free(records);
+	// cppcheck-suppress misra-c2012-21.3
+	free(buffer);
+	// cppcheck-suppress misra-c2012-21.3
+	free(blob);
+}
+
+/**
+ * \brief Runs the shared definition's handler, on instNum instances in
+ *        turn.
+ *
+ * The definition is compiled when eventTypeNum is not 0.
+ */
+static void bench_instDispatch(const char* const    name,
+                               const state_t* const initialState,
+                               const state_t* const allStates[],
+                               const uint32_t       allStatesSize,
+                               const uint32_t       eventTypeNum,
+                               const uint32_t       instNum,
+                               const uint32_t       eventNum)
+{
+	hsm_def_t       def;
+	hsm_inst_t*     insts     = NULL;
+	hsm_state_id_t* histories = NULL;
+	hsm_event_t     event     = {HSM_EVENT_ANY, NULL};
+	bench_t         bench;
+	int             errorCode = 0;
+
+	errorCode =
+	    _hsm_def_build(&def, initialState, allStates, allStatesSize);
+
+	if ((errorCode == 0) && (eventTypeNum != 0U))
+	{
+		errorCode = hsm_def_compile(&def, eventTypeNum);
+	}
+
+	if (errorCode == 0)
+	{
+		const size_t historyNum = (size_t)instNum * def.itsHistoryNum;
+
+		// cppcheck-suppress misra-c2012-21.3
+		insts     = (hsm_inst_t*)malloc(sizeof(hsm_inst_t) * instNum);
+		// cppcheck-suppress misra-c2012-21.3
+		histories = (hsm_state_id_t*)malloc(
+		    (sizeof(hsm_state_id_t) * historyNum) + 1U);
+
+		if ((insts == NULL) || (histories == NULL))
+		{
+			/* Out of memory */
+			errorCode = -1;
+		}
+	}
+
+	for (uint32_t i = 0U; (errorCode == 0) && (i < instNum); i++)
+	{
+		errorCode = hsm_inst_init(&insts[i],
+		                          &def,
+		                          &histories[i * def.itsHistoryNum]);
+	}
+
+	if (errorCode == 0)
+	{
+		uint32_t i = 0U;
+
+		bench_begin(&bench, name);
+
+		for (uint32_t n = 0U; n < eventNum; n++)
+		{
+			event.eventType = bench_getEventType(n / instNum);
+			errorCode |= hsm_inst_dispatch(&insts[i], &event);
+
+			i = ((i + 1U) < instNum) ? (i + 1U) : 0U;
+		}
+
+		bench_end(&bench, eventNum);
+	}
+
+	if (errorCode != 0)
+	{
+		(void)printf("%-44s failed\n", name);
+	}
+
+	// cppcheck-suppress misra-c2012-21.3
+	free(histories);
+	// cppcheck-suppress misra-c2012-21.3
+	free(insts);
+	hsm_def_destroy(&def);
+}
+
+/**
+ * \brief Broadcasts to a fleet of instNum instances.
+ */
+static void bench_fleetBroadcast(const char* const    name,
+                                 const state_t* const initialState,
+                                 const state_t* const allStates[],
+                                 const uint32_t       allStatesSize,
+                                 const uint32_t       eventTypeNum,
+                                 const uint32_t       instNum,
+                                 const uint32_t       eventNum)
+{
+	hsm_def_t   def;
+	hsm_fleet_t fleet;
+	hsm_event_t event = {HSM_EVENT_ANY, NULL};
+	bench_t     bench;
+	int         errorCode = 0;
+
+	fleet.itsMemory = NULL;
+
+	errorCode =
+	    _hsm_def_build(&def, initialState, allStates, allStatesSize);
+
+	if (errorCode == 0)
+	{
+		errorCode = hsm_def_compile(&def, eventTypeNum);
+	}
+
+	if (errorCode == 0)
+	{
+		errorCode = hsm_fleet_init(&fleet, &def, instNum);
+	}
+
+	if (errorCode == 0)
+	{
+		const uint32_t broadcastNum = eventNum / instNum;
+
+		bench_begin(&bench, name);
+
+		for (uint32_t n = 0U; n < broadcastNum; n++)
+		{
+			event.eventType = bench_getEventType(n);
+			errorCode |= hsm_fleet_broadcast(&fleet, &event);
+		}
+
+		bench_end(&bench, (uint64_t)broadcastNum * instNum);
+	}
+
+	if (errorCode != 0)
+	{
+		(void)printf("%-44s failed\n", name);
+	}
+
+	hsm_fleet_destroy(&fleet);
+	hsm_def_destroy(&def);
+}
+
+/**
+ * \brief Runs the microbenchmarks.
+ *
+ * The first argument is the number of events of each benchmark.
+ *
+ * \return 0 on success, 1 on a debug build or no events.
+ */
+int main(int argc, char* argv[])
+{
+	uint32_t eventNum = BENCH_EVENT_NUM;
+
+#ifdef DEBUG
+	/* A debug build is not optimized, its numbers would mislead */
+	(void)printf("Build with 'make bench TARGET=rel' to benchmark\n");
+	(void)argc;
+	(void)argv;
+	eventNum = 0U;
+#else
+	if (argc > 1)
+	{
+		eventNum = (uint32_t)strtoul(argv[1], NULL, 10);
+	}
+#endif
+
+	if (eventNum == 0U)
+	{
+		return 1;
+	}
+
+	/* The state lists of the generated topologies */
+	deepStates[0] = &deepRoot;
+	for (uint32_t i = 0U; i < DEEP_DEPTH; i++)
+	{
+		deepStates[1U + i]              = &deepA[i];
+		deepStates[1U + DEEP_DEPTH + i] = &deepB[i];
+	}
+
+	fanStates[0] = &fanRoot;
+	fanStates[1] = &fanHub;
+	for (uint32_t i = 0U; i < FAN_NUM; i++)
+	{
+		fanStates[2U + i] = &fanLeaves[i];
+	}
+
+	bench_printHeader();
+
+	/* Flat toggle */
+	bench_handleEvent("flat/handleEvent",
+	                  &flatOff,
+	                  (const state_t**)flatStates,
+	                  2U,
+	                  eventNum);
+	bench_handleEvents("flat/handleEvents",
+	                   &flatOff,
+	                   (const state_t**)flatStates,
+	                   2U,
+	                   eventNum);
+	bench_dispatch("flat/dispatch",
+	               &flatOff,
+	               (const state_t**)flatStates,
+	               2U,
+	               eventNum);
+	bench_instDispatch("flat/inst_dispatch",
+	                   &flatOff,
+	                   (const state_t**)flatStates,
+	                   2U,
+	                   0U,
+	                   1U,
+	                   eventNum);
+	bench_instDispatch("flat/inst_dispatch/compiled",
+	                   &flatOff,
+	                   (const state_t**)flatStates,
+	                   2U,
+	                   FAN_NUM + 1U,
+	                   1U,
+	                   eventNum);
+
+	/* 2 layer topology */
+	bench_handleEvent("2layer/handleEvent",
+	                  &topA,
+	                  (const state_t**)layerStates,
+	                  5U,
+	                  eventNum);
+	bench_handleEvents("2layer/handleEvents",
+	                   &topA,
+	                   (const state_t**)layerStates,
+	                   5U,
+	                   eventNum);
+	bench_dispatch("2layer/dispatch",
+	               &topA,
+	               (const state_t**)layerStates,
+	               5U,
+	               eventNum);
+	bench_instDispatch("2layer/inst_dispatch/compiled",
+	                   &topA,
+	                   (const state_t**)layerStates,
+	                   5U,
+	                   FAN_NUM + 1U,
+	                   1U,
+	                   eventNum);
+	bench_journal("2layer/handleEvent/journal",
+	              "2layer/journal_replay",
+	              &topA,
+	              (const state_t**)layerStates,
+	              5U,
+	              eventNum);
+
+	/* Deep hierarchy */
+	bench_handleEvent("deep8/handleEvent",
+	                  &deepRoot,
+	                  deepStates,
+	                  1U + (2U * DEEP_DEPTH),
+	                  eventNum);
+	bench_handleEvents("deep8/handleEvents",
+	                   &deepRoot,
+	                   deepStates,
+	                   1U + (2U * DEEP_DEPTH),
+	                   eventNum);
+	bench_dispatch("deep8/dispatch",
+	               &deepRoot,
+	               deepStates,
+	               1U + (2U * DEEP_DEPTH),
+	               eventNum);
+	bench_instDispatch("deep8/inst_dispatch/compiled",
+	                   &deepRoot,
+	                   deepStates,
+	                   1U + (2U * DEEP_DEPTH),
+	                   FAN_NUM + 1U,
+	                   1U,
+	                   eventNum);
+
+	/* Wide fan-out */
+	bench_dispatch("fanout64/dispatch",
+	               &fanRoot,
+	               fanStates,
+	               2U + FAN_NUM,
+	               eventNum);
+	bench_instDispatch("fanout64/inst_dispatch",
+	                   &fanRoot,
+	                   fanStates,
+	                   2U + FAN_NUM,
+	                   0U,
+	                   1U,
+	                   eventNum);
+	bench_instDispatch("fanout64/inst_dispatch/compiled",
+	                   &fanRoot,
+	                   fanStates,
+	                   2U + FAN_NUM,
+	                   FAN_NUM + 1U,
+	                   1U,
+	                   eventNum);
+
+	/* Guard heavy */
+	bench_dispatch("guard16/dispatch",
+	               &guardState,
+	               (const state_t**)guardStates,
+	               1U,
+	               eventNum);
+	bench_instDispatch("guard16/inst_dispatch/compiled",
+	                   &guardState,
+	                   (const state_t**)guardStates,
+	                   1U,
+	                   FAN_NUM + 1U,
+	                   1U,
+	                   eventNum);
+
+	/* Multiple instances */
+	bench_instDispatch("2layer/inst_dispatch/compiled/x1024",
+	                   &topA,
+	                   (const state_t**)layerStates,
+	                   5U,
+	                   FAN_NUM + 1U,
+	                   BENCH_INST_NUM,
+	                   eventNum);
+	bench_instDispatch("fanout64/inst_dispatch/compiled/x1024",
+	                   &fanRoot,
+	                   fanStates,
+	                   2U + FAN_NUM,
+	                   FAN_NUM + 1U,
+	                   BENCH_INST_NUM,
+	                   eventNum);
+	bench_fleetBroadcast("fanout64/fleet_broadcast/x1024",
+	                     &fanRoot,
+	                     fanStates,
+	                     2U + FAN_NUM,
+	                     FAN_NUM + 1U,
+	                     BENCH_INST_NUM,
+	                     eventNum);
+
+	return 0;
+}
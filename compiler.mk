@@ -31,7 +31,10 @@ CPPFLAGS += -w -Werror -Wall -pedantic-errors -Wshadow -Wextra
 CFLAGS   += -std=c99
 
 # C++ language specification
-CXXFLAGS += -std=c++98
+CXXFLAGS += -std=c++17
+
+# Threads
+CPPFLAGS += -pthread
 
 # Autodependency
 CPPFLAGS += -MT $@ -MMD -MP -MF $(@:%.o=%.Td)
@@ -37,8 +37,48 @@ extern "C"
 // Dependencies
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
+// ############################################################################
+// ############################################################################
+// Configuration
+
+#ifndef HSM_MAX_DEPTH
+/**
+ * \brief The maximum nesting depth of the states.
+ */
+#	define HSM_MAX_DEPTH (16U)
+#endif
+
+#ifndef HSM_EVENT_INLINE_SIZE
+/**
+ * \brief The bytes of payload an event carries inline, 0 for none. With 48
+ * an event fills a 64 byte cache line on 64 bit targets.
+ */
+#	define HSM_EVENT_INLINE_SIZE (0U)
+#endif
+
+#ifndef HSM_STATS
+/**
+ * \brief If the machines count and time their states and transitions, 0 or
+ * 1. Without it the counters do not exist.
+ */
+#	define HSM_STATS (0)
+#endif
+
+#ifndef HSM_STATS_BUCKET_NUM
+/**
+ * \brief The number of buckets of the dispatch latency histogram.
+ */
+#	define HSM_STATS_BUCKET_NUM (32U)
+#endif
+
+/**
+ * \brief What \see hsm_getStateIndex returns for a state not in allStates.
+ */
+#define HSM_STATE_INDEX_NONE (0xFFFFFFFFU)
+
 // ############################################################################
 // ############################################################################
 // Types
@@ -50,15 +90,29 @@ typedef struct state state_t;
 
 /**
  * \brief HSM event signal.
+ *
+ * A payload that fits is copied inline and data is NULL, see
+ * \see hsm_event_init. The handlers read it with \see hsm_event_getData.
  */
 typedef struct
 {
 	uint32_t eventType; /**< The event type. */
 	void*    data;      /**< Opague pointer data argument. */
+#if HSM_EVENT_INLINE_SIZE > 0
+	uint8_t itsInline[HSM_EVENT_INLINE_SIZE]; /**< Inline payload. */
+#endif
 } hsm_event_t;
 
+/**
+ * \brief Transition trigger that matches every event.
+ */
+#define HSM_EVENT_ANY (0U)
+
 /**
  * \brief HSM state transitions.
+ *
+ * A transition fires on events of its eventType, or on every event if it is
+ * HSM_EVENT_ANY. A transition without target state is internal.
  */
 typedef struct
 {
@@ -69,6 +123,7 @@ typedef struct
 	    const state_t*     me,
 	    const hsm_event_t* event); /**< The transitions's action. */
 	state_t* targetState;          /**< The transitions's target state. */
+	uint32_t eventType;            /**< The transitions's trigger. */
 } hsm_transition_t;
 
 /**
@@ -84,8 +139,57 @@ typedef enum
 	HSM_ST_M_ERROR           /**< The HSM state is in error. */
 } hsm_st_mode_t;
 
+/**
+ * \brief HSM history pseudostate, what a state with children resumes when
+ * it is entered again.
+ *
+ * A deep history keeps the leaf it was in, the whole configuration below it
+ * is entered again straight from it.
+ */
+typedef enum
+{
+	HSM_HISTORY_SHALLOW = 0u, /**< Its last active child. */
+	HSM_HISTORY_DEEP,         /**< Its last active leaf. */
+	HSM_HISTORY_NONE          /**< Always its initial state. */
+} hsm_history_t;
+
+#if HSM_STATS
+/**
+ * \brief HSM state counters.
+ *
+ * The times are in nanoseconds.
+ */
+typedef struct
+{
+	uint64_t  itsEntryNum; /**< Times it was entered. */
+	uint64_t  itsExitNum;  /**< Times it was exited. */
+	uint64_t  itsEventNum; /**< Events handled as the current state. */
+	uint64_t  itsDuringNs; /**< Time in its during action. */
+	uint64_t  itsGuardNs;  /**< Time in the guards of its transitions. */
+	uint64_t  itsActionNs; /**< Time in the actions of its transitions. */
+	uint64_t* itsFireNum;  /**< Times each of its transitions fired. */
+} hsm_state_stats_t;
+
+/**
+ * \brief HSM counters.
+ *
+ * Bucket i of the latency histogram counts the events handled in less
+ * than 2^(i+1) nanoseconds, and not in the buckets before. The last one
+ * also counts the slower ones.
+ */
+typedef struct
+{
+	hsm_state_stats_t* itsStates;   /**< Of each state, as allStates. */
+	uint64_t*          itsFireNums; /**< Of all the transitions. */
+	uint64_t itsLatency[HSM_STATS_BUCKET_NUM]; /**< Handling time. */
+} hsm_stats_t;
+#endif
+
 /**
  * \brief HSM state.
+ *
+ * A state with children is entered down to a leaf through its history
+ * pseudostate, see hsm_history_t. Its default, zero, is shallow.
  */
 struct state
 {
@@ -105,15 +209,55 @@ struct state
 	const hsm_transition_t* const
 	               itsTransition;    /**< The state's transition. */
 	const uint32_t itsTransitionNum; /**< The state's transition number. */
+	const hsm_history_t itsHistory; /**< Its history pseudostate. */
 
 	/* Private data, do not touch */
-	hsm_st_mode_t itsMode; /**< The state mode. */
-	state_t*
-	    itsHistoryState; /**< If it has children, this is the history pseudostate. */
+	hsm_st_mode_t itsMode;         /**< The state mode. */
+	state_t*      itsHistoryState; /**< What it resumes, see itsHistory. */
+	state_t*      itsActiveState;  /**< Its active child, if active. */
+	uint32_t      itsIndex;        /**< Its index in allStates. */
+	struct hsm_timer* itsTimers;   /**< The timers bound to it. */
 
 	const char* const itsName; /**< TODO: Delete. */
+
+#if HSM_STATS
+	/* Private data, do not touch */
+	hsm_state_stats_t* itsStats; /**< Its counters, NULL if none. */
+#endif
 };
 
+/**
+ * \brief HSM transition path, see hsm_table_init.
+ *
+ * The states entered are itsEntries[itsEntryFirst] and the itsEntryNum - 1
+ * after it, from the target up to below the LCA.
+ */
+typedef struct
+{
+	const state_t* itsLca;        /**< Least common ancestor, or NULL. */
+	uint32_t       itsEntryFirst; /**< Its first entered state. */
+	uint32_t       itsEntryNum;   /**< The states entered to the target. */
+	uint32_t       itsExitNum;    /**< The states the micro steps exit. */
+} hsm_table_path_t;
+
+/**
+ * \brief HSM transition table, see hsm_table_init.
+ *
+ * The candidates of cell (state index, event type) are from itsFirst[cell]
+ * to itsFirst[cell + 1], the current state's first and then its parents'.
+ * The path of transition j of state i is itsPaths[itsPathFirst[i] + j].
+ */
+typedef struct
+{
+	const hsm_transition_t** itsCandidates; /**< Transitions to check. */
+	const state_t**          itsSources;    /**< Their source states. */
+	const state_t**          itsEntries;    /**< Entered by the paths. */
+	hsm_table_path_t*        itsPaths;      /**< Of every transition. */
+	uint32_t*                itsFirst; /**< First candidate of a cell. */
+	uint32_t*                itsPathFirst; /**< First path of a state. */
+	uint32_t itsEventTypeNum;          /**< The number of event types. */
+} hsm_table_t;
+
 /**
  * \brief Hierarchical state machine
  */
@@ -123,6 +267,16 @@ typedef struct
 	state_t*       itsCurrentState; /**< The current state. */
 	state_t**      allStates;     /**< A list with all the hsm's states. */
 	uint32_t       allStatesSize; /**< The number of the hsm's states. */
+	const hsm_transition_t*
+	    itsTransition; /**< The one the micro steps take, if any. */
+	uint32_t itsTakenNum; /**< Transitions it took, it wraps around. */
+	uint32_t itsExitNum;  /**< States the micro steps still exit. */
+	struct hsm_journal* itsJournal; /**< Its journal, NULL if none. */
+	struct hsm_regions* itsRegions; /**< The regions of its states. */
+	hsm_table_t* itsTable; /**< Its transition table, NULL if none. */
+#if HSM_STATS
+	hsm_stats_t* itsStats; /**< The counters, NULL if none. */
+#endif
 } hsm_t;
 
 // ############################################################################
@@ -156,6 +310,52 @@ int hsm_reset(hsm_t* const me);
 
 int hsm_handleEvent(hsm_t* const me, const hsm_event_t* const event);
 
+int hsm_handleEvents(hsm_t* const             me,
+                     const hsm_event_t* const events,
+                     const size_t             eventNum,
+                     size_t* const            eventDoneNum);
+
+int hsm_dispatch(hsm_t* const me, const hsm_event_t* const event);
+
+int hsm_enter(hsm_t* const me, const hsm_event_t* const event);
+
+int hsm_exit(hsm_t* const me, const hsm_event_t* const event);
+
+uint32_t hsm_getStateIndex(const hsm_t* const me, const state_t* const state);
+
+/*
+ * Transition table
+ */
+int hsm_table_init(hsm_t* const me, const uint32_t eventTypeNum);
+
+void hsm_table_destroy(hsm_t* const me);
+
+/*
+ * Events
+ */
+int hsm_event_init(hsm_event_t* const me,
+                   const uint32_t     eventType,
+                   void* const        payload,
+                   const size_t       size);
+
+const void* hsm_event_getData(const hsm_event_t* const me);
+
+#if HSM_STATS
+/*
+ * Counters
+ */
+int hsm_stats_init(hsm_t* const me);
+
+void hsm_stats_destroy(hsm_t* const me);
+
+void hsm_stats_reset(hsm_t* const me);
+
+const hsm_stats_t* hsm_stats_get(const hsm_t* const me);
+
+const hsm_state_stats_t* hsm_stats_getState(const hsm_t* const   me,
+                                            const state_t* const state);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,1510 @@
+// ############################################################################
+// ############################################################################
+// About
+
+/**
+ * \file     hsm.hpp
+ *
+ * \brief    Compile time C++17 front end of the shared definition.
+ *
+ * States are declared as types with their parent, initial child, actions and
+ * transitions. The topology is validated with static_assert and all the
+ * tables of the hsm_def_t, including the compiled transition table, are
+ * generated as constexpr data. Instances dispatch with hsm_inst_dispatch
+ * without hsm_def_build or hsm_def_compile at startup.
+ *
+ * \code
+ * struct idle;
+ * struct running;
+ *
+ * struct on : hsm::state<void, idle>
+ * {
+ * };
+ *
+ * struct idle : hsm::state<on>
+ * {
+ * 	using transitions = hsm::list<hsm::transition<EV_START, running>>;
+ * };
+ *
+ * struct running : hsm::state<on>
+ * {
+ * 	static bool during(const state_t* me, const hsm_event_t* event);
+ * };
+ *
+ * using machine_t = hsm::machine<EV_NUM, on, on, idle, running>;
+ *
+ * hsm::instance<machine_t> sys;
+ * \endcode
+ *
+ * Created:  18/10/2026
+ */
+
+/**
+ * \defgroup Ungrouped    Ungrouped
+ *
+ * \code
+ * #include "hsm.hpp"
+ * \endcode
+ */
+
+// ############################################################################
+// ############################################################################
+// Code
+
+#ifndef HSM_HPP_ONLY_ONE_INCLUDE_SAFETY
+#define HSM_HPP_ONLY_ONE_INCLUDE_SAFETY
+
+#if !defined(__cplusplus) || (__cplusplus < 201703L)
+#	error "hsm.hpp needs C++17"
+#endif
+
+// ############################################################################
+// ############################################################################
+// Dependencies
+
+#include "hsm.h"
+#include "hsm_def.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace hsm
+{
+
+// ############################################################################
+// ############################################################################
+// Types
+
+/**
+ * \brief A list of types.
+ */
+template <typename... Ts>
+struct list
+{
+};
+
+/**
+ * \brief Base of a state type.
+ *
+ * A state type derives from it and hides the members it needs: onEntry,
+ * during and onExit as static functions, transitions as a list of
+ * \see transition, its history as a hsm_history_t and its name.
+ *
+ * \tparam Parent  The parent state, void for a top state.
+ * \tparam Initial The initial child, void for a leaf.
+ */
+template <typename Parent = void, typename Initial = void>
+struct state
+{
+	using parent      = Parent;
+	using initial     = Initial;
+	using transitions = list<>;
+
+	static constexpr std::nullptr_t onEntry = nullptr;
+	static constexpr std::nullptr_t during  = nullptr;
+	static constexpr std::nullptr_t onExit  = nullptr;
+
+	static constexpr hsm_history_t history = HSM_HISTORY_SHALLOW;
+	static constexpr const char*   name    = nullptr;
+};
+
+/**
+ * \brief A transition of a state.
+ *
+ * \tparam EventType The trigger, HSM_EVENT_ANY for every event.
+ * \tparam Target    The target state, void for an internal transition.
+ * \tparam Guard     The guard function, nullptr for none.
+ * \tparam Action    The action function, nullptr for none.
+ */
+template <uint32_t EventType,
+          typename Target,
+          auto Guard  = nullptr,
+          auto Action = nullptr>
+struct transition
+{
+	using target = Target;
+
+	static constexpr uint32_t eventType = EventType;
+	static constexpr auto     guard     = Guard;
+	static constexpr auto     action    = Action;
+};
+
+namespace detail
+{
+
+/**
+ * \brief A transition and its source state.
+ */
+template <typename Source, typename Transition>
+struct edge
+{
+	using source     = Source;
+	using transition = Transition;
+};
+
+/**
+ * \brief The edges of a state.
+ */
+template <typename Source, typename Transitions>
+struct edges;
+
+template <typename Source, typename... Ts>
+struct edges<Source, list<Ts...>>
+{
+	using type = list<edge<Source, Ts>...>;
+};
+
+/**
+ * \brief Concatenates lists.
+ */
+template <typename... Lists>
+struct concat
+{
+	using type = list<>;
+};
+
+template <typename... Ts>
+struct concat<list<Ts...>>
+{
+	using type = list<Ts...>;
+};
+
+template <typename... Ts, typename... Us, typename... Lists>
+struct concat<list<Ts...>, list<Us...>, Lists...>
+{
+	using type = typename concat<list<Ts..., Us...>, Lists...>::type;
+};
+
+/**
+ * \brief The ids of the topology, as hsm_def_build links them.
+ */
+template <std::size_t N, std::size_t M>
+struct graph
+{
+	std::array<hsm_state_id_t, N> itsParent;    /**< Parent of each. */
+	std::array<hsm_state_id_t, N> itsInitial;   /**< Initial of each. */
+	std::array<bool, N>           itsHasDuring; /**< During of each. */
+	std::array<hsm_history_t, N>  itsHistory;   /**< History of each. */
+	std::array<hsm_state_id_t, M> itsSource;    /**< Of each transition. */
+	std::array<hsm_state_id_t, M> itsTarget;    /**< NONE: internal. */
+	std::array<uint32_t, M>       itsEventType; /**< Trigger of each. */
+	hsm_state_id_t                itsInitialState; /**< First to enter. */
+};
+
+/**
+ * \brief Gets the id of a state type.
+ *
+ * \return The index of T in Ts, HSM_STATE_ID_NONE if not there.
+ */
+template <typename T, typename... Ts>
+constexpr hsm_state_id_t indexOf()
+{
+	constexpr bool matches[] = {std::is_same_v<T, Ts>..., false};
+	hsm_state_id_t id        = HSM_STATE_ID_NONE;
+
+	for (std::size_t i = sizeof...(Ts); i > 0U; i--)
+	{
+		if (matches[i - 1U])
+		{
+			id = (hsm_state_id_t)(i - 1U);
+		}
+	}
+
+	return id;
+}
+
+/**
+ * \brief Checks if a state type is void or one of the states.
+ */
+template <typename T, typename... Ts>
+constexpr bool isKnown()
+{
+	return std::is_void_v<T> || (indexOf<T, Ts...>() != HSM_STATE_ID_NONE);
+}
+
+/**
+ * \brief Checks if an action is given.
+ */
+template <typename T>
+constexpr bool isSet()
+{
+	return !std::is_null_pointer_v<T>;
+}
+
+/**
+ * \brief Gets the actions of a state type, as itsActions of hsm_def_t.
+ */
+template <typename S>
+constexpr uint8_t getActions()
+{
+	constexpr bool deep = !std::is_void_v<typename S::initial> &&
+	                      (S::history == HSM_HISTORY_DEEP);
+
+	return (uint8_t)((isSet<decltype(S::onEntry)>() ? HSM_DEF_ACTION_ENTRY
+	                                                : 0U) |
+	                 (isSet<decltype(S::during)>() ? HSM_DEF_ACTION_DURING
+	                                               : 0U) |
+	                 (isSet<decltype(S::onExit)>() ? HSM_DEF_ACTION_EXIT
+	                                               : 0U) |
+	                 (deep ? HSM_DEF_HISTORY_DEEP : 0U));
+}
+
+/**
+ * \brief Gets the states from a state up to one of its ancestors.
+ *
+ * Same as def_getPath of hsm_def.c.
+ *
+ * \return The number of states in the path, -1 on failure.
+ */
+template <std::size_t N, std::size_t M>
+constexpr int getPath(const graph<N, M>&   me,
+                      const hsm_state_id_t state,
+                      const hsm_state_id_t ancestor,
+                      hsm_state_id_t       path[])
+{
+	int            pathSize = 0;
+	hsm_state_id_t aux      = state;
+
+	while ((aux != ancestor) && (pathSize >= 0))
+	{
+		if ((aux >= N) || (pathSize >= (int)HSM_MAX_DEPTH))
+		{
+			/* Not an ancestor or too deep */
+			pathSize = -1;
+		}
+		else
+		{
+			path[pathSize] = aux;
+			pathSize++;
+			aux = me.itsParent[aux];
+		}
+	}
+
+	return pathSize;
+}
+
+/**
+ * \brief Gets the least common ancestor of a transition.
+ *
+ * Same as def_getLca of hsm_def.c.
+ */
+template <std::size_t N, std::size_t M>
+constexpr hsm_state_id_t getLca(const graph<N, M>&   me,
+                                const hsm_state_id_t source,
+                                const hsm_state_id_t target)
+{
+	hsm_state_id_t lca   = me.itsParent[source];
+	bool           found = false;
+
+	while ((lca != HSM_STATE_ID_NONE) && !found)
+	{
+		hsm_state_id_t aux = me.itsParent[target];
+
+		while ((aux != HSM_STATE_ID_NONE) && (aux != lca))
+		{
+			aux = me.itsParent[aux];
+		}
+
+		if (aux == lca)
+		{
+			found = true;
+		}
+		else
+		{
+			lca = me.itsParent[lca];
+		}
+	}
+
+	return lca;
+}
+
+/**
+ * \brief Checks that the hierarchy has no loops and is not too deep, and
+ *        that every initial child is a child.
+ */
+template <std::size_t N, std::size_t M>
+constexpr bool isValid(const graph<N, M>& me)
+{
+	bool success = true;
+
+	for (std::size_t i = 0U; (i < N) && success; i++)
+	{
+		hsm_state_id_t path[HSM_MAX_DEPTH] = {};
+
+		success = (getPath(me,
+		                   (hsm_state_id_t)i,
+		                   HSM_STATE_ID_NONE,
+		                   path) > 0);
+
+		if (success && (me.itsInitial[i] != HSM_STATE_ID_NONE))
+		{
+			success = (me.itsParent[me.itsInitial[i]] == i);
+		}
+	}
+
+	return success;
+}
+
+/**
+ * \brief Numbers the history slots, one per state with children and a
+ *        history pseudostate.
+ */
+template <std::size_t N, std::size_t M>
+constexpr std::array<hsm_state_id_t, N> getHistorySlots(
+    const graph<N, M>& me)
+{
+	std::array<hsm_state_id_t, N> slots   = {};
+	uint32_t                      history = 0U;
+
+	for (std::size_t i = 0U; i < N; i++)
+	{
+		slots[i] = HSM_STATE_ID_NONE;
+
+		if ((me.itsInitial[i] != HSM_STATE_ID_NONE) &&
+		    (me.itsHistory[i] != HSM_HISTORY_NONE))
+		{
+			slots[i] = (hsm_state_id_t)history;
+			history++;
+		}
+	}
+
+	return slots;
+}
+
+/**
+ * \brief Gets the number of history slots.
+ */
+template <std::size_t N, std::size_t M>
+constexpr uint32_t getHistoryNum(const graph<N, M>& me)
+{
+	uint32_t history = 0U;
+
+	for (std::size_t i = 0U; i < N; i++)
+	{
+		if ((me.itsInitial[i] != HSM_STATE_ID_NONE) &&
+		    (me.itsHistory[i] != HSM_HISTORY_NONE))
+		{
+			history++;
+		}
+	}
+
+	return history;
+}
+
+/**
+ * \brief Gets the first transition of each state, the transitions are in
+ *        the order of their source states.
+ */
+template <std::size_t N, std::size_t M>
+constexpr std::array<uint32_t, N + 1U> getTransitionFirst(
+    const graph<N, M>& me)
+{
+	std::array<uint32_t, N + 1U> first = {};
+
+	for (std::size_t i = 0U; i < M; i++)
+	{
+		first[me.itsSource[i] + 1U]++;
+	}
+
+	for (std::size_t i = 0U; i < N; i++)
+	{
+		first[i + 1U] += first[i];
+	}
+
+	return first;
+}
+
+/**
+ * \brief Gets where the path of each state starts.
+ */
+template <std::size_t N, std::size_t M>
+constexpr std::array<uint32_t, N + 1U> getPathFirst(const graph<N, M>& me)
+{
+	std::array<uint32_t, N + 1U> first = {};
+
+	for (std::size_t i = 0U; i < N; i++)
+	{
+		hsm_state_id_t path[HSM_MAX_DEPTH] = {};
+
+		first[i + 1U] = first[i] + (uint32_t)getPath(me,
+		                                             (hsm_state_id_t)i,
+		                                             HSM_STATE_ID_NONE,
+		                                             path);
+	}
+
+	return first;
+}
+
+/**
+ * \brief Gets the path of every state up to the top.
+ */
+template <std::size_t P, std::size_t N, std::size_t M>
+constexpr std::array<hsm_state_id_t, P> getPaths(const graph<N, M>& me)
+{
+	std::array<hsm_state_id_t, P> paths = {};
+	std::size_t                   first = 0U;
+
+	for (std::size_t i = 0U; i < N; i++)
+	{
+		hsm_state_id_t path[HSM_MAX_DEPTH] = {};
+		const int      num =
+		    getPath(me, (hsm_state_id_t)i, HSM_STATE_ID_NONE, path);
+
+		for (int j = 0; j < num; j++)
+		{
+			paths[first] = path[j];
+			first++;
+		}
+	}
+
+	return paths;
+}
+
+/**
+ * \brief Gets the number of states every transition enters.
+ */
+template <std::size_t N, std::size_t M>
+constexpr std::array<uint32_t, M> getEntryNums(const graph<N, M>& me)
+{
+	std::array<uint32_t, M> entryNums = {};
+
+	for (std::size_t i = 0U; i < M; i++)
+	{
+		if (me.itsTarget[i] != HSM_STATE_ID_NONE)
+		{
+			hsm_state_id_t path[HSM_MAX_DEPTH] = {};
+
+			entryNums[i] = (uint32_t)getPath(
+			    me,
+			    me.itsTarget[i],
+			    getLca(me, me.itsSource[i], me.itsTarget[i]),
+			    path);
+		}
+	}
+
+	return entryNums;
+}
+
+/**
+ * \brief Gets the transitions of the definition.
+ *
+ * Same as def_link and def_plan of hsm_def.c.
+ */
+template <std::size_t N, std::size_t M>
+constexpr std::array<hsm_def_transition_t, M> getTransitions(
+    const graph<N, M>&                  me,
+    const std::array<uint32_t, N + 1U>& pathFirst,
+    const hsm_transition_t* const       userTransitions)
+{
+	std::array<hsm_def_transition_t, M> transitions = {};
+	const std::array<uint32_t, M>       entryNums   = getEntryNums(me);
+	uint32_t                            first       = 0U;
+
+	for (std::size_t i = 0U; i < M; i++)
+	{
+		hsm_def_transition_t& aux = transitions[i];
+
+		aux.itsTransition = &userTransitions[i];
+		aux.itsSource     = me.itsSource[i];
+		aux.itsTarget     = me.itsTarget[i];
+		aux.itsLca        = HSM_STATE_ID_NONE;
+		aux.itsLcaLevel   = 0U;
+		aux.itsEntryNum   = (uint16_t)entryNums[i];
+		aux.itsEntryFirst = first;
+
+		if (aux.itsTarget != HSM_STATE_ID_NONE)
+		{
+			aux.itsLca = getLca(me, aux.itsSource, aux.itsTarget);
+
+			if (aux.itsLca != HSM_STATE_ID_NONE)
+			{
+				aux.itsLcaLevel =
+				    (uint16_t)(pathFirst[aux.itsLca + 1U] -
+				               pathFirst[aux.itsLca]);
+			}
+		}
+
+		first += entryNums[i];
+	}
+
+	return transitions;
+}
+
+/**
+ * \brief Gets the states every transition enters, outermost first.
+ */
+template <std::size_t E, std::size_t N, std::size_t M>
+constexpr std::array<hsm_state_id_t, E> getEntries(const graph<N, M>& me)
+{
+	std::array<hsm_state_id_t, E> entries = {};
+	std::size_t                   first   = 0U;
+
+	for (std::size_t i = 0U; i < M; i++)
+	{
+		if (me.itsTarget[i] != HSM_STATE_ID_NONE)
+		{
+			const hsm_state_id_t lca =
+			    getLca(me, me.itsSource[i], me.itsTarget[i]);
+			hsm_state_id_t path[HSM_MAX_DEPTH] = {};
+			const int      num =
+			    getPath(me, me.itsTarget[i], lca, path);
+
+			for (int j = num; j > 0; j--)
+			{
+				entries[first] = path[j - 1];
+				first++;
+			}
+		}
+	}
+
+	return entries;
+}
+
+/**
+ * \brief Lists the transitions a state checks for an event type.
+ *
+ * Same as def_fillCandidates of hsm_def.c.
+ *
+ * \return The number of transitions.
+ */
+template <std::size_t N, std::size_t M>
+constexpr uint32_t fillCandidates(
+    const graph<N, M>&                  me,
+    const std::array<uint32_t, N + 1U>& first,
+    const hsm_state_id_t                state,
+    const uint32_t                      eventType,
+    uint32_t* const                     candidates)
+{
+	uint32_t       candidateNum = 0U;
+	hsm_state_id_t aux          = state;
+
+	while (aux != HSM_STATE_ID_NONE)
+	{
+		for (uint32_t i = first[aux]; i < first[aux + 1U]; i++)
+		{
+			if ((me.itsEventType[i] == HSM_EVENT_ANY) ||
+			    (me.itsEventType[i] == eventType))
+			{
+				if (candidates != nullptr)
+				{
+					candidates[candidateNum] = i;
+				}
+
+				candidateNum++;
+			}
+		}
+
+		aux = me.itsParent[aux];
+	}
+
+	return candidateNum;
+}
+
+/**
+ * \brief Gets the first candidate of every (state, event type) cell.
+ */
+template <std::size_t C, std::size_t N, std::size_t M>
+constexpr std::array<uint32_t, C + 1U> getTable(
+    const graph<N, M>&                  me,
+    const std::array<uint32_t, N + 1U>& first,
+    const uint32_t                      eventTypeNum)
+{
+	std::array<uint32_t, C + 1U> table = {};
+
+	for (std::size_t cell = 0U; cell < C; cell++)
+	{
+		table[cell + 1U] =
+		    table[cell] +
+		    fillCandidates(me,
+		                   first,
+		                   (hsm_state_id_t)(cell / eventTypeNum),
+		                   (uint32_t)(cell % eventTypeNum),
+		                   nullptr);
+	}
+
+	return table;
+}
+
+/**
+ * \brief Gets the candidates of all the cells.
+ */
+template <std::size_t K, std::size_t C, std::size_t N, std::size_t M>
+constexpr std::array<uint32_t, K> getCandidates(
+    const graph<N, M>&                  me,
+    const std::array<uint32_t, N + 1U>& first,
+    const std::array<uint32_t, C + 1U>& table,
+    const uint32_t                      eventTypeNum)
+{
+	std::array<uint32_t, K> candidates = {};
+
+	for (std::size_t cell = 0U; cell < C; cell++)
+	{
+		(void)fillCandidates(me,
+		                     first,
+		                     (hsm_state_id_t)(cell / eventTypeNum),
+		                     (uint32_t)(cell % eventTypeNum),
+		                     &candidates[table[cell]]);
+	}
+
+	return candidates;
+}
+
+/**
+ * \brief Gets if anything runs in every cell: a candidate or a during.
+ */
+template <std::size_t C, std::size_t N, std::size_t M>
+constexpr std::array<uint32_t, C> getActive(
+    const graph<N, M>&                  me,
+    const std::array<uint32_t, C + 1U>& table,
+    const uint32_t                      eventTypeNum)
+{
+	std::array<uint32_t, C> active = {};
+
+	for (std::size_t cell = 0U; cell < C; cell++)
+	{
+		hsm_state_id_t aux = (hsm_state_id_t)(cell / eventTypeNum);
+		bool           hasDuring = false;
+
+		while ((aux != HSM_STATE_ID_NONE) && !hasDuring)
+		{
+			hasDuring = me.itsHasDuring[aux];
+			aux       = me.itsParent[aux];
+		}
+
+		active[cell] =
+		    (uint32_t)((table[cell + 1U] != table[cell]) || hasDuring);
+	}
+
+	return active;
+}
+
+template <uint32_t EventTypeNum,
+          typename Initial,
+          typename States,
+          typename Edges>
+struct machine;
+
+/**
+ * \brief A machine, see \see hsm::machine.
+ */
+template <uint32_t EventTypeNum,
+          typename Initial,
+          typename... States,
+          typename... Edges>
+struct machine<EventTypeNum, Initial, list<States...>, list<Edges...>>
+{
+	static constexpr uint32_t stateNum      = sizeof...(States);
+	static constexpr uint32_t transitionNum = sizeof...(Edges);
+	static constexpr uint32_t cellNum       = stateNum * EventTypeNum;
+
+	static_assert((stateNum > 0U) && (stateNum < HSM_STATE_ID_NONE),
+	              "Invalid number of states");
+	static_assert(EventTypeNum > 0U, "Invalid number of event types");
+	static_assert((isKnown<typename States::parent, States...>() && ...),
+	              "A parent state is not in the machine");
+	static_assert((isKnown<typename States::initial, States...>() && ...),
+	              "An initial state is not in the machine");
+	static_assert(
+	    (isKnown<typename Edges::transition::target, States...>() && ...),
+	    "A target state is not in the machine");
+	static_assert(((Edges::transition::eventType < EventTypeNum) && ...),
+	              "A trigger is not below the number of event types");
+	static_assert(indexOf<Initial, States...>() != HSM_STATE_ID_NONE,
+	              "The initial state is not in the machine");
+	static_assert(std::is_void_v<typename Initial::parent>,
+	              "The initial state must be a top state");
+
+	/* The ids */
+	static constexpr graph<stateNum, transitionNum> topology = {
+	    {indexOf<typename States::parent, States...>()...},
+	    {indexOf<typename States::initial, States...>()...},
+	    {isSet<decltype(States::during)>()...},
+	    {States::history...},
+	    {indexOf<typename Edges::source, States...>()...},
+	    {indexOf<typename Edges::transition::target, States...>()...},
+	    {Edges::transition::eventType...},
+	    indexOf<Initial, States...>()};
+
+	static_assert(isValid(topology),
+	              "Loop, too deep or initial state that is not a child");
+
+	/* The user's states and transitions */
+	static state_t states[sizeof...(States)];
+
+	static constexpr const state_t* stateList[stateNum] = {
+	    &states[indexOf<States, States...>()]...};
+
+	static constexpr hsm_transition_t transitions[transitionNum + 1U] = {
+	    {Edges::transition::guard,
+	     Edges::transition::action,
+	     std::is_void_v<typename Edges::transition::target>
+	         ? nullptr
+	         : &states[indexOf<typename Edges::transition::target,
+	                           States...>()],
+	     Edges::transition::eventType}...,
+	    {nullptr, nullptr, nullptr, HSM_EVENT_ANY}};
+
+	/* The definition's tables */
+	static constexpr std::array<hsm_state_id_t, stateNum> historySlot =
+	    getHistorySlots(topology);
+	static constexpr std::array<uint8_t, stateNum> actions = {
+	    getActions<States>()...};
+	static constexpr std::array<uint32_t, stateNum + 1U> transitionFirst =
+	    getTransitionFirst(topology);
+	static constexpr std::array<uint32_t, stateNum + 1U> pathFirst =
+	    getPathFirst(topology);
+	static constexpr std::size_t pathNum = pathFirst[stateNum];
+	static constexpr std::array<hsm_state_id_t, pathNum> paths =
+	    getPaths<pathNum>(topology);
+	static constexpr std::array<hsm_def_transition_t, transitionNum>
+	    defTransitions = getTransitions(topology, pathFirst, transitions);
+
+	static constexpr std::size_t entryNum =
+	    (transitionNum != 0U) ? (defTransitions[transitionNum - 1U]
+	                                 .itsEntryFirst +
+	                             defTransitions[transitionNum - 1U]
+	                                 .itsEntryNum)
+	                          : 0U;
+	static constexpr std::array<hsm_state_id_t, entryNum> entries =
+	    getEntries<entryNum>(topology);
+
+	static constexpr std::array<uint32_t, cellNum + 1U> table =
+	    getTable<cellNum>(topology, transitionFirst, EventTypeNum);
+	static constexpr std::array<uint32_t, table[cellNum]> candidates =
+	    getCandidates<table[cellNum], cellNum>(topology,
+	                                           transitionFirst,
+	                                           table,
+	                                           EventTypeNum);
+	static constexpr std::array<uint32_t, cellNum> active =
+	    getActive<cellNum>(topology, table, EventTypeNum);
+
+	/** \brief The number of history slots of an instance. */
+	static constexpr uint32_t historyNum = getHistoryNum(topology);
+
+	/** \brief The definition, already built and compiled. */
+	static constexpr hsm_def_t def = {stateList,
+	                                  topology.itsParent.data(),
+	                                  topology.itsInitial.data(),
+	                                  historySlot.data(),
+	                                  actions.data(),
+	                                  transitionFirst.data(),
+	                                  defTransitions.data(),
+	                                  stateNum,
+	                                  transitionNum,
+	                                  historyNum,
+	                                  topology.itsInitialState,
+	                                  nullptr,
+	                                  pathFirst.data(),
+	                                  paths.data(),
+	                                  entries.data(),
+	                                  nullptr,
+	                                  table.data(),
+	                                  candidates.data(),
+	                                  active.data(),
+	                                  EventTypeNum,
+	                                  nullptr};
+
+	/** \brief The id of a state type. */
+	template <typename S>
+	static constexpr hsm_state_id_t id = indexOf<S, States...>();
+
+	/** \brief The state_t of a state type. */
+	template <typename S>
+	static constexpr const state_t* stateOf =
+	    &states[indexOf<S, States...>()];
+
+	/** \brief The state type of an id. */
+	template <std::size_t I>
+	using stateType = std::tuple_element_t<I, std::tuple<States...>>;
+
+	/** \brief The transition type of an index. */
+	template <std::size_t K>
+	using transitionType =
+	    typename std::tuple_element_t<K, std::tuple<Edges...>>::transition;
+};
+
+/* The states are not constexpr, the legacy hsm_t writes to them */
+template <uint32_t EventTypeNum,
+          typename Initial,
+          typename... States,
+          typename... Edges>
+state_t machine<EventTypeNum, Initial, list<States...>, list<Edges...>>::
+    states[sizeof...(States)] = {
+        {std::is_void_v<typename States::initial>
+             ? nullptr
+             : &states[indexOf<typename States::initial, States...>()],
+         std::is_void_v<typename States::parent>
+             ? nullptr
+             : &states[indexOf<typename States::parent, States...>()],
+         States::onEntry,
+         States::during,
+         States::onExit,
+         &transitions[transitionFirst[indexOf<States, States...>()]],
+         transitionFirst[indexOf<States, States...>() + 1U] -
+             transitionFirst[indexOf<States, States...>()],
+         States::history,
+         HSM_ST_M_ON_ENTRY,
+         nullptr,
+         nullptr,
+         0U,
+         nullptr,
+         States::name
+#if HSM_STATS
+         ,
+         nullptr
+#endif
+        }...};
+
+/**
+ * \brief Run to completion dispatch of a machine, generated per state.
+ *
+ * Same algorithm as hsm_inst_dispatch, but every path, transition and
+ * action is known at compile time: the actions are called directly so the
+ * compiler can inline them, the missing ones generate no code and the
+ * current state is looked up with a chain of compares, which the compiler
+ * turns into a switch.
+ */
+template <typename Machine>
+struct dispatcher
+{
+	template <std::size_t I>
+	using id = std::integral_constant<std::size_t, I>;
+
+	using sequence = std::make_index_sequence<Machine::stateNum>;
+
+	/**
+	 * \brief Calls f with the id of a state as a type.
+	 *
+	 * Only the states that pass Filter are considered.
+	 *
+	 * \return True if the state passed, False otherwise.
+	 */
+	template <typename Filter, typename F, std::size_t... Is>
+	static bool visit(const hsm_state_id_t state,
+	                  F&&                  f,
+	                  std::index_sequence<Is...>)
+	{
+		return (visitOne<Filter, Is>(state, f) || ...);
+	}
+
+	template <typename Filter, std::size_t I, typename F>
+	static bool visitOne(const hsm_state_id_t state, F& f)
+	{
+		bool found = false;
+
+		if constexpr (Filter::template value<I>)
+		{
+			if (state == I)
+			{
+				f(id<I>{});
+				found = true;
+			}
+		}
+
+		return found;
+	}
+
+	/** \brief Every state. */
+	struct anyState
+	{
+		template <std::size_t I>
+		static constexpr bool value = true;
+	};
+
+	/** \brief The children of a state. */
+	template <std::size_t P>
+	struct childOf
+	{
+		template <std::size_t I>
+		static constexpr bool value =
+		    (Machine::topology.itsParent[I] == P);
+	};
+
+	/** \brief Checks if a state is below another one. */
+	static constexpr bool isBelow(const std::size_t state,
+	                              const std::size_t ancestor)
+	{
+		hsm_state_id_t aux   = Machine::topology.itsParent[state];
+		bool           found = false;
+
+		while ((aux != HSM_STATE_ID_NONE) && !found)
+		{
+			found = (aux == ancestor);
+			aux   = Machine::topology.itsParent[aux];
+		}
+
+		return found;
+	}
+
+	/** \brief The states below a state. */
+	template <std::size_t P>
+	struct descendantOf
+	{
+		template <std::size_t I>
+		static constexpr bool value = isBelow(I, P);
+	};
+
+	/** \brief The n-th active state of a leaf, innermost first. */
+	template <std::size_t L, std::size_t N>
+	static constexpr std::size_t pathAt()
+	{
+		return Machine::paths[Machine::pathFirst[L] + N];
+	}
+
+	/** \brief The n-th state a transition enters, outermost first. */
+	template <std::size_t K, std::size_t N>
+	static constexpr std::size_t entryAt()
+	{
+		constexpr std::size_t first =
+		    Machine::defTransitions[K].itsEntryFirst;
+
+		return Machine::entries[first + N];
+	}
+
+	/**
+	 * \brief Enters a single state, see inst_enterState of hsm_def.c.
+	 */
+	template <std::size_t I>
+	static int enterState(hsm_inst_t* const        me,
+	                      const hsm_event_t* const event)
+	{
+		using S = typename Machine::template stateType<I>;
+
+		constexpr hsm_state_id_t parent =
+		    Machine::topology.itsParent[I];
+		int errorCode = 0;
+
+		if constexpr (isSet<decltype(S::onEntry)>())
+		{
+			if (!S::onEntry(&Machine::states[I], event))
+			{
+				/* Fail */
+				errorCode = -1;
+			}
+		}
+
+		if (errorCode == 0)
+		{
+			/* Remember it for a shallow history pseudostate */
+			if constexpr ((parent != HSM_STATE_ID_NONE) &&
+			              (Machine::historySlot[parent] !=
+			               HSM_STATE_ID_NONE) &&
+			              ((Machine::actions[parent] &
+			                HSM_DEF_HISTORY_DEEP) == 0U))
+			{
+				me->itsHistory[Machine::historySlot[parent]] =
+				    (hsm_state_id_t)I;
+			}
+
+			me->itsCurrentState = (hsm_state_id_t)I;
+		}
+
+		return errorCode;
+	}
+
+	/**
+	 * \brief Enters the states below an entered state down to one of its
+	 *        descendants, outermost first.
+	 */
+	template <std::size_t P, std::size_t D>
+	static int enterPath(hsm_inst_t* const        me,
+	                     const hsm_event_t* const event)
+	{
+		constexpr std::size_t parent = Machine::topology.itsParent[D];
+		int                   errorCode = 0;
+
+		if constexpr (parent != P)
+		{
+			errorCode = enterPath<P, parent>(me, event);
+		}
+
+		if (errorCode == 0)
+		{
+			errorCode = enterState<D>(me, event);
+		}
+
+		return errorCode;
+	}
+
+	/**
+	 * \brief Enters from an entered state down to a leaf, through the
+	 *        history pseudostates.
+	 */
+	template <std::size_t I>
+	static int enterDown(hsm_inst_t* const        me,
+	                     const hsm_event_t* const event)
+	{
+		constexpr hsm_state_id_t initial =
+		    Machine::topology.itsInitial[I];
+		constexpr hsm_state_id_t slot      = Machine::historySlot[I];
+		int                      errorCode = 0;
+
+		if constexpr ((initial != HSM_STATE_ID_NONE) &&
+		              (slot == HSM_STATE_ID_NONE))
+		{
+			/* Always the initial state */
+			errorCode = enterState<initial>(me, event);
+
+			if (errorCode == 0)
+			{
+				errorCode = enterDown<initial>(me, event);
+			}
+		}
+		else if constexpr (initial != HSM_STATE_ID_NONE)
+		{
+			/* A deep history goes straight down to its leaf */
+			using Filter = std::conditional_t<
+			    (Machine::actions[I] & HSM_DEF_HISTORY_DEEP) != 0U,
+			    descendantOf<I>,
+			    childOf<I>>;
+
+			(void)visit<Filter>(
+			    me->itsHistory[slot],
+			    [&](auto d) {
+				    constexpr std::size_t D =
+				        decltype(d)::value;
+
+				    errorCode = enterPath<I, D>(me, event);
+
+				    if (errorCode == 0)
+				    {
+					    errorCode =
+					        enterDown<D>(me, event);
+				    }
+			    },
+			    sequence{});
+		}
+		else
+		{
+			/* A leaf */
+		}
+
+		return errorCode;
+	}
+
+	/**
+	 * \brief Executes the during actions of the active states of a leaf,
+	 *        outermost first.
+	 */
+	template <std::size_t L, std::size_t... Ks>
+	static int during(const hsm_event_t* const event,
+	                  std::index_sequence<Ks...>)
+	{
+		constexpr std::size_t depth = sizeof...(Ks);
+		int                   errorCode = 0;
+
+		(void)((errorCode == 0) &&
+		       ... &&
+		       ((errorCode = duringOne<pathAt<L, depth - 1U - Ks>()>(
+		             event)) == 0));
+
+		return errorCode;
+	}
+
+	template <std::size_t I>
+	static int duringOne(const hsm_event_t* const event)
+	{
+		using S = typename Machine::template stateType<I>;
+
+		int errorCode = 0;
+
+		if constexpr (isSet<decltype(S::during)>())
+		{
+			if (!S::during(&Machine::states[I], event))
+			{
+				/* Fail */
+				errorCode = -1;
+			}
+		}
+
+		return errorCode;
+	}
+
+	/**
+	 * \brief Gets the number of transitions a leaf checks.
+	 */
+	template <std::size_t L>
+	static constexpr std::size_t getCandidateNum()
+	{
+		std::size_t    num = 0U;
+		hsm_state_id_t aux = (hsm_state_id_t)L;
+
+		while (aux != HSM_STATE_ID_NONE)
+		{
+			num += Machine::transitionFirst[aux + 1U] -
+			       Machine::transitionFirst[aux];
+			aux = Machine::topology.itsParent[aux];
+		}
+
+		return num;
+	}
+
+	/**
+	 * \brief Gets the transitions a leaf checks, in order.
+	 */
+	template <std::size_t L>
+	static constexpr std::array<uint32_t, getCandidateNum<L>()>
+	getCandidates()
+	{
+		std::array<uint32_t, getCandidateNum<L>()> candidates = {};
+		std::size_t    num = 0U;
+		hsm_state_id_t aux = (hsm_state_id_t)L;
+
+		while (aux != HSM_STATE_ID_NONE)
+		{
+			for (uint32_t k = Machine::transitionFirst[aux];
+			     k < Machine::transitionFirst[aux + 1U];
+			     k++)
+			{
+				candidates[num] = k;
+				num++;
+			}
+
+			aux = Machine::topology.itsParent[aux];
+		}
+
+		return candidates;
+	}
+
+	/**
+	 * \brief Takes the first enabled transition of a leaf.
+	 */
+	template <std::size_t L, std::size_t... Js>
+	static int react(hsm_inst_t* const        me,
+	                 const hsm_event_t* const event,
+	                 const uint32_t           eventType,
+	                 std::index_sequence<Js...>)
+	{
+		constexpr auto candidates = getCandidates<L>();
+		int            errorCode  = 0;
+
+		/* Unused by leaves without transitions */
+		(void)candidates;
+		(void)me;
+		(void)event;
+		(void)eventType;
+
+		(void)(tryTransition<L, candidates[Js]>(me,
+		                                        event,
+		                                        eventType,
+		                                        errorCode) ||
+		       ...);
+
+		return errorCode;
+	}
+
+	/**
+	 * \brief Takes a transition if triggered and its guard passes.
+	 *
+	 * \return True if taken, False otherwise.
+	 */
+	template <std::size_t L, std::size_t K>
+	static bool tryTransition(hsm_inst_t* const        me,
+	                          const hsm_event_t* const event,
+	                          const uint32_t           eventType,
+	                          int&                     errorCode)
+	{
+		using T = typename Machine::template transitionType<K>;
+
+		constexpr hsm_def_transition_t aux =
+		    Machine::defTransitions[K];
+		const state_t* const source = &Machine::states[aux.itsSource];
+		bool                 taken  = false;
+
+		if constexpr (T::eventType == HSM_EVENT_ANY)
+		{
+			taken = true;
+		}
+		else
+		{
+			taken = (eventType == T::eventType);
+		}
+
+		if constexpr (isSet<decltype(T::guard)>())
+		{
+			taken = taken && T::guard(source, event);
+		}
+
+		if (taken)
+		{
+			errorCode = take<L, K>(me, event, source);
+		}
+
+		return taken;
+	}
+
+	/**
+	 * \brief Takes a transition, see hsm_inst_dispatch.
+	 */
+	template <std::size_t L, std::size_t K>
+	static int take(hsm_inst_t* const        me,
+	                const hsm_event_t* const event,
+	                const state_t* const     source)
+	{
+		using T = typename Machine::template transitionType<K>;
+
+		constexpr hsm_def_transition_t aux =
+		    Machine::defTransitions[K];
+		int errorCode = 0;
+
+		if constexpr (aux.itsTarget != HSM_STATE_ID_NONE)
+		{
+			constexpr std::size_t activeNum =
+			    Machine::pathFirst[L + 1U] - Machine::pathFirst[L];
+
+			/* Exit up to the LCA */
+			errorCode = exit<L>(
+			    me,
+			    event,
+			    std::make_index_sequence<activeNum -
+			                             aux.itsLcaLevel>{});
+		}
+
+		if constexpr (isSet<decltype(T::action)>())
+		{
+			if (errorCode == 0)
+			{
+				T::action(source, event);
+			}
+		}
+
+		if constexpr (aux.itsTarget != HSM_STATE_ID_NONE)
+		{
+			if (errorCode == 0)
+			{
+				using entrySequence =
+				    std::make_index_sequence<aux.itsEntryNum>;
+
+				errorCode =
+				    enter<K>(me, event, entrySequence{});
+			}
+		}
+
+		return errorCode;
+	}
+
+	/**
+	 * \brief Exits states from a leaf upwards, see inst_exit.
+	 */
+	template <std::size_t L, std::size_t... Es>
+	static int exit(hsm_inst_t* const        me,
+	                const hsm_event_t* const event,
+	                std::index_sequence<Es...>)
+	{
+		int errorCode = 0;
+
+		(void)((errorCode == 0) &&
+		       ... &&
+		       ((errorCode = exitOne<L, pathAt<L, Es>()>(me, event)) ==
+		        0));
+
+		return errorCode;
+	}
+
+	template <std::size_t L, std::size_t I>
+	static int exitOne(hsm_inst_t* const        me,
+	                   const hsm_event_t* const event)
+	{
+		using S = typename Machine::template stateType<I>;
+
+		int errorCode = 0;
+
+		if constexpr (isSet<decltype(S::onExit)>())
+		{
+			if (!S::onExit(&Machine::states[I], event))
+			{
+				/* Fail */
+				errorCode = -1;
+			}
+		}
+
+		if (errorCode == 0)
+		{
+			/* A deep history remembers the leaf it is left in */
+			if constexpr ((Machine::actions[I] &
+			               HSM_DEF_HISTORY_DEEP) != 0U)
+			{
+				me->itsHistory[Machine::historySlot[I]] =
+				    (hsm_state_id_t)L;
+			}
+
+			me->itsCurrentState = Machine::topology.itsParent[I];
+		}
+
+		return errorCode;
+	}
+
+	/**
+	 * \brief Enters the states of a transition and then down to a leaf,
+	 *        see inst_enter.
+	 */
+	template <std::size_t K, std::size_t... Es>
+	static int enter(hsm_inst_t* const        me,
+	                 const hsm_event_t* const event,
+	                 std::index_sequence<Es...>)
+	{
+		constexpr hsm_def_transition_t aux =
+		    Machine::defTransitions[K];
+		int errorCode = 0;
+
+		(void)((errorCode == 0) &&
+		       ... &&
+		       ((errorCode =
+		             enterState<entryAt<K, Es>()>(me, event)) == 0));
+
+		if (errorCode == 0)
+		{
+			errorCode = enterDown<aux.itsTarget>(me, event);
+		}
+
+		return errorCode;
+	}
+
+	/**
+	 * \brief Handles an event, same as hsm_inst_dispatch.
+	 */
+	static int dispatch(hsm_inst_t* const        me,
+	                    const hsm_event_t* const event)
+	{
+		constexpr std::size_t initialState =
+		    Machine::topology.itsInitialState;
+		const uint32_t eventType =
+		    (event != nullptr) ? event->eventType : HSM_EVENT_ANY;
+		int errorCode = 0;
+
+		/* Enter the initial state on the first event */
+		if (me->itsMode == (uint8_t)HSM_ST_M_ON_ENTRY)
+		{
+			errorCode = enterState<initialState>(me, event);
+
+			if (errorCode == 0)
+			{
+				errorCode = enterDown<initialState>(me, event);
+			}
+		}
+		else if (me->itsMode != (uint8_t)HSM_ST_M_DURING)
+		{
+			/* Failed before */
+			errorCode = -1;
+		}
+		else
+		{
+			/* No action */
+		}
+
+		/* Execute during and take the transition of the leaf */
+		if (errorCode == 0)
+		{
+			(void)visit<anyState>(
+			    me->itsCurrentState,
+			    [&](auto leaf) {
+				    constexpr std::size_t L =
+				        decltype(leaf)::value;
+				    constexpr std::size_t depth =
+				        Machine::pathFirst[L + 1U] -
+				        Machine::pathFirst[L];
+
+				    errorCode = during<L>(
+				        event,
+				        std::make_index_sequence<depth>{});
+
+				    if (errorCode == 0)
+				    {
+					    errorCode = react<L>(
+					        me,
+					        event,
+					        eventType,
+					        std::make_index_sequence<
+					            getCandidateNum<L>()>{});
+				    }
+			    },
+			    sequence{});
+		}
+
+		me->itsMode = (errorCode == 0) ? (uint8_t)HSM_ST_M_DURING
+		                               : (uint8_t)HSM_ST_M_ERROR;
+
+		if ((errorCode == 0) && (event == nullptr))
+		{
+			/* No event signal given */
+			errorCode = 1;
+		}
+
+		return errorCode;
+	}
+};
+
+} // namespace detail
+
+/**
+ * \brief A machine generated at compile time.
+ *
+ * \tparam EventTypeNum The number of event types of the transition table.
+ * \tparam Initial      The state that the instances will begin with.
+ * \tparam States       All the states, the ids are in this order.
+ */
+template <uint32_t EventTypeNum, typename Initial, typename... States>
+using machine = detail::machine<
+    EventTypeNum,
+    Initial,
+    list<States...>,
+    typename detail::concat<
+        typename detail::edges<States,
+                               typename States::transitions>::type...>::type>;
+
+/**
+ * \brief An instance of a machine with its history slots.
+ */
+template <typename Machine>
+class instance
+{
+public:
+	instance()
+	{
+		(void)hsm_inst_init(&itsInst, &Machine::def, itsHistory);
+	}
+
+	int reset()
+	{
+		return hsm_inst_reset(&itsInst);
+	}
+
+	int dispatch(const hsm_event_t* const event)
+	{
+		return hsm_inst_dispatch(&itsInst, event);
+	}
+
+	const state_t* getState() const
+	{
+		return hsm_inst_getState(&itsInst);
+	}
+
+protected:
+	hsm_inst_t     itsInst; /**< The instance. */
+	hsm_state_id_t itsHistory[Machine::historyNum + 1U]; /**< Slots. */
+};
+
+/**
+ * \brief An instance of a machine dispatched by code generated for it.
+ *
+ * Behaves as \see instance, but the actions, guards and paths are compiled
+ * into the dispatch instead of read from the definition's tables.
+ */
+template <typename Machine>
+class engine : public instance<Machine>
+{
+public:
+	int dispatch(const hsm_event_t* const event)
+	{
+		return detail::dispatcher<Machine>::dispatch(&this->itsInst,
+		                                             event);
+	}
+};
+
+} // namespace hsm
+
+#endif /* HSM_HPP_ONLY_ONE_INCLUDE_SAFETY */
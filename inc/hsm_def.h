@@ -0,0 +1,235 @@
+// ############################################################################
+// ############################################################################
+// About
+
+/**
+ * \file     hsm_def.h
+ *
+ * \brief    Shared hierarchical state machine definitions and instances.
+ *
+ * A definition is built once from the states and is read only afterwards.
+ * Any number of instances run on the same definition. An instance holds only
+ * its current state, mode and history slots.
+ *
+ * Created:  18/10/2026
+ */
+
+/**
+ * \defgroup Ungrouped    Ungrouped
+ *
+ * \code
+ * #include "hsm_def.h"
+ * \endcode
+ */
+
+// ############################################################################
+// ############################################################################
+// Code
+
+#ifndef HSM_DEF_H_ONLY_ONE_INCLUDE_SAFETY
+#define HSM_DEF_H_ONLY_ONE_INCLUDE_SAFETY
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// ############################################################################
+// ############################################################################
+// Dependencies
+
+#include "hsm.h"
+#include "hsm_trace.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ############################################################################
+// ############################################################################
+// Configuration
+
+#ifndef HSM_STATE_ID_BITS
+/**
+ * \brief The size of a state id in bits, 8 or 16.
+ *
+ * With 8 a definition has up to 254 states and an instance's current state
+ * and mode take two bytes.
+ */
+#	define HSM_STATE_ID_BITS (16)
+#endif
+
+#if (HSM_STATE_ID_BITS != 8) && (HSM_STATE_ID_BITS != 16)
+#	error "HSM_STATE_ID_BITS must be 8 or 16"
+#endif
+
+// ############################################################################
+// ############################################################################
+// Types
+
+#if HSM_STATE_ID_BITS == 8
+/**
+ * \brief HSM state index in a definition.
+ */
+typedef uint8_t hsm_state_id_t;
+
+/**
+ * \brief No state.
+ */
+#	define HSM_STATE_ID_NONE ((hsm_state_id_t)0xFFU)
+#else
+/**
+ * \brief HSM state index in a definition.
+ */
+typedef uint16_t hsm_state_id_t;
+
+/**
+ * \brief No state.
+ */
+#	define HSM_STATE_ID_NONE ((hsm_state_id_t)0xFFFFU)
+#endif
+
+/**
+ * \brief The state has an on entry action, see itsActions of hsm_def_t.
+ */
+#define HSM_DEF_ACTION_ENTRY (0x01U)
+
+/**
+ * \brief The state has a during action, see itsActions of hsm_def_t.
+ */
+#define HSM_DEF_ACTION_DURING (0x02U)
+
+/**
+ * \brief The state has an on exit action, see itsActions of hsm_def_t.
+ */
+#define HSM_DEF_ACTION_EXIT (0x04U)
+
+/**
+ * \brief The state has a deep history, see itsActions of hsm_def_t. Its
+ * history slot keeps the leaf it was left in, not a child.
+ */
+#define HSM_DEF_HISTORY_DEEP (0x08U)
+
+/**
+ * \brief HSM definition transition.
+ */
+typedef struct
+{
+	const hsm_transition_t* itsTransition; /**< The user's transition. */
+	hsm_state_id_t          itsSource;     /**< The source state. */
+	hsm_state_id_t          itsTarget;     /**< Target, NONE: internal. */
+	hsm_state_id_t          itsLca;        /**< Least common ancestor. */
+	uint16_t                itsLcaLevel;   /**< Path size of the LCA. */
+	uint16_t                itsEntryNum;   /**< The states to enter. */
+	uint32_t                itsEntryFirst; /**< First in itsEntries. */
+} hsm_def_transition_t;
+
+/**
+ * \brief HSM definition.
+ *
+ * It is read only after \see hsm_def_build and \see hsm_def_compile. The
+ * tables are const so a definition can also be generated at compile time,
+ * without memory of its own.
+ *
+ * Everything a dispatch reads is packed in the tables, by state id. The
+ * user's states are only read to call their actions, so states without
+ * actions are never touched. A candidate transition is read for its guard.
+ */
+typedef struct
+{
+	const state_t* const*       itsStates;      /**< The states, by id. */
+	const hsm_state_id_t*       itsParent;      /**< Parent of each. */
+	const hsm_state_id_t*       itsInitial;     /**< Initial of each. */
+	const hsm_state_id_t*       itsHistorySlot; /**< History of each. */
+	const uint8_t*              itsActions;     /**< Actions of each. */
+	const uint32_t*             itsTransitionFirst; /**< First one. */
+	const hsm_def_transition_t* itsTransitions; /**< All transitions. */
+	uint32_t                    itsStateNum;    /**< Number of states. */
+	uint32_t                    itsTransitionNum; /**< Transitions. */
+	uint32_t                    itsHistoryNum;  /**< Histories. */
+	hsm_state_id_t              itsInitialState; /**< First to enter. */
+	void*                       itsMemory;      /**< The tables' memory. */
+
+	/* Paths, precomputed by hsm_def_build */
+	const uint32_t*       itsPathFirst;  /**< First in itsPaths of each. */
+	const hsm_state_id_t* itsPaths;      /**< Each state up to the top. */
+	const hsm_state_id_t* itsEntries;    /**< To enter per transition. */
+	void*                 itsPathMemory; /**< The paths' memory. */
+
+	/* Transition table, see hsm_def_compile */
+	const uint32_t* itsTable;        /**< First candidate of a cell. */
+	const uint32_t* itsCandidates;   /**< The candidate transitions. */
+	const uint32_t* itsActive;       /**< If a cell runs anything. */
+	uint32_t        itsEventTypeNum; /**< The number of event types. */
+	void*           itsTableMemory;  /**< The transition table's memory. */
+} hsm_def_t;
+
+/**
+ * \brief HSM instance.
+ */
+typedef struct
+{
+	const hsm_def_t* itsDef;          /**< The shared definition. */
+	hsm_state_id_t*  itsHistory;      /**< The history slots. */
+	hsm_state_id_t   itsCurrentState; /**< The current leaf state. */
+	uint8_t          itsMode;         /**< The leaf's hsm_st_mode_t. */
+#if HSM_TRACE
+	const void* itsTraceId; /**< The machine of its trace records. */
+#endif
+} hsm_inst_t;
+
+// ############################################################################
+// ############################################################################
+// Function declarations
+
+// cppcheck-suppress misra-c2012-2.5
+/**
+ * \brief Builds a shared hierarchical state machine definition.
+ *
+ * For valid definition initial state must be a top level state. (no parent)
+ *
+ * \param[out] me           The definition.
+ * \param[in]  initialState The state that the instances will begin with.
+ * \param[in]  allStates    A list with all the hsm's states.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+#define hsm_def_build(me, initialState, allStates) \
+	_hsm_def_build((me),                       \
+	               (initialState),             \
+	               (allStates),                \
+	               (sizeof(allStates) / sizeof(allStates[0])))
+
+/*
+ * Definition
+ */
+int _hsm_def_build(hsm_def_t* const     me,
+                   const state_t* const initialState,
+                   const state_t* const allStates[],
+                   const uint32_t       allStatesSize);
+
+int hsm_def_compile(hsm_def_t* const me, const uint32_t eventTypeNum);
+
+void hsm_def_destroy(hsm_def_t* const me);
+
+hsm_state_id_t hsm_def_getId(const hsm_def_t* const me,
+                             const state_t* const   state);
+
+/*
+ * Instance
+ */
+int hsm_inst_init(hsm_inst_t* const      me,
+                  const hsm_def_t* const def,
+                  hsm_state_id_t* const  history);
+
+int hsm_inst_reset(hsm_inst_t* const me);
+
+int hsm_inst_dispatch(hsm_inst_t* const me, const hsm_event_t* const event);
+
+const state_t* hsm_inst_getState(const hsm_inst_t* const me);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HSM_DEF_H_ONLY_ONE_INCLUDE_SAFETY */
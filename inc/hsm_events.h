@@ -0,0 +1,123 @@
+// ############################################################################
+// ############################################################################
+// About
+
+/**
+ * \file     hsm_events.h
+ *
+ * \brief    Event queue of a machine, with priorities and deferral.
+ *
+ * The events wait in a pool that is allocated up front, one list per
+ * priority. \see hsm_events_run dispatches the most urgent first.
+ *
+ * A state that can not handle an event yet defers it from its actions with
+ * \see hsm_events_defer. The deferred events are recalled after the next
+ * transition, before the other events of their priority.
+ *
+ * A queue belongs to the thread that runs its machine, use hsm_queue.h to
+ * post from other threads.
+ *
+ * Created:  18/10/2026
+ */
+
+/**
+ * \defgroup Ungrouped    Ungrouped
+ *
+ * \code
+ * #include "hsm_events.h"
+ * \endcode
+ */
+
+// ############################################################################
+// ############################################################################
+// Code
+
+#ifndef HSM_EVENTS_H_ONLY_ONE_INCLUDE_SAFETY
+#define HSM_EVENTS_H_ONLY_ONE_INCLUDE_SAFETY
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// ############################################################################
+// ############################################################################
+// Dependencies
+
+#include "hsm.h"
+
+#include <stdint.h>
+
+// ############################################################################
+// ############################################################################
+// Configuration
+
+#ifndef HSM_PRIORITY_NUM
+/**
+ * \brief The number of priorities, 0 is the most urgent.
+ */
+#	define HSM_PRIORITY_NUM (4U)
+#endif
+
+// ############################################################################
+// ############################################################################
+// Types
+
+/**
+ * \brief HSM queued event.
+ */
+typedef struct
+{
+	hsm_event_t itsEvent;    /**< The event. */
+	uint32_t    itsNext;     /**< Next in its list. */
+	uint32_t    itsPriority; /**< Its priority. */
+} hsm_events_node_t;
+
+/**
+ * \brief HSM event queue.
+ */
+typedef struct
+{
+	/* Initialize and do not change again */
+	hsm_t*             itsMachine;  /**< The machine to dispatch to. */
+	hsm_events_node_t* itsNodes;    /**< The pool. */
+	uint32_t           itsCapacity; /**< The size of the pool. */
+
+	/* Private data, do not touch */
+	uint32_t itsFree;                    /**< First free node. */
+	uint32_t itsFirst[HSM_PRIORITY_NUM]; /**< First of each priority. */
+	uint32_t itsLast[HSM_PRIORITY_NUM];  /**< Last of each priority. */
+	uint32_t itsDeferredFirst; /**< First deferred event. */
+	uint32_t itsDeferredLast;  /**< Last deferred event. */
+	uint32_t itsNum;           /**< The events waiting, not deferred. */
+	uint32_t itsDeferredNum;   /**< The deferred events. */
+} hsm_events_t;
+
+// ############################################################################
+// ############################################################################
+// Function declarations
+
+int hsm_events_init(hsm_events_t* const      me,
+                    hsm_t* const             machine,
+                    hsm_events_node_t* const nodes,
+                    const uint32_t           capacity);
+
+int hsm_events_push(hsm_events_t* const      me,
+                    const hsm_event_t* const event,
+                    const uint32_t           priority);
+
+int hsm_events_defer(hsm_events_t* const      me,
+                     const hsm_event_t* const event,
+                     const uint32_t           priority);
+
+uint32_t hsm_events_recall(hsm_events_t* const me);
+
+int hsm_events_pop(hsm_events_t* const me, hsm_event_t* const event);
+
+int hsm_events_run(hsm_events_t* const me);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HSM_EVENTS_H_ONLY_ONE_INCLUDE_SAFETY */
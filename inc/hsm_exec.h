@@ -0,0 +1,142 @@
+// ############################################################################
+// ############################################################################
+// About
+
+/**
+ * \file     hsm_exec.h
+ *
+ * \brief    Multi-core active object executor.
+ *
+ * An actor is a machine with its own event queue, either an hsm_t or an
+ * instance of a shared definition. Every actor has an affinity to one worker
+ * thread. An actor with posted events is queued as ready on its worker, and
+ * idle workers steal ready actors from the others.
+ * An actor is held by at most one worker at a time, so its dispatch stays
+ * single-threaded.
+ *
+ * Created:  18/10/2026
+ */
+
+/**
+ * \defgroup Ungrouped    Ungrouped
+ *
+ * \code
+ * #include "hsm_exec.h"
+ * \endcode
+ */
+
+// ############################################################################
+// ############################################################################
+// Code
+
+#ifndef HSM_EXEC_H_ONLY_ONE_INCLUDE_SAFETY
+#define HSM_EXEC_H_ONLY_ONE_INCLUDE_SAFETY
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// ############################################################################
+// ############################################################################
+// Dependencies
+
+#include "hsm.h"
+#include "hsm_def.h"
+#include "hsm_queue.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// ############################################################################
+// ############################################################################
+// Types
+
+typedef struct hsm_exec  hsm_exec_t;
+typedef struct hsm_actor hsm_actor_t;
+
+/**
+ * \brief HSM actor.
+ */
+struct hsm_actor
+{
+	/* Initialize and do not change again */
+	hsm_exec_t* itsExec;   /**< The executor. */
+	uint32_t    itsWorker; /**< The worker it has affinity to. */
+
+	/* Private data, do not touch */
+	hsm_queue_t  itsQueue;     /**< The posted events. */
+	uint32_t     itsScheduled; /**< Ready or running on a worker. */
+	hsm_actor_t* itsNext;      /**< Next in the ready list. */
+};
+
+/**
+ * \brief HSM worker.
+ */
+typedef struct
+{
+	/* Private data, do not touch */
+	hsm_exec_t*     itsExec;     /**< The executor. */
+	uint32_t        itsIndex;    /**< Its index in the executor. */
+	pthread_t       itsThread;   /**< The thread. */
+	pthread_mutex_t itsLock;     /**< Protects the ready list. */
+	hsm_actor_t*    itsFirst;    /**< First ready actor. */
+	hsm_actor_t*    itsLast;     /**< Last ready actor. */
+	uint64_t        itsRunNum;   /**< The actors it ran. */
+	uint64_t        itsStealNum; /**< Of them, the ones of others. */
+} hsm_worker_t;
+
+/**
+ * \brief HSM executor.
+ */
+struct hsm_exec
+{
+	/* Initialize and do not change again */
+	hsm_worker_t* itsWorkers;   /**< The workers. */
+	uint32_t      itsWorkerNum; /**< The number of workers. */
+
+	/* Private data, do not touch */
+	pthread_mutex_t itsIdleLock; /**< Protects sleeping. */
+	pthread_cond_t  itsIdleCond; /**< Wakes sleeping workers. */
+	uint32_t        itsReadyNum; /**< Actors in all the ready lists. */
+	uint32_t        itsIdleNum;  /**< Sleeping workers. */
+	uint32_t        itsStartNum; /**< Workers started. */
+	bool            itsStopping; /**< Exit when nothing is ready. */
+};
+
+// ############################################################################
+// ############################################################################
+// Function declarations
+
+int hsm_exec_init(hsm_exec_t* const   me,
+                  hsm_worker_t* const workers,
+                  const uint32_t      workerNum);
+
+void hsm_exec_destroy(hsm_exec_t* const me);
+
+int hsm_exec_start(hsm_exec_t* const me);
+
+int hsm_exec_stop(hsm_exec_t* const me);
+
+int hsm_actor_init(hsm_actor_t* const      me,
+                   hsm_exec_t* const       exec,
+                   const uint32_t          worker,
+                   hsm_inst_t* const       machine,
+                   hsm_queue_slot_t* const slots,
+                   const uint32_t          capacity);
+
+int hsm_actor_initMachine(hsm_actor_t* const      me,
+                          hsm_exec_t* const       exec,
+                          const uint32_t          worker,
+                          hsm_t* const            machine,
+                          hsm_queue_slot_t* const slots,
+                          const uint32_t          capacity);
+
+int hsm_actor_post(hsm_actor_t* const me, const hsm_event_t* const event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HSM_EXEC_H_ONLY_ONE_INCLUDE_SAFETY */
@@ -0,0 +1,95 @@
+// ############################################################################
+// ############################################################################
+// About
+
+/**
+ * \file     hsm_fleet.h
+ *
+ * \brief    Many instances of a shared definition, stored as arrays.
+ *
+ * The current states and modes of all the instances are kept in separate
+ * arrays so an event can be broadcast to all of them with one table lookup
+ * per instance. Only the instances that the event does something to are
+ * dispatched.
+ *
+ * Created:  18/10/2026
+ */
+
+/**
+ * \defgroup Ungrouped    Ungrouped
+ *
+ * \code
+ * #include "hsm_fleet.h"
+ * \endcode
+ */
+
+// ############################################################################
+// ############################################################################
+// Code
+
+#ifndef HSM_FLEET_H_ONLY_ONE_INCLUDE_SAFETY
+#define HSM_FLEET_H_ONLY_ONE_INCLUDE_SAFETY
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// ############################################################################
+// ############################################################################
+// Dependencies
+
+#include "hsm.h"
+#include "hsm_def.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ############################################################################
+// ############################################################################
+// Types
+
+/**
+ * \brief HSM fleet.
+ */
+typedef struct
+{
+	/* Initialize and do not change again */
+	const hsm_def_t* itsDef;     /**< The shared definition. */
+	uint32_t         itsInstNum; /**< The number of instances. */
+
+	/* Private data, do not touch */
+	hsm_state_id_t* itsCurrentStates; /**< Current leaf of each. */
+	uint8_t*        itsModes;         /**< hsm_st_mode_t of each. */
+	hsm_state_id_t* itsHistories;     /**< History slots of each. */
+	uint8_t*        itsActive;        /**< Instances to dispatch to. */
+	void*           itsMemory;        /**< The arrays' memory. */
+} hsm_fleet_t;
+
+// ############################################################################
+// ############################################################################
+// Function declarations
+
+int hsm_fleet_init(hsm_fleet_t* const     me,
+                   const hsm_def_t* const def,
+                   const uint32_t         instNum);
+
+void hsm_fleet_destroy(hsm_fleet_t* const me);
+
+int hsm_fleet_reset(hsm_fleet_t* const me);
+
+int hsm_fleet_dispatch(hsm_fleet_t* const       me,
+                       const uint32_t           index,
+                       const hsm_event_t* const event);
+
+int hsm_fleet_broadcast(hsm_fleet_t* const       me,
+                        const hsm_event_t* const event);
+
+const state_t* hsm_fleet_getState(const hsm_fleet_t* const me,
+                                  const uint32_t           index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HSM_FLEET_H_ONLY_ONE_INCLUDE_SAFETY */
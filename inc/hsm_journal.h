@@ -0,0 +1,153 @@
+// ############################################################################
+// ############################################################################
+// About
+
+/**
+ * \file     hsm_journal.h
+ *
+ * \brief    Journal of the events a machine handled, and its replay.
+ *
+ * A machine with a journal attached appends a record for every event it
+ * handles: the event's type and inline payload, the path it came through,
+ * if it failed and the state it left the machine in. The records are
+ * collected in the caller's buffer and written to the file a whole buffer
+ * at a time.
+ *
+ * \see hsm_journal_replay drives a machine with the events again, batched
+ * through \see hsm_handleEvents, and checks it ends up in the recorded
+ * states, failing where it failed. Restore the machine first from a
+ * snapshot taken when the journal was opened, \see hsm_restore.
+ *
+ * Only the inline payload is recorded, the replayed events' data is NULL.
+ * The file holds a header and the records as they are, in the byte order
+ * of the machine that wrote it.
+ *
+ * Created:  18/10/2026
+ */
+
+/**
+ * \defgroup Ungrouped    Ungrouped
+ *
+ * \code
+ * #include "hsm_journal.h"
+ * \endcode
+ */
+
+// ############################################################################
+// ############################################################################
+// Code
+
+#ifndef HSM_JOURNAL_H_ONLY_ONE_INCLUDE_SAFETY
+#define HSM_JOURNAL_H_ONLY_ONE_INCLUDE_SAFETY
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// ############################################################################
+// ############################################################################
+// Dependencies
+
+#include "hsm.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ############################################################################
+// ############################################################################
+// Types
+
+/**
+ * \brief The version of the file.
+ */
+#define HSM_JOURNAL_VERSION (1U)
+
+/**
+ * \brief No state, in a journal record.
+ */
+#define HSM_JOURNAL_STATE_NONE (0xFFFFU)
+
+/**
+ * \brief Journal record flags.
+ */
+typedef enum
+{
+	HSM_JOURNAL_F_DISPATCH = 1u, /**< By hsm_dispatch, else a step. */
+	HSM_JOURNAL_F_NO_EVENT = 2u, /**< Without an event signal. */
+	HSM_JOURNAL_F_FAILED   = 4u  /**< The machine failed to handle it. */
+} hsm_journal_flag_t;
+
+/**
+ * \brief HSM journal record.
+ *
+ * The states are indexes in allStates of hsm_t.
+ */
+typedef struct
+{
+	uint32_t itsEventType; /**< The event's type. */
+	uint16_t itsFrom;      /**< The state it left. */
+	uint16_t itsTo;        /**< The state it is in now. */
+	uint8_t  itsFromMode;  /**< The hsm_st_mode_t it left in. */
+	uint8_t  itsToMode;    /**< The hsm_st_mode_t it is in now. */
+	uint8_t  itsFlags;     /**< The hsm_journal_flag_t set. */
+	uint8_t  itsPad;       /**< Zero. */
+#if HSM_EVENT_INLINE_SIZE > 0
+	uint8_t itsInline[HSM_EVENT_INLINE_SIZE]; /**< Inline payload. */
+#endif
+} hsm_journal_record_t;
+
+/**
+ * \brief HSM journal.
+ */
+typedef struct hsm_journal
+{
+	/* Initialize and do not change again */
+	uint8_t* itsBuffer;   /**< Where the records are collected. */
+	size_t   itsCapacity; /**< The size of itsBuffer. */
+
+	/* Private data, do not touch */
+	size_t   itsLength;    /**< The bytes in itsBuffer. */
+	uint64_t itsRecordNum; /**< The records appended. */
+	int      itsFile;      /**< The file descriptor, -1 if closed. */
+	int      itsError;     /**< If a write failed, 0 or -1. */
+} hsm_journal_t;
+
+// ############################################################################
+// ############################################################################
+// Function declarations
+
+int hsm_journal_open(hsm_journal_t* const me,
+                     const char* const    path,
+                     uint8_t* const       buffer,
+                     const size_t         capacity);
+
+int hsm_journal_close(hsm_journal_t* const me);
+
+int hsm_journal_flush(hsm_journal_t* const me);
+
+void hsm_journal_attach(hsm_t* const machine, hsm_journal_t* const me);
+
+uint64_t hsm_journal_getRecordNum(const hsm_journal_t* const me);
+
+int hsm_journal_replay(hsm_t* const                machine,
+                       const char* const           path,
+                       hsm_journal_record_t* const records,
+                       const size_t                recordNum,
+                       uint64_t* const             recordDoneNum);
+
+/*
+ * Called by the machines
+ */
+void hsm_journal_write(hsm_journal_t* const     me,
+                       const hsm_t* const       machine,
+                       const hsm_event_t* const event,
+                       const state_t* const     fromState,
+                       const hsm_st_mode_t      fromStateMode,
+                       const uint8_t            flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HSM_JOURNAL_H_ONLY_ONE_INCLUDE_SAFETY */
@@ -0,0 +1,122 @@
+// ############################################################################
+// ############################################################################
+// About
+
+/**
+ * \file     hsm_pool.h
+ *
+ * \brief    Fixed-size block pool for the event payloads.
+ *
+ * The producer takes a payload with \see hsm_pool_alloc and sets it as the
+ * event's data. Each consumer that keeps it calls \see hsm_pool_retain, and
+ * \see hsm_pool_release once done. The block goes back to the pool with the
+ * last release, from any thread.
+ *
+ * The free blocks are in a lock-free list. A thread that attaches a cache
+ * with \see hsm_pool_attach takes and gives back blocks in batches, most
+ * calls do not touch the shared list.
+ *
+ * Created:  18/10/2026
+ */
+
+/**
+ * \defgroup Ungrouped    Ungrouped
+ *
+ * \code
+ * #include "hsm_pool.h"
+ * \endcode
+ */
+
+// ############################################################################
+// ############################################################################
+// Code
+
+#ifndef HSM_POOL_H_ONLY_ONE_INCLUDE_SAFETY
+#define HSM_POOL_H_ONLY_ONE_INCLUDE_SAFETY
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// ############################################################################
+// ############################################################################
+// Dependencies
+
+#include <stdint.h>
+
+// ############################################################################
+// ############################################################################
+// Configuration
+
+#ifndef HSM_CACHE_LINE_SIZE
+/**
+ * \brief The size of a cache line in bytes.
+ */
+#	define HSM_CACHE_LINE_SIZE (64U)
+#endif
+
+#ifndef HSM_POOL_CACHE_NUM
+/**
+ * \brief The number of blocks a thread cache holds, even.
+ */
+#	define HSM_POOL_CACHE_NUM (16U)
+#endif
+
+// ############################################################################
+// ############################################################################
+// Types
+
+/**
+ * \brief HSM payload pool.
+ */
+typedef struct
+{
+	/* Initialize and do not change again */
+	uint8_t* itsBlocks;    /**< The blocks, headers included. */
+	uint32_t itsBlockSize; /**< The size of a payload. */
+	uint32_t itsStride;    /**< The size of a block. */
+	uint32_t itsBlockNum;  /**< The number of blocks. */
+
+	/* Private data, do not touch */
+	uint8_t  itsPad0[HSM_CACHE_LINE_SIZE]; /**< Padding. */
+	uint64_t itsFree; /**< First free block, tagged against ABA. */
+	uint8_t  itsPad1[HSM_CACHE_LINE_SIZE]; /**< Padding. */
+} hsm_pool_t;
+
+/**
+ * \brief HSM thread cache of free blocks.
+ */
+typedef struct
+{
+	/* Private data, do not touch */
+	hsm_pool_t* itsPool; /**< The pool of the blocks. */
+	uint32_t    itsNum;  /**< The number of blocks. */
+	uint32_t    itsBlocks[HSM_POOL_CACHE_NUM]; /**< The blocks. */
+} hsm_pool_cache_t;
+
+// ############################################################################
+// ############################################################################
+// Function declarations
+
+int hsm_pool_init(hsm_pool_t* const me,
+                  const uint32_t    blockSize,
+                  const uint32_t    blockNum);
+
+void hsm_pool_destroy(hsm_pool_t* const me);
+
+void hsm_pool_attach(hsm_pool_cache_t* const cache, hsm_pool_t* const pool);
+
+void* hsm_pool_alloc(hsm_pool_t* const me);
+
+void hsm_pool_retain(void* const data);
+
+void hsm_pool_release(void* const data);
+
+uint32_t hsm_pool_getRefNum(const void* const data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HSM_POOL_H_ONLY_ONE_INCLUDE_SAFETY */
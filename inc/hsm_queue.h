@@ -0,0 +1,127 @@
+// ############################################################################
+// ############################################################################
+// About
+
+/**
+ * \file     hsm_queue.h
+ *
+ * \brief    Lock-free multi-producer single-consumer event queue.
+ *
+ * Any thread posts events to a machine with \see hsm_post. Only the thread
+ * that owns the machine calls \see hsm_run to dispatch them. The machine is
+ * an hsm_t, \see hsm_queue_initMachine, or an instance of a shared
+ * definition, \see hsm_queue_init.
+ *
+ * Created:  18/10/2026
+ */
+
+/**
+ * \defgroup Ungrouped    Ungrouped
+ *
+ * \code
+ * #include "hsm_queue.h"
+ * \endcode
+ */
+
+// ############################################################################
+// ############################################################################
+// Code
+
+#ifndef HSM_QUEUE_H_ONLY_ONE_INCLUDE_SAFETY
+#define HSM_QUEUE_H_ONLY_ONE_INCLUDE_SAFETY
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// ############################################################################
+// ############################################################################
+// Dependencies
+
+#include "hsm.h"
+#include "hsm_def.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ############################################################################
+// ############################################################################
+// Configuration
+
+#ifndef HSM_CACHE_LINE_SIZE
+/**
+ * \brief The size of a cache line in bytes.
+ */
+#	define HSM_CACHE_LINE_SIZE (64U)
+#endif
+
+// ############################################################################
+// ############################################################################
+// Types
+
+/**
+ * \brief Dispatches an event to the machine of a queue.
+ *
+ * \param[in,out] machine The machine.
+ * \param[in]     event   The event signal.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+typedef int (*hsm_queue_dispatch_t)(void* const              machine,
+                                    const hsm_event_t* const event);
+
+/**
+ * \brief HSM queue slot.
+ */
+typedef struct
+{
+	uint32_t    itsSequence; /**< Claimed index plus one once published. */
+	hsm_event_t itsEvent;    /**< The event. */
+} hsm_queue_slot_t;
+
+/**
+ * \brief HSM queue.
+ *
+ * The producers' and the consumer's counters are in different cache lines.
+ */
+typedef struct
+{
+	/* Initialize and do not change again */
+	void*                itsMachine;  /**< The machine to dispatch to. */
+	hsm_queue_dispatch_t itsDispatch; /**< How to dispatch to it. */
+	hsm_queue_slot_t*    itsSlots;    /**< The ring buffer. */
+	uint32_t             itsMask;     /**< The capacity minus one. */
+
+	/* Private data, do not touch */
+	uint8_t  itsPad0[HSM_CACHE_LINE_SIZE]; /**< Padding. */
+	uint32_t itsCount; /**< Events posted and not yet dispatched. */
+	uint32_t itsTail;  /**< Next index to claim by the producers. */
+	uint8_t  itsPad1[HSM_CACHE_LINE_SIZE]; /**< Padding. */
+	uint32_t itsHead;  /**< Next index to dispatch by the consumer. */
+} hsm_queue_t;
+
+// ############################################################################
+// ############################################################################
+// Function declarations
+
+int hsm_queue_init(hsm_queue_t* const      me,
+                   hsm_inst_t* const       machine,
+                   hsm_queue_slot_t* const slots,
+                   const uint32_t          capacity);
+
+int hsm_queue_initMachine(hsm_queue_t* const      me,
+                          hsm_t* const            machine,
+                          hsm_queue_slot_t* const slots,
+                          const uint32_t          capacity);
+
+int hsm_post(hsm_queue_t* const me, const hsm_event_t* const event);
+
+int hsm_run(hsm_queue_t* const me);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HSM_QUEUE_H_ONLY_ONE_INCLUDE_SAFETY */
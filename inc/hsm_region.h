@@ -0,0 +1,146 @@
+// ############################################################################
+// ############################################################################
+// About
+
+/**
+ * \file     hsm_region.h
+ *
+ * \brief    Orthogonal regions of a state.
+ *
+ * The regions of a state are machines that are all active while the state
+ * is. They are entered after the state and exited before it, and handle
+ * every event \see hsm_dispatch gives the state's machine, after the during
+ * actions and before its transitions. A region re-entered resumes through
+ * its history pseudostates.
+ *
+ * The state must be a leaf of its machine. A region can have regions of
+ * its own. The regions follow \see hsm_dispatch only, not the micro steps
+ * of \see hsm_handleEvent.
+ *
+ * With worker threads started, the regions marked thread safe handle an
+ * event on the workers in parallel, the others on the calling thread in
+ * turn. The call returns when all of them are done.
+ *
+ * The timer wheels and the journals are not locked, so the workers may not
+ * reach them. \see hsm_regions_start fails if the machine of a thread safe
+ * region, or of a region below it, has timers bound to its states or a
+ * journal attached, and none may be bound or attached while they run. The
+ * regions that need them run on the calling thread if not thread safe.
+ *
+ * Created:  18/10/2026
+ */
+
+/**
+ * \defgroup Ungrouped    Ungrouped
+ *
+ * \code
+ * #include "hsm_region.h"
+ * \endcode
+ */
+
+// ############################################################################
+// ############################################################################
+// Code
+
+#ifndef HSM_REGION_H_ONLY_ONE_INCLUDE_SAFETY
+#define HSM_REGION_H_ONLY_ONE_INCLUDE_SAFETY
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// ############################################################################
+// ############################################################################
+// Dependencies
+
+#include "hsm.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// ############################################################################
+// ############################################################################
+// Types
+
+/**
+ * \brief HSM region.
+ */
+typedef struct
+{
+	hsm_t* itsMachine;    /**< The region's machine. */
+	bool   itsThreadSafe; /**< If its actions may run on a worker. */
+} hsm_region_t;
+
+/**
+ * \brief HSM regions.
+ */
+typedef struct hsm_regions hsm_regions_t;
+
+struct hsm_regions
+{
+	/* Initialize and do not change again */
+	hsm_t*         itsMachine;   /**< The machine of the state. */
+	const state_t* itsState;     /**< The state the regions belong to. */
+	hsm_region_t*  itsRegions;   /**< The regions. */
+	uint32_t       itsRegionNum; /**< The number of regions. */
+
+	/* Private data, do not touch */
+	hsm_regions_t*     itsNext;       /**< Next of the machine. */
+	bool               itsActive;     /**< If the state is active. */
+	uint32_t           itsSafeNum;    /**< The thread safe regions. */
+	pthread_t*         itsThreads;    /**< The workers, NULL if none. */
+	uint32_t           itsThreadNum;  /**< The number of workers. */
+	pthread_mutex_t    itsLock;       /**< Protects the rest. */
+	pthread_cond_t     itsStartCond;  /**< Wakes the workers. */
+	pthread_cond_t     itsDoneCond;   /**< Wakes the dispatcher. */
+	const hsm_event_t* itsEvent;      /**< The event being handled. */
+	uint32_t           itsRound;      /**< The events handled. */
+	uint32_t           itsNextIndex;  /**< Next region to take. */
+	uint32_t           itsPendingNum; /**< Safe regions not done. */
+	int                itsError;      /**< If a region failed, 0 or -1. */
+	bool               itsStopping;   /**< The workers exit. */
+};
+
+// ############################################################################
+// ############################################################################
+// Function declarations
+
+int hsm_regions_init(hsm_regions_t* const me,
+                     hsm_t* const         machine,
+                     const state_t* const state,
+                     hsm_region_t* const  regions,
+                     const uint32_t       regionNum);
+
+void hsm_regions_destroy(hsm_regions_t* const me);
+
+int hsm_regions_start(hsm_regions_t* const me,
+                      pthread_t* const     threads,
+                      const uint32_t       threadNum);
+
+int hsm_regions_stop(hsm_regions_t* const me);
+
+bool hsm_regions_isActive(const hsm_regions_t* const me);
+
+/*
+ * Called by the machines
+ */
+int hsm_region_enter(const hsm_t* const       machine,
+                     const state_t* const     state,
+                     const hsm_event_t* const event);
+
+int hsm_region_exit(const hsm_t* const       machine,
+                    const state_t* const     state,
+                    const hsm_event_t* const event);
+
+int hsm_region_dispatch(const hsm_t* const       machine,
+                        const hsm_event_t* const event);
+
+void hsm_region_reset(const hsm_t* const machine);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HSM_REGION_H_ONLY_ONE_INCLUDE_SAFETY */
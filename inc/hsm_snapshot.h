@@ -0,0 +1,90 @@
+// ############################################################################
+// ############################################################################
+// About
+
+/**
+ * \file     hsm_snapshot.h
+ *
+ * \brief    Checkpoints of a machine in a compact binary blob.
+ *
+ * A snapshot holds the current state, and the mode and history of every
+ * state, as indexes in the machine's state list. It does not depend on where
+ * the states are, so another process with the same state list restores it.
+ *
+ * The blob is little endian:
+ * - "HSMS", version (uint16), reserved (uint16), state number (uint32) and
+ *   current state (uint16).
+ * - For each state its mode (uint8) and history state (uint16), a child or
+ *   the leaf of a deep history.
+ * - The snapshot of each region machine, in the order of the machine's list
+ *   of regions, \see hsm_regions_init.
+ * - An FNV-1a checksum (uint32) of all the above.
+ *
+ * A state without history is HSM_SNAPSHOT_STATE_NONE. The regions of the
+ * restored leaf are active if it was entered.
+ *
+ * Created:  18/10/2026
+ */
+
+/**
+ * \defgroup Ungrouped    Ungrouped
+ *
+ * \code
+ * #include "hsm_snapshot.h"
+ * \endcode
+ */
+
+// ############################################################################
+// ############################################################################
+// Code
+
+#ifndef HSM_SNAPSHOT_H_ONLY_ONE_INCLUDE_SAFETY
+#define HSM_SNAPSHOT_H_ONLY_ONE_INCLUDE_SAFETY
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// ############################################################################
+// ############################################################################
+// Dependencies
+
+#include "hsm.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ############################################################################
+// ############################################################################
+// Types
+
+/**
+ * \brief The version of the blob.
+ */
+#define HSM_SNAPSHOT_VERSION (1U)
+
+/**
+ * \brief No state.
+ */
+#define HSM_SNAPSHOT_STATE_NONE (0xFFFFU)
+
+// ############################################################################
+// ############################################################################
+// Function declarations
+
+size_t hsm_snapshot_getSize(const hsm_t* const me);
+
+int hsm_snapshot(const hsm_t* const me,
+                 uint8_t* const     blob,
+                 const size_t       size);
+
+int hsm_restore(hsm_t* const         me,
+                const uint8_t* const blob,
+                const size_t         size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HSM_SNAPSHOT_H_ONLY_ONE_INCLUDE_SAFETY */
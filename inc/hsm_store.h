@@ -0,0 +1,104 @@
+// ############################################################################
+// ############################################################################
+// About
+
+/**
+ * \file     hsm_store.h
+ *
+ * \brief    Instances of a definition kept in a memory-mapped file.
+ *
+ * Each instance is a fixed-size record addressed by its index: the current
+ * state, the mode and the history slots, as in \see hsm_inst_t. The
+ * instances are dispatched to in place, so a process that opens the file
+ * resumes at once. A record is checked once, when it is first touched.
+ *
+ * The file starts with a header that identifies the definition. It is in
+ * the byte order of the machine that created it.
+ *
+ * Created:  18/10/2026
+ */
+
+/**
+ * \defgroup Ungrouped    Ungrouped
+ *
+ * \code
+ * #include "hsm_store.h"
+ * \endcode
+ */
+
+// ############################################################################
+// ############################################################################
+// Code
+
+#ifndef HSM_STORE_H_ONLY_ONE_INCLUDE_SAFETY
+#define HSM_STORE_H_ONLY_ONE_INCLUDE_SAFETY
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// ############################################################################
+// ############################################################################
+// Dependencies
+
+#include "hsm.h"
+#include "hsm_def.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ############################################################################
+// ############################################################################
+// Types
+
+/**
+ * \brief The version of the file.
+ */
+#define HSM_STORE_VERSION (1U)
+
+/**
+ * \brief HSM instance store.
+ */
+typedef struct
+{
+	/* Initialize and do not change again */
+	const hsm_def_t* itsDef;       /**< The shared definition. */
+	uint32_t         itsRecordNum; /**< The number of instances. */
+
+	/* Private data, do not touch */
+	uint32_t        itsRecordSize; /**< The state ids in a record. */
+	hsm_state_id_t* itsRecords;    /**< The records, in the mapping. */
+	uint8_t*        itsChecked;    /**< Per record, if it was checked. */
+	void*           itsMemory;     /**< The mapping, NULL if closed. */
+	size_t          itsSize;       /**< The size of the mapping. */
+	int             itsFile;       /**< The file descriptor. */
+} hsm_store_t;
+
+// ############################################################################
+// ############################################################################
+// Function declarations
+
+int hsm_store_open(hsm_store_t* const     me,
+                   const hsm_def_t* const def,
+                   const char* const      path,
+                   const uint32_t         recordNum);
+
+void hsm_store_close(hsm_store_t* const me);
+
+int hsm_store_sync(const hsm_store_t* const me);
+
+int hsm_store_reset(hsm_store_t* const me, const uint32_t index);
+
+int hsm_store_dispatch(hsm_store_t* const       me,
+                       const uint32_t           index,
+                       const hsm_event_t* const event);
+
+const state_t* hsm_store_getState(const hsm_store_t* const me,
+                                  const uint32_t           index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HSM_STORE_H_ONLY_ONE_INCLUDE_SAFETY */
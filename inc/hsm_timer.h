@@ -0,0 +1,143 @@
+// ############################################################################
+// ############################################################################
+// About
+
+/**
+ * \file     hsm_timer.h
+ *
+ * \brief    Hierarchical timer wheel that delivers timeouts to machines.
+ *
+ * A timer belongs to a machine and sends it an event when it expires, the
+ * event's data is the timer. A timer bound to a state is armed when the
+ * machine enters the state and cancelled when it exits. Arming and
+ * cancelling take constant time, the timers are allocated by the caller.
+ *
+ * The wheel has HSM_TIMER_LEVEL_NUM levels of 2^HSM_TIMER_SLOT_BITS slots.
+ * Its time is counted in ticks, \see hsm_wheel_advance moves it forward.
+ *
+ * Created:  18/10/2026
+ */
+
+/**
+ * \defgroup Ungrouped    Ungrouped
+ *
+ * \code
+ * #include "hsm_timer.h"
+ * \endcode
+ */
+
+// ############################################################################
+// ############################################################################
+// Code
+
+#ifndef HSM_TIMER_H_ONLY_ONE_INCLUDE_SAFETY
+#define HSM_TIMER_H_ONLY_ONE_INCLUDE_SAFETY
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// ############################################################################
+// ############################################################################
+// Dependencies
+
+#include "hsm.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ############################################################################
+// ############################################################################
+// Configuration
+
+#ifndef HSM_TIMER_SLOT_BITS
+/**
+ * \brief The log2 of the number of slots of a level.
+ */
+#	define HSM_TIMER_SLOT_BITS (6U)
+#endif
+
+#ifndef HSM_TIMER_LEVEL_NUM
+/**
+ * \brief The number of levels, a level's slot spans the whole level below.
+ */
+#	define HSM_TIMER_LEVEL_NUM (4U)
+#endif
+
+// ############################################################################
+// ############################################################################
+// Types
+
+/**
+ * \brief HSM timer.
+ */
+typedef struct hsm_timer hsm_timer_t;
+
+/**
+ * \brief HSM timer wheel.
+ */
+typedef struct
+{
+	/* Private data, do not touch */
+	uint64_t     itsNow;      /**< The current tick. */
+	uint32_t     itsArmedNum; /**< The number of armed timers. */
+	hsm_timer_t* itsSlots[HSM_TIMER_LEVEL_NUM]
+	                     [1U << HSM_TIMER_SLOT_BITS]; /**< The slots. */
+} hsm_wheel_t;
+
+struct hsm_timer
+{
+	/* Initialize and do not change again */
+	hsm_wheel_t*   itsWheel;     /**< The wheel it is armed in. */
+	hsm_t*         itsMachine;   /**< The machine to notify. */
+	const state_t* itsState;     /**< The state it is bound to, or NULL. */
+	uint64_t       itsTimeout;   /**< Ticks armed on entry, 0 for none. */
+	uint32_t       itsEventType; /**< The event sent on expiry. */
+
+	/* Private data, do not touch */
+	hsm_timer_t*  itsNext;     /**< Next in its slot. */
+	hsm_timer_t** itsPrev;     /**< The link to it, NULL if not armed. */
+	uint64_t      itsDeadline; /**< The tick it expires at. */
+	hsm_timer_t*  itsBound;    /**< Next timer bound to its state. */
+};
+
+// ############################################################################
+// ############################################################################
+// Function declarations
+
+/*
+ * Wheel
+ */
+int hsm_wheel_init(hsm_wheel_t* const me, const uint64_t now);
+
+int hsm_wheel_advance(hsm_wheel_t* const me, const uint64_t now);
+
+/*
+ * Timers
+ */
+int hsm_timer_init(hsm_timer_t* const   me,
+                   hsm_wheel_t* const   wheel,
+                   hsm_t* const         machine,
+                   const state_t* const state,
+                   const uint32_t       eventType,
+                   const uint64_t       timeout);
+
+int hsm_timer_arm(hsm_timer_t* const me, const uint64_t ticks);
+
+void hsm_timer_cancel(hsm_timer_t* const me);
+
+bool hsm_timer_isArmed(const hsm_timer_t* const me);
+
+/*
+ * Called by the machines
+ */
+void hsm_timer_enter(const hsm_t* const me, const state_t* const state);
+
+void hsm_timer_exit(const hsm_t* const me, const state_t* const state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HSM_TIMER_H_ONLY_ONE_INCLUDE_SAFETY */
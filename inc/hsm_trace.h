@@ -0,0 +1,139 @@
+// ############################################################################
+// ############################################################################
+// About
+
+/**
+ * \file     hsm_trace.h
+ *
+ * \brief    Binary tracing of the state machines' transitions.
+ *
+ * Every thread that runs machines attaches its own ring buffer with
+ * \see hsm_trace_attach. The machines write fixed-size records to the ring
+ * of the calling thread, without locks, formatting or system calls. Any
+ * other thread collects them with \see hsm_trace_read, to store them for
+ * the hsmtrace decoder.
+ *
+ * The machines write records only when built with HSM_TRACE set to 1.
+ *
+ * Created:  18/10/2026
+ */
+
+/**
+ * \defgroup Ungrouped    Ungrouped
+ *
+ * \code
+ * #include "hsm_trace.h"
+ * \endcode
+ */
+
+// ############################################################################
+// ############################################################################
+// Code
+
+#ifndef HSM_TRACE_H_ONLY_ONE_INCLUDE_SAFETY
+#define HSM_TRACE_H_ONLY_ONE_INCLUDE_SAFETY
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// ############################################################################
+// ############################################################################
+// Dependencies
+
+#include <stdint.h>
+
+// ############################################################################
+// ############################################################################
+// Configuration
+
+#ifndef HSM_TRACE
+/**
+ * \brief If the machines write trace records, 0 or 1.
+ */
+#	define HSM_TRACE (0)
+#endif
+
+#ifndef HSM_CACHE_LINE_SIZE
+/**
+ * \brief The size of a cache line in bytes.
+ */
+#	define HSM_CACHE_LINE_SIZE (64U)
+#endif
+
+// ############################################################################
+// ############################################################################
+// Types
+
+/**
+ * \brief No state, in a trace record.
+ */
+#define HSM_TRACE_STATE_NONE (0xFFFFU)
+
+/**
+ * \brief HSM trace record.
+ *
+ * The states are ids in the definition, or indexes in allStates of hsm_t.
+ * The size and layout are fixed, the records are stored as they are.
+ */
+typedef struct
+{
+	uint64_t itsTime;      /**< Monotonic time in nanoseconds. */
+	uint64_t itsMachine;   /**< The machine's id, see hsm_trace_write. */
+	uint32_t itsEventType; /**< The event's type. */
+	uint16_t itsFrom;      /**< The state it left. */
+	uint16_t itsTo;        /**< The state it is in now. */
+	uint8_t  itsFromMode;  /**< The hsm_st_mode_t it left in. */
+	uint8_t  itsToMode;    /**< The hsm_st_mode_t it is in now. */
+	uint8_t  itsPad[6];    /**< Zero. */
+} hsm_trace_record_t;
+
+/**
+ * \brief HSM trace ring buffer.
+ *
+ * One thread writes and one reads. The writer's and the reader's counters
+ * are in different cache lines.
+ */
+typedef struct
+{
+	/* Initialize and do not change again */
+	hsm_trace_record_t* itsRecords; /**< The ring buffer. */
+	uint32_t            itsMask;    /**< The capacity minus one. */
+
+	/* Private data, do not touch */
+	uint8_t  itsPad0[HSM_CACHE_LINE_SIZE]; /**< Padding. */
+	uint32_t itsHead;    /**< Next index to write. */
+	uint32_t itsDropNum; /**< Records lost while full. */
+	uint8_t  itsPad1[HSM_CACHE_LINE_SIZE]; /**< Padding. */
+	uint32_t itsTail;    /**< Next index to read. */
+} hsm_trace_t;
+
+// ############################################################################
+// ############################################################################
+// Function declarations
+
+int hsm_trace_init(hsm_trace_t* const        me,
+                   hsm_trace_record_t* const records,
+                   const uint32_t            capacity);
+
+void hsm_trace_attach(hsm_trace_t* const me);
+
+void hsm_trace_write(const void* const machine,
+                     const uint32_t    eventType,
+                     const uint16_t    from,
+                     const uint16_t    to,
+                     const uint8_t     fromMode,
+                     const uint8_t     toMode);
+
+uint32_t hsm_trace_read(hsm_trace_t* const        me,
+                        hsm_trace_record_t* const records,
+                        const uint32_t            recordNum);
+
+uint32_t hsm_trace_getDropNum(const hsm_trace_t* const me);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HSM_TRACE_H_ONLY_ONE_INCLUDE_SAFETY */
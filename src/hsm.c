@@ -6,55 +6,118 @@
 // ############################################################################
 // Include files
 
+/* For clock_gettime */
+#define _GNU_SOURCE
+
 #include "hsm.h"
+#include "hsm_journal.h"
+#include "hsm_region.h"
+#include "hsm_timer.h"
+#include "hsm_trace.h"
 
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 // ############################################################################
 // ############################################################################
 // Local definitions
 
-#ifdef DEBUG
-#	include <stdio.h>
-
-// cppcheck-suppress misra-c2012-8.9
-static const char* hsm_state_modeName[] =
-    {"onEntry", "during ", "guard  ", "action ", "onExit ", "ERROR  "};
+/**
+ * \brief Where a micro step starts from, for its records.
+ */
+typedef struct
+{
+	const state_t* itsFromState;     /**< The state it left. */
+	hsm_st_mode_t  itsFromStateMode; /**< The mode it left in. */
+#if HSM_STATS
+	uint64_t itsStart; /**< When it started. */
 #endif
+} hsm_step_t;
 
-static void hsm_debug(const state_t* fromState,
-                      const state_t* toState,
-                      const char*    msg)
-{
-#ifdef DEBUG
-	const char* fromStateModeName = hsm_state_modeName[fromState->itsMode];
-	const char* toStateModeName   = hsm_state_modeName[toState->itsMode];
-
-	const char* fmt =
-	    // cppcheck-suppress misra-c2012-4.1
-	    "\x1b[32m%s\x1b[0m: "
-	    // cppcheck-suppress misra-c2012-4.1
-	    "\x1b[33m%s\x1b[0m.\x1b[33m%s\x1b[0m"
-	    // cppcheck-suppress misra-c2012-4.1
-	    " ---> \x1b[33m%s.\x1b[33m%s\x1b[0m\x1b[0m"
-	    // cppcheck-suppress misra-c2012-4.1
-	    "   \t[\x1b[34m%-40s\x1b[0m]\t";
-
-	(void)printf(fmt,
-	             fromStateModeName,
-	             fromState->itsName,
-	             fromStateModeName,
-	             toState->itsName,
-	             toStateModeName,
-	             msg);
+/**
+ * \brief Writes a trace record of a step or a transition.
+ *
+ * \param[in] me            The hierarchical state machine handle.
+ * \param[in] fromState     The state it left.
+ * \param[in] fromStateMode The mode it left in.
+ * \param[in] event         The event signal.
+ */
+static void hsm_trace(const hsm_t* const       me,
+                      const state_t* const     fromState,
+                      const hsm_st_mode_t      fromStateMode,
+                      const hsm_event_t* const event)
+{
+#if HSM_TRACE
+	const uint32_t from = hsm_getStateIndex(me, fromState);
+	const uint32_t to   = hsm_getStateIndex(me, me->itsCurrentState);
+
+	hsm_trace_write(me,
+	                (event != NULL) ? event->eventType : HSM_EVENT_ANY,
+	                (from < HSM_TRACE_STATE_NONE) ? (uint16_t)from
+	                                              : HSM_TRACE_STATE_NONE,
+	                (to < HSM_TRACE_STATE_NONE) ? (uint16_t)to
+	                                            : HSM_TRACE_STATE_NONE,
+	                (uint8_t)fromStateMode,
+	                (uint8_t)me->itsCurrentState->itsMode);
 #else
-	(void)msg;
+	(void)me;
 	(void)fromState;
-	(void)toState;
+	(void)fromStateMode;
+	(void)event;
 #endif
 }
 
+#if HSM_STATS
+/**
+ * \brief Reads the monotonic clock.
+ *
+ * \return The time in nanoseconds.
+ */
+static uint64_t stats_getNs(void)
+{
+	struct timespec now;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return ((uint64_t)now.tv_sec * 1000000000U) + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * \brief Counts an event handled by a state and the time it took.
+ *
+ * \param[in,out] me    The hierarchical state machine handle.
+ * \param[in]     state The state that handled it.
+ * \param[in]     event The event signal.
+ * \param[in]     start When the handling started.
+ */
+static void stats_addEvent(const hsm_t* const       me,
+                           const state_t* const     state,
+                           const hsm_event_t* const event,
+                           const uint64_t           start)
+{
+	if (me->itsStats != NULL)
+	{
+		const uint64_t ns     = stats_getNs() - start;
+		uint32_t       bucket = 0U;
+
+		while (((ns >> (bucket + 1U)) != 0U) &&
+		       (bucket < (HSM_STATS_BUCKET_NUM - 1U)))
+		{
+			bucket++;
+		}
+
+		me->itsStats->itsLatency[bucket]++;
+
+		if ((event != NULL) && (state->itsStats != NULL))
+		{
+			state->itsStats->itsEventNum++;
+		}
+	}
+}
+#endif
+
 // ############################################################################
 // ############################################################################
 // Local functions
@@ -73,6 +136,10 @@ static int  state_hasParent(const state_t* const state);
 
 static state_t* state_getTop(const state_t* const state);
 
+static void           state_setActive(const state_t* const state);
+static const state_t* state_getResume(const state_t* const state);
+static state_t*       state_getActiveLeaf(const state_t* const state);
+
 static bool state_exec_onEntry(const state_t* const     state,
                                const hsm_event_t* const event);
 static bool state_exec_during(const state_t* const     state,
@@ -80,6 +147,81 @@ static bool state_exec_during(const state_t* const     state,
 static bool state_exec_onExit(const state_t* const     state,
                               const hsm_event_t* const event);
 
+static state_t* state_getPrivate(const state_t* const state);
+static int      state_getPath(const state_t* const state,
+                              const state_t* const ancestor,
+                              const state_t*       path[]);
+static const state_t* state_getLca(const state_t* const source,
+                                   const state_t* const target);
+
+/*
+ * Transition related
+ */
+static bool transition_isTriggered(const hsm_transition_t* const transition,
+                                   const hsm_event_t* const      event);
+static bool transition_exec_guard(const hsm_transition_t* const transition,
+                                  const state_t* const          source,
+                                  const hsm_event_t* const      event);
+static void transition_exec_action(const hsm_transition_t* const transition,
+                                   const state_t* const          source,
+                                   const hsm_event_t* const      event);
+static const hsm_transition_t* transition_find(const state_t* const     state,
+                                               const hsm_event_t* const event);
+
+/*
+ * Transition table related
+ */
+static uint32_t table_fillCandidates(const state_t* const     state,
+                                     const uint32_t           eventType,
+                                     const hsm_transition_t** candidates,
+                                     const state_t**          sources);
+static const hsm_transition_t* table_find(const hsm_table_t* const table,
+                                          const state_t* const     state,
+                                          const hsm_event_t* const event,
+                                          const bool               inherited,
+                                          const state_t**          source);
+static int table_fillPath(const state_t* const          source,
+                          const hsm_transition_t* const transition,
+                          hsm_table_path_t* const       path,
+                          const state_t**               entries);
+static const hsm_table_path_t*
+table_getPath(const hsm_table_t* const      table,
+              const state_t* const          source,
+              const hsm_transition_t* const transition);
+
+/*
+ * Run to completion related
+ */
+static int hsm_rtc_start(hsm_t* const me, const hsm_event_t* const event);
+static int hsm_rtc_enter(hsm_t* const             me,
+                         const state_t* const     path[],
+                         const int                pathSize,
+                         const state_t* const     target,
+                         const hsm_event_t* const event);
+static int hsm_rtc_enterState(hsm_t* const             me,
+                              const state_t* const     state,
+                              const hsm_event_t* const event);
+static int hsm_rtc_exit(hsm_t* const             me,
+                        const state_t* const     lca,
+                        const hsm_event_t* const event);
+static int hsm_rtc_during(const hsm_t* const       me,
+                          const hsm_event_t* const event);
+static void hsm_rtc_findTransition(const hsm_t* const       me,
+                                   const hsm_event_t* const event,
+                                   const state_t**          source,
+                                   const hsm_transition_t** transition);
+
+/*
+ * Micro step related
+ */
+static int  hsm_step(hsm_t* const me, const hsm_event_t* const event);
+static bool hsm_step_isRecorded(const hsm_t* const me);
+static void hsm_step_begin(const hsm_t* const me, hsm_step_t* const step);
+static void hsm_step_end(const hsm_t* const       me,
+                         const hsm_step_t* const  step,
+                         const hsm_event_t* const event,
+                         const int                errorCode);
+
 /**
  * \brief Initializes the hierarchical state machine.
  *
@@ -116,11 +258,15 @@ static bool hsm_init(hsm_t* const         me,
 		me->itsCurrentState = initialState;
 		me->allStates       = allStates;
 		me->allStatesSize   = allStatesSize;
+		me->itsTransition   = NULL;
+		me->itsTakenNum     = 0U;
+		me->itsExitNum      = 0U;
 
 		/* Reset all states */
 		for (uint32_t i = 0U; i < me->allStatesSize; i++)
 		{
 			state_reset(me->allStates[i]);
+			me->allStates[i]->itsIndex = i;
 		}
 	}
 	else
@@ -132,6 +278,9 @@ static bool hsm_init(hsm_t* const         me,
 			me->itsCurrentState = NULL;
 			me->allStates       = NULL;
 			me->allStatesSize   = 0;
+			me->itsTransition   = NULL;
+			me->itsTakenNum     = 0U;
+			me->itsExitNum      = 0U;
 			success             = false;
 		}
 	}
@@ -149,6 +298,7 @@ static void state_reset(state_t* const state)
 	/* Reset state */
 	state->itsMode         = HSM_ST_M_ON_ENTRY;
 	state->itsHistoryState = state->itsInitialState;
+	state->itsActiveState  = NULL;
 }
 
 /**
@@ -172,7 +322,7 @@ static int state_hasChild(const state_t* const state)
 
 	if (returnCode == 0)
 	{
-		if (state->itsHistoryState == NULL)
+		if (state->itsInitialState == NULL)
 		{
 			/* No children */
 			returnCode = 0;
@@ -261,6 +411,67 @@ static state_t* state_getTop(const state_t* const state)
 	return topState;
 }
 
+/**
+ * \brief Marks an entered state as the active child of its parent.
+ *
+ * A shallow history pseudostate of the parent remembers it too.
+ *
+ * \param[in] state The hsm state.
+ */
+static void state_setActive(const state_t* const state)
+{
+	state_t* const parent = state_getPrivate(state->itsParentState);
+
+	if (parent != NULL)
+	{
+		parent->itsActiveState = state_getPrivate(state);
+
+		if (parent->itsHistory == HSM_HISTORY_SHALLOW)
+		{
+			parent->itsHistoryState = state_getPrivate(state);
+		}
+	}
+}
+
+/**
+ * \brief Gets what a state with children resumes when it is entered.
+ *
+ * \param[in] state The hsm state.
+ *
+ * \return Its initial state or the descendant its history remembers.
+ */
+static const state_t* state_getResume(const state_t* const state)
+{
+	const state_t* resume = state->itsHistoryState;
+
+	if (state->itsHistory == HSM_HISTORY_NONE)
+	{
+		resume = state->itsInitialState;
+	}
+
+	return resume;
+}
+
+/**
+ * \brief Gets the active leaf below an active state.
+ *
+ * \param[in] state The hsm state.
+ *
+ * \return The leaf, the state itself if it has no children.
+ */
+static state_t* state_getActiveLeaf(const state_t* const state)
+{
+	const state_t* leaf = state;
+
+	while ((leaf->itsInitialState != NULL) &&
+	       (leaf->itsActiveState != NULL))
+	{
+		leaf = leaf->itsActiveState;
+	}
+
+	return state_getPrivate(leaf);
+}
+
 /**
  * \brief Executes states on entry action.
  *
@@ -281,6 +492,13 @@ static bool state_exec_onEntry(const state_t* state, const hsm_event_t* event)
 		{
 			success = state->onEntry(state, event);
 		}
+
+#if HSM_STATS
+		if (success && (state->itsStats != NULL))
+		{
+			state->itsStats->itsEntryNum++;
+		}
+#endif
 	}
 
 	return success;
@@ -305,7 +523,19 @@ static bool state_exec_during(const state_t* const     state,
 	{
 		if (state->during != NULL)
 		{
+#if HSM_STATS
+			const uint64_t start = stats_getNs();
+#endif
+
 			success = state->during(state, event);
+
+#if HSM_STATS
+			if (state->itsStats != NULL)
+			{
+				state->itsStats->itsDuringNs +=
+				    stats_getNs() - start;
+			}
+#endif
 		}
 	}
 
@@ -333,419 +563,2095 @@ static bool state_exec_onExit(const state_t* const     state,
 		{
 			success = state->onExit(state, event);
 		}
+
+#if HSM_STATS
+		if (success && (state->itsStats != NULL))
+		{
+			state->itsStats->itsExitNum++;
+		}
+#endif
 	}
 
 	return success;
 }
 
-// ############################################################################
-// ############################################################################
-// Function definitions
-
 /**
- * \brief Creates the hierarchical state machine handle.
- *
- * For valid hsm machine initial state must be a top level state. (no parent)
+ * \brief Gets write access to the private data of a state.
  *
- * Use \see hsm_build instead.
+ * The topology of a state is constant but its mode and history are not.
  *
- * \param[in] initialState  The state that the HSM will begin with.
- * \param[in] allStates     A list with all the hsm's states.
- * \param[in] allStatesSize The number of the hsm's states.
+ * \param[in] state The hsm state.
  *
- * \return The hierarchical state machine handle.
+ * \return The same state.
  */
-hsm_t _hsm_build(const state_t* const initialState,
-                 const state_t* const allStates[],
-                 const uint32_t       allStatesSize)
+static state_t* state_getPrivate(const state_t* const state)
 {
-	/* Build it */
-	hsm_t aux;
-	/* TODO: Check return code. */
-	(void)hsm_init(&aux, initialState, allStates, allStatesSize);
-	return aux;
+	// cppcheck-suppress misra-c2012-11.8
+	return (state_t*)state;
 }
 
 /**
- * \brief Resets the hierarchical state machine and all its states.
+ * \brief Gets the states from a state up to one of its ancestors.
  *
- * \param[in,out] me The hierarchical state machine handle.
+ * The path starts with the state itself and ends with the child of the
+ * ancestor. The ancestor is excluded.
  *
- * \retval 0  Success.
- * \retval -1 Failure.
+ * \param[in]  state    The hsm state.
+ * \param[in]  ancestor The ancestor to stop at, NULL for the top state.
+ * \param[out] path     The path, at least HSM_MAX_DEPTH in size.
+ *
+ * \return The number of states in the path, -1 on failure.
  */
-int hsm_reset(hsm_t* const me)
+static int state_getPath(const state_t* const state,
+                         const state_t* const ancestor,
+                         const state_t*       path[])
 {
-	/* Check valid input */
-	int errorCode = 0;
+	int            pathSize = 0;
+	const state_t* aux      = state;
 
-	if (me == NULL)
+	while ((aux != ancestor) && (pathSize >= 0))
 	{
-		/* Invalid input. */
-		errorCode = -1;
+		if ((aux == NULL) || (pathSize >= (int)HSM_MAX_DEPTH))
+		{
+			/* Not an ancestor or too deep */
+			pathSize = -1;
+		}
+		else
+		{
+			path[pathSize] = aux;
+			pathSize++;
+			aux = aux->itsParentState;
+		}
 	}
 
-	if (errorCode == 0)
+	return pathSize;
+}
+
+/**
+ * \brief Gets the least common ancestor of a transition.
+ *
+ * It is the deepest state that is a proper ancestor of both the source and
+ * the target, so a transition to self exits and re-enters the state.
+ *
+ * \param[in] source The transition's source state.
+ * \param[in] target The transition's target state.
+ *
+ * \return The least common ancestor, NULL if it is above the top states.
+ */
+static const state_t* state_getLca(const state_t* const source,
+                                   const state_t* const target)
+{
+	const state_t* lca   = source->itsParentState;
+	bool           found = false;
+
+	while ((lca != NULL) && !found)
 	{
-		/* Reset hsm */
-		const bool initSuccess = hsm_init(me,
-		                                  me->itsInitialState,
-		                                  me->allStates,
-		                                  me->allStatesSize);
+		/* Check if it is also an ancestor of the target */
+		const state_t* aux = target->itsParentState;
 
-		if (!initSuccess)
+		while ((aux != NULL) && (aux != lca))
 		{
-			/* Failed to initialize the HSM */
-			errorCode = -1;
+			aux = aux->itsParentState;
+		}
+
+		if (aux == lca)
+		{
+			found = true;
+		}
+		else
+		{
+			lca = lca->itsParentState;
 		}
 	}
 
-	return errorCode;
+	return lca;
 }
 
 /**
- * \brief Hierarchical state machine event handler.
- *
- * This is the handlers algorithm
- * \dot
- * 	digraph HSM{
- * 		graph [fontsize=10 fontname="Verdana" compound=true rankdir=LR];
- * 		node [shape=record fontsize=10 fontname="Verdana"];
+ * \brief Checks if the event triggers the transition.
  *
- * 		onEntry [ label="onEntry" ];
- * 		during [ label="during" ];
- * 		guard [ label="guard" ];
- * 		action [ label="action" ];
- * 		onExit [ label="onExit" ];
+ * \param[in] transition The hsm transition.
+ * \param[in] event      The event signal.
  *
- * 		onEntry -> during;
- * 		during -> guard [ label = "" ];
- * 		guard -> during [ label = "F" ];
- * 		guard -> action [ label = "T" ];
- * 		guard -> onExit [ label = "NULL" ];
- * 		action -> onExit;
- * 		onExit -> onEntry;
- * 	}
- * \enddot
+ * \retval True  The event is the transition's trigger.
+ * \retval False The event is not the transition's trigger.
+ */
+static bool transition_isTriggered(const hsm_transition_t* const transition,
+                                   const hsm_event_t* const      event)
+{
+	bool triggered = (transition->eventType == HSM_EVENT_ANY);
+
+	if ((!triggered) && (event != NULL))
+	{
+		triggered = (transition->eventType == event->eventType);
+	}
+
+	return triggered;
+}
+
+/**
+ * \brief Executes transition's guard.
  *
- * \param[in] me    The hierarchical state machine handle.
- * \param[in] event The event signal.
+ * \param[in] transition The hsm transition.
+ * \param[in] source     The transition's source state.
+ * \param[in] event      The event signal.
  *
- * \retval  1  No event signal given.
- * \retval  0  Success.
- * \retval -1 Failure.
+ * \retval True  The transition is enabled.
+ * \retval False The transition is disabled.
  */
-int hsm_handleEvent(hsm_t* const me, const hsm_event_t* const event)
+static bool transition_exec_guard(const hsm_transition_t* const transition,
+                                  const state_t* const          source,
+                                  const hsm_event_t* const      event)
 {
-	int errorCode = 0;
+	bool enabled = true;
 
-	/* Check valid input */
-	if (me == NULL)
+	if (transition->guard != NULL)
 	{
-		/* Invalid input. */
-		errorCode = -1;
+#if HSM_STATS
+		const uint64_t start = stats_getNs();
+#endif
+
+		enabled = transition->guard(source, event);
+
+#if HSM_STATS
+		if (source->itsStats != NULL)
+		{
+			source->itsStats->itsGuardNs += stats_getNs() - start;
+		}
+#endif
 	}
 
-	if (errorCode == 0)
+	return enabled;
+}
+
+/**
+ * \brief Executes transition's action.
+ *
+ * \param[in] transition The hsm transition.
+ * \param[in] source     The transition's source state.
+ * \param[in] event      The event signal.
+ */
+static void transition_exec_action(const hsm_transition_t* const transition,
+                                   const state_t* const          source,
+                                   const hsm_event_t* const      event)
+{
+	if (transition->action != NULL)
 	{
-		if (me->itsCurrentState == NULL)
+#if HSM_STATS
+		const uint64_t start = stats_getNs();
+#endif
+
+		transition->action(source, event);
+
+#if HSM_STATS
+		if (source->itsStats != NULL)
 		{
-			/* Invalid input. */
-			errorCode = -1;
+			source->itsStats->itsActionNs += stats_getNs() - start;
 		}
+#endif
 	}
+}
 
-	const state_t* nextState     = NULL;
-	hsm_st_mode_t  nextStateMode = HSM_ST_M_ERROR;
-	const char*    msg           = NULL;
+/**
+ * \brief Enters a single state.
+ *
+ * \param[in,out] me    The hierarchical state machine handle.
+ * \param[in]     state The state to enter.
+ * \param[in]     event The event signal.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int hsm_rtc_enterState(hsm_t* const             me,
+                              const state_t* const     state,
+                              const hsm_event_t* const event)
+{
+	int errorCode = 0;
+
+	if (!state_exec_onEntry(state, event))
+	{
+		/* Fail */
+		errorCode = -1;
+	}
 
 	if (errorCode == 0)
 	{
-		/* Handle event */
-		const state_t* const currentState = me->itsCurrentState;
-		nextState                         = me->itsCurrentState;
+		state_getPrivate(state)->itsMode = HSM_ST_M_DURING;
+		hsm_timer_enter(me, state);
 
-		switch (currentState->itsMode)
-		{
-			case HSM_ST_M_ON_ENTRY:
-			{
-				/*
-				 * Go to parent/child
-				 */
-				const int hasChildReturnCode =
-				    state_hasChild(currentState);
+		/* Remember it for the history pseudostate */
+		state_setActive(state);
 
-				if (hasChildReturnCode == 1)
-				{
-					/* Change current state */
-					nextState =
-					    currentState->itsInitialState;
-					msg = "Top --> Child";
-				}
-				else if (hasChildReturnCode == 0)
-				{
-					nextState = state_getTop(currentState);
-					msg       = "Child --> Top";
-				}
-				else
-				{
-					/* Error */
-					errorCode = -1;
-				}
+		me->itsCurrentState = state_getPrivate(state);
 
-				/* Execute on_entry */
-				if (errorCode == 0)
-				{
-					if (!state_exec_onEntry(currentState,
-					                        event))
-					{
-						/* Fail */
-						errorCode = -1;
+		/* Its regions start after it */
+		errorCode = hsm_region_enter(me, state, event);
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Enters the initial state down to a leaf, if not entered yet.
+ *
+ * \param[in,out] me    The hierarchical state machine handle.
+ * \param[in]     event The event signal.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int hsm_rtc_start(hsm_t* const me, const hsm_event_t* const event)
+{
+	const state_t* const currentState = me->itsCurrentState;
+	int                  errorCode    = 0;
+
+	if (currentState->itsMode == HSM_ST_M_ON_ENTRY)
+	{
+		const state_t* path[HSM_MAX_DEPTH];
+		const int pathSize = state_getPath(currentState, NULL, path);
+
+		errorCode =
+		    hsm_rtc_enter(me, path, pathSize, currentState, event);
+	}
+	else if (currentState->itsMode != HSM_ST_M_DURING)
+	{
+		/* In the middle of hsm_handleEvent */
+		errorCode = -1;
+	}
+	else
+	{
+		/* No action */
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Enters the states from below the LCA down to a leaf.
+ *
+ * The states of the path are entered outermost first. Then the target is
+ * entered down to a leaf through the history pseudostates.
+ *
+ * \param[in,out] me       The hierarchical state machine handle.
+ * \param[in]     path     From the target up to below the LCA.
+ * \param[in]     pathSize The number of states in the path, -1 if none.
+ * \param[in]     target   The transition's target state.
+ * \param[in]     event    The event signal.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int hsm_rtc_enter(hsm_t* const             me,
+                         const state_t* const     path[],
+                         const int                pathSize,
+                         const state_t* const     target,
+                         const hsm_event_t* const event)
+{
+	const state_t* resumePath[HSM_MAX_DEPTH];
+	int            errorCode = (pathSize < 0) ? -1 : 0;
+
+	/* Enter from the outermost state down to the target */
+	for (int i = pathSize - 1; (i >= 0) && (errorCode == 0); i--)
+	{
+		errorCode = hsm_rtc_enterState(me, path[i], event);
+	}
+
+	/* Enter down to a leaf, through the history pseudostates */
+	const state_t* state = target;
+
+	while ((errorCode == 0) && (state_hasChild(state) == 1))
+	{
+		const state_t* const resume = state_getResume(state);
+		const int            resumeSize =
+		    state_getPath(resume, state, resumePath);
+
+		errorCode = (resumeSize < 1) ? -1 : 0;
+
+		/* A deep history goes straight down to the leaf it kept */
+		for (int i = resumeSize - 1; (i >= 0) && (errorCode == 0); i--)
+		{
+			errorCode =
+			    hsm_rtc_enterState(me, resumePath[i], event);
+		}
+
+		state = resume;
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Exits the states from the current leaf up to the LCA.
+ *
+ * \param[in,out] me    The hierarchical state machine handle.
+ * \param[in]     lca   The least common ancestor, NULL for none.
+ * \param[in]     event The event signal.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int hsm_rtc_exit(hsm_t* const             me,
+                        const state_t* const     lca,
+                        const hsm_event_t* const event)
+{
+	state_t* const leaf      = me->itsCurrentState;
+	int            errorCode = 0;
+
+	while ((errorCode == 0) && (me->itsCurrentState != lca))
+	{
+		state_t* const state = me->itsCurrentState;
+
+		/* Its regions stop before it */
+		errorCode = hsm_region_exit(me, state, event);
+
+		if ((errorCode == 0) && !state_exec_onExit(state, event))
+		{
+			/* Fail */
+			errorCode = -1;
+		}
+
+		if (errorCode == 0)
+		{
+			hsm_timer_exit(me, state);
+			state->itsMode      = HSM_ST_M_ON_ENTRY;
+			me->itsCurrentState =
+			    state_getPrivate(state->itsParentState);
+
+			/* A deep history remembers the leaf it is left in */
+			if ((state->itsHistory == HSM_HISTORY_DEEP) &&
+			    (state != leaf))
+			{
+				state->itsHistoryState = leaf;
+			}
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Executes the during action of all active states, outermost first.
+ *
+ * \param[in] me    The hierarchical state machine handle.
+ * \param[in] event The event signal.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int hsm_rtc_during(const hsm_t* const       me,
+                          const hsm_event_t* const event)
+{
+	const state_t* path[HSM_MAX_DEPTH];
+	const int      pathSize =
+	    state_getPath(me->itsCurrentState, NULL, path);
+	int errorCode = (pathSize < 0) ? -1 : 0;
+
+	for (int i = pathSize - 1; (i >= 0) && (errorCode == 0); i--)
+	{
+		if (!state_exec_during(path[i], event))
+		{
+			/* Fail */
+			errorCode = -1;
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Finds the first enabled transition of a state.
+ *
+ * Only transitions triggered by the event are checked, in their order.
+ *
+ * \param[in] state The hsm state.
+ * \param[in] event The event signal.
+ *
+ * \return The transition, NULL if none is enabled.
+ */
+static const hsm_transition_t* transition_find(const state_t* const     state,
+                                               const hsm_event_t* const event)
+{
+	const hsm_transition_t* transition = NULL;
+
+	for (uint32_t i = 0U; (i < state->itsTransitionNum) &&
+	                      (state->itsTransition != NULL) &&
+	                      (transition == NULL);
+	     i++)
+	{
+		const hsm_transition_t* const aux = &state->itsTransition[i];
+
+		if (transition_isTriggered(aux, event) &&
+		    transition_exec_guard(aux, state, event))
+		{
+			transition = aux;
+		}
+	}
+
+	return transition;
+}
+
+/**
+ * \brief Lists the transitions a state checks for an event type.
+ *
+ * The state's own transitions come first and then its parents', each in
+ * their order. The ones of other event types are left out.
+ *
+ * \param[in]  state      The hsm state.
+ * \param[in]  eventType  The event type, HSM_EVENT_ANY for only those.
+ * \param[out] candidates The transitions, NULL to only count them.
+ * \param[out] sources    Their source states, NULL to only count them.
+ *
+ * \return The number of transitions.
+ */
+static uint32_t table_fillCandidates(const state_t* const     state,
+                                     const uint32_t           eventType,
+                                     const hsm_transition_t** candidates,
+                                     const state_t**          sources)
+{
+	uint32_t num = 0U;
+
+	for (const state_t* aux = state; aux != NULL;
+	     aux                = aux->itsParentState)
+	{
+		for (uint32_t i = 0U; (aux->itsTransition != NULL) &&
+		                      (i < aux->itsTransitionNum);
+		     i++)
+		{
+			const hsm_transition_t* const transition =
+			    &aux->itsTransition[i];
+
+			if ((transition->eventType == HSM_EVENT_ANY) ||
+			    (transition->eventType == eventType))
+			{
+				if ((candidates != NULL) && (sources != NULL))
+				{
+					candidates[num] = transition;
+					sources[num]    = aux;
+				}
+				num++;
+			}
+		}
+	}
+
+	return num;
+}
+
+/**
+ * \brief Finds the first enabled transition in the transition table.
+ *
+ * \param[in]  table     The transition table.
+ * \param[in]  state     The current state.
+ * \param[in]  event     The event signal.
+ * \param[in]  inherited If the parents' transitions are checked too.
+ * \param[out] source    The transition's source state.
+ *
+ * \return The transition, NULL if none is enabled.
+ */
+static const hsm_transition_t* table_find(const hsm_table_t* const table,
+                                          const state_t* const     state,
+                                          const hsm_event_t* const event,
+                                          const bool               inherited,
+                                          const state_t**          source)
+{
+	const hsm_transition_t* transition = NULL;
+
+	/* Out of the table's range only HSM_EVENT_ANY can trigger */
+	const uint32_t column =
+	    ((event != NULL) && (event->eventType < table->itsEventTypeNum))
+	        ? event->eventType
+	        : HSM_EVENT_ANY;
+	const uint32_t cell =
+	    (state->itsIndex * table->itsEventTypeNum) + column;
+
+	*source = state;
+
+	for (uint32_t i = table->itsFirst[cell];
+	     (i < table->itsFirst[cell + 1U]) && (transition == NULL) &&
+	     (inherited || (table->itsSources[i] == state));
+	     i++)
+	{
+		if (transition_exec_guard(table->itsCandidates[i],
+		                          table->itsSources[i],
+		                          event))
+		{
+			transition = table->itsCandidates[i];
+			*source     = table->itsSources[i];
+		}
+	}
+
+	return transition;
+}
+
+/**
+ * \brief Computes the path of a transition for the transition table.
+ *
+ * The LCA and the states entered are the ones of hsm_dispatch. The states
+ * exited are the ones of the micro steps, from the source up to the child
+ * of the target's parent, or up to the top state if that is no ancestor.
+ *
+ * \param[in]  source     The transition's source state.
+ * \param[in]  transition The hsm transition.
+ * \param[out] path       The path, NULL to only count its states.
+ * \param[out] entries    The states entered, innermost first, NULL to only
+ *                        count them.
+ *
+ * \return The number of states entered, -1 on failure.
+ */
+static int table_fillPath(const state_t* const          source,
+                          const hsm_transition_t* const transition,
+                          hsm_table_path_t* const       path,
+                          const state_t**               entries)
+{
+	const state_t* const target = transition->targetState;
+	const state_t*       aux[HSM_MAX_DEPTH];
+	const state_t*       lca      = NULL;
+	uint32_t             exitNum  = 0U;
+	int                  entryNum = 0;
+
+	if (target != NULL)
+	{
+		/* Both must reach a top state, so the walks below end */
+		if ((state_getPath(source, NULL, aux) < 0) ||
+		    (state_getPath(target, NULL, aux) < 0))
+		{
+			/* Too deep */
+			entryNum = -1;
+		}
+		else
+		{
+			lca      = state_getLca(source, target);
+			entryNum = state_getPath(
+			    target, lca, (entries != NULL) ? entries : aux);
+			exitNum = 1U;
+
+			for (const state_t* state = source;
+			     (state->itsParentState != NULL) &&
+			     (state->itsParentState != target->itsParentState);
+			     state = state->itsParentState)
+			{
+				exitNum++;
+			}
+		}
+	}
+
+	if ((entryNum >= 0) && (path != NULL))
+	{
+		path->itsLca      = lca;
+		path->itsEntryNum = (uint32_t)entryNum;
+		path->itsExitNum  = exitNum;
+	}
+
+	return entryNum;
+}
+
+/**
+ * \brief Gets the path of a transition from the transition table.
+ *
+ * \param[in] table      The transition table.
+ * \param[in] source     The transition's source state.
+ * \param[in] transition One of the source's transitions.
+ *
+ * \return The path.
+ */
+static const hsm_table_path_t*
+table_getPath(const hsm_table_t* const      table,
+              const state_t* const          source,
+              const hsm_transition_t* const transition)
+{
+	const uint32_t index = (uint32_t)(transition - source->itsTransition);
+
+	return &table->itsPaths[table->itsPathFirst[source->itsIndex] + index];
+}
+
+/**
+ * \brief Finds the first enabled transition of the active states.
+ *
+ * The current leaf is checked first and then its ancestors, so a child
+ * overrides the transitions it inherits from its parents. With a transition
+ * table they are looked up in it instead, see hsm_table_init.
+ *
+ * \param[in]  me         The hierarchical state machine handle.
+ * \param[in]  event      The event signal.
+ * \param[out] source     The transition's source state.
+ * \param[out] transition The transition, NULL if none is enabled.
+ */
+static void hsm_rtc_findTransition(const hsm_t* const       me,
+                                   const hsm_event_t* const event,
+                                   const state_t**          source,
+                                   const hsm_transition_t** transition)
+{
+	const state_t* state = me->itsCurrentState;
+
+	*source     = NULL;
+	*transition = NULL;
+
+	if (me->itsTable != NULL)
+	{
+		*transition =
+		    table_find(me->itsTable, state, event, true, source);
+	}
+	else
+	{
+		while ((state != NULL) && (*transition == NULL))
+		{
+			*transition = transition_find(state, event);
+			*source     = state;
+			state       = state->itsParentState;
+		}
+	}
+}
+
+/**
+ * \brief Advances the hierarchical state machine by a single mode.
+ *
+ * The handle must be already validated. The trace, the counters and the
+ * journal are left to the caller, see hsm_step_begin.
+ *
+ * \param[in,out] me    The hierarchical state machine handle.
+ * \param[in]     event The event signal.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int hsm_step(hsm_t* const me, const hsm_event_t* const event)
+{
+	int errorCode = 0;
+
+	const state_t* const currentState  = me->itsCurrentState;
+	const state_t*       nextState     = currentState;
+	hsm_st_mode_t        nextStateMode = HSM_ST_M_ERROR;
+
+	switch (currentState->itsMode)
+	{
+		case HSM_ST_M_ON_ENTRY:
+		{
+			/*
+			 * Go to parent/child
+			 */
+			const int hasChildReturnCode =
+			    state_hasChild(currentState);
+
+			if (hasChildReturnCode == 1)
+			{
+				/* Change current state */
+				nextState =
+				    currentState->itsInitialState;
+			}
+			else if (hasChildReturnCode == 0)
+			{
+				nextState = state_getTop(currentState);
+			}
+			else
+			{
+				/* Error */
+				errorCode = -1;
+			}
+
+			/* Execute on_entry */
+			if (errorCode == 0)
+			{
+				if (!state_exec_onEntry(currentState,
+				                        event))
+				{
+					/* Fail */
+					errorCode = -1;
+				}
+				else
+				{
+					hsm_timer_enter(me,
+					                currentState);
+				}
+			}
+
+			/* The parent goes down to it */
+			if ((errorCode == 0) &&
+			    (currentState->itsParentState != NULL))
+			{
+				state_getPrivate(
+				    currentState->itsParentState)
+				    ->itsActiveState =
+				    state_getPrivate(currentState);
+			}
+
+			/* Go to next mode */
+			if (errorCode == 0)
+			{
+				nextStateMode = HSM_ST_M_DURING;
+			}
+
+			break;
+		}
+
+		case HSM_ST_M_DURING:
+		{
+			/*
+			 * Go to parent/child
+			 */
+			const int hasChildReturnCode =
+			    state_hasChild(currentState);
+
+			if (hasChildReturnCode == 1)
+			{
+				/* Go down the active states */
+				nextState =
+				    currentState->itsActiveState;
+			}
+			else if (hasChildReturnCode == 0)
+			{
+				nextState = state_getTop(currentState);
+			}
+			else
+			{
+				/* Error */
+				errorCode = -1;
+			}
+
+			/* Execute during */
+			if (errorCode == 0)
+			{
+				if (!state_exec_during(currentState,
+				                       event))
+				{
+					/* Fail */
+					errorCode = -1;
+				}
+			}
+
+			/* Go to next mode */
+			if (errorCode == 0)
+			{
+				nextStateMode =
+				    HSM_ST_M_CHECKING_GUARD;
+			}
+
+			break;
+		}
+
+		case HSM_ST_M_CHECKING_GUARD:
+		{
+			hsm_st_mode_t new_state_mode =
+			    currentState->itsMode;
+
+			/* Check guard, only of the current state */
+			const state_t*          source     = NULL;
+			const hsm_transition_t* transition = NULL;
+
+			if (me->itsTable != NULL)
+			{
+				transition = table_find(me->itsTable,
+				                        currentState,
+				                        event,
+				                        false,
+				                        &source);
+			}
+			else
+			{
+				transition =
+				    transition_find(currentState, event);
+			}
+
+			/* Take action */
+			if (transition != NULL)
+			{
+				transition_exec_action(transition,
+				                       currentState,
+				                       event);
+
+#if HSM_STATS
+				hsm_state_stats_t* const stats =
+				    currentState->itsStats;
+
+				if (stats != NULL)
+				{
+					stats->itsFireNum
+					    [transition -
+					     currentState
+					         ->itsTransition]++;
+				}
+#endif
+			}
+
+			if ((transition != NULL) &&
+			    (transition->targetState != NULL))
+			{
+				/* Exit towards its target */
+				me->itsTransition = transition;
+				me->itsExitNum =
+				    (me->itsTable != NULL)
+				        ? table_getPath(me->itsTable,
+				                        currentState,
+				                        transition)
+				              ->itsExitNum
+				        : 0U;
+				new_state_mode = HSM_ST_M_ON_EXIT;
+			}
+			else
+			{
+				/* None or internal, go on */
+				const int hasChildReturnCode =
+				    state_hasChild(currentState);
+
+				if (hasChildReturnCode == 1)
+				{
+					new_state_mode =
+					    HSM_ST_M_DURING;
+					/* Change current state */
+					nextState =
+					    currentState
+					        ->itsActiveState;
+				}
+				else if (hasChildReturnCode == 0)
+				{
+					nextState =
+					    state_getTop(currentState);
+				}
+				else
+				{
+					/* Error */
+					errorCode = -1;
+				}
+			}
+
+			/* Go to next mode */
+			if (errorCode == 0)
+			{
+				nextStateMode = new_state_mode;
+			}
+
+			break;
+		}
+
+		case HSM_ST_M_ON_EXIT:
+		{
+			/* The target of the transition taken */
+			if (me->itsTransition != NULL)
+			{
+				nextState =
+				    me->itsTransition->targetState;
+			}
+			else
+			{
+				/* Error */
+				errorCode = -1;
+			}
+
+			const int hasParentReturnCode =
+			    (errorCode == 0)
+			        ? state_hasParent(currentState)
+			        : -1;
+
+			/* The table counted the states to exit */
+			const bool exitParent =
+			    (me->itsExitNum != 0U)
+			        ? (me->itsExitNum > 1U)
+			        : (currentState->itsParentState !=
+			           nextState->itsParentState);
+
+			/* Change state */
+			if (hasParentReturnCode == 1)
+			{
+				state_t* const parent =
+				    currentState->itsParentState;
+
+				if (!exitParent)
+				{
+					/*
+					 * Have common parent (but not NULL)
+					 */
+					if (parent->itsHistory ==
+					    HSM_HISTORY_SHALLOW)
+					{
+						parent->itsHistoryState =
+						    state_getPrivate(
+						        nextState);
 					}
 				}
+				else
+				{
+					/*
+					 * We exit a parent state so parent should exit also
+					 */
+					parent->itsMode =
+					    HSM_ST_M_ON_EXIT;
+					nextState = parent;
+				}
+			}
+			else if (hasParentReturnCode == 0)
+			{
+				nextState = state_getTop(nextState);
+			}
+			else
+			{
+				/* Error */
+				errorCode = -1;
+			}
+
+			/* Execute onExit */
+			if (errorCode == 0)
+			{
+				if (!state_exec_onExit(currentState,
+				                       event))
+				{
+					/* Fail */
+					errorCode = -1;
+				}
+				else
+				{
+					hsm_timer_exit(me,
+					               currentState);
+				}
+			}
+
+			/* A deep history remembers its leaf */
+			if ((errorCode == 0) &&
+			    (currentState->itsHistory ==
+			     HSM_HISTORY_DEEP) &&
+			    (state_hasChild(currentState) == 1))
+			{
+				state_getPrivate(currentState)
+				    ->itsHistoryState =
+				    state_getActiveLeaf(currentState);
+			}
+
+			/* Current state is old now */
+			if (errorCode == 0)
+			{
+				nextStateMode = HSM_ST_M_ON_ENTRY;
+
+				if (me->itsExitNum != 0U)
+				{
+					me->itsExitNum--;
+				}
+
+				if (nextState !=
+				    currentState->itsParentState)
+				{
+					/* The last state is left */
+					me->itsTransition = NULL;
+					me->itsTakenNum++;
+				}
+			}
+
+			break;
+		}
+
+		default:
+		{
+			/* Fail */
+			errorCode = -1;
+		}
+	}
+
+	if (errorCode == 0)
+	{
+		me->itsCurrentState->itsMode = nextStateMode;
+		me->itsCurrentState          = nextState;
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Checks if the steps of a machine are recorded anywhere.
+ *
+ * \param[in] me The hierarchical state machine handle.
+ *
+ * \return True if traced, counted or journaled, False otherwise.
+ */
+static bool hsm_step_isRecorded(const hsm_t* const me)
+{
+	bool recorded = (HSM_TRACE != 0) || (me->itsJournal != NULL);
+
+#if HSM_STATS
+	recorded = recorded || (me->itsStats != NULL);
+#endif
+
+	return recorded;
+}
+
+/**
+ * \brief Takes what the records of a step need before it.
+ *
+ * \param[in]  me   The hierarchical state machine handle.
+ * \param[out] step Where the step starts from.
+ */
+static void hsm_step_begin(const hsm_t* const me, hsm_step_t* const step)
+{
+	step->itsFromState     = me->itsCurrentState;
+	step->itsFromStateMode = me->itsCurrentState->itsMode;
+
+#if HSM_STATS
+	step->itsStart = stats_getNs();
+#endif
+}
+
+/**
+ * \brief Records a step in the trace, the counters and the journal.
+ *
+ * A failed step is only journaled, flagged so that its replay fails too.
+ *
+ * \param[in] me        The hierarchical state machine handle.
+ * \param[in] step      Where the step started from.
+ * \param[in] event     The event signal.
+ * \param[in] errorCode What the step returned.
+ */
+static void hsm_step_end(const hsm_t* const       me,
+                         const hsm_step_t* const  step,
+                         const hsm_event_t* const event,
+                         const int                errorCode)
+{
+	if (errorCode == 0)
+	{
+		hsm_trace(me,
+		          step->itsFromState,
+		          step->itsFromStateMode,
+		          event);
+
+#if HSM_STATS
+		stats_addEvent(me, step->itsFromState, event, step->itsStart);
+#endif
+	}
+
+	if (me->itsJournal != NULL)
+	{
+		hsm_journal_write(me->itsJournal,
+		                  me,
+		                  event,
+		                  step->itsFromState,
+		                  step->itsFromStateMode,
+		                  (uint8_t)((errorCode != 0)
+		                                ? HSM_JOURNAL_F_FAILED
+		                                : 0U));
+	}
+}
+
+// ############################################################################
+// ############################################################################
+// Function definitions
+
+/**
+ * \brief Creates the hierarchical state machine handle.
+ *
+ * For valid hsm machine initial state must be a top level state. (no parent)
+ *
+ * Use \see hsm_build instead.
+ *
+ * \param[in] initialState  The state that the HSM will begin with.
+ * \param[in] allStates     A list with all the hsm's states.
+ * \param[in] allStatesSize The number of the hsm's states.
+ *
+ * \return The hierarchical state machine handle.
+ */
+hsm_t _hsm_build(const state_t* const initialState,
+                 const state_t* const allStates[],
+                 const uint32_t       allStatesSize)
+{
+	/* Build it */
+	hsm_t aux;
+	/* TODO: Check return code. */
+	(void)hsm_init(&aux, initialState, allStates, allStatesSize);
+	aux.itsJournal = NULL;
+	aux.itsRegions = NULL;
+	aux.itsTable   = NULL;
+#if HSM_STATS
+	aux.itsStats = NULL;
+#endif
+
+	/* No timers are bound to its states yet */
+	for (uint32_t i = 0U; i < aux.allStatesSize; i++)
+	{
+		aux.allStates[i]->itsTimers = NULL;
+	}
+
+	return aux;
+}
+
+/**
+ * \brief Resets the hierarchical state machine and all its states.
+ *
+ * \param[in,out] me The hierarchical state machine handle.
+ *
+ * \retval 0  Success.
+ * \retval -1 Failure.
+ */
+int hsm_reset(hsm_t* const me)
+{
+	/* Check valid input */
+	int errorCode = 0;
+
+	if (me == NULL)
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		/* Reset hsm */
+		const bool initSuccess = hsm_init(me,
+		                                  me->itsInitialState,
+		                                  me->allStates,
+		                                  me->allStatesSize);
+
+		if (!initSuccess)
+		{
+			/* Failed to initialize the HSM */
+			errorCode = -1;
+		}
+		else
+		{
+			/* Its states are left */
+			hsm_timer_exit(me, NULL);
+			hsm_region_reset(me);
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Hierarchical state machine event handler.
+ *
+ * In its guard mode a state takes the first of its transitions that the
+ * event triggers and whose guard passes. An internal one only takes its
+ * action.
+ *
+ * This is the handlers algorithm
+ * \dot
+ * 	digraph HSM{
+ * 		graph [fontsize=10 fontname="Verdana" compound=true rankdir=LR];
+ * 		node [shape=record fontsize=10 fontname="Verdana"];
+ *
+ * 		onEntry [ label="onEntry" ];
+ * 		during [ label="during" ];
+ * 		guard [ label="guard" ];
+ * 		action [ label="action" ];
+ * 		onExit [ label="onExit" ];
+ *
+ * 		onEntry -> during;
+ * 		during -> guard [ label = "" ];
+ * 		guard -> during [ label = "F" ];
+ * 		guard -> action [ label = "T" ];
+ * 		guard -> onExit [ label = "NULL" ];
+ * 		action -> onExit;
+ * 		onExit -> onEntry;
+ * 	}
+ * \enddot
+ *
+ * \param[in] me    The hierarchical state machine handle.
+ * \param[in] event The event signal.
+ *
+ * \retval  1  No event signal given.
+ * \retval  0  Success.
+ * \retval -1 Failure.
+ */
+int hsm_handleEvent(hsm_t* const me, const hsm_event_t* const event)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if (me == NULL)
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		if (me->itsCurrentState == NULL)
+		{
+			/* Invalid input. */
+			errorCode = -1;
+		}
+	}
+
+	if (errorCode == 0)
+	{
+		hsm_step_t step;
+
+		hsm_step_begin(me, &step);
+		errorCode = hsm_step(me, event);
+		hsm_step_end(me, &step, event, errorCode);
+	}
+
+	if (errorCode == 0)
+	{
+		/* Check for event signal */
+		if (event == NULL)
+		{
+			/* No event signal given */
+			errorCode = 1;
+		}
+	}
+
+	/* Success */
+	return errorCode;
+}
+
+/**
+ * \brief Hierarchical state machine batch event handler.
+ *
+ * Same as calling \see hsm_handleEvent for every event in turn, but the
+ * handle is validated and its records looked up once for the whole batch.
+ * Without a trace, counters or journal, the batch runs the bare steps.
+ * Attach them before the batch, not from its actions.
+ *
+ * \param[in,out] me           The hierarchical state machine handle.
+ * \param[in]     events       The event signals, eventNum in size.
+ * \param[in]     eventNum     The number of event signals.
+ * \param[out]    eventDoneNum The number of events handled successfully. On
+ *                             failure it is the index of the failed event.
+ *                             Can be NULL.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_handleEvents(hsm_t* const             me,
+                     const hsm_event_t* const events,
+                     const size_t             eventNum,
+                     size_t* const            eventDoneNum)
+{
+	int    errorCode = 0;
+	size_t doneNum   = 0U;
+
+	/* Check valid input */
+	if ((me == NULL) || ((events == NULL) && (eventNum != 0U)))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		if (me->itsCurrentState == NULL)
+		{
+			/* Invalid input. */
+			errorCode = -1;
+		}
+	}
+
+	/* Without records a step is only its mode */
+	const bool recorded = (errorCode == 0) && hsm_step_isRecorded(me);
+
+	while ((errorCode == 0) && (doneNum < eventNum) && !recorded)
+	{
+		errorCode = hsm_step(me, &events[doneNum]);
+		doneNum += (errorCode == 0) ? 1U : 0U;
+	}
+
+	while ((errorCode == 0) && (doneNum < eventNum) && recorded)
+	{
+		const hsm_event_t* const event = &events[doneNum];
+		hsm_step_t               step;
+
+		hsm_step_begin(me, &step);
+		errorCode = hsm_step(me, event);
+		hsm_step_end(me, &step, event, errorCode);
+		doneNum += (errorCode == 0) ? 1U : 0U;
+	}
+
+	if (eventDoneNum != NULL)
+	{
+		*eventDoneNum = doneNum;
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Hierarchical state machine run to completion event handler.
+ *
+ * Unlike \see hsm_handleEvent that advances a single mode per call, this
+ * processes the whole event in one call:
+ *  - On the first call the initial state is entered down to a leaf.
+ *  - The during actions of the active states run, outermost first.
+ *  - The regions of the active states handle the event, see hsm_region.h.
+ *  - The first enabled transition, searching from the leaf upwards, fires.
+ *    The states are exited up to the least common ancestor, the action is
+ *    taken and the states are entered down to the target and then down to
+ *    a leaf through the history pseudostates.
+ *
+ * A transition without target state is internal. Only its action is taken.
+ *
+ * Do not mix it with \see hsm_handleEvent on the same handle without an
+ * \see hsm_reset in between.
+ *
+ * \param[in,out] me    The hierarchical state machine handle.
+ * \param[in]     event The event signal.
+ *
+ * \retval  1  No event signal given.
+ * \retval  0  Success.
+ * \retval -1 Failure.
+ */
+int hsm_dispatch(hsm_t* const me, const hsm_event_t* const event)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if (me == NULL)
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		if (me->itsCurrentState == NULL)
+		{
+			/* Invalid input. */
+			errorCode = -1;
+		}
+	}
+
+#if HSM_STATS
+	const uint64_t start = stats_getNs();
+#endif
+
+	/* For the journal */
+	const state_t* const fromState =
+	    (errorCode == 0) ? me->itsCurrentState : NULL;
+	const hsm_st_mode_t fromStateMode =
+	    (errorCode == 0) ? fromState->itsMode : HSM_ST_M_ERROR;
+
+	/* Enter the initial state on the first event */
+	if (errorCode == 0)
+	{
+		errorCode = hsm_rtc_start(me, event);
+	}
+
+#if HSM_STATS
+	/* The leaf handles the event */
+	const state_t* const leafState =
+	    (errorCode == 0) ? me->itsCurrentState : NULL;
+#endif
+
+	/* Execute during */
+	if (errorCode == 0)
+	{
+		errorCode = hsm_rtc_during(me, event);
+	}
+
+	/* The regions of the active states handle it too */
+	if (errorCode == 0)
+	{
+		errorCode = hsm_region_dispatch(me, event);
+	}
+
+	/* Take the transition */
+	if (errorCode == 0)
+	{
+		const state_t*          source     = NULL;
+		const hsm_transition_t* transition = NULL;
+
+		hsm_rtc_findTransition(me, event, &source, &transition);
+
+#if HSM_STATS
+		if ((transition != NULL) && (source->itsStats != NULL))
+		{
+			source->itsStats
+			    ->itsFireNum[transition - source->itsTransition]++;
+		}
+#endif
+
+		if (transition != NULL)
+		{
+			const state_t* const target = transition->targetState;
+
+			if (target == NULL)
+			{
+				/* Internal transition */
+				transition_exec_action(transition,
+				                       source,
+				                       event);
+			}
+			else
+			{
+				/* The table has the path precomputed */
+				const hsm_table_path_t* const path =
+				    (me->itsTable != NULL)
+				        ? table_getPath(me->itsTable,
+				                        source,
+				                        transition)
+				        : NULL;
+				const state_t* entries[HSM_MAX_DEPTH];
+				const state_t* const* entered = entries;
+				const state_t*        lca     = NULL;
+				int                   entryNum;
+
+				if (path != NULL)
+				{
+					lca      = path->itsLca;
+					entered  = &me->itsTable->itsEntries
+					               [path->itsEntryFirst];
+					entryNum = (int)path->itsEntryNum;
+				}
+				else
+				{
+					lca = state_getLca(source, target);
+					entryNum =
+					    state_getPath(target,
+					                  lca,
+					                  entries);
+				}
+
+				errorCode = hsm_rtc_exit(me, lca, event);
+
+				if (errorCode == 0)
+				{
+					transition_exec_action(transition,
+					                       source,
+					                       event);
+					errorCode = hsm_rtc_enter(me,
+					                          entered,
+					                          entryNum,
+					                          target,
+					                          event);
+				}
+
+				if (errorCode == 0)
+				{
+					me->itsTakenNum++;
+					hsm_trace(me,
+					          source,
+					          HSM_ST_M_TAKING_ACTION,
+					          event);
+				}
+			}
+		}
+	}
+
+#if HSM_STATS
+	if (errorCode == 0)
+	{
+		stats_addEvent(me, leafState, event, start);
+	}
+#endif
+
+	/* The failed ones too, unless the input was invalid */
+	if ((fromState != NULL) && (me->itsJournal != NULL))
+	{
+		const uint8_t failed =
+		    (uint8_t)((errorCode != 0) ? HSM_JOURNAL_F_FAILED : 0U);
+
+		hsm_journal_write(me->itsJournal,
+		                  me,
+		                  event,
+		                  fromState,
+		                  fromStateMode,
+		                  (uint8_t)(HSM_JOURNAL_F_DISPATCH | failed));
+	}
+
+	if (errorCode == 0)
+	{
+		/* Check for event signal */
+		if (event == NULL)
+		{
+			/* No event signal given */
+			errorCode = 1;
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Enters the initial state down to a leaf, without handling an event.
+ *
+ * \see hsm_dispatch enters it on the first event otherwise. Does nothing if
+ * the states are entered already.
+ *
+ * \param[in,out] me    The hierarchical state machine handle.
+ * \param[in]     event The event signal for the entry actions, can be NULL.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_enter(hsm_t* const me, const hsm_event_t* const event)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (me->itsCurrentState == NULL))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		errorCode = hsm_rtc_start(me, event);
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Exits all the active states, innermost first.
+ *
+ * The machine is left as if built, but the history pseudostates keep the
+ * states it was in. Does nothing if the states are not entered.
+ *
+ * \param[in,out] me    The hierarchical state machine handle.
+ * \param[in]     event The event signal for the exit actions, can be NULL.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_exit(hsm_t* const me, const hsm_event_t* const event)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (me->itsCurrentState == NULL))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		const hsm_st_mode_t mode = me->itsCurrentState->itsMode;
+
+		if (mode == HSM_ST_M_DURING)
+		{
+			errorCode = hsm_rtc_exit(me, NULL, event);
+		}
+		else if (mode != HSM_ST_M_ON_ENTRY)
+		{
+			/* In the middle of hsm_handleEvent */
+			errorCode = -1;
+		}
+		else
+		{
+			/* Not entered */
+		}
+	}
+
+	if ((errorCode == 0) && (me->itsCurrentState == NULL))
+	{
+		me->itsCurrentState = state_getPrivate(me->itsInitialState);
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Gets the index of a state in allStates.
+ *
+ * The index is kept in the state when the machine is built, so it takes
+ * no search.
+ *
+ * \param[in] me    The hierarchical state machine handle.
+ * \param[in] state The hsm state.
+ *
+ * \return The state's index, HSM_STATE_INDEX_NONE if not in the list.
+ */
+uint32_t hsm_getStateIndex(const hsm_t* const me, const state_t* const state)
+{
+	uint32_t index = HSM_STATE_INDEX_NONE;
+
+	/* Check valid input */
+	if ((me != NULL) && (state != NULL) &&
+	    (state->itsIndex < me->allStatesSize) &&
+	    (me->allStates[state->itsIndex] == state))
+	{
+		index = state->itsIndex;
+	}
+
+	return index;
+}
+
+/**
+ * \brief Compiles the transition table of a machine.
+ *
+ * For every state and event type the table lists the transitions to check,
+ * including the ones inherited from the parents, so the dispatch of an event
+ * no longer walks up the hierarchy. For every transition it keeps the LCA,
+ * the states to enter and the number of states the micro steps exit, so
+ * taking it does not walk the hierarchy either.
+ *
+ * Event types must be below eventTypeNum, events of other types only trigger
+ * HSM_EVENT_ANY transitions. The states may not change their transitions
+ * until \see hsm_table_destroy.
+ *
+ * \param[in,out] me           The hierarchical state machine handle.
+ * \param[in]     eventTypeNum The number of event types.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_table_init(hsm_t* const me, const uint32_t eventTypeNum)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (me->allStates == NULL) ||
+	    (me->itsTable != NULL) || (eventTypeNum == 0U))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	/* The cells and the end sentinel must fit in a uint32_t index */
+	if (errorCode == 0)
+	{
+		if ((me->allStatesSize == 0U) ||
+		    (eventTypeNum > ((UINT32_MAX - 1U) / me->allStatesSize)))
+		{
+			/* Too large */
+			errorCode = -1;
+		}
+	}
+
+	/* Every state and trigger must fit in the table */
+	for (uint32_t i = 0U; (errorCode == 0) && (i < me->allStatesSize); i++)
+	{
+		const state_t* const state = me->allStates[i];
+
+		if (state->itsIndex != i)
+		{
+			/* Invalid input. */
+			errorCode = -1;
+		}
+
+		for (uint32_t j = 0U; (errorCode == 0) &&
+		                      (state->itsTransition != NULL) &&
+		                      (j < state->itsTransitionNum);
+		     j++)
+		{
+			if (state->itsTransition[j].eventType >= eventTypeNum)
+			{
+				/* Invalid input. */
+				errorCode = -1;
+			}
+		}
+	}
+
+	/* Count the candidates */
+	const uint32_t cellNum =
+	    (errorCode == 0) ? (me->allStatesSize * eventTypeNum) : 0U;
+	uint32_t candidateNum = 0U;
 
-				/* Go to next mode */
-				if (errorCode == 0)
-				{
-					nextStateMode = HSM_ST_M_DURING;
-				}
+	for (uint32_t cell = 0U; (errorCode == 0) && (cell < cellNum); cell++)
+	{
+		const uint32_t num =
+		    table_fillCandidates(me->allStates[cell / eventTypeNum],
+		                         cell % eventTypeNum,
+		                         NULL,
+		                         NULL);
 
-				break;
-			}
+		if (num > (UINT32_MAX - candidateNum))
+		{
+			/* Too large */
+			errorCode = -1;
+		}
+		else
+		{
+			candidateNum += num;
+		}
+	}
 
-			case HSM_ST_M_DURING:
-			{
-				/*
-				 * Go to parent/child
-				 */
-				const int hasChildReturnCode =
-				    state_hasChild(currentState);
+	/* Count the transitions and the states they enter */
+	uint32_t transitionNum = 0U;
+	uint32_t entryNum      = 0U;
 
-				if (hasChildReturnCode == 1)
-				{
-					/* Change current state */
-					if (currentState->itsInitialState
-					        ->itsMode == HSM_ST_M_DURING)
-					{
-						nextState =
-						    currentState
-						        ->itsInitialState;
-					}
-					else
-					{
-						nextState =
-						    currentState
-						        ->itsHistoryState; //BUG
-					}
+	for (uint32_t i = 0U; (errorCode == 0) && (i < me->allStatesSize); i++)
+	{
+		const state_t* const state = me->allStates[i];
 
-					msg = "Top --> Child";
-				}
-				else if (hasChildReturnCode == 0)
-				{
-					nextState = state_getTop(currentState);
-					msg       = "Child --> Top";
-				}
-				else
-				{
-					/* Error */
-					errorCode = -1;
-				}
+		for (uint32_t j = 0U; (errorCode == 0) &&
+		                      (state->itsTransition != NULL) &&
+		                      (j < state->itsTransitionNum);
+		     j++)
+		{
+			const int num = table_fillPath(
+			    state, &state->itsTransition[j], NULL, NULL);
 
-				/* Execute during */
-				if (errorCode == 0)
-				{
-					if (!state_exec_during(currentState,
-					                       event))
-					{
-						/* Fail */
-						errorCode = -1;
-					}
-				}
+			if (num < 0)
+			{
+				/* Invalid input. */
+				errorCode = -1;
+			}
+			else if ((transitionNum == UINT32_MAX) ||
+			         ((uint32_t)num > (UINT32_MAX - entryNum)))
+			{
+				/* Too large */
+				errorCode = -1;
+			}
+			else
+			{
+				transitionNum++;
+				entryNum += (uint32_t)num;
+			}
+		}
+	}
 
-				/* Go to next mode */
-				if (errorCode == 0)
-				{
-					nextStateMode =
-					    HSM_ST_M_CHECKING_GUARD;
-				}
+#if SIZE_MAX <= UINT32_MAX
+	/* The size of the table must fit in a size_t */
+	if (errorCode == 0)
+	{
+		const size_t candidateSize =
+		    sizeof(hsm_transition_t*) + sizeof(state_t*);
+
+		if ((candidateNum >= ((SIZE_MAX / 8U) / candidateSize)) ||
+		    (cellNum >= ((SIZE_MAX / 8U) / sizeof(uint32_t))) ||
+		    (transitionNum >=
+		     ((SIZE_MAX / 8U) / sizeof(hsm_table_path_t))) ||
+		    (entryNum >= ((SIZE_MAX / 8U) / sizeof(state_t*))))
+		{
+			/* Too large */
+			errorCode = -1;
+		}
+	}
+#endif
 
-				break;
+	if (errorCode == 0)
+	{
+		const size_t size =
+		    sizeof(hsm_table_t) +
+		    (candidateNum * sizeof(hsm_transition_t*)) +
+		    (candidateNum * sizeof(state_t*)) +
+		    (entryNum * sizeof(state_t*)) +
+		    (transitionNum * sizeof(hsm_table_path_t)) +
+		    ((cellNum + 1U) * sizeof(uint32_t)) +
+		    (me->allStatesSize * sizeof(uint32_t));
+
+		// cppcheck-suppress misra-c2012-21.3
+		hsm_table_t* const table = (hsm_table_t*)calloc(1U, size);
+
+		if (table == NULL)
+		{
+			/* Out of memory */
+			errorCode = -1;
+		}
+		else
+		{
+			const hsm_transition_t** const candidates =
+			    (const hsm_transition_t**)&table[1];
+			const state_t** const sources =
+			    (const state_t**)&candidates[candidateNum];
+			const state_t** const entries =
+			    &sources[candidateNum];
+			hsm_table_path_t* const paths =
+			    (hsm_table_path_t*)&entries[entryNum];
+			uint32_t* const firsts =
+			    (uint32_t*)&paths[transitionNum];
+			uint32_t* const pathFirsts = &firsts[cellNum + 1U];
+			uint32_t        first      = 0U;
+
+			table->itsCandidates   = candidates;
+			table->itsSources      = sources;
+			table->itsEntries      = entries;
+			table->itsPaths        = paths;
+			table->itsFirst        = firsts;
+			table->itsPathFirst    = pathFirsts;
+			table->itsEventTypeNum = eventTypeNum;
+
+			/* Fill it */
+			for (uint32_t cell = 0U; cell < cellNum; cell++)
+			{
+				table->itsFirst[cell] = first;
+				first += table_fillCandidates(
+				    me->allStates[cell / eventTypeNum],
+				    cell % eventTypeNum,
+				    &table->itsCandidates[first],
+				    &table->itsSources[first]);
 			}
 
-			case HSM_ST_M_CHECKING_GUARD:
+			table->itsFirst[cellNum] = first;
+
+			/* Fill the paths, as counted above */
+			uint32_t path  = 0U;
+			uint32_t entry = 0U;
+
+			for (uint32_t i = 0U; i < me->allStatesSize; i++)
 			{
-				hsm_st_mode_t new_state_mode =
-				    currentState->itsMode;
+				const state_t* const state = me->allStates[i];
 
-				/* Check guard */
-				if (currentState->itsTransition == NULL)
-				{
-					const int hasChildReturnCode =
-					    state_hasChild(currentState);
+				table->itsPathFirst[i] = path;
 
-					if (hasChildReturnCode == 1)
-					{
-						/* Transition == NULL and no child */
-						new_state_mode =
-						    HSM_ST_M_DURING;
-						/* Change current state */
-						nextState =
-						    currentState
-						        ->itsHistoryState;
-						msg =
-						    "(Transition == NULL): Top --> Child";
-					}
-					else if (hasChildReturnCode == 0)
-					{
-						nextState =
-						    state_getTop(currentState);
-						msg = "Child --> Top";
-					}
-					else
-					{
-						/* Error */
-						errorCode = -1;
-					}
-				}
-				else
+				for (uint32_t j = 0U;
+				     (state->itsTransition != NULL) &&
+				     (j < state->itsTransitionNum);
+				     j++)
 				{
-					/* Check guard */
-					if (currentState->itsTransition[0]
-					        .guard == NULL)
-					{
-						/* No guard */
-						new_state_mode =
-						    HSM_ST_M_ON_EXIT;
-						msg =
-						    "(No guard): Top --> Child";
-					}
+					table->itsPaths[path].itsEntryFirst =
+					    entry;
+					entry += (uint32_t)table_fillPath(
+					    state,
+					    &state->itsTransition[j],
+					    &table->itsPaths[path],
+					    &table->itsEntries[entry]);
+					path++;
 				}
+			}
 
-				/* Execute guard */
-				//
+			me->itsTable = table;
+		}
+	}
 
-				/* Go to next mode */
-				if (errorCode == 0)
-				{
-					nextStateMode = new_state_mode;
-				}
+	return errorCode;
+}
 
-				break;
-			}
+/**
+ * \brief Frees the transition table, the machine walks up its states again.
+ *
+ * \param[in,out] me The hierarchical state machine handle.
+ */
+void hsm_table_destroy(hsm_t* const me)
+{
+	if ((me != NULL) && (me->itsTable != NULL))
+	{
+		// cppcheck-suppress misra-c2012-21.3
+		free(me->itsTable);
+		me->itsTable = NULL;
+	}
+}
 
-			case HSM_ST_M_ON_EXIT:
-			{
-				/*  */
-				if (currentState->itsTransition != NULL)
-				{
-					nextState =
-					    currentState->itsTransition[0]
-					        .targetState;
-				}
+/**
+ * \brief Initializes an event and its payload.
+ *
+ * A payload of up to HSM_EVENT_INLINE_SIZE bytes is copied into the event,
+ * so it moves with the event by value. A larger one is passed by pointer,
+ * it must outlive the event.
+ *
+ * \param[out] me        The event.
+ * \param[in]  eventType The event type.
+ * \param[in]  payload   The payload, NULL if none.
+ * \param[in]  size      The size of the payload, 0 only if none.
+ *
+ * \retval  1 The payload is passed by pointer.
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_event_init(hsm_event_t* const me,
+                   const uint32_t     eventType,
+                   void* const        payload,
+                   const size_t       size)
+{
+	int errorCode = 0;
 
-				const int hasParentReturnCode =
-				    state_hasParent(currentState);
+	/* Check valid input */
+	if ((me == NULL) || ((payload == NULL) != (size == 0U)))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
 
-				/* Change state */
-				if (hasParentReturnCode == 1)
-				{
-					state_t* const parent =
-					    currentState->itsParentState;
+	if (errorCode == 0)
+	{
+		me->eventType = eventType;
+		me->data      = NULL;
 
-					if (currentState->itsParentState ==
-					    nextState->itsParentState)
-					{
-						/*
-						 * Have common parent (but not NULL)
-						 */
-						parent->itsHistoryState =
-						    nextState;
-						msg =
-						    "(Common parent): Child --> Child";
-					}
-					else
-					{
-						/*
-						 * We exit a parent state so parent should exit also
-						 */
-						parent->itsMode =
-						    HSM_ST_M_ON_EXIT;
-						nextState = parent;
-						msg =
-						    "(Parent shouldExit also) --> ";
-					}
-				}
-				else if (hasParentReturnCode == 0)
-				{
-					if (currentState->itsTransition ==
-					    NULL)
-					{
-						//printf( "Name: %s\n", currentState->itsHistoryState->itsTransition[0].targetState->itsName );
-						nextState = state_getTop(
-						    currentState
-						        ->itsHistoryState
-						        ->itsTransition[0]
-						        .targetState);
-						msg =
-						    "(Change TOP)Top --> Top";
-					}
-					else
-					{
-						nextState =
-						    state_getTop(nextState);
-						msg =
-						    "? ? ? (Change TOP)Top --> Top";
-					}
-				}
-				else
-				{
-					/* Error */
-					errorCode = -1;
-				}
+		if (size > HSM_EVENT_INLINE_SIZE)
+		{
+			/* Too large */
+			me->data  = payload;
+			errorCode = 1;
+		}
+#if HSM_EVENT_INLINE_SIZE > 0
+		else if (size != 0U)
+		{
+			(void)memcpy(me->itsInline, payload, size);
+		}
+#endif
+		else
+		{
+			/* No payload */
+		}
+	}
 
-				/* Execute onExit */
-				if (errorCode == 0)
-				{
-					if (!state_exec_onExit(currentState,
-					                       event))
-					{
-						/* Fail */
-						errorCode = -1;
-					}
-				}
+	return errorCode;
+}
 
-				/* Current state is old now */
-				if (errorCode == 0)
-				{
-					nextStateMode = HSM_ST_M_ON_ENTRY;
-				}
+/**
+ * \brief Gets the payload of an event.
+ *
+ * \param[in] me The event.
+ *
+ * \return The payload, inline or not. Meaningless if the event has none.
+ */
+const void* hsm_event_getData(const hsm_event_t* const me)
+{
+	const void* data = NULL;
 
-				break;
-			}
+	if (me != NULL)
+	{
+		data = me->data;
+#if HSM_EVENT_INLINE_SIZE > 0
+		data = (data != NULL) ? data : me->itsInline;
+#endif
+	}
+
+	return data;
+}
+
+#if HSM_STATS
+/**
+ * \brief Starts counting the states and transitions of a machine.
+ *
+ * The counters are allocated and attached to the states, so a state counts
+ * for a single machine.
+ *
+ * \param[in,out] me The hierarchical state machine handle.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_stats_init(hsm_t* const me)
+{
+	int      errorCode     = 0;
+	uint32_t transitionNum = 0U;
+
+	/* Check valid input */
+	if ((me == NULL) || (me->allStates == NULL) || (me->itsStats != NULL))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	for (uint32_t i = 0U; (errorCode == 0) && (i < me->allStatesSize); i++)
+	{
+		if (me->allStates[i]->itsTransition != NULL)
+		{
+			transitionNum += me->allStates[i]->itsTransitionNum;
+		}
+	}
+
+	if (errorCode == 0)
+	{
+		const size_t size =
+		    sizeof(hsm_stats_t) +
+		    (me->allStatesSize * sizeof(hsm_state_stats_t)) +
+		    (transitionNum * sizeof(uint64_t));
+
+		// cppcheck-suppress misra-c2012-21.3
+		hsm_stats_t* const stats = (hsm_stats_t*)calloc(1U, size);
+
+		if (stats == NULL)
+		{
+			/* Out of memory */
+			errorCode = -1;
+		}
+		else
+		{
+			uint64_t* fireNum = NULL;
 
-			default:
+			stats->itsStates = (hsm_state_stats_t*)&stats[1];
+			stats->itsFireNums =
+			    (uint64_t*)&stats->itsStates[me->allStatesSize];
+			fireNum = stats->itsFireNums;
+
+			for (uint32_t i = 0U; i < me->allStatesSize; i++)
 			{
-				/* Fail */
-				errorCode = -1;
+				state_t* const state = me->allStates[i];
+
+				stats->itsStates[i].itsFireNum = fireNum;
+				state->itsStats = &stats->itsStates[i];
+
+				if (state->itsTransition != NULL)
+				{
+					fireNum += state->itsTransitionNum;
+				}
 			}
+
+			me->itsStats = stats;
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Stops counting and frees the counters.
+ *
+ * \param[in,out] me The hierarchical state machine handle.
+ */
+void hsm_stats_destroy(hsm_t* const me)
+{
+	if ((me != NULL) && (me->itsStats != NULL))
+	{
+		for (uint32_t i = 0U; i < me->allStatesSize; i++)
+		{
+			me->allStates[i]->itsStats = NULL;
 		}
 
-		hsm_debug(currentState, nextState, msg);
+		// cppcheck-suppress misra-c2012-21.3
+		free(me->itsStats);
+		me->itsStats = NULL;
 	}
+}
 
-	if (errorCode == 0)
+/**
+ * \brief Sets all the counters of a machine to zero.
+ *
+ * \param[in,out] me The hierarchical state machine handle.
+ */
+void hsm_stats_reset(hsm_t* const me)
+{
+	if ((me != NULL) && (me->itsStats != NULL))
 	{
-		me->itsCurrentState->itsMode = nextStateMode;
-		me->itsCurrentState          = nextState;
+		hsm_stats_t* const stats = me->itsStats;
 
-		/* Check for event signal */
-		if (event == NULL)
+		for (uint32_t i = 0U; i < me->allStatesSize; i++)
 		{
-			/* No event signal given */
-			errorCode = 1;
+			hsm_state_stats_t* const aux = &stats->itsStates[i];
+			const state_t* const     state = me->allStates[i];
+			const uint32_t           transitionNum =
+			    (state->itsTransition != NULL)
+			        ? state->itsTransitionNum
+			        : 0U;
+
+			aux->itsEntryNum = 0U;
+			aux->itsExitNum  = 0U;
+			aux->itsEventNum = 0U;
+			aux->itsDuringNs = 0U;
+			aux->itsGuardNs  = 0U;
+			aux->itsActionNs = 0U;
+
+			for (uint32_t j = 0U; j < transitionNum; j++)
+			{
+				aux->itsFireNum[j] = 0U;
+			}
+		}
+
+		for (uint32_t i = 0U; i < HSM_STATS_BUCKET_NUM; i++)
+		{
+			stats->itsLatency[i] = 0U;
 		}
 	}
+}
 
-	/* Success */
-	return errorCode;
+/**
+ * \brief Gets the counters of a machine.
+ *
+ * \param[in] me The hierarchical state machine handle.
+ *
+ * \return The counters, NULL if it does not count.
+ */
+const hsm_stats_t* hsm_stats_get(const hsm_t* const me)
+{
+	return (me != NULL) ? me->itsStats : NULL;
+}
+
+/**
+ * \brief Gets the counters of a state of a machine.
+ *
+ * \param[in] me    The hierarchical state machine handle.
+ * \param[in] state The hsm state.
+ *
+ * \return The counters, NULL if it does not count.
+ */
+const hsm_state_stats_t* hsm_stats_getState(const hsm_t* const   me,
+                                            const state_t* const state)
+{
+	const hsm_state_stats_t* stats = NULL;
+
+	if ((me != NULL) && (me->itsStats != NULL) && (state != NULL))
+	{
+		stats = state->itsStats;
+	}
+
+	return stats;
 }
+#endif
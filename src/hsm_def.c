@@ -0,0 +1,1440 @@
+// ############################################################################
+// ############################################################################
+// Code
+
+// ############################################################################
+// ############################################################################
+// Include files
+
+#include "hsm_def.h"
+#include "hsm_trace.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+// ############################################################################
+// ############################################################################
+// Local definitions
+
+/**
+ * \brief Alignment of the tables in the definition's memory.
+ */
+#define HSM_DEF_ALIGNMENT (8U)
+
+/**
+ * \brief The writable tables of a definition that is being built.
+ */
+typedef struct
+{
+	hsm_state_id_t*       itsParent;          /**< Parent of each. */
+	hsm_state_id_t*       itsInitial;         /**< Initial of each. */
+	hsm_state_id_t*       itsHistorySlot;     /**< History of each. */
+	uint8_t*              itsActions;         /**< Actions of each. */
+	uint32_t*             itsTransitionFirst; /**< First transition. */
+	hsm_def_transition_t* itsTransitions;     /**< All the transitions. */
+} def_tables_t;
+
+// ############################################################################
+// ############################################################################
+// Local functions
+
+/*
+ * Definition related
+ */
+static size_t def_align(const size_t size);
+static void*  def_carve(uint8_t** const cursor, const size_t size);
+static hsm_state_id_t def_findState(const state_t* const state,
+                                    const state_t* const allStates[],
+                                    const uint32_t       allStatesSize);
+static bool           def_link(hsm_def_t* const          me,
+                               const def_tables_t* const tables);
+static bool           def_validate(const hsm_def_t* const me);
+static bool           def_plan(hsm_def_t* const            me,
+                               hsm_def_transition_t* const transitions);
+static int            def_getPath(const hsm_def_t* const me,
+                                  const hsm_state_id_t   state,
+                                  const hsm_state_id_t   ancestor,
+                                  hsm_state_id_t         path[]);
+static hsm_state_id_t def_getLca(const hsm_def_t* const me,
+                                 const hsm_state_id_t   source,
+                                 const hsm_state_id_t   target);
+static bool def_isTriggered(const hsm_transition_t* const transition,
+                            const uint32_t                eventType);
+static bool     def_hasDuring(const hsm_def_t* const me,
+                              const hsm_state_id_t   state);
+static uint32_t def_fillCandidates(const hsm_def_t* const me,
+                                   const hsm_state_id_t   state,
+                                   const uint32_t         eventType,
+                                   uint32_t* const        candidates);
+
+/*
+ * Instance related
+ */
+static int  inst_enterState(hsm_inst_t* const        me,
+                            const hsm_state_id_t     state,
+                            const hsm_event_t* const event);
+static int  inst_enter(hsm_inst_t* const          me,
+                       const hsm_state_id_t* const entries,
+                       const uint32_t              entryNum,
+                       const hsm_event_t* const    event);
+static int  inst_exit(hsm_inst_t* const        me,
+                      const uint32_t           exitNum,
+                      const hsm_event_t* const event);
+static int  inst_during(const hsm_inst_t* const  me,
+                        const hsm_event_t* const event);
+static bool inst_findTransition(const hsm_inst_t* const  me,
+                                const hsm_event_t* const event,
+                                uint32_t* const          transition);
+static void inst_trace(const hsm_inst_t* const  me,
+                       const hsm_state_id_t     source,
+                       const hsm_event_t* const event);
+
+/**
+ * \brief Rounds a size up to the tables' alignment.
+ *
+ * \param[in] size The size in bytes.
+ *
+ * \return The aligned size in bytes.
+ */
+static size_t def_align(const size_t size)
+{
+	return (size + (HSM_DEF_ALIGNMENT - 1U)) &
+	       ~((size_t)HSM_DEF_ALIGNMENT - 1U);
+}
+
+/**
+ * \brief Carves a table out of the definition's memory.
+ *
+ * \param[in,out] cursor The next free byte of the memory.
+ * \param[in]     size   The size of the table in bytes.
+ *
+ * \return The table.
+ */
+static void* def_carve(uint8_t** const cursor, const size_t size)
+{
+	void* const table = *cursor;
+
+	*cursor = &(*cursor)[def_align(size)];
+
+	return table;
+}
+
+/**
+ * \brief Finds the id of a state.
+ *
+ * \param[in] state         The hsm state.
+ * \param[in] allStates     A list with all the hsm's states.
+ * \param[in] allStatesSize The number of the hsm's states.
+ *
+ * \return The state's id, HSM_STATE_ID_NONE if not in the list.
+ */
+static hsm_state_id_t def_findState(const state_t* const state,
+                                    const state_t* const allStates[],
+                                    const uint32_t       allStatesSize)
+{
+	hsm_state_id_t id = HSM_STATE_ID_NONE;
+
+	for (uint32_t i = 0U; (i < allStatesSize) && (id == HSM_STATE_ID_NONE);
+	     i++)
+	{
+		if (allStates[i] == state)
+		{
+			id = (hsm_state_id_t)i;
+		}
+	}
+
+	return id;
+}
+
+/**
+ * \brief Turns the pointers of the states into ids.
+ *
+ * \param[in,out] me     The definition.
+ * \param[out]    tables The definition's tables.
+ *
+ * \return True on success, False if a state is missing from the list.
+ */
+static bool def_link(hsm_def_t* const me, const def_tables_t* const tables)
+{
+	hsm_state_id_t* const parent      = tables->itsParent;
+	hsm_state_id_t* const initial     = tables->itsInitial;
+	hsm_state_id_t* const historySlot = tables->itsHistorySlot;
+	uint32_t* const       first       = tables->itsTransitionFirst;
+	bool                  success     = true;
+	uint32_t              transition  = 0U;
+	uint32_t              history     = 0U;
+
+	for (uint32_t i = 0U; (i < me->itsStateNum) && success; i++)
+	{
+		const state_t* const state = me->itsStates[i];
+
+		/* Parent */
+		parent[i] = HSM_STATE_ID_NONE;
+
+		if (state->itsParentState != NULL)
+		{
+			parent[i] = def_findState(state->itsParentState,
+			                          me->itsStates,
+			                          me->itsStateNum);
+			success   = (parent[i] != HSM_STATE_ID_NONE);
+		}
+
+		/* Actions */
+		tables->itsActions[i] =
+		    (uint8_t)(((state->onEntry != NULL) ? HSM_DEF_ACTION_ENTRY
+		                                        : 0U) |
+		              ((state->during != NULL) ? HSM_DEF_ACTION_DURING
+		                                       : 0U) |
+		              ((state->onExit != NULL) ? HSM_DEF_ACTION_EXIT
+		                                       : 0U));
+
+		/* Initial child and its history slot */
+		initial[i]     = HSM_STATE_ID_NONE;
+		historySlot[i] = HSM_STATE_ID_NONE;
+
+		if (success && (state->itsInitialState != NULL))
+		{
+			initial[i] = def_findState(state->itsInitialState,
+			                           me->itsStates,
+			                           me->itsStateNum);
+			success    = (initial[i] != HSM_STATE_ID_NONE);
+
+			if (state->itsHistory != HSM_HISTORY_NONE)
+			{
+				historySlot[i] = (hsm_state_id_t)history;
+				history++;
+			}
+
+			if (state->itsHistory == HSM_HISTORY_DEEP)
+			{
+				tables->itsActions[i] |= HSM_DEF_HISTORY_DEEP;
+			}
+		}
+
+		/* Transitions */
+		first[i] = transition;
+
+		for (uint32_t j = 0U;
+		     success && (state->itsTransition != NULL) &&
+		     (j < state->itsTransitionNum);
+		     j++)
+		{
+			hsm_def_transition_t* const aux =
+			    &tables->itsTransitions[transition];
+			const state_t* const target =
+			    state->itsTransition[j].targetState;
+
+			aux->itsTransition = &state->itsTransition[j];
+			aux->itsSource     = (hsm_state_id_t)i;
+			aux->itsTarget     = HSM_STATE_ID_NONE;
+
+			if (target != NULL)
+			{
+				aux->itsTarget =
+				    def_findState(target,
+				                  me->itsStates,
+				                  me->itsStateNum);
+				success =
+				    (aux->itsTarget != HSM_STATE_ID_NONE);
+			}
+
+			transition++;
+		}
+	}
+
+	first[me->itsStateNum] = transition;
+	me->itsHistoryNum      = history;
+
+	return success;
+}
+
+/**
+ * \brief Validates the topology of a linked definition.
+ *
+ * \param[in] me The definition.
+ *
+ * \return True if valid, False otherwise.
+ */
+static bool def_validate(const hsm_def_t* const me)
+{
+	const hsm_state_id_t initialState = me->itsInitialState;
+	bool success = (me->itsParent[initialState] == HSM_STATE_ID_NONE);
+
+	for (uint32_t i = 0U; (i < me->itsStateNum) && success; i++)
+	{
+		hsm_state_id_t path[HSM_MAX_DEPTH];
+
+		/* Not too deep and no loops */
+		success = (def_getPath(me,
+		                       (hsm_state_id_t)i,
+		                       HSM_STATE_ID_NONE,
+		                       path) > 0);
+
+		/* The initial child is a child */
+		if (success && (me->itsInitial[i] != HSM_STATE_ID_NONE))
+		{
+			success = (me->itsParent[me->itsInitial[i]] == i);
+		}
+	}
+
+	return success;
+}
+
+/**
+ * \brief Gets the states from a state up to one of its ancestors.
+ *
+ * The path starts with the state itself and ends with the child of the
+ * ancestor. The ancestor is excluded.
+ *
+ * \param[in]  me       The definition.
+ * \param[in]  state    The state.
+ * \param[in]  ancestor The ancestor to stop at, NONE for the top state.
+ * \param[out] path     The path, at least HSM_MAX_DEPTH in size.
+ *
+ * \return The number of states in the path, -1 on failure.
+ */
+static int def_getPath(const hsm_def_t* const me,
+                       const hsm_state_id_t   state,
+                       const hsm_state_id_t   ancestor,
+                       hsm_state_id_t         path[])
+{
+	int            pathSize = 0;
+	hsm_state_id_t aux      = state;
+
+	while ((aux != ancestor) && (pathSize >= 0))
+	{
+		if ((aux == HSM_STATE_ID_NONE) ||
+		    (pathSize >= (int)HSM_MAX_DEPTH))
+		{
+			/* Not an ancestor or too deep */
+			pathSize = -1;
+		}
+		else
+		{
+			path[pathSize] = aux;
+			pathSize++;
+			aux = me->itsParent[aux];
+		}
+	}
+
+	return pathSize;
+}
+
+/**
+ * \brief Gets the least common ancestor of a transition.
+ *
+ * It is the deepest state that is a proper ancestor of both the source and
+ * the target, so a transition to self exits and re-enters the state.
+ *
+ * \param[in] me     The definition.
+ * \param[in] source The transition's source state.
+ * \param[in] target The transition's target state.
+ *
+ * \return The least common ancestor, NONE if it is above the top states.
+ */
+static hsm_state_id_t def_getLca(const hsm_def_t* const me,
+                                 const hsm_state_id_t   source,
+                                 const hsm_state_id_t   target)
+{
+	hsm_state_id_t lca   = me->itsParent[source];
+	bool           found = false;
+
+	while ((lca != HSM_STATE_ID_NONE) && !found)
+	{
+		/* Check if it is also an ancestor of the target */
+		hsm_state_id_t aux = me->itsParent[target];
+
+		while ((aux != HSM_STATE_ID_NONE) && (aux != lca))
+		{
+			aux = me->itsParent[aux];
+		}
+
+		if (aux == lca)
+		{
+			found = true;
+		}
+		else
+		{
+			lca = me->itsParent[lca];
+		}
+	}
+
+	return lca;
+}
+
+/**
+ * \brief Precomputes the paths of the states and the transitions.
+ *
+ * Every state gets its path up to the top, which lists the states to exit
+ * from it and, reversed, the active states outermost first. Every transition
+ * gets its least common ancestor and the states to enter down to its target.
+ *
+ * \param[in,out] me          The linked and valid definition.
+ * \param[in,out] transitions The definition's transitions.
+ *
+ * \return True on success, False if out of memory.
+ */
+static bool def_plan(hsm_def_t* const            me,
+                     hsm_def_transition_t* const transitions)
+{
+	hsm_state_id_t path[HSM_MAX_DEPTH];
+	uint32_t       pathNum  = 0U;
+	uint32_t       entryNum = 0U;
+
+	/* Count */
+	for (uint32_t i = 0U; i < me->itsStateNum; i++)
+	{
+		pathNum += (uint32_t)def_getPath(me,
+		                                 (hsm_state_id_t)i,
+		                                 HSM_STATE_ID_NONE,
+		                                 path);
+	}
+
+	for (uint32_t i = 0U; i < me->itsTransitionNum; i++)
+	{
+		hsm_def_transition_t* const aux = &transitions[i];
+
+		aux->itsLca      = HSM_STATE_ID_NONE;
+		aux->itsLcaLevel = 0U;
+		aux->itsEntryNum = 0U;
+
+		if (aux->itsTarget != HSM_STATE_ID_NONE)
+		{
+			const hsm_state_id_t lca =
+			    def_getLca(me, aux->itsSource, aux->itsTarget);
+			const int num =
+			    def_getPath(me, aux->itsTarget, lca, path);
+
+			aux->itsLca      = lca;
+			aux->itsEntryNum = (uint16_t)num;
+			entryNum += (uint32_t)num;
+		}
+	}
+
+	/* Allocate */
+	const size_t firstSize =
+	    def_align((me->itsStateNum + 1U) * sizeof(uint32_t));
+	const size_t pathSize  = def_align(pathNum * sizeof(hsm_state_id_t));
+	const size_t entrySize = def_align(entryNum * sizeof(hsm_state_id_t));
+
+	// cppcheck-suppress misra-c2012-21.3
+	uint8_t* cursor = (uint8_t*)malloc(firstSize + pathSize + entrySize);
+
+	me->itsPathMemory = cursor;
+
+	if (cursor != NULL)
+	{
+		uint32_t* const pathFirst = def_carve(&cursor, firstSize);
+		hsm_state_id_t* const paths = def_carve(&cursor, pathSize);
+		hsm_state_id_t* const entries =
+		    def_carve(&cursor, entrySize);
+
+		me->itsPathFirst = pathFirst;
+		me->itsPaths     = paths;
+		me->itsEntries   = entries;
+
+		/* Paths from the state up to the top */
+		uint32_t first = 0U;
+
+		for (uint32_t i = 0U; i < me->itsStateNum; i++)
+		{
+			pathFirst[i] = first;
+			first += (uint32_t)def_getPath(me,
+			                               (hsm_state_id_t)i,
+			                               HSM_STATE_ID_NONE,
+			                               &paths[first]);
+		}
+
+		pathFirst[me->itsStateNum] = first;
+
+		/* Entries from below the LCA down to the target */
+		first = 0U;
+
+		for (uint32_t i = 0U; i < me->itsTransitionNum; i++)
+		{
+			hsm_def_transition_t* const aux = &transitions[i];
+			const hsm_state_id_t        lca = aux->itsLca;
+			const uint32_t       num = aux->itsEntryNum;
+
+			aux->itsEntryFirst = first;
+
+			if (lca != HSM_STATE_ID_NONE)
+			{
+				aux->itsLcaLevel =
+				    (uint16_t)(pathFirst[lca + 1U] -
+				               pathFirst[lca]);
+			}
+
+			/* Outermost first */
+			(void)def_getPath(me, aux->itsTarget, lca, path);
+
+			for (uint32_t j = 0U; j < num; j++)
+			{
+				entries[first + j] = path[num - 1U - j];
+			}
+
+			first += num;
+		}
+	}
+
+	return (cursor != NULL);
+}
+
+/**
+ * \brief Checks if an event type triggers the transition.
+ *
+ * \param[in] transition The hsm transition.
+ * \param[in] eventType  The event type, HSM_EVENT_ANY for no event.
+ *
+ * \retval True  The event type is the transition's trigger.
+ * \retval False The event type is not the transition's trigger.
+ */
+static bool def_isTriggered(const hsm_transition_t* const transition,
+                            const uint32_t                eventType)
+{
+	return (transition->eventType == HSM_EVENT_ANY) ||
+	       (transition->eventType == eventType);
+}
+
+/**
+ * \brief Checks if a state or any of its ancestors has a during action.
+ *
+ * \param[in] me    The definition.
+ * \param[in] state The state.
+ *
+ * \return True if a during action runs on every event, False otherwise.
+ */
+static bool def_hasDuring(const hsm_def_t* const me,
+                          const hsm_state_id_t   state)
+{
+	bool           hasDuring = false;
+	hsm_state_id_t aux       = state;
+
+	while ((aux != HSM_STATE_ID_NONE) && !hasDuring)
+	{
+		hasDuring =
+		    ((me->itsActions[aux] & HSM_DEF_ACTION_DURING) != 0U);
+		aux       = me->itsParent[aux];
+	}
+
+	return hasDuring;
+}
+
+/**
+ * \brief Lists the transitions a state checks for an event type.
+ *
+ * The list is in the order they are checked: the state's own transitions
+ * first and then the ones inherited from its ancestors.
+ *
+ * \param[in]  me         The definition.
+ * \param[in]  state      The state.
+ * \param[in]  eventType  The event type.
+ * \param[out] candidates The transitions, NULL to only count them.
+ *
+ * \return The number of transitions.
+ */
+static uint32_t def_fillCandidates(const hsm_def_t* const me,
+                                   const hsm_state_id_t   state,
+                                   const uint32_t         eventType,
+                                   uint32_t* const        candidates)
+{
+	uint32_t       candidateNum = 0U;
+	hsm_state_id_t aux          = state;
+
+	while (aux != HSM_STATE_ID_NONE)
+	{
+		for (uint32_t i = me->itsTransitionFirst[aux];
+		     i < me->itsTransitionFirst[aux + 1U];
+		     i++)
+		{
+			const hsm_transition_t* const transition =
+			    me->itsTransitions[i].itsTransition;
+
+			if (def_isTriggered(transition, eventType))
+			{
+				if (candidates != NULL)
+				{
+					candidates[candidateNum] = i;
+				}
+
+				candidateNum++;
+			}
+		}
+
+		aux = me->itsParent[aux];
+	}
+
+	return candidateNum;
+}
+
+/**
+ * \brief Enters a single state.
+ *
+ * \param[in,out] me    The instance.
+ * \param[in]     state The state to enter.
+ * \param[in]     event The event signal.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int inst_enterState(hsm_inst_t* const        me,
+                           const hsm_state_id_t     state,
+                           const hsm_event_t* const event)
+{
+	const hsm_def_t* const def       = me->itsDef;
+	const hsm_state_id_t   parent    = def->itsParent[state];
+	int                    errorCode = 0;
+
+	if ((def->itsActions[state] & HSM_DEF_ACTION_ENTRY) != 0U)
+	{
+		const state_t* const aux = def->itsStates[state];
+
+		if (!aux->onEntry(aux, event))
+		{
+			/* Fail */
+			errorCode = -1;
+		}
+	}
+
+	if (errorCode == 0)
+	{
+		/* Remember it for a shallow history pseudostate */
+		if ((parent != HSM_STATE_ID_NONE) &&
+		    (def->itsHistorySlot[parent] != HSM_STATE_ID_NONE) &&
+		    ((def->itsActions[parent] & HSM_DEF_HISTORY_DEEP) == 0U))
+		{
+			me->itsHistory[def->itsHistorySlot[parent]] = state;
+		}
+
+		me->itsCurrentState = state;
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Enters a list of states and then down to a leaf.
+ *
+ * \param[in,out] me       The instance.
+ * \param[in]     entries  The states to enter, outermost first.
+ * \param[in]     entryNum The number of states to enter.
+ * \param[in]     event    The event signal.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int inst_enter(hsm_inst_t* const           me,
+                      const hsm_state_id_t* const entries,
+                      const uint32_t              entryNum,
+                      const hsm_event_t* const    event)
+{
+	const hsm_def_t* const def       = me->itsDef;
+	int                    errorCode = 0;
+
+	/* Enter from the outermost state down to the target */
+	for (uint32_t i = 0U; (i < entryNum) && (errorCode == 0); i++)
+	{
+		errorCode = inst_enterState(me, entries[i], event);
+	}
+
+	/* Enter down to a leaf, through the history pseudostates */
+	hsm_state_id_t state = me->itsCurrentState;
+
+	while ((errorCode == 0) &&
+	       (def->itsInitial[state] != HSM_STATE_ID_NONE))
+	{
+		const hsm_state_id_t slot   = def->itsHistorySlot[state];
+		const hsm_state_id_t resume = (slot == HSM_STATE_ID_NONE)
+		                                  ? def->itsInitial[state]
+		                                  : me->itsHistory[slot];
+		const uint32_t       first  = def->itsPathFirst[resume];
+
+		/* A deep history goes straight down the path of its leaf */
+		uint32_t i = (def->itsPathFirst[resume + 1U] - first) -
+		             (def->itsPathFirst[state + 1U] -
+		              def->itsPathFirst[state]);
+
+		while ((i > 0U) && (errorCode == 0))
+		{
+			i--;
+			errorCode = inst_enterState(me,
+			                            def->itsPaths[first + i],
+			                            event);
+		}
+
+		state = resume;
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Exits a number of states from the current leaf upwards.
+ *
+ * \param[in,out] me      The instance.
+ * \param[in]     exitNum The number of states to exit.
+ * \param[in]     event   The event signal.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int inst_exit(hsm_inst_t* const        me,
+                     const uint32_t           exitNum,
+                     const hsm_event_t* const event)
+{
+	const hsm_def_t* const      def = me->itsDef;
+	const hsm_state_id_t* const path =
+	    &def->itsPaths[def->itsPathFirst[me->itsCurrentState]];
+	int errorCode = 0;
+
+	for (uint32_t i = 0U; (i < exitNum) && (errorCode == 0); i++)
+	{
+		if ((def->itsActions[path[i]] & HSM_DEF_ACTION_EXIT) != 0U)
+		{
+			const state_t* const state = def->itsStates[path[i]];
+
+			if (!state->onExit(state, event))
+			{
+				/* Fail */
+				errorCode = -1;
+			}
+		}
+
+		/* A deep history remembers the leaf it is left in */
+		if ((errorCode == 0) &&
+		    ((def->itsActions[path[i]] & HSM_DEF_HISTORY_DEEP) != 0U))
+		{
+			me->itsHistory[def->itsHistorySlot[path[i]]] = path[0];
+		}
+
+		if (errorCode == 0)
+		{
+			me->itsCurrentState = def->itsParent[path[i]];
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Executes the during action of all active states, outermost first.
+ *
+ * \param[in] me    The instance.
+ * \param[in] event The event signal.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int inst_during(const hsm_inst_t* const  me,
+                       const hsm_event_t* const event)
+{
+	const hsm_def_t* const def       = me->itsDef;
+	const hsm_state_id_t   leaf      = me->itsCurrentState;
+	const uint32_t         first     = def->itsPathFirst[leaf];
+	uint32_t               i         = def->itsPathFirst[leaf + 1U];
+	int                    errorCode = 0;
+
+	while ((i > first) && (errorCode == 0))
+	{
+		i--;
+
+		const hsm_state_id_t id = def->itsPaths[i];
+
+		if ((def->itsActions[id] & HSM_DEF_ACTION_DURING) != 0U)
+		{
+			const state_t* const state = def->itsStates[id];
+
+			if (!state->during(state, event))
+			{
+				/* Fail */
+				errorCode = -1;
+			}
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Finds the first enabled transition of the active states.
+ *
+ * The current leaf is checked first and then its ancestors. Only transitions
+ * triggered by the event are checked. With a compiled definition they are
+ * looked up in the transition table instead of walking up the parents.
+ *
+ * \param[in]  me         The instance.
+ * \param[in]  event      The event signal.
+ * \param[out] transition The index of the transition in the definition.
+ *
+ * \return True if a transition is enabled, False otherwise.
+ */
+static bool inst_findTransition(const hsm_inst_t* const  me,
+                                const hsm_event_t* const event,
+                                uint32_t* const          transition)
+{
+	const hsm_def_t* const def = me->itsDef;
+	const uint32_t         eventType =
+	    (event != NULL) ? event->eventType : HSM_EVENT_ANY;
+	bool found = false;
+
+	if (def->itsTable != NULL)
+	{
+		/* Out of the table's range only HSM_EVENT_ANY can trigger */
+		const uint32_t column = (eventType < def->itsEventTypeNum)
+		                            ? eventType
+		                            : HSM_EVENT_ANY;
+		const uint32_t cell =
+		    (me->itsCurrentState * def->itsEventTypeNum) + column;
+
+		for (uint32_t i = def->itsTable[cell];
+		     (i < def->itsTable[cell + 1U]) && !found;
+		     i++)
+		{
+			const hsm_def_transition_t* const aux =
+			    &def->itsTransitions[def->itsCandidates[i]];
+
+			if ((aux->itsTransition->guard == NULL) ||
+			    aux->itsTransition->guard(
+			        def->itsStates[aux->itsSource],
+			        event))
+			{
+				*transition = def->itsCandidates[i];
+				found       = true;
+			}
+		}
+	}
+	else
+	{
+		hsm_state_id_t state = me->itsCurrentState;
+
+		while ((state != HSM_STATE_ID_NONE) && !found)
+		{
+			const state_t* const source = def->itsStates[state];
+			const uint32_t       last =
+			    def->itsTransitionFirst[state + 1U];
+
+			for (uint32_t i = def->itsTransitionFirst[state];
+			     (i < last) && !found;
+			     i++)
+			{
+				const hsm_transition_t* const aux =
+				    def->itsTransitions[i].itsTransition;
+
+				if (def_isTriggered(aux, eventType) &&
+				    ((aux->guard == NULL) ||
+				     aux->guard(source, event)))
+				{
+					*transition = i;
+					found       = true;
+				}
+			}
+
+			state = def->itsParent[state];
+		}
+	}
+
+	return found;
+}
+
+/**
+ * \brief Writes a trace record of a transition.
+ *
+ * \param[in] me     The instance.
+ * \param[in] source The transition's source state.
+ * \param[in] event  The event signal.
+ */
+static void inst_trace(const hsm_inst_t* const  me,
+                       const hsm_state_id_t     source,
+                       const hsm_event_t* const event)
+{
+#if HSM_TRACE
+	hsm_trace_write(me->itsTraceId,
+	                (event != NULL) ? event->eventType : HSM_EVENT_ANY,
+	                (uint16_t)source,
+	                (uint16_t)me->itsCurrentState,
+	                (uint8_t)HSM_ST_M_TAKING_ACTION,
+	                (uint8_t)HSM_ST_M_DURING);
+#else
+	(void)me;
+	(void)source;
+	(void)event;
+#endif
+}
+
+// ############################################################################
+// ############################################################################
+// Function definitions
+
+/**
+ * \brief Builds a shared hierarchical state machine definition.
+ *
+ * For valid definition initial state must be a top level state. (no parent)
+ * Every parent, initial and target state must be in the list.
+ *
+ * Use \see hsm_def_build instead.
+ *
+ * \param[out] me            The definition.
+ * \param[in]  initialState  The state that the instances will begin with.
+ * \param[in]  allStates     A list with all the hsm's states.
+ * \param[in]  allStatesSize The number of the hsm's states.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int _hsm_def_build(hsm_def_t* const     me,
+                   const state_t* const initialState,
+                   const state_t* const allStates[],
+                   const uint32_t       allStatesSize)
+{
+	int          errorCode     = 0;
+	uint32_t     transitionNum = 0U;
+	def_tables_t tables;
+
+	/* Check valid input */
+	if (me == NULL)
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+	else
+	{
+		/* Nothing is allocated yet */
+		me->itsMemory      = NULL;
+		me->itsPathMemory  = NULL;
+		me->itsTableMemory = NULL;
+		me->itsTable       = NULL;
+		me->itsActive      = NULL;
+		me->itsStateNum    = 0U;
+
+		if ((initialState == NULL) || (allStates == NULL) ||
+		    (allStatesSize == 0U) ||
+		    (allStatesSize >= HSM_STATE_ID_NONE))
+		{
+			/* Invalid input. */
+			errorCode = -1;
+		}
+	}
+
+	/* Count the transitions */
+	for (uint32_t i = 0U; (errorCode == 0) && (i < allStatesSize); i++)
+	{
+		if (allStates[i] == NULL)
+		{
+			/* Invalid input. */
+			errorCode = -1;
+		}
+		else if (allStates[i]->itsTransition != NULL)
+		{
+			transitionNum += allStates[i]->itsTransitionNum;
+		}
+		else
+		{
+			/* No action */
+		}
+	}
+
+	/* Allocate the tables */
+	if (errorCode == 0)
+	{
+		const size_t idSize = allStatesSize * sizeof(hsm_state_id_t);
+		const size_t size =
+		    (3U * def_align(idSize)) + def_align(allStatesSize) +
+		    def_align((allStatesSize + 1U) * sizeof(uint32_t)) +
+		    def_align(transitionNum * sizeof(hsm_def_transition_t));
+
+		// cppcheck-suppress misra-c2012-21.3
+		uint8_t* cursor = (uint8_t*)malloc(size);
+
+		me->itsMemory = cursor;
+
+		if (cursor == NULL)
+		{
+			/* Out of memory */
+			errorCode = -1;
+		}
+		else
+		{
+			me->itsStates        = allStates;
+			me->itsStateNum      = allStatesSize;
+			me->itsTransitionNum = transitionNum;
+
+			tables.itsParent      = def_carve(&cursor, idSize);
+			tables.itsInitial     = def_carve(&cursor, idSize);
+			tables.itsHistorySlot = def_carve(&cursor, idSize);
+			tables.itsActions = def_carve(&cursor, allStatesSize);
+			tables.itsTransitionFirst = def_carve(
+			    &cursor,
+			    (allStatesSize + 1U) * sizeof(uint32_t));
+			tables.itsTransitions = def_carve(
+			    &cursor,
+			    transitionNum * sizeof(hsm_def_transition_t));
+
+			me->itsParent          = tables.itsParent;
+			me->itsInitial         = tables.itsInitial;
+			me->itsHistorySlot     = tables.itsHistorySlot;
+			me->itsActions         = tables.itsActions;
+			me->itsTransitionFirst = tables.itsTransitionFirst;
+			me->itsTransitions     = tables.itsTransitions;
+		}
+	}
+
+	/* Link and validate */
+	if (errorCode == 0)
+	{
+		me->itsInitialState =
+		    def_findState(initialState, allStates, allStatesSize);
+
+		if ((me->itsInitialState == HSM_STATE_ID_NONE) ||
+		    !def_link(me, &tables) || !def_validate(me) ||
+		    !def_plan(me, tables.itsTransitions))
+		{
+			/* Invalid topology */
+			hsm_def_destroy(me);
+			errorCode = -1;
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Compiles the transition table of a definition.
+ *
+ * For every state and event type the table lists the transitions to check,
+ * including the ones inherited from the parents, so the dispatch of an event
+ * no longer walks up the hierarchy.
+ *
+ * Event types must be below eventTypeNum, events of other types only trigger
+ * HSM_EVENT_ANY transitions.
+ *
+ * \param[in,out] me           The definition.
+ * \param[in]     eventTypeNum The number of event types.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_def_compile(hsm_def_t* const me, const uint32_t eventTypeNum)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (eventTypeNum == 0U))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		if (me->itsMemory == NULL)
+		{
+			/* Not built */
+			errorCode = -1;
+		}
+	}
+
+	/* The cells and the end sentinel must fit in a uint32_t index */
+	if (errorCode == 0)
+	{
+		if ((me->itsStateNum == 0U) ||
+		    (eventTypeNum > ((UINT32_MAX - 1U) / me->itsStateNum)))
+		{
+			/* Too large */
+			errorCode = -1;
+		}
+	}
+
+	/* Every trigger must fit in the table */
+	for (uint32_t i = 0U; (errorCode == 0) && (i < me->itsTransitionNum);
+	     i++)
+	{
+		if (me->itsTransitions[i].itsTransition->eventType >=
+		    eventTypeNum)
+		{
+			/* Invalid input. */
+			errorCode = -1;
+		}
+	}
+
+	/* Count the candidates */
+	const uint32_t cellNum =
+	    (errorCode == 0) ? (me->itsStateNum * eventTypeNum) : 0U;
+	uint32_t candidateNum = 0U;
+
+	for (uint32_t cell = 0U; (errorCode == 0) && (cell < cellNum); cell++)
+	{
+		const uint32_t num =
+		    def_fillCandidates(me,
+		                       (hsm_state_id_t)(cell / eventTypeNum),
+		                       cell % eventTypeNum,
+		                       NULL);
+
+		if (num > (UINT32_MAX - candidateNum))
+		{
+			/* Too large */
+			errorCode = -1;
+		}
+		else
+		{
+			candidateNum += num;
+		}
+	}
+
+#if SIZE_MAX <= UINT32_MAX
+	/* The sum of the array sizes must fit in a size_t */
+	if (errorCode == 0)
+	{
+		if ((cellNum >= (SIZE_MAX / (4U * sizeof(uint32_t)))) ||
+		    (candidateNum >= (SIZE_MAX / (4U * sizeof(uint32_t)))))
+		{
+			/* Too large */
+			errorCode = -1;
+		}
+	}
+#endif
+
+	/* Allocate the table */
+	if (errorCode == 0)
+	{
+		const size_t tableSize =
+		    def_align((cellNum + 1U) * sizeof(uint32_t));
+		const size_t activeSize =
+		    def_align(cellNum * sizeof(uint32_t));
+		const size_t candidateSize =
+		    def_align(candidateNum * sizeof(uint32_t));
+		const size_t size = tableSize + activeSize + candidateSize;
+
+		// cppcheck-suppress misra-c2012-21.3
+		free(me->itsTableMemory);
+
+		// cppcheck-suppress misra-c2012-21.3
+		uint8_t* cursor = (uint8_t*)malloc(size);
+
+		me->itsTableMemory  = cursor;
+		me->itsTable        = NULL;
+		me->itsActive       = NULL;
+		me->itsEventTypeNum = 0U;
+
+		if (cursor == NULL)
+		{
+			/* Out of memory */
+			errorCode = -1;
+		}
+		else
+		{
+			uint32_t* const table = def_carve(&cursor, tableSize);
+			uint32_t* const active =
+			    def_carve(&cursor, activeSize);
+			uint32_t* const candidates = def_carve(
+			    &cursor,
+			    candidateNum * sizeof(uint32_t));
+
+			/* Fill it */
+			uint32_t first = 0U;
+
+			for (uint32_t cell = 0U; cell < cellNum; cell++)
+			{
+				table[cell] = first;
+				first += def_fillCandidates(
+				    me,
+				    (hsm_state_id_t)(cell / eventTypeNum),
+				    cell % eventTypeNum,
+				    &candidates[first]);
+
+				/* Nothing runs without candidates or during */
+				const hsm_state_id_t state =
+				    (hsm_state_id_t)(cell / eventTypeNum);
+
+				active[cell] =
+				    (uint32_t)((first != table[cell]) ||
+				               def_hasDuring(me, state));
+			}
+
+			table[cellNum]      = first;
+			me->itsTable        = table;
+			me->itsCandidates   = candidates;
+			me->itsActive       = active;
+			me->itsEventTypeNum = eventTypeNum;
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Releases the memory of a definition.
+ *
+ * No instance may use the definition afterwards.
+ *
+ * \param[in,out] me The definition.
+ */
+void hsm_def_destroy(hsm_def_t* const me)
+{
+	if (me != NULL)
+	{
+		// cppcheck-suppress misra-c2012-21.3
+		free(me->itsMemory);
+		// cppcheck-suppress misra-c2012-21.3
+		free(me->itsPathMemory);
+		// cppcheck-suppress misra-c2012-21.3
+		free(me->itsTableMemory);
+
+		me->itsMemory       = NULL;
+		me->itsPathMemory   = NULL;
+		me->itsTableMemory  = NULL;
+		me->itsTable        = NULL;
+		me->itsActive       = NULL;
+		me->itsEventTypeNum = 0U;
+		me->itsStates       = NULL;
+		me->itsStateNum     = 0U;
+	}
+}
+
+/**
+ * \brief Gets the id of a state in a definition.
+ *
+ * \param[in] me    The definition.
+ * \param[in] state The hsm state.
+ *
+ * \return The state's id, HSM_STATE_ID_NONE if not found.
+ */
+hsm_state_id_t hsm_def_getId(const hsm_def_t* const me,
+                             const state_t* const   state)
+{
+	hsm_state_id_t id = HSM_STATE_ID_NONE;
+
+	if (me != NULL)
+	{
+		id = def_findState(state, me->itsStates, me->itsStateNum);
+	}
+
+	return id;
+}
+
+/**
+ * \brief Initializes an instance of a definition.
+ *
+ * \param[out] me      The instance.
+ * \param[in]  def     The shared definition.
+ * \param[in]  history The history slots, def->itsHistoryNum in size.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_inst_init(hsm_inst_t* const      me,
+                  const hsm_def_t* const def,
+                  hsm_state_id_t* const  history)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (def == NULL))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		if ((def->itsStateNum == 0U) ||
+		    ((history == NULL) && (def->itsHistoryNum != 0U)))
+		{
+			/* Invalid input. */
+			errorCode = -1;
+		}
+	}
+
+	if (errorCode == 0)
+	{
+		me->itsDef     = def;
+		me->itsHistory = history;
+#if HSM_TRACE
+		me->itsTraceId = me;
+#endif
+		errorCode = hsm_inst_reset(me);
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Resets an instance to the initial state and clears its history.
+ *
+ * \param[in,out] me The instance.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_inst_reset(hsm_inst_t* const me)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (me->itsDef == NULL))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		const hsm_def_t* const def = me->itsDef;
+
+		for (uint32_t i = 0U; i < def->itsStateNum; i++)
+		{
+			if (def->itsHistorySlot[i] != HSM_STATE_ID_NONE)
+			{
+				me->itsHistory[def->itsHistorySlot[i]] =
+				    def->itsInitial[i];
+			}
+		}
+
+		me->itsCurrentState = def->itsInitialState;
+		me->itsMode         = (uint8_t)HSM_ST_M_ON_ENTRY;
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Instance run to completion event handler.
+ *
+ * Same algorithm as \see hsm_dispatch on the shared definition.
+ *
+ * \param[in,out] me    The instance.
+ * \param[in]     event The event signal.
+ *
+ * \retval  1  No event signal given.
+ * \retval  0  Success.
+ * \retval -1 Failure.
+ */
+int hsm_inst_dispatch(hsm_inst_t* const me, const hsm_event_t* const event)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (me->itsDef == NULL))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	/* Enter the initial state on the first event */
+	if (errorCode == 0)
+	{
+		if (me->itsMode == (uint8_t)HSM_ST_M_ON_ENTRY)
+		{
+			errorCode = inst_enter(me,
+			                       &me->itsDef->itsInitialState,
+			                       1U,
+			                       event);
+		}
+		else if (me->itsMode != (uint8_t)HSM_ST_M_DURING)
+		{
+			/* Failed before */
+			errorCode = -1;
+		}
+		else
+		{
+			/* No action */
+		}
+	}
+
+	/* Execute during */
+	if (errorCode == 0)
+	{
+		errorCode = inst_during(me, event);
+	}
+
+	/* Take the transition */
+	uint32_t transition = 0U;
+
+	if ((errorCode == 0) && inst_findTransition(me, event, &transition))
+	{
+		const hsm_def_t* const            def = me->itsDef;
+		const hsm_def_transition_t* const aux =
+		    &def->itsTransitions[transition];
+		const state_t* const source = def->itsStates[aux->itsSource];
+
+		if (aux->itsTarget == HSM_STATE_ID_NONE)
+		{
+			/* Internal transition */
+			if (aux->itsTransition->action != NULL)
+			{
+				aux->itsTransition->action(source, event);
+			}
+		}
+		else
+		{
+			const hsm_state_id_t leaf = me->itsCurrentState;
+			const uint32_t       activeNum =
+			    def->itsPathFirst[leaf + 1U] -
+			    def->itsPathFirst[leaf];
+
+			/* Exit up to the LCA */
+			errorCode =
+			    inst_exit(me, activeNum - aux->itsLcaLevel, event);
+
+			if (errorCode == 0)
+			{
+				if (aux->itsTransition->action != NULL)
+				{
+					aux->itsTransition->action(source,
+					                           event);
+				}
+
+				errorCode = inst_enter(
+				    me,
+				    &def->itsEntries[aux->itsEntryFirst],
+				    aux->itsEntryNum,
+				    event);
+			}
+
+			if (errorCode == 0)
+			{
+				inst_trace(me, aux->itsSource, event);
+			}
+		}
+	}
+
+	if (me != NULL)
+	{
+		me->itsMode = (errorCode == 0) ? (uint8_t)HSM_ST_M_DURING
+		                               : (uint8_t)HSM_ST_M_ERROR;
+	}
+
+	if (errorCode == 0)
+	{
+		/* Check for event signal */
+		if (event == NULL)
+		{
+			/* No event signal given */
+			errorCode = 1;
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Gets the current leaf state of an instance.
+ *
+ * \param[in] me The instance.
+ *
+ * \return The current state, NULL on failure.
+ */
+const state_t* hsm_inst_getState(const hsm_inst_t* const me)
+{
+	const state_t* state = NULL;
+
+	if ((me != NULL) && (me->itsDef != NULL))
+	{
+		if (me->itsCurrentState != HSM_STATE_ID_NONE)
+		{
+			state = me->itsDef->itsStates[me->itsCurrentState];
+		}
+	}
+
+	return state;
+}
@@ -0,0 +1,424 @@
+// ############################################################################
+// ############################################################################
+// Code
+
+// ############################################################################
+// ############################################################################
+// Include files
+
+#include "hsm_events.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+// ############################################################################
+// ############################################################################
+// Local definitions
+
+/**
+ * \brief End of a list of nodes.
+ */
+#define HSM_EVENTS_NONE (0xFFFFFFFFU)
+
+// ############################################################################
+// ############################################################################
+// Local functions
+
+static uint32_t events_take(hsm_events_t* const      me,
+                            const hsm_event_t* const event,
+                            const uint32_t           priority);
+static void     events_append(hsm_events_t* const me,
+                              uint32_t* const     first,
+                              uint32_t* const     last,
+                              const uint32_t      node);
+
+/**
+ * \brief Takes a node from the pool and fills it.
+ *
+ * \param[in,out] me       The queue.
+ * \param[in]     event    The event.
+ * \param[in]     priority Its priority.
+ *
+ * \return The node, HSM_EVENTS_NONE if the pool is empty.
+ */
+static uint32_t events_take(hsm_events_t* const      me,
+                            const hsm_event_t* const event,
+                            const uint32_t           priority)
+{
+	const uint32_t node = me->itsFree;
+
+	if (node != HSM_EVENTS_NONE)
+	{
+		hsm_events_node_t* const aux = &me->itsNodes[node];
+
+		me->itsFree      = aux->itsNext;
+		aux->itsEvent    = *event;
+		aux->itsNext     = HSM_EVENTS_NONE;
+		aux->itsPriority = priority;
+	}
+
+	return node;
+}
+
+/**
+ * \brief Appends a node to a list.
+ *
+ * \param[in,out] me    The queue.
+ * \param[in,out] first The first of the list.
+ * \param[in,out] last  The last of the list.
+ * \param[in]     node  The node.
+ */
+static void events_append(hsm_events_t* const me,
+                          uint32_t* const     first,
+                          uint32_t* const     last,
+                          const uint32_t      node)
+{
+	if (*first == HSM_EVENTS_NONE)
+	{
+		*first = node;
+	}
+	else
+	{
+		me->itsNodes[*last].itsNext = node;
+	}
+
+	*last = node;
+}
+
+// ############################################################################
+// ############################################################################
+// Function definitions
+
+/**
+ * \brief Initializes an event queue attached to a machine.
+ *
+ * \param[out] me       The queue.
+ * \param[in]  machine  The machine the events are dispatched to.
+ * \param[in]  nodes    The pool, capacity in size.
+ * \param[in]  capacity The number of events that can wait, deferred ones
+ *                      included.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_events_init(hsm_events_t* const      me,
+                    hsm_t* const             machine,
+                    hsm_events_node_t* const nodes,
+                    const uint32_t           capacity)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (machine == NULL) || (nodes == NULL) ||
+	    (capacity == 0U) || (capacity == HSM_EVENTS_NONE))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		me->itsMachine       = machine;
+		me->itsNodes         = nodes;
+		me->itsCapacity      = capacity;
+		me->itsFree          = 0U;
+		me->itsDeferredFirst = HSM_EVENTS_NONE;
+		me->itsDeferredLast  = HSM_EVENTS_NONE;
+		me->itsNum           = 0U;
+		me->itsDeferredNum   = 0U;
+
+		for (uint32_t i = 0U; i < HSM_PRIORITY_NUM; i++)
+		{
+			me->itsFirst[i] = HSM_EVENTS_NONE;
+			me->itsLast[i]  = HSM_EVENTS_NONE;
+		}
+
+		/* Every node is free */
+		for (uint32_t i = 0U; i < capacity; i++)
+		{
+			nodes[i].itsNext = i + 1U;
+		}
+
+		nodes[capacity - 1U].itsNext = HSM_EVENTS_NONE;
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Queues an event after the others of its priority.
+ *
+ * The event is copied.
+ *
+ * \param[in,out] me       The queue.
+ * \param[in]     event    The event signal.
+ * \param[in]     priority Its priority, below HSM_PRIORITY_NUM.
+ *
+ * \retval  1 The pool is empty, the event is dropped.
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_events_push(hsm_events_t* const      me,
+                    const hsm_event_t* const event,
+                    const uint32_t           priority)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (event == NULL) || (priority >= HSM_PRIORITY_NUM))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		const uint32_t node = events_take(me, event, priority);
+
+		if (node == HSM_EVENTS_NONE)
+		{
+			/* Full */
+			errorCode = 1;
+		}
+		else
+		{
+			events_append(me,
+			              &me->itsFirst[priority],
+			              &me->itsLast[priority],
+			              node);
+			me->itsNum++;
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Keeps an event aside until the next transition.
+ *
+ * Called from the actions of a state that can not handle the event yet.
+ * The event is copied.
+ *
+ * \param[in,out] me       The queue.
+ * \param[in]     event    The event signal.
+ * \param[in]     priority Its priority once recalled.
+ *
+ * \retval  1 The pool is empty, the event is dropped.
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_events_defer(hsm_events_t* const      me,
+                     const hsm_event_t* const event,
+                     const uint32_t           priority)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (event == NULL) || (priority >= HSM_PRIORITY_NUM))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		const uint32_t node = events_take(me, event, priority);
+
+		if (node == HSM_EVENTS_NONE)
+		{
+			/* Full */
+			errorCode = 1;
+		}
+		else
+		{
+			events_append(me,
+			              &me->itsDeferredFirst,
+			              &me->itsDeferredLast,
+			              node);
+			me->itsDeferredNum++;
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Queues the deferred events again.
+ *
+ * They go before the other events of their priority, in the order they were
+ * deferred. \see hsm_events_run calls it after every transition.
+ *
+ * \param[in,out] me The queue.
+ *
+ * \return The number of events recalled.
+ */
+uint32_t hsm_events_recall(hsm_events_t* const me)
+{
+	uint32_t recallNum = 0U;
+
+	if ((me != NULL) && (me->itsDeferredNum != 0U))
+	{
+		uint32_t first[HSM_PRIORITY_NUM];
+		uint32_t last[HSM_PRIORITY_NUM];
+		uint32_t node = me->itsDeferredFirst;
+
+		for (uint32_t i = 0U; i < HSM_PRIORITY_NUM; i++)
+		{
+			first[i] = HSM_EVENTS_NONE;
+			last[i]  = HSM_EVENTS_NONE;
+		}
+
+		/* Split them by priority */
+		while (node != HSM_EVENTS_NONE)
+		{
+			hsm_events_node_t* const aux  = &me->itsNodes[node];
+			const uint32_t           next = aux->itsNext;
+
+			aux->itsNext = HSM_EVENTS_NONE;
+			events_append(me,
+			              &first[aux->itsPriority],
+			              &last[aux->itsPriority],
+			              node);
+			node = next;
+		}
+
+		/* And put each part in front */
+		for (uint32_t i = 0U; i < HSM_PRIORITY_NUM; i++)
+		{
+			if (first[i] != HSM_EVENTS_NONE)
+			{
+				me->itsNodes[last[i]].itsNext =
+				    me->itsFirst[i];
+
+				if (me->itsFirst[i] == HSM_EVENTS_NONE)
+				{
+					me->itsLast[i] = last[i];
+				}
+
+				me->itsFirst[i] = first[i];
+			}
+		}
+
+		recallNum            = me->itsDeferredNum;
+		me->itsNum          += recallNum;
+		me->itsDeferredNum   = 0U;
+		me->itsDeferredFirst = HSM_EVENTS_NONE;
+		me->itsDeferredLast  = HSM_EVENTS_NONE;
+	}
+
+	return recallNum;
+}
+
+/**
+ * \brief Takes the most urgent event out of the queue.
+ *
+ * \param[in,out] me    The queue.
+ * \param[out]    event The event.
+ *
+ * \retval  1 The queue is empty.
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_events_pop(hsm_events_t* const me, hsm_event_t* const event)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (event == NULL))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		uint32_t priority = 0U;
+
+		while ((priority < HSM_PRIORITY_NUM) &&
+		       (me->itsFirst[priority] == HSM_EVENTS_NONE))
+		{
+			priority++;
+		}
+
+		if (priority == HSM_PRIORITY_NUM)
+		{
+			/* Empty */
+			errorCode = 1;
+		}
+		else
+		{
+			const uint32_t           node = me->itsFirst[priority];
+			hsm_events_node_t* const aux  = &me->itsNodes[node];
+
+			*event                 = aux->itsEvent;
+			me->itsFirst[priority] = aux->itsNext;
+
+			if (aux->itsNext == HSM_EVENTS_NONE)
+			{
+				me->itsLast[priority] = HSM_EVENTS_NONE;
+			}
+
+			/* Give the node back */
+			aux->itsNext = me->itsFree;
+			me->itsFree  = node;
+			me->itsNum--;
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Dispatches the queued events to the machine.
+ *
+ * The most urgent events go first, see \see hsm_dispatch. When an event
+ * takes a transition the deferred events are recalled, a self transition
+ * too, not an internal one. It returns when the queue is empty.
+ *
+ * \param[in,out] me The queue.
+ *
+ * \return The number of events dispatched, -1 on failure.
+ */
+int hsm_events_run(hsm_events_t* const me)
+{
+	int         eventNum = 0;
+	bool        empty    = false;
+	hsm_event_t event;
+
+	/* Check valid input */
+	if (me == NULL)
+	{
+		/* Invalid input. */
+		eventNum = -1;
+	}
+
+	while ((eventNum >= 0) && !empty)
+	{
+		if (hsm_events_pop(me, &event) != 0)
+		{
+			empty = true;
+		}
+		else
+		{
+			/* A self transition leaves the state as it was */
+			const uint32_t takenNum = me->itsMachine->itsTakenNum;
+
+			if (hsm_dispatch(me->itsMachine, &event) != 0)
+			{
+				/* Fail */
+				eventNum = -1;
+			}
+			else
+			{
+				eventNum++;
+
+				if (me->itsMachine->itsTakenNum != takenNum)
+				{
+					(void)hsm_events_recall(me);
+				}
+			}
+		}
+	}
+
+	return eventNum;
+}
@@ -0,0 +1,604 @@
+// ############################################################################
+// ############################################################################
+// Code
+
+// ############################################################################
+// ############################################################################
+// Include files
+
+/* For pthread_setaffinity_np */
+#define _GNU_SOURCE
+
+#include "hsm_exec.h"
+
+#include <sched.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// ############################################################################
+// ############################################################################
+// Local functions
+
+static void         exec_pin(const hsm_worker_t* const me);
+static void         exec_push(hsm_worker_t* const me,
+                              hsm_actor_t* const  actor);
+static hsm_actor_t* exec_pop(hsm_worker_t* const me);
+static void         exec_schedule(hsm_actor_t* const me);
+static void         exec_run(hsm_actor_t* const me);
+static bool         exec_idle(hsm_exec_t* const me);
+static void*        exec_work(void* arg);
+static int          exec_initActor(hsm_actor_t* const me,
+                                   hsm_exec_t* const  exec,
+                                   const uint32_t     worker);
+
+/**
+ * \brief Pins the calling worker to a cpu.
+ *
+ * \param[in] me The worker.
+ */
+static void exec_pin(const hsm_worker_t* const me)
+{
+#if defined(__linux__)
+	const long cpuNum = sysconf(_SC_NPROCESSORS_ONLN);
+	cpu_set_t  cpus;
+
+	if (cpuNum > 0L)
+	{
+		CPU_ZERO(&cpus);
+		CPU_SET(me->itsIndex % (uint32_t)cpuNum, &cpus);
+
+		/* Best effort, runs unpinned otherwise */
+		(void)pthread_setaffinity_np(pthread_self(),
+		                             sizeof(cpus),
+		                             &cpus);
+	}
+#else
+	(void)me;
+#endif
+}
+
+/**
+ * \brief Appends an actor to a ready list and wakes a sleeping worker.
+ *
+ * \param[in,out] me    The worker.
+ * \param[in]     actor The actor.
+ */
+static void exec_push(hsm_worker_t* const me, hsm_actor_t* const actor)
+{
+	hsm_exec_t* const exec = me->itsExec;
+
+	actor->itsNext = NULL;
+
+	(void)pthread_mutex_lock(&me->itsLock);
+	if (me->itsLast == NULL)
+	{
+		__atomic_store_n(&me->itsFirst, actor, __ATOMIC_RELAXED);
+	}
+	else
+	{
+		me->itsLast->itsNext = actor;
+	}
+	me->itsLast = actor;
+	(void)pthread_mutex_unlock(&me->itsLock);
+
+	(void)__atomic_fetch_add(&exec->itsReadyNum, 1U, __ATOMIC_SEQ_CST);
+
+	if (__atomic_load_n(&exec->itsIdleNum, __ATOMIC_SEQ_CST) != 0U)
+	{
+		(void)pthread_mutex_lock(&exec->itsIdleLock);
+		(void)pthread_cond_signal(&exec->itsIdleCond);
+		(void)pthread_mutex_unlock(&exec->itsIdleLock);
+	}
+}
+
+/**
+ * \brief Takes the first actor of a ready list.
+ *
+ * \param[in,out] me The worker.
+ *
+ * \return The actor, NULL if none is ready.
+ */
+static hsm_actor_t* exec_pop(hsm_worker_t* const me)
+{
+	hsm_actor_t* actor = NULL;
+
+	/* Do not lock empty lists while stealing */
+	if (__atomic_load_n(&me->itsFirst, __ATOMIC_RELAXED) != NULL)
+	{
+		(void)pthread_mutex_lock(&me->itsLock);
+		actor = me->itsFirst;
+		if (actor != NULL)
+		{
+			__atomic_store_n(&me->itsFirst,
+			                 actor->itsNext,
+			                 __ATOMIC_RELAXED);
+			if (actor->itsNext == NULL)
+			{
+				me->itsLast = NULL;
+			}
+		}
+		(void)pthread_mutex_unlock(&me->itsLock);
+	}
+
+	if (actor != NULL)
+	{
+		(void)__atomic_fetch_sub(&me->itsExec->itsReadyNum,
+		                         1U,
+		                         __ATOMIC_SEQ_CST);
+	}
+
+	return actor;
+}
+
+/**
+ * \brief Makes an actor ready on its worker, unless it already is.
+ *
+ * \param[in,out] me The actor.
+ */
+static void exec_schedule(hsm_actor_t* const me)
+{
+	if (__atomic_exchange_n(&me->itsScheduled, 1U, __ATOMIC_SEQ_CST) == 0U)
+	{
+		exec_push(&me->itsExec->itsWorkers[me->itsWorker], me);
+	}
+}
+
+/**
+ * \brief Dispatches the posted events of an actor.
+ *
+ * A failed dispatch leaves the instance in error, which fails the rest of
+ * its events.
+ *
+ * \param[in,out] me The actor.
+ */
+static void exec_run(hsm_actor_t* const me)
+{
+	(void)hsm_run(&me->itsQueue);
+
+	/* Events posted while running are not lost */
+	__atomic_store_n(&me->itsScheduled, 0U, __ATOMIC_SEQ_CST);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	if (__atomic_load_n(&me->itsQueue.itsCount, __ATOMIC_SEQ_CST) != 0U)
+	{
+		exec_schedule(me);
+	}
+}
+
+/**
+ * \brief Sleeps until an actor is ready.
+ *
+ * \param[in,out] me The executor.
+ *
+ * \retval true  Stopping and nothing is ready.
+ * \retval false Something may be ready.
+ */
+static bool exec_idle(hsm_exec_t* const me)
+{
+	bool done = false;
+
+	(void)pthread_mutex_lock(&me->itsIdleLock);
+	(void)__atomic_fetch_add(&me->itsIdleNum, 1U, __ATOMIC_SEQ_CST);
+
+	while ((__atomic_load_n(&me->itsReadyNum, __ATOMIC_SEQ_CST) == 0U) &&
+	       !me->itsStopping)
+	{
+		(void)pthread_cond_wait(&me->itsIdleCond, &me->itsIdleLock);
+	}
+
+	if (__atomic_load_n(&me->itsReadyNum, __ATOMIC_SEQ_CST) == 0U)
+	{
+		done = true;
+	}
+
+	(void)__atomic_fetch_sub(&me->itsIdleNum, 1U, __ATOMIC_SEQ_CST);
+	(void)pthread_mutex_unlock(&me->itsIdleLock);
+
+	return done;
+}
+
+/**
+ * \brief The worker thread.
+ *
+ * Runs its own ready actors first, then steals from the next workers.
+ *
+ * \param[in,out] arg The worker.
+ *
+ * \return NULL.
+ */
+static void* exec_work(void* arg)
+{
+	hsm_worker_t* const me   = (hsm_worker_t*)arg;
+	hsm_exec_t* const   exec = me->itsExec;
+	bool                done = false;
+
+	exec_pin(me);
+
+	while (!done)
+	{
+		const uint32_t num   = exec->itsWorkerNum;
+		hsm_actor_t*   actor = exec_pop(me);
+
+		for (uint32_t i = 1U; (actor == NULL) && (i < num); i++)
+		{
+			const uint32_t victim = (me->itsIndex + i) % num;
+
+			actor = exec_pop(&exec->itsWorkers[victim]);
+		}
+
+		if (actor != NULL)
+		{
+			/* Counted first, so the actor sees it */
+			(void)__atomic_fetch_add(&me->itsRunNum,
+			                         1U,
+			                         __ATOMIC_RELAXED);
+			if (actor->itsWorker != me->itsIndex)
+			{
+				(void)__atomic_fetch_add(&me->itsStealNum,
+				                         1U,
+				                         __ATOMIC_RELAXED);
+			}
+
+			exec_run(actor);
+		}
+		else
+		{
+			done = exec_idle(exec);
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * \brief Initializes an actor, its queue is initialized next.
+ *
+ * \param[out] me     The actor.
+ * \param[in]  exec   The executor.
+ * \param[in]  worker The index of the worker it has affinity to.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int exec_initActor(hsm_actor_t* const me,
+                          hsm_exec_t* const  exec,
+                          const uint32_t     worker)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (exec == NULL) || (worker >= exec->itsWorkerNum))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		me->itsExec      = exec;
+		me->itsWorker    = worker;
+		me->itsScheduled = 0U;
+		me->itsNext      = NULL;
+	}
+
+	return errorCode;
+}
+
+// ############################################################################
+// ############################################################################
+// Function definitions
+
+/**
+ * \brief Initializes an executor.
+ *
+ * \param[out] me        The executor.
+ * \param[in]  workers   The workers, workerNum in size.
+ * \param[in]  workerNum The number of worker threads.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_exec_init(hsm_exec_t* const   me,
+                  hsm_worker_t* const workers,
+                  const uint32_t      workerNum)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (workers == NULL) || (workerNum == 0U))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		me->itsWorkers   = workers;
+		me->itsWorkerNum = workerNum;
+		me->itsReadyNum  = 0U;
+		me->itsIdleNum   = 0U;
+		me->itsStartNum  = 0U;
+		me->itsStopping  = false;
+
+		if (pthread_mutex_init(&me->itsIdleLock, NULL) != 0)
+		{
+			/* Fail */
+			errorCode = -1;
+		}
+		else if (pthread_cond_init(&me->itsIdleCond, NULL) != 0)
+		{
+			/* Fail */
+			(void)pthread_mutex_destroy(&me->itsIdleLock);
+			errorCode = -1;
+		}
+		else
+		{
+			/* Do nothing */
+		}
+	}
+
+	if (errorCode == 0)
+	{
+		uint32_t lockNum = 0U;
+
+		for (uint32_t i = 0U; (errorCode == 0) && (i < workerNum); i++)
+		{
+			workers[i].itsExec  = me;
+			workers[i].itsIndex = i;
+			workers[i].itsFirst    = NULL;
+			workers[i].itsLast     = NULL;
+			workers[i].itsRunNum   = 0U;
+			workers[i].itsStealNum = 0U;
+
+			if (pthread_mutex_init(&workers[i].itsLock, NULL) != 0)
+			{
+				/* Fail */
+				errorCode = -1;
+			}
+			else
+			{
+				lockNum++;
+			}
+		}
+
+		if (errorCode != 0)
+		{
+			/* Free the locks made so far */
+			for (uint32_t i = 0U; i < lockNum; i++)
+			{
+				hsm_worker_t* const worker = &workers[i];
+
+				(void)pthread_mutex_destroy(&worker->itsLock);
+			}
+
+			(void)pthread_cond_destroy(&me->itsIdleCond);
+			(void)pthread_mutex_destroy(&me->itsIdleLock);
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Stops the worker threads and frees the locks of an executor.
+ *
+ * \param[in,out] me The executor.
+ */
+void hsm_exec_destroy(hsm_exec_t* const me)
+{
+	if (me != NULL)
+	{
+		(void)hsm_exec_stop(me);
+
+		for (uint32_t i = 0U; i < me->itsWorkerNum; i++)
+		{
+			hsm_worker_t* const worker = &me->itsWorkers[i];
+
+			(void)pthread_mutex_destroy(&worker->itsLock);
+		}
+
+		(void)pthread_cond_destroy(&me->itsIdleCond);
+		(void)pthread_mutex_destroy(&me->itsIdleLock);
+	}
+}
+
+/**
+ * \brief Starts the worker threads.
+ *
+ * \param[in,out] me The executor.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_exec_start(hsm_exec_t* const me)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (me->itsStartNum != 0U))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		me->itsStopping = false;
+
+		for (uint32_t i = 0U;
+		     (errorCode == 0) && (i < me->itsWorkerNum);
+		     i++)
+		{
+			hsm_worker_t* const worker = &me->itsWorkers[i];
+
+			if (pthread_create(&worker->itsThread,
+			                   NULL,
+			                   exec_work,
+			                   worker) != 0)
+			{
+				/* Fail */
+				errorCode = -1;
+			}
+			else
+			{
+				me->itsStartNum++;
+			}
+		}
+
+		if (errorCode != 0)
+		{
+			(void)hsm_exec_stop(me);
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Stops the worker threads.
+ *
+ * The workers dispatch the events already posted before they exit. No
+ * events should be posted after stopping.
+ *
+ * \param[in,out] me The executor.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_exec_stop(hsm_exec_t* const me)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if (me == NULL)
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		(void)pthread_mutex_lock(&me->itsIdleLock);
+		me->itsStopping = true;
+		(void)pthread_cond_broadcast(&me->itsIdleCond);
+		(void)pthread_mutex_unlock(&me->itsIdleLock);
+
+		for (uint32_t i = 0U; i < me->itsStartNum; i++)
+		{
+			const pthread_t thread = me->itsWorkers[i].itsThread;
+
+			if (pthread_join(thread, NULL) != 0)
+			{
+				/* Fail */
+				errorCode = -1;
+			}
+		}
+
+		me->itsStartNum = 0U;
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Initializes an actor of an instance.
+ *
+ * \param[out] me       The actor.
+ * \param[in]  exec     The executor.
+ * \param[in]  worker   The index of the worker it has affinity to.
+ * \param[in]  machine  The instance.
+ * \param[in]  slots    The event queue, capacity in size.
+ * \param[in]  capacity The number of slots, a power of two.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_actor_init(hsm_actor_t* const      me,
+                   hsm_exec_t* const       exec,
+                   const uint32_t          worker,
+                   hsm_inst_t* const       machine,
+                   hsm_queue_slot_t* const slots,
+                   const uint32_t          capacity)
+{
+	int errorCode = exec_initActor(me, exec, worker);
+
+	if (errorCode == 0)
+	{
+		errorCode =
+		    hsm_queue_init(&me->itsQueue, machine, slots, capacity);
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Initializes an actor of a machine.
+ *
+ * \param[out] me       The actor.
+ * \param[in]  exec     The executor.
+ * \param[in]  worker   The index of the worker it has affinity to.
+ * \param[in]  machine  The hierarchical state machine handle.
+ * \param[in]  slots    The event queue, capacity in size.
+ * \param[in]  capacity The number of slots, a power of two.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_actor_initMachine(hsm_actor_t* const      me,
+                          hsm_exec_t* const       exec,
+                          const uint32_t          worker,
+                          hsm_t* const            machine,
+                          hsm_queue_slot_t* const slots,
+                          const uint32_t          capacity)
+{
+	int errorCode = exec_initActor(me, exec, worker);
+
+	if (errorCode == 0)
+	{
+		errorCode = hsm_queue_initMachine(&me->itsQueue,
+		                                  machine,
+		                                  slots,
+		                                  capacity);
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Posts an event to an actor.
+ *
+ * Safe to call from any thread, including from the actions of other actors.
+ *
+ * \param[in,out] me    The actor.
+ * \param[in]     event The event signal.
+ *
+ * \retval  1 The queue is full, the event is dropped.
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_actor_post(hsm_actor_t* const me, const hsm_event_t* const event)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if (me == NULL)
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		errorCode = hsm_post(&me->itsQueue, event);
+	}
+
+	if (errorCode == 0)
+	{
+		/* Pairs with the fence in exec_run */
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		exec_schedule(me);
+	}
+
+	return errorCode;
+}
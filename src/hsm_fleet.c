@@ -0,0 +1,361 @@
+// ############################################################################
+// ############################################################################
+// Code
+
+// ############################################################################
+// ############################################################################
+// Include files
+
+#include "hsm_fleet.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+// ############################################################################
+// ############################################################################
+// Local functions
+
+static hsm_inst_t fleet_getInst(const hsm_fleet_t* const me,
+                                const uint32_t           index);
+static void       fleet_setInst(hsm_fleet_t* const      me,
+                                const uint32_t          index,
+                                const hsm_inst_t* const inst);
+static void       fleet_mark(uint8_t* restrict const              active,
+                             const uint8_t* restrict const        modes,
+                             const hsm_state_id_t* restrict const states,
+                             const uint32_t* restrict const       cells,
+                             const uint32_t                       stride,
+                             const uint32_t                       instNum);
+
+/**
+ * \brief Gets an instance of the fleet.
+ *
+ * \param[in] me    The fleet.
+ * \param[in] index The index of the instance.
+ *
+ * \return The instance, its history slots are in the fleet.
+ */
+static hsm_inst_t fleet_getInst(const hsm_fleet_t* const me,
+                                const uint32_t           index)
+{
+	const hsm_def_t* const def = me->itsDef;
+	hsm_inst_t             inst;
+
+	inst.itsDef     = def;
+	inst.itsHistory = (def->itsHistoryNum != 0U)
+	                      ? &me->itsHistories[index * def->itsHistoryNum]
+	                      : NULL;
+	inst.itsCurrentState = me->itsCurrentStates[index];
+	inst.itsMode         = me->itsModes[index];
+#if HSM_TRACE
+	/* The instance itself is a temporary, its slot is not */
+	inst.itsTraceId = &me->itsCurrentStates[index];
+#endif
+
+	return inst;
+}
+
+/**
+ * \brief Stores an instance back to the fleet.
+ *
+ * \param[in,out] me    The fleet.
+ * \param[in]     index The index of the instance.
+ * \param[in]     inst  The instance.
+ */
+static void fleet_setInst(hsm_fleet_t* const      me,
+                          const uint32_t          index,
+                          const hsm_inst_t* const inst)
+{
+	me->itsCurrentStates[index] = inst->itsCurrentState;
+	me->itsModes[index]         = inst->itsMode;
+}
+
+/**
+ * \brief Marks the instances an event does anything to.
+ *
+ * Not entered or failed instances are always marked. The loop has no
+ * branches and the arrays do not alias, so the compiler can vectorize the
+ * lookups with gathers.
+ *
+ * \param[out] active  One flag per instance.
+ * \param[in]  modes   The mode of each instance.
+ * \param[in]  states  The current leaf state of each instance.
+ * \param[in]  cells   The definition's active table, at the event's column.
+ * \param[in]  stride  The number of event types of the table.
+ * \param[in]  instNum The number of instances.
+ */
+static void fleet_mark(uint8_t* restrict const              active,
+                       const uint8_t* restrict const        modes,
+                       const hsm_state_id_t* restrict const states,
+                       const uint32_t* restrict const       cells,
+                       const uint32_t                       stride,
+                       const uint32_t                       instNum)
+{
+	for (uint32_t i = 0U; i < instNum; i++)
+	{
+		active[i] = (uint8_t)(
+		    (uint32_t)(modes[i] != (uint8_t)HSM_ST_M_DURING) |
+		    cells[(uint32_t)states[i] * stride]);
+	}
+}
+
+// ############################################################################
+// ############################################################################
+// Function definitions
+
+/**
+ * \brief Initializes a fleet of instances of a definition.
+ *
+ * All the instances are reset.
+ *
+ * \param[out] me      The fleet.
+ * \param[in]  def     The shared definition.
+ * \param[in]  instNum The number of instances.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_fleet_init(hsm_fleet_t* const     me,
+                   const hsm_def_t* const def,
+                   const uint32_t         instNum)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if (me == NULL)
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+	else
+	{
+		/* Nothing is allocated yet */
+		me->itsMemory  = NULL;
+		me->itsInstNum = 0U;
+
+		if ((def == NULL) || (def->itsStateNum == 0U) ||
+		    (instNum == 0U))
+		{
+			/* Invalid input. */
+			errorCode = -1;
+		}
+	}
+
+	/* Allocate the arrays, the 16 bit ones first */
+	if (errorCode == 0)
+	{
+		const size_t historySize =
+		    sizeof(hsm_state_id_t) * instNum * def->itsHistoryNum;
+		const size_t currentSize = sizeof(hsm_state_id_t) * instNum;
+
+		// cppcheck-suppress misra-c2012-21.3
+		uint8_t* const memory = (uint8_t*)malloc(
+		    historySize + currentSize + (2U * (size_t)instNum));
+
+		if (memory == NULL)
+		{
+			/* Out of memory */
+			errorCode = -1;
+		}
+		else
+		{
+			me->itsDef           = def;
+			me->itsInstNum       = instNum;
+			me->itsMemory        = memory;
+			me->itsHistories     = (hsm_state_id_t*)memory;
+			me->itsCurrentStates =
+			    (hsm_state_id_t*)&memory[historySize];
+			me->itsModes  = &memory[historySize + currentSize];
+			me->itsActive = &me->itsModes[instNum];
+
+			errorCode = hsm_fleet_reset(me);
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Releases the memory of a fleet.
+ *
+ * \param[in,out] me The fleet.
+ */
+void hsm_fleet_destroy(hsm_fleet_t* const me)
+{
+	if (me != NULL)
+	{
+		// cppcheck-suppress misra-c2012-21.3
+		free(me->itsMemory);
+
+		me->itsMemory  = NULL;
+		me->itsInstNum = 0U;
+	}
+}
+
+/**
+ * \brief Resets all the instances of a fleet.
+ *
+ * \param[in,out] me The fleet.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_fleet_reset(hsm_fleet_t* const me)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (me->itsMemory == NULL))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	for (uint32_t i = 0U; (errorCode == 0) && (i < me->itsInstNum); i++)
+	{
+		hsm_inst_t inst = fleet_getInst(me, i);
+
+		errorCode = hsm_inst_reset(&inst);
+		fleet_setInst(me, i, &inst);
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Dispatches an event to a single instance of a fleet.
+ *
+ * Same as \see hsm_inst_dispatch.
+ *
+ * \param[in,out] me    The fleet.
+ * \param[in]     index The index of the instance.
+ * \param[in]     event The event signal.
+ *
+ * \retval  1  No event signal given.
+ * \retval  0  Success.
+ * \retval -1 Failure.
+ */
+int hsm_fleet_dispatch(hsm_fleet_t* const       me,
+                       const uint32_t           index,
+                       const hsm_event_t* const event)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (index >= me->itsInstNum))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		hsm_inst_t inst = fleet_getInst(me, index);
+
+		errorCode = hsm_inst_dispatch(&inst, event);
+		fleet_setInst(me, index, &inst);
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Dispatches the same event to all the instances of a fleet.
+ *
+ * With a compiled definition, a first pass looks up in the transition table
+ * whether the event does anything to each instance, without branches so
+ * the compiler can vectorize it. Only those instances are then dispatched
+ * to. Otherwise every instance is dispatched to.
+ *
+ * A failed instance is left in error and the rest are still dispatched to.
+ *
+ * \param[in,out] me    The fleet.
+ * \param[in]     event The event signal.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure of at least one instance.
+ */
+int hsm_fleet_broadcast(hsm_fleet_t* const       me,
+                        const hsm_event_t* const event)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (me->itsMemory == NULL) || (event == NULL))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		const hsm_def_t* const def     = me->itsDef;
+		const uint32_t         instNum = me->itsInstNum;
+		uint8_t* const         active  = me->itsActive;
+
+		if (def->itsActive != NULL)
+		{
+			/* Out of the table's range only ANY triggers */
+			const uint32_t eventTypeNum = def->itsEventTypeNum;
+			const uint32_t eventType    = event->eventType;
+			const uint32_t column =
+			    (eventType < eventTypeNum) ? eventType
+			                               : HSM_EVENT_ANY;
+
+			fleet_mark(active,
+			           me->itsModes,
+			           me->itsCurrentStates,
+			           &def->itsActive[column],
+			           eventTypeNum,
+			           instNum);
+		}
+		else
+		{
+			for (uint32_t i = 0U; i < instNum; i++)
+			{
+				active[i] = 1U;
+			}
+		}
+
+		for (uint32_t i = 0U; i < instNum; i++)
+		{
+			if (active[i] != 0U)
+			{
+				hsm_inst_t inst = fleet_getInst(me, i);
+
+				if (hsm_inst_dispatch(&inst, event) != 0)
+				{
+					/* Fail, go on with the others */
+					errorCode = -1;
+				}
+
+				fleet_setInst(me, i, &inst);
+			}
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Gets the current leaf state of an instance of a fleet.
+ *
+ * \param[in] me    The fleet.
+ * \param[in] index The index of the instance.
+ *
+ * \return The current state, NULL on failure.
+ */
+const state_t* hsm_fleet_getState(const hsm_fleet_t* const me,
+                                  const uint32_t           index)
+{
+	const state_t* state = NULL;
+
+	if ((me != NULL) && (index < me->itsInstNum))
+	{
+		const hsm_inst_t inst = fleet_getInst(me, index);
+
+		state = hsm_inst_getState(&inst);
+	}
+
+	return state;
+}
@@ -0,0 +1,580 @@
+// ############################################################################
+// ############################################################################
+// Code
+
+// ############################################################################
+// ############################################################################
+// Include files
+
+#include "hsm_journal.h"
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// ############################################################################
+// ############################################################################
+// Local definitions
+
+/**
+ * \brief File header.
+ */
+typedef struct
+{
+	uint8_t  itsMagic[4];   /**< "HSMJ". */
+	uint16_t itsVersion;    /**< HSM_JOURNAL_VERSION. */
+	uint16_t itsRecordSize; /**< The size of a record. */
+} journal_header_t;
+
+/* The first bytes of a file */
+static const uint8_t journal_magic[4] = {'H', 'S', 'M', 'J'};
+
+// ############################################################################
+// ############################################################################
+// Local functions
+
+static bool     journal_isAt(const hsm_t* const                machine,
+                             const hsm_journal_record_t* const record);
+static void     journal_writeBuffer(hsm_journal_t* const me);
+static size_t   journal_read(const int    file,
+                             void* const  buffer,
+                             const size_t size);
+static int      journal_run(hsm_t* const                      machine,
+                            const hsm_journal_record_t* const records,
+                            const hsm_event_t* const          events,
+                            const size_t                      eventNum);
+
+/**
+ * \brief Checks if a machine is where a record left it.
+ *
+ * \param[in] machine The hierarchical state machine handle.
+ * \param[in] record  The record.
+ *
+ * \return True if it is in the record's state and mode.
+ */
+static bool journal_isAt(const hsm_t* const                machine,
+                         const hsm_journal_record_t* const record)
+{
+	const state_t* const state = machine->itsCurrentState;
+
+	return (state != NULL) &&
+	       (hsm_getStateIndex(machine, state) == record->itsTo) &&
+	       ((uint8_t)state->itsMode == record->itsToMode);
+}
+
+/**
+ * \brief Writes the collected records to the file.
+ *
+ * The records are dropped if the write fails, the journal remembers the
+ * failure.
+ *
+ * \param[in,out] me The journal.
+ */
+static void journal_writeBuffer(hsm_journal_t* const me)
+{
+	size_t doneNum = 0U;
+
+	while ((me->itsError == 0) && (doneNum < me->itsLength))
+	{
+		const ssize_t size = write(me->itsFile,
+		                           &me->itsBuffer[doneNum],
+		                           me->itsLength - doneNum);
+
+		if (size <= 0)
+		{
+			/* Can not write */
+			me->itsError = -1;
+		}
+		else
+		{
+			doneNum += (size_t)size;
+		}
+	}
+
+	me->itsLength = 0U;
+}
+
+/**
+ * \brief Reads from a file until the buffer is full or the file ends.
+ *
+ * \param[in]  file   The file descriptor.
+ * \param[out] buffer Where to read.
+ * \param[in]  size   The size of buffer.
+ *
+ * \return The bytes read.
+ */
+static size_t journal_read(const int    file,
+                           void* const  buffer,
+                           const size_t size)
+{
+	uint8_t* const bytes   = (uint8_t*)buffer;
+	size_t         doneNum = 0U;
+	bool           end     = false;
+
+	while (!end && (doneNum < size))
+	{
+		const ssize_t readNum =
+		    read(file, &bytes[doneNum], size - doneNum);
+
+		if (readNum <= 0)
+		{
+			/* End of file or failure */
+			end = true;
+		}
+		else
+		{
+			doneNum += (size_t)readNum;
+		}
+	}
+
+	return doneNum;
+}
+
+/**
+ * \brief Replays records with the same flags.
+ *
+ * The events without flags are handled as one batch. The events of failed
+ * records must fail again.
+ *
+ * \param[in,out] machine  The hierarchical state machine handle.
+ * \param[in]     records  The records.
+ * \param[in]     events   Their events.
+ * \param[in]     eventNum The number of records.
+ *
+ * \retval  1 The machine did not fail as recorded.
+ * \retval  0 Success.
+ */
+static int journal_run(hsm_t* const                      machine,
+                       const hsm_journal_record_t* const records,
+                       const hsm_event_t* const          events,
+                       const size_t                      eventNum)
+{
+	const uint8_t flags = records[0].itsFlags;
+	const bool    failed =
+	    ((flags & (uint8_t)HSM_JOURNAL_F_FAILED) != 0U);
+	int errorCode = 0;
+
+	if (flags == 0U)
+	{
+		errorCode =
+		    (hsm_handleEvents(machine, events, eventNum, NULL) != 0)
+		        ? 1
+		        : 0;
+	}
+
+	for (size_t i = 0U;
+	     (flags != 0U) && (errorCode == 0) && (i < eventNum);
+	     i++)
+	{
+		const hsm_event_t* const event =
+		    ((flags & (uint8_t)HSM_JOURNAL_F_NO_EVENT) != 0U)
+		        ? NULL
+		        : &events[i];
+		int result = ((flags & (uint8_t)HSM_JOURNAL_F_DISPATCH) != 0U)
+		                 ? hsm_dispatch(machine, event)
+		                 : hsm_handleEvent(machine, event);
+
+		if ((result == 1) && (event == NULL))
+		{
+			/* No event signal, as recorded */
+			result = 0;
+		}
+
+		if ((result != 0) != failed)
+		{
+			/* Not as recorded */
+			errorCode = 1;
+		}
+	}
+
+	return errorCode;
+}
+
+// ############################################################################
+// ############################################################################
+// Function definitions
+
+/**
+ * \brief Opens a journal, an existing file is truncated.
+ *
+ * \param[out] me       The journal.
+ * \param[in]  path     The file.
+ * \param[in]  buffer   Where to collect the records until written.
+ * \param[in]  capacity The size of buffer, at least a record.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_journal_open(hsm_journal_t* const me,
+                     const char* const    path,
+                     uint8_t* const       buffer,
+                     const size_t         capacity)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (path == NULL) || (buffer == NULL) ||
+	    (capacity < sizeof(hsm_journal_record_t)) ||
+	    (capacity < sizeof(journal_header_t)))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		me->itsBuffer    = buffer;
+		me->itsCapacity  = capacity;
+		me->itsLength    = 0U;
+		me->itsRecordNum = 0U;
+		me->itsError     = 0;
+		me->itsFile =
+		    open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+		if (me->itsFile < 0)
+		{
+			/* Can not open */
+			errorCode = -1;
+		}
+	}
+
+	/* The header goes out with the first records */
+	if (errorCode == 0)
+	{
+		journal_header_t header;
+
+		(void)memcpy(header.itsMagic,
+		             journal_magic,
+		             sizeof(journal_magic));
+		header.itsVersion    = HSM_JOURNAL_VERSION;
+		header.itsRecordSize = (uint16_t)sizeof(hsm_journal_record_t);
+
+		(void)memcpy(me->itsBuffer, &header, sizeof(header));
+		me->itsLength = sizeof(header);
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Writes the remaining records and closes a journal.
+ *
+ * Detach it from its machines first.
+ *
+ * \param[in,out] me The journal.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure, a write failed and records were lost.
+ */
+int hsm_journal_close(hsm_journal_t* const me)
+{
+	const int errorCode = hsm_journal_flush(me);
+
+	if ((me != NULL) && (me->itsFile >= 0))
+	{
+		(void)close(me->itsFile);
+		me->itsFile = -1;
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Writes the collected records to the file.
+ *
+ * \param[in,out] me The journal.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure, a write failed and records were lost.
+ */
+int hsm_journal_flush(hsm_journal_t* const me)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (me->itsFile < 0))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		journal_writeBuffer(me);
+		errorCode = me->itsError;
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Attaches a journal to a machine.
+ *
+ * Several machines of one thread can share a journal, but only the records
+ * of one can be replayed.
+ *
+ * \param[in,out] machine The hierarchical state machine handle.
+ * \param[in]     me      The journal, NULL to detach it.
+ */
+void hsm_journal_attach(hsm_t* const machine, hsm_journal_t* const me)
+{
+	if (machine != NULL)
+	{
+		machine->itsJournal = me;
+	}
+}
+
+/**
+ * \brief Gets the number of records appended since the journal was opened.
+ *
+ * \param[in] me The journal.
+ *
+ * \return The number of records.
+ */
+uint64_t hsm_journal_getRecordNum(const hsm_journal_t* const me)
+{
+	return (me != NULL) ? me->itsRecordNum : 0U;
+}
+
+/**
+ * \brief Replays a journal on a machine.
+ *
+ * The file is read recordNum records at a time. The events of a micro step
+ * run are handled with one \see hsm_handleEvents call, the others in turn.
+ * The events the machine failed to handle must fail again. After each run
+ * the machine must be in the state and mode of the run's last record.
+ *
+ * The machine's journal is not written while replaying.
+ *
+ * \param[in,out] machine       The hierarchical state machine handle, as
+ *                              it was when the journal was opened.
+ * \param[in]     path          The file.
+ * \param[out]    records       Where to read the records.
+ * \param[in]     recordNum     The size of records, the batch size.
+ * \param[out]    recordDoneNum The records replayed. On divergence it is
+ *                              the first record of the run that diverged.
+ *                              Can be NULL.
+ *
+ * \retval  1 The machine diverged from the journal.
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_journal_replay(hsm_t* const                machine,
+                       const char* const           path,
+                       hsm_journal_record_t* const records,
+                       const size_t                recordNum,
+                       uint64_t* const             recordDoneNum)
+{
+	hsm_journal_t* journal   = NULL;
+	hsm_event_t*   events    = NULL;
+	uint64_t       doneNum   = 0U;
+	int            file      = -1;
+	int            errorCode = 0;
+
+	/* Check valid input */
+	if ((machine == NULL) || (path == NULL) || (records == NULL) ||
+	    (recordNum == 0U))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		journal_header_t header;
+
+		file = open(path, O_RDONLY);
+
+		if ((file < 0) ||
+		    (journal_read(file, &header, sizeof(header)) !=
+		     sizeof(header)) ||
+		    (memcmp(header.itsMagic,
+		            journal_magic,
+		            sizeof(journal_magic)) != 0) ||
+		    (header.itsVersion != HSM_JOURNAL_VERSION) ||
+		    (header.itsRecordSize != sizeof(hsm_journal_record_t)))
+		{
+			/* Not a journal of this build */
+			errorCode = -1;
+		}
+	}
+
+	if (errorCode == 0)
+	{
+		// cppcheck-suppress misra-c2012-21.3
+		events = (hsm_event_t*)calloc(recordNum, sizeof(hsm_event_t));
+
+		if (events == NULL)
+		{
+			/* Out of memory */
+			errorCode = -1;
+		}
+	}
+
+	if (errorCode == 0)
+	{
+		journal             = machine->itsJournal;
+		machine->itsJournal = NULL;
+	}
+
+	for (bool end = false; (errorCode == 0) && !end;)
+	{
+		const size_t size =
+		    journal_read(file,
+		                 records,
+		                 recordNum * sizeof(hsm_journal_record_t));
+		const size_t num   = size / sizeof(hsm_journal_record_t);
+		size_t       first = 0U;
+
+		if ((size % sizeof(hsm_journal_record_t)) != 0U)
+		{
+			/* Truncated record */
+			errorCode = -1;
+		}
+
+		end = (num < recordNum);
+
+		for (size_t i = 0U; (errorCode == 0) && (i < num); i++)
+		{
+			events[i].eventType = records[i].itsEventType;
+			events[i].data      = NULL;
+#if HSM_EVENT_INLINE_SIZE > 0
+			(void)memcpy(events[i].itsInline,
+			             records[i].itsInline,
+			             HSM_EVENT_INLINE_SIZE);
+#endif
+
+			if (records[i].itsFlags >
+			    (uint8_t)(HSM_JOURNAL_F_DISPATCH |
+			              HSM_JOURNAL_F_NO_EVENT |
+			              HSM_JOURNAL_F_FAILED))
+			{
+				/* Unknown flags */
+				errorCode = -1;
+			}
+		}
+
+		/* Each run of the same flags */
+		while ((errorCode == 0) && (first < num))
+		{
+			size_t last = first;
+
+			while (((last + 1U) < num) &&
+			       (records[last + 1U].itsFlags ==
+			        records[first].itsFlags))
+			{
+				last++;
+			}
+
+			errorCode = journal_run(machine,
+			                        &records[first],
+			                        &events[first],
+			                        (last + 1U) - first);
+
+			if ((errorCode == 0) &&
+			    !journal_isAt(machine, &records[last]))
+			{
+				/* Not where it was */
+				errorCode = 1;
+			}
+
+			if (errorCode == 0)
+			{
+				doneNum += (last + 1U) - first;
+			}
+
+			first = last + 1U;
+		}
+	}
+
+	/* Attached again if it was detached */
+	if (events != NULL)
+	{
+		machine->itsJournal = journal;
+	}
+
+	// cppcheck-suppress misra-c2012-21.3
+	free(events);
+
+	if (file >= 0)
+	{
+		(void)close(file);
+	}
+
+	if (recordDoneNum != NULL)
+	{
+		*recordDoneNum = doneNum;
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Appends a record of an event a machine handled.
+ *
+ * The buffer is written to the file when it can not take the record.
+ *
+ * \param[in,out] me            The journal.
+ * \param[in]     machine       The hierarchical state machine handle.
+ * \param[in]     event         The event signal, can be NULL.
+ * \param[in]     fromState     The state it left.
+ * \param[in]     fromStateMode The mode it left in.
+ * \param[in]     flags         The hsm_journal_flag_t set.
+ */
+void hsm_journal_write(hsm_journal_t* const     me,
+                       const hsm_t* const       machine,
+                       const hsm_event_t* const event,
+                       const state_t* const     fromState,
+                       const hsm_st_mode_t      fromStateMode,
+                       const uint8_t            flags)
+{
+	if ((me != NULL) && (machine != NULL) && (me->itsFile >= 0))
+	{
+		const state_t* const toState = machine->itsCurrentState;
+		const uint32_t       from =
+		    hsm_getStateIndex(machine, fromState);
+		const uint32_t to = hsm_getStateIndex(machine, toState);
+		hsm_journal_record_t record;
+
+		(void)memset(&record, 0, sizeof(record));
+		record.itsFrom     = (from < HSM_JOURNAL_STATE_NONE)
+		                         ? (uint16_t)from
+		                         : HSM_JOURNAL_STATE_NONE;
+		record.itsTo       = (to < HSM_JOURNAL_STATE_NONE)
+		                         ? (uint16_t)to
+		                         : HSM_JOURNAL_STATE_NONE;
+		record.itsFromMode = (uint8_t)fromStateMode;
+		record.itsToMode   = (toState != NULL)
+		                         ? (uint8_t)toState->itsMode
+		                         : (uint8_t)HSM_ST_M_ERROR;
+		record.itsFlags    = flags;
+
+		if (event != NULL)
+		{
+			record.itsEventType = event->eventType;
+#if HSM_EVENT_INLINE_SIZE > 0
+			(void)memcpy(record.itsInline,
+			             event->itsInline,
+			             HSM_EVENT_INLINE_SIZE);
+#endif
+		}
+		else
+		{
+			record.itsEventType = HSM_EVENT_ANY;
+			record.itsFlags |= (uint8_t)HSM_JOURNAL_F_NO_EVENT;
+		}
+
+		if ((me->itsLength + sizeof(record)) > me->itsCapacity)
+		{
+			journal_writeBuffer(me);
+		}
+
+		(void)memcpy(&me->itsBuffer[me->itsLength],
+		             &record,
+		             sizeof(record));
+		me->itsLength += sizeof(record);
+		me->itsRecordNum++;
+	}
+}
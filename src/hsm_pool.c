@@ -0,0 +1,439 @@
+// ############################################################################
+// ############################################################################
+// Code
+
+// ############################################################################
+// ############################################################################
+// Include files
+
+#include "hsm_pool.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+// ############################################################################
+// ############################################################################
+// Local definitions
+
+/**
+ * \brief The alignment of the payloads.
+ */
+#define HSM_POOL_ALIGN (16U)
+
+/**
+ * \brief No block.
+ */
+#define HSM_POOL_NONE (0xFFFFFFFFU)
+
+/**
+ * \brief Block header, right before the payload.
+ */
+typedef struct
+{
+	hsm_pool_t* itsPool;   /**< The pool of the block. */
+	uint32_t    itsRefNum; /**< The number of owners. */
+	uint32_t    itsNext;   /**< Next free block. */
+} pool_header_t;
+
+/**
+ * \brief The size of the header, keeping the payload aligned.
+ */
+#define HSM_POOL_HEADER_SIZE \
+	pool_align((uint32_t)sizeof(pool_header_t))
+
+/* The cache of the calling thread, NULL if it has none */
+static __thread hsm_pool_cache_t* pool_cache = NULL;
+
+// ############################################################################
+// ############################################################################
+// Local functions
+
+static uint32_t       pool_align(const uint32_t size);
+static pool_header_t* pool_getHeader(const hsm_pool_t* const me,
+                                     const uint32_t          block);
+static pool_header_t* pool_getOwner(const void* const data);
+static uint32_t       pool_pop(hsm_pool_t* const me);
+static void           pool_push(hsm_pool_t* const me, const uint32_t block);
+static void           pool_flush(hsm_pool_cache_t* const cache,
+                                 const uint32_t          num);
+
+/**
+ * \brief Rounds a size up to the alignment of the payloads.
+ *
+ * \param[in] size The size.
+ *
+ * \return The aligned size.
+ */
+static uint32_t pool_align(const uint32_t size)
+{
+	return (size + HSM_POOL_ALIGN - 1U) & ~(HSM_POOL_ALIGN - 1U);
+}
+
+/**
+ * \brief Gets the header of a block.
+ *
+ * \param[in] me    The pool.
+ * \param[in] block The block.
+ *
+ * \return The header.
+ */
+static pool_header_t* pool_getHeader(const hsm_pool_t* const me,
+                                     const uint32_t          block)
+{
+	// cppcheck-suppress misra-c2012-11.3
+	return (pool_header_t*)&me->itsBlocks[(size_t)block * me->itsStride];
+}
+
+/**
+ * \brief Gets the header of a payload.
+ *
+ * \param[in] data The payload.
+ *
+ * \return The header.
+ */
+static pool_header_t* pool_getOwner(const void* const data)
+{
+	// cppcheck-suppress misra-c2012-11.3
+	return (pool_header_t*)((uintptr_t)data - HSM_POOL_HEADER_SIZE);
+}
+
+/**
+ * \brief Takes a block from the shared list.
+ *
+ * \param[in,out] me The pool.
+ *
+ * \return The block, HSM_POOL_NONE if there is none.
+ */
+static uint32_t pool_pop(hsm_pool_t* const me)
+{
+	uint64_t head  = __atomic_load_n(&me->itsFree, __ATOMIC_ACQUIRE);
+	uint32_t block = HSM_POOL_NONE;
+	bool     done  = false;
+
+	while (!done)
+	{
+		block = (uint32_t)head;
+
+		if (block == HSM_POOL_NONE)
+		{
+			/* Empty */
+			done = true;
+		}
+		else
+		{
+			/* Stale if another thread took it, the tag differs */
+			const pool_header_t* const header =
+			    pool_getHeader(me, block);
+			const uint32_t next =
+			    __atomic_load_n(&header->itsNext,
+			                    __ATOMIC_RELAXED);
+			const uint64_t tag = (head >> 32U) + 1U;
+
+			done = __atomic_compare_exchange_n(&me->itsFree,
+			                                   &head,
+			                                   (tag << 32U) | next,
+			                                   true,
+			                                   __ATOMIC_ACQUIRE,
+			                                   __ATOMIC_ACQUIRE);
+		}
+	}
+
+	return block;
+}
+
+/**
+ * \brief Gives a block back to the shared list.
+ *
+ * \param[in,out] me    The pool.
+ * \param[in]     block The block.
+ */
+static void pool_push(hsm_pool_t* const me, const uint32_t block)
+{
+	pool_header_t* const header = pool_getHeader(me, block);
+	uint64_t head = __atomic_load_n(&me->itsFree, __ATOMIC_RELAXED);
+	bool     done = false;
+
+	while (!done)
+	{
+		const uint64_t tag = (head >> 32U) + 1U;
+
+		__atomic_store_n(&header->itsNext,
+		                 (uint32_t)head,
+		                 __ATOMIC_RELAXED);
+		done = __atomic_compare_exchange_n(&me->itsFree,
+		                                   &head,
+		                                   (tag << 32U) | block,
+		                                   true,
+		                                   __ATOMIC_RELEASE,
+		                                   __ATOMIC_RELAXED);
+	}
+}
+
+/**
+ * \brief Gives the last blocks of a cache back to its pool.
+ *
+ * \param[in,out] cache The cache.
+ * \param[in]     num   The number of blocks.
+ */
+static void pool_flush(hsm_pool_cache_t* const cache, const uint32_t num)
+{
+	for (uint32_t i = 0U; i < num; i++)
+	{
+		cache->itsNum--;
+		pool_push(cache->itsPool, cache->itsBlocks[cache->itsNum]);
+	}
+}
+
+// ############################################################################
+// ############################################################################
+// Function definitions
+
+/**
+ * \brief Allocates a pool.
+ *
+ * \param[out] me        The pool.
+ * \param[in]  blockSize The size of a payload.
+ * \param[in]  blockNum  The number of payloads.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_pool_init(hsm_pool_t* const me,
+                  const uint32_t    blockSize,
+                  const uint32_t    blockNum)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (blockSize == 0U) ||
+	    (blockSize > (0x80000000U - HSM_POOL_HEADER_SIZE)) ||
+	    (blockNum == 0U) || (blockNum == HSM_POOL_NONE))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		const uint32_t stride =
+		    pool_align(HSM_POOL_HEADER_SIZE + blockSize);
+
+		me->itsBlockSize = blockSize;
+		me->itsBlockNum  = blockNum;
+		me->itsStride    = stride;
+
+		// cppcheck-suppress misra-c2012-21.3
+		me->itsBlocks = (uint8_t*)calloc(blockNum, me->itsStride);
+
+		if (me->itsBlocks == NULL)
+		{
+			/* No memory */
+			errorCode = -1;
+		}
+	}
+
+	if (errorCode == 0)
+	{
+		/* Every block is free */
+		for (uint32_t i = 0U; i < blockNum; i++)
+		{
+			pool_header_t* const header = pool_getHeader(me, i);
+
+			header->itsPool = me;
+			header->itsNext = i + 1U;
+		}
+
+		pool_getHeader(me, blockNum - 1U)->itsNext = HSM_POOL_NONE;
+		me->itsFree                               = 0U;
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Frees a pool.
+ *
+ * The payloads must have been released and the caches detached.
+ *
+ * \param[in,out] me The pool.
+ */
+void hsm_pool_destroy(hsm_pool_t* const me)
+{
+	if (me != NULL)
+	{
+		// cppcheck-suppress misra-c2012-21.3
+		free(me->itsBlocks);
+		me->itsBlocks = NULL;
+	}
+}
+
+/**
+ * \brief Sets the cache of the calling thread.
+ *
+ * The blocks of the previous cache go back to their pool. A thread has one
+ * cache, the payloads of other pools use the shared lists.
+ *
+ * \param[out] cache The cache, NULL to detach.
+ * \param[in]  pool  The pool it caches, NULL to detach.
+ */
+void hsm_pool_attach(hsm_pool_cache_t* const cache, hsm_pool_t* const pool)
+{
+	if (pool_cache != NULL)
+	{
+		pool_flush(pool_cache, pool_cache->itsNum);
+		pool_cache = NULL;
+	}
+
+	if ((cache != NULL) && (pool != NULL))
+	{
+		cache->itsPool = pool;
+		cache->itsNum  = 0U;
+		pool_cache     = cache;
+	}
+}
+
+/**
+ * \brief Takes a payload from a pool.
+ *
+ * The caller owns it, \see hsm_pool_release.
+ *
+ * \param[in,out] me The pool.
+ *
+ * \return The payload, NULL if the pool is empty.
+ */
+void* hsm_pool_alloc(hsm_pool_t* const me)
+{
+	hsm_pool_cache_t* const cache = pool_cache;
+	uint32_t                block = HSM_POOL_NONE;
+	void*                   data  = NULL;
+
+	if (me == NULL)
+	{
+		/* Invalid input. */
+	}
+	else if ((cache != NULL) && (cache->itsPool == me))
+	{
+		if (cache->itsNum == 0U)
+		{
+			bool empty = false;
+
+			/* Refill half of it */
+			while (!empty &&
+			       (cache->itsNum < (HSM_POOL_CACHE_NUM / 2U)))
+			{
+				const uint32_t aux = pool_pop(me);
+
+				if (aux == HSM_POOL_NONE)
+				{
+					empty = true;
+				}
+				else
+				{
+					cache->itsBlocks[cache->itsNum] = aux;
+					cache->itsNum++;
+				}
+			}
+		}
+
+		if (cache->itsNum != 0U)
+		{
+			cache->itsNum--;
+			block = cache->itsBlocks[cache->itsNum];
+		}
+	}
+	else
+	{
+		block = pool_pop(me);
+	}
+
+	if (block != HSM_POOL_NONE)
+	{
+		pool_header_t* const header = pool_getHeader(me, block);
+
+		__atomic_store_n(&header->itsRefNum, 1U, __ATOMIC_RELAXED);
+		data = &((uint8_t*)header)[HSM_POOL_HEADER_SIZE];
+	}
+
+	return data;
+}
+
+/**
+ * \brief Adds an owner to a payload.
+ *
+ * \param[in,out] data The payload.
+ */
+void hsm_pool_retain(void* const data)
+{
+	if (data != NULL)
+	{
+		pool_header_t* const header = pool_getOwner(data);
+
+		(void)__atomic_fetch_add(&header->itsRefNum,
+		                         1U,
+		                         __ATOMIC_RELAXED);
+	}
+}
+
+/**
+ * \brief Removes an owner from a payload.
+ *
+ * The last one gives it back to its pool.
+ *
+ * \param[in,out] data The payload.
+ */
+void hsm_pool_release(void* const data)
+{
+	if (data != NULL)
+	{
+		pool_header_t* const header = pool_getOwner(data);
+
+		if (__atomic_sub_fetch(&header->itsRefNum,
+		                       1U,
+		                       __ATOMIC_ACQ_REL) == 0U)
+		{
+			hsm_pool_t* const       me    = header->itsPool;
+			hsm_pool_cache_t* const cache = pool_cache;
+			const uint32_t          block =
+			    (uint32_t)(((uint8_t*)header - me->itsBlocks) /
+			               me->itsStride);
+
+			if ((cache != NULL) && (cache->itsPool == me))
+			{
+				if (cache->itsNum == HSM_POOL_CACHE_NUM)
+				{
+					/* Give half of it back */
+					pool_flush(cache,
+					           HSM_POOL_CACHE_NUM / 2U);
+				}
+
+				cache->itsBlocks[cache->itsNum] = block;
+				cache->itsNum++;
+			}
+			else
+			{
+				pool_push(me, block);
+			}
+		}
+	}
+}
+
+/**
+ * \brief Gets the number of owners of a payload.
+ *
+ * \param[in] data The payload.
+ *
+ * \return The number of owners.
+ */
+uint32_t hsm_pool_getRefNum(const void* const data)
+{
+	uint32_t refNum = 0U;
+
+	if (data != NULL)
+	{
+		const pool_header_t* const header = pool_getOwner(data);
+
+		refNum = __atomic_load_n(&header->itsRefNum, __ATOMIC_RELAXED);
+	}
+
+	return refNum;
+}
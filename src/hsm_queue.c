@@ -0,0 +1,271 @@
+// ############################################################################
+// ############################################################################
+// Code
+
+// ############################################################################
+// ############################################################################
+// Include files
+
+#include "hsm_queue.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+// ############################################################################
+// ############################################################################
+// Local functions
+
+static int queue_init(hsm_queue_t* const         me,
+                      void* const                machine,
+                      const hsm_queue_dispatch_t dispatch,
+                      hsm_queue_slot_t* const    slots,
+                      const uint32_t             capacity);
+static int queue_dispatchInst(void* const              machine,
+                              const hsm_event_t* const event);
+static int queue_dispatchMachine(void* const              machine,
+                                 const hsm_event_t* const event);
+
+/**
+ * \brief Initializes an event queue attached to a machine.
+ *
+ * \param[out] me       The queue.
+ * \param[in]  machine  The machine the events are dispatched to.
+ * \param[in]  dispatch How to dispatch to the machine.
+ * \param[in]  slots    The ring buffer, capacity in size.
+ * \param[in]  capacity The number of slots, a power of two.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int queue_init(hsm_queue_t* const         me,
+                      void* const                machine,
+                      const hsm_queue_dispatch_t dispatch,
+                      hsm_queue_slot_t* const    slots,
+                      const uint32_t             capacity)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (machine == NULL) || (slots == NULL) ||
+	    (capacity == 0U) || (capacity > 0x80000000U) ||
+	    ((capacity & (capacity - 1U)) != 0U))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		me->itsMachine  = machine;
+		me->itsDispatch = dispatch;
+		me->itsSlots    = slots;
+		me->itsMask     = capacity - 1U;
+		me->itsCount    = 0U;
+		me->itsTail     = 0U;
+		me->itsHead     = 0U;
+
+		/* No slot is published */
+		for (uint32_t i = 0U; i < capacity; i++)
+		{
+			slots[i].itsSequence = 0U;
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Dispatches an event to an instance, \see hsm_inst_dispatch.
+ *
+ * \param[in,out] machine The instance.
+ * \param[in]     event   The event signal.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int queue_dispatchInst(void* const              machine,
+                              const hsm_event_t* const event)
+{
+	// cppcheck-suppress misra-c2012-11.5
+	return hsm_inst_dispatch((hsm_inst_t*)machine, event);
+}
+
+/**
+ * \brief Dispatches an event to a machine, \see hsm_dispatch.
+ *
+ * \param[in,out] machine The hierarchical state machine handle.
+ * \param[in]     event   The event signal.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int queue_dispatchMachine(void* const              machine,
+                                 const hsm_event_t* const event)
+{
+	// cppcheck-suppress misra-c2012-11.5
+	return hsm_dispatch((hsm_t*)machine, event);
+}
+
+// ############################################################################
+// ############################################################################
+// Function definitions
+
+/**
+ * \brief Initializes an event queue attached to an instance.
+ *
+ * \param[out] me       The queue.
+ * \param[in]  machine  The instance the events are dispatched to.
+ * \param[in]  slots    The ring buffer, capacity in size.
+ * \param[in]  capacity The number of slots, a power of two.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_queue_init(hsm_queue_t* const      me,
+                   hsm_inst_t* const       machine,
+                   hsm_queue_slot_t* const slots,
+                   const uint32_t          capacity)
+{
+	return queue_init(me, machine, queue_dispatchInst, slots, capacity);
+}
+
+/**
+ * \brief Initializes an event queue attached to a machine.
+ *
+ * \param[out] me       The queue.
+ * \param[in]  machine  The machine the events are dispatched to.
+ * \param[in]  slots    The ring buffer, capacity in size.
+ * \param[in]  capacity The number of slots, a power of two.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_queue_initMachine(hsm_queue_t* const      me,
+                          hsm_t* const            machine,
+                          hsm_queue_slot_t* const slots,
+                          const uint32_t          capacity)
+{
+	return queue_init(me,
+	                  machine,
+	                  queue_dispatchMachine,
+	                  slots,
+	                  capacity);
+}
+
+/**
+ * \brief Posts an event to the queue.
+ *
+ * Wait-free, safe to call from any number of threads. The event is copied.
+ *
+ * A producer first reserves room with the count, so it never waits for the
+ * consumer, then claims an index and publishes its slot with the index.
+ *
+ * \param[in,out] me    The queue.
+ * \param[in]     event The event signal.
+ *
+ * \retval  1 The queue is full, the event is dropped.
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_post(hsm_queue_t* const me, const hsm_event_t* const event)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (event == NULL))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	/* Reserve room */
+	if (errorCode == 0)
+	{
+		const uint32_t count =
+		    __atomic_fetch_add(&me->itsCount, 1U, __ATOMIC_ACQ_REL);
+
+		if (count > me->itsMask)
+		{
+			/* Full */
+			(void)__atomic_fetch_sub(&me->itsCount,
+			                         1U,
+			                         __ATOMIC_RELEASE);
+			errorCode = 1;
+		}
+	}
+
+	/* Claim and publish */
+	if (errorCode == 0)
+	{
+		const uint32_t index =
+		    __atomic_fetch_add(&me->itsTail, 1U, __ATOMIC_ACQ_REL);
+		hsm_queue_slot_t* const slot =
+		    &me->itsSlots[index & me->itsMask];
+
+		slot->itsEvent = *event;
+		__atomic_store_n(&slot->itsSequence,
+		                 index + 1U,
+		                 __ATOMIC_RELEASE);
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Dispatches the posted events to the machine.
+ *
+ * Only the thread that owns the machine may call it. It returns when the
+ * queue is empty.
+ *
+ * \param[in,out] me The queue.
+ *
+ * \return The number of events dispatched, -1 on failure.
+ */
+int hsm_run(hsm_queue_t* const me)
+{
+	int  eventNum = 0;
+	bool empty    = false;
+
+	/* Check valid input */
+	if (me == NULL)
+	{
+		/* Invalid input. */
+		eventNum = -1;
+	}
+
+	while ((eventNum >= 0) && !empty)
+	{
+		const uint32_t    index = me->itsHead;
+		hsm_queue_slot_t* const slot =
+		    &me->itsSlots[index & me->itsMask];
+
+		if (__atomic_load_n(&slot->itsSequence, __ATOMIC_ACQUIRE) !=
+		    (index + 1U))
+		{
+			/* Not published yet */
+			empty = true;
+		}
+		else
+		{
+			/* Take it and give the slot back */
+			const hsm_event_t event = slot->itsEvent;
+
+			me->itsHead = index + 1U;
+			(void)__atomic_fetch_sub(&me->itsCount,
+			                         1U,
+			                         __ATOMIC_ACQ_REL);
+
+			if (me->itsDispatch(me->itsMachine, &event) != 0)
+			{
+				/* Fail */
+				eventNum = -1;
+			}
+			else
+			{
+				eventNum++;
+			}
+		}
+	}
+
+	return eventNum;
+}
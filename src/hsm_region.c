@@ -0,0 +1,587 @@
+// ############################################################################
+// ############################################################################
+// Code
+
+// ############################################################################
+// ############################################################################
+// Include files
+
+#include "hsm_region.h"
+
+#include <stdlib.h>
+
+// ############################################################################
+// ############################################################################
+// Local functions
+
+static int   regions_dispatch(hsm_regions_t* const     me,
+                              const hsm_event_t* const event);
+static void  regions_take(hsm_regions_t* const me);
+static void* regions_work(void* arg);
+static bool  regions_isShared(const hsm_t* const machine);
+
+/**
+ * \brief Gives an event to every region, in parallel if possible.
+ *
+ * \param[in,out] me    The regions.
+ * \param[in]     event The event signal, can be NULL.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int regions_dispatch(hsm_regions_t* const     me,
+                            const hsm_event_t* const event)
+{
+	const bool parallel =
+	    (me->itsThreads != NULL) && (me->itsSafeNum != 0U);
+	int errorCode = 0;
+
+	/* The workers take the thread safe regions */
+	if (parallel)
+	{
+		(void)pthread_mutex_lock(&me->itsLock);
+		me->itsEvent      = event;
+		me->itsNextIndex  = 0U;
+		me->itsPendingNum = me->itsSafeNum;
+		me->itsError      = 0;
+		me->itsRound++;
+		(void)pthread_cond_broadcast(&me->itsStartCond);
+		(void)pthread_mutex_unlock(&me->itsLock);
+	}
+
+	for (uint32_t i = 0U; i < me->itsRegionNum; i++)
+	{
+		const hsm_region_t* const region = &me->itsRegions[i];
+
+		if (!parallel || !region->itsThreadSafe)
+		{
+			if (hsm_dispatch(region->itsMachine, event) < 0)
+			{
+				/* Fail */
+				errorCode = -1;
+			}
+		}
+	}
+
+	/* Help the workers, then wait for them */
+	if (parallel)
+	{
+		(void)pthread_mutex_lock(&me->itsLock);
+		regions_take(me);
+
+		while (me->itsPendingNum != 0U)
+		{
+			(void)pthread_cond_wait(&me->itsDoneCond,
+			                        &me->itsLock);
+		}
+
+		if (me->itsError != 0)
+		{
+			/* Fail */
+			errorCode = -1;
+		}
+
+		(void)pthread_mutex_unlock(&me->itsLock);
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Handles the event in the thread safe regions not taken yet.
+ *
+ * Called with the lock held, it is released while a region runs.
+ *
+ * \param[in,out] me The regions.
+ */
+static void regions_take(hsm_regions_t* const me)
+{
+	while (me->itsNextIndex < me->itsRegionNum)
+	{
+		const hsm_region_t* const region =
+		    &me->itsRegions[me->itsNextIndex];
+
+		me->itsNextIndex++;
+
+		if (region->itsThreadSafe)
+		{
+			const hsm_event_t* const event = me->itsEvent;
+			int                      errorCode;
+
+			(void)pthread_mutex_unlock(&me->itsLock);
+			errorCode = hsm_dispatch(region->itsMachine, event);
+			(void)pthread_mutex_lock(&me->itsLock);
+
+			if (errorCode < 0)
+			{
+				me->itsError = -1;
+			}
+
+			me->itsPendingNum--;
+
+			if (me->itsPendingNum == 0U)
+			{
+				(void)pthread_cond_signal(&me->itsDoneCond);
+			}
+		}
+	}
+}
+
+/**
+ * \brief The worker thread.
+ *
+ * \param[in,out] arg The regions.
+ *
+ * \return NULL.
+ */
+static void* regions_work(void* arg)
+{
+	hsm_regions_t* const me    = (hsm_regions_t*)arg;
+	uint32_t             round = 0U;
+	bool                 done  = false;
+
+	(void)pthread_mutex_lock(&me->itsLock);
+	round = me->itsRound;
+
+	while (!done)
+	{
+		while (!me->itsStopping && (me->itsRound == round))
+		{
+			(void)pthread_cond_wait(&me->itsStartCond,
+			                        &me->itsLock);
+		}
+
+		done  = me->itsStopping;
+		round = me->itsRound;
+
+		if (!done)
+		{
+			regions_take(me);
+		}
+	}
+
+	(void)pthread_mutex_unlock(&me->itsLock);
+
+	return NULL;
+}
+
+/**
+ * \brief Checks if a machine or the machines of its regions reach state
+ *        shared with other machines, that is not locked.
+ *
+ * The timers bound to its states arm and cancel in their wheel, and a
+ * journal is appended to, on every transition.
+ *
+ * \param[in] machine The hierarchical state machine handle.
+ *
+ * \return True if it has bound timers or a journal.
+ */
+static bool regions_isShared(const hsm_t* const machine)
+{
+	bool shared = (machine->itsJournal != NULL);
+
+	for (uint32_t i = 0U; !shared && (i < machine->allStatesSize); i++)
+	{
+		shared = (machine->allStates[i]->itsTimers != NULL);
+	}
+
+	for (const hsm_regions_t* regions = machine->itsRegions;
+	     !shared && (regions != NULL);
+	     regions = regions->itsNext)
+	{
+		for (uint32_t i = 0U; !shared && (i < regions->itsRegionNum);
+		     i++)
+		{
+			shared = regions_isShared(
+			    regions->itsRegions[i].itsMachine);
+		}
+	}
+
+	return shared;
+}
+
+// ############################################################################
+// ############################################################################
+// Function definitions
+
+/**
+ * \brief Initializes the regions of a state.
+ *
+ * The region machines are reset, they start when the state is entered.
+ *
+ * \param[out] me        The regions.
+ * \param[in]  machine   The machine of the state.
+ * \param[in]  state     The state, a leaf of machine.
+ * \param[in]  regions   The regions, regionNum in size.
+ * \param[in]  regionNum The number of regions.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_regions_init(hsm_regions_t* const me,
+                     hsm_t* const         machine,
+                     const state_t* const state,
+                     hsm_region_t* const  regions,
+                     const uint32_t       regionNum)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (machine == NULL) || (state == NULL) ||
+	    (regions == NULL) || (regionNum == 0U))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+	else if (state->itsInitialState != NULL)
+	{
+		/* Not a leaf */
+		errorCode = -1;
+	}
+	else
+	{
+		/* Valid */
+	}
+
+	for (uint32_t i = 0U; (errorCode == 0) && (i < regionNum); i++)
+	{
+		errorCode = hsm_reset(regions[i].itsMachine);
+	}
+
+	if (errorCode == 0)
+	{
+		me->itsMachine    = machine;
+		me->itsState      = state;
+		me->itsRegions    = regions;
+		me->itsRegionNum  = regionNum;
+		me->itsActive     = false;
+		me->itsSafeNum    = 0U;
+		me->itsThreads    = NULL;
+		me->itsThreadNum  = 0U;
+		me->itsEvent      = NULL;
+		me->itsRound      = 0U;
+		me->itsNextIndex  = regionNum;
+		me->itsPendingNum = 0U;
+		me->itsError      = 0;
+		me->itsStopping   = false;
+
+		if (pthread_mutex_init(&me->itsLock, NULL) != 0)
+		{
+			/* Fail */
+			errorCode = -1;
+		}
+		else if (pthread_cond_init(&me->itsStartCond, NULL) != 0)
+		{
+			/* Fail */
+			(void)pthread_mutex_destroy(&me->itsLock);
+			errorCode = -1;
+		}
+		else if (pthread_cond_init(&me->itsDoneCond, NULL) != 0)
+		{
+			/* Fail */
+			(void)pthread_cond_destroy(&me->itsStartCond);
+			(void)pthread_mutex_destroy(&me->itsLock);
+			errorCode = -1;
+		}
+		else
+		{
+			/* Do nothing */
+		}
+	}
+
+	if (errorCode == 0)
+	{
+		for (uint32_t i = 0U; i < regionNum; i++)
+		{
+			me->itsSafeNum += regions[i].itsThreadSafe ? 1U : 0U;
+		}
+
+		me->itsNext         = machine->itsRegions;
+		machine->itsRegions = me;
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Stops the workers and unbinds the regions from their machine.
+ *
+ * \param[in,out] me The regions.
+ */
+void hsm_regions_destroy(hsm_regions_t* const me)
+{
+	if (me != NULL)
+	{
+		hsm_regions_t** link = &me->itsMachine->itsRegions;
+
+		(void)hsm_regions_stop(me);
+
+		while ((*link != NULL) && (*link != me))
+		{
+			link = &(*link)->itsNext;
+		}
+
+		if (*link == me)
+		{
+			*link = me->itsNext;
+		}
+
+		(void)pthread_cond_destroy(&me->itsDoneCond);
+		(void)pthread_cond_destroy(&me->itsStartCond);
+		(void)pthread_mutex_destroy(&me->itsLock);
+	}
+}
+
+/**
+ * \brief Starts worker threads for the thread safe regions.
+ *
+ * The calling thread also handles events, threadNum workers with it make
+ * threadNum + 1 regions run at once.
+ *
+ * A thread safe region may not have timers bound to its states or a
+ * journal attached, nor may the machines of its own regions, see
+ * hsm_region.h.
+ *
+ * \param[in,out] me        The regions.
+ * \param[out]    threads   The workers, threadNum in size.
+ * \param[in]     threadNum The number of workers.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_regions_start(hsm_regions_t* const me,
+                      pthread_t* const     threads,
+                      const uint32_t       threadNum)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (threads == NULL) || (threadNum == 0U) ||
+	    (me->itsThreads != NULL))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	/* The wheels and the journals are not locked */
+	for (uint32_t i = 0U; (errorCode == 0) && (i < me->itsRegionNum); i++)
+	{
+		if (me->itsRegions[i].itsThreadSafe &&
+		    regions_isShared(me->itsRegions[i].itsMachine))
+		{
+			/* Invalid input. */
+			errorCode = -1;
+		}
+	}
+
+	if (errorCode == 0)
+	{
+		me->itsThreads   = threads;
+		me->itsThreadNum = 0U;
+		me->itsStopping  = false;
+
+		for (uint32_t i = 0U; (errorCode == 0) && (i < threadNum); i++)
+		{
+			const int result = pthread_create(&threads[i],
+			                                  NULL,
+			                                  regions_work,
+			                                  me);
+
+			if (result != 0)
+			{
+				/* Fail */
+				errorCode = -1;
+			}
+			else
+			{
+				me->itsThreadNum++;
+			}
+		}
+
+		if (errorCode != 0)
+		{
+			(void)hsm_regions_stop(me);
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Stops the worker threads, the regions run on the calling thread
+ *        after.
+ *
+ * Do not call it while an event is being dispatched.
+ *
+ * \param[in,out] me The regions.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_regions_stop(hsm_regions_t* const me)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if (me == NULL)
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if ((errorCode == 0) && (me->itsThreads != NULL))
+	{
+		(void)pthread_mutex_lock(&me->itsLock);
+		me->itsStopping = true;
+		(void)pthread_cond_broadcast(&me->itsStartCond);
+		(void)pthread_mutex_unlock(&me->itsLock);
+
+		for (uint32_t i = 0U; i < me->itsThreadNum; i++)
+		{
+			if (pthread_join(me->itsThreads[i], NULL) != 0)
+			{
+				/* Fail */
+				errorCode = -1;
+			}
+		}
+
+		me->itsThreads   = NULL;
+		me->itsThreadNum = 0U;
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Checks if the state of the regions is active.
+ *
+ * \param[in] me The regions.
+ *
+ * \return True if the regions handle the events.
+ */
+bool hsm_regions_isActive(const hsm_regions_t* const me)
+{
+	return (me != NULL) && me->itsActive;
+}
+
+/**
+ * \brief Enters the regions of a state the machine entered.
+ *
+ * \param[in] machine The hierarchical state machine handle.
+ * \param[in] state   The state.
+ * \param[in] event   The event signal.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_region_enter(const hsm_t* const       machine,
+                     const state_t* const     state,
+                     const hsm_event_t* const event)
+{
+	int errorCode = 0;
+
+	for (hsm_regions_t* regions = machine->itsRegions;
+	     (errorCode == 0) && (regions != NULL);
+	     regions = regions->itsNext)
+	{
+		if (regions->itsState == state)
+		{
+			for (uint32_t i = 0U;
+			     (errorCode == 0) && (i < regions->itsRegionNum);
+			     i++)
+			{
+				errorCode = hsm_enter(
+				    regions->itsRegions[i].itsMachine,
+				    event);
+			}
+
+			regions->itsActive = (errorCode == 0);
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Exits the regions of a state the machine is exiting.
+ *
+ * \param[in] machine The hierarchical state machine handle.
+ * \param[in] state   The state.
+ * \param[in] event   The event signal.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_region_exit(const hsm_t* const       machine,
+                    const state_t* const     state,
+                    const hsm_event_t* const event)
+{
+	int errorCode = 0;
+
+	for (hsm_regions_t* regions = machine->itsRegions;
+	     (errorCode == 0) && (regions != NULL);
+	     regions = regions->itsNext)
+	{
+		if (regions->itsState == state)
+		{
+			regions->itsActive = false;
+
+			for (uint32_t i = 0U;
+			     (errorCode == 0) && (i < regions->itsRegionNum);
+			     i++)
+			{
+				errorCode = hsm_exit(
+				    regions->itsRegions[i].itsMachine,
+				    event);
+			}
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Gives an event to the regions of the machine's active states.
+ *
+ * \param[in] machine The hierarchical state machine handle.
+ * \param[in] event   The event signal, can be NULL.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_region_dispatch(const hsm_t* const       machine,
+                        const hsm_event_t* const event)
+{
+	int errorCode = 0;
+
+	for (hsm_regions_t* regions = machine->itsRegions;
+	     (errorCode == 0) && (regions != NULL);
+	     regions = regions->itsNext)
+	{
+		if (regions->itsActive)
+		{
+			errorCode = regions_dispatch(regions, event);
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Resets the regions of a machine that was reset.
+ *
+ * \param[in] machine The hierarchical state machine handle.
+ */
+void hsm_region_reset(const hsm_t* const machine)
+{
+	for (hsm_regions_t* regions = machine->itsRegions; regions != NULL;
+	     regions                = regions->itsNext)
+	{
+		regions->itsActive = false;
+
+		for (uint32_t i = 0U; i < regions->itsRegionNum; i++)
+		{
+			(void)hsm_reset(regions->itsRegions[i].itsMachine);
+		}
+	}
+}
@@ -0,0 +1,537 @@
+// ############################################################################
+// ############################################################################
+// Code
+
+// ############################################################################
+// ############################################################################
+// Include files
+
+#include "hsm_snapshot.h"
+
+#include "hsm_region.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+// ############################################################################
+// ############################################################################
+// Local definitions
+
+/**
+ * \brief The size of the blob's header.
+ */
+#define HSM_SNAPSHOT_HEADER_SIZE (14U)
+
+/**
+ * \brief The size of a state's record.
+ */
+#define HSM_SNAPSHOT_RECORD_SIZE (3U)
+
+/**
+ * \brief The size of the checksum.
+ */
+#define HSM_SNAPSHOT_CHECKSUM_SIZE (4U)
+
+/* The first bytes of a blob */
+static const uint8_t snapshot_magic[4] = {'H', 'S', 'M', 'S'};
+
+// ############################################################################
+// ############################################################################
+// Local functions
+
+static void     snapshot_put16(uint8_t* const blob, const uint32_t value);
+static void     snapshot_put32(uint8_t* const blob, const uint32_t value);
+static uint32_t snapshot_get16(const uint8_t* const blob);
+static uint32_t snapshot_get32(const uint8_t* const blob);
+static uint32_t snapshot_getChecksum(const uint8_t* const blob,
+                                     const size_t         size);
+static bool     snapshot_isBelow(const state_t* const state,
+                                 const state_t* const ancestor);
+static size_t   snapshot_getBlobSize(const hsm_t* const me);
+static int      snapshot_write(const hsm_t* const me, uint8_t* const blob);
+static int      snapshot_check(const hsm_t* const me,
+                               const uint8_t* const blob);
+static void     snapshot_read(hsm_t* const me, const uint8_t* const blob);
+
+/**
+ * \brief Writes a 16 bit value, little endian.
+ *
+ * \param[out] blob  Where to write.
+ * \param[in]  value The value.
+ */
+static void snapshot_put16(uint8_t* const blob, const uint32_t value)
+{
+	blob[0] = (uint8_t)value;
+	blob[1] = (uint8_t)(value >> 8U);
+}
+
+/**
+ * \brief Writes a 32 bit value, little endian.
+ *
+ * \param[out] blob  Where to write.
+ * \param[in]  value The value.
+ */
+static void snapshot_put32(uint8_t* const blob, const uint32_t value)
+{
+	snapshot_put16(blob, value);
+	snapshot_put16(&blob[2], value >> 16U);
+}
+
+/**
+ * \brief Reads a 16 bit value, little endian.
+ *
+ * \param[in] blob Where to read.
+ *
+ * \return The value.
+ */
+static uint32_t snapshot_get16(const uint8_t* const blob)
+{
+	return (uint32_t)blob[0] | ((uint32_t)blob[1] << 8U);
+}
+
+/**
+ * \brief Reads a 32 bit value, little endian.
+ *
+ * \param[in] blob Where to read.
+ *
+ * \return The value.
+ */
+static uint32_t snapshot_get32(const uint8_t* const blob)
+{
+	return snapshot_get16(blob) | (snapshot_get16(&blob[2]) << 16U);
+}
+
+/**
+ * \brief Computes the FNV-1a hash of some bytes.
+ *
+ * \param[in] blob The bytes.
+ * \param[in] size The number of bytes.
+ *
+ * \return The hash.
+ */
+static uint32_t snapshot_getChecksum(const uint8_t* const blob,
+                                     const size_t         size)
+{
+	uint32_t checksum = 2166136261U;
+
+	for (size_t i = 0U; i < size; i++)
+	{
+		checksum = (checksum ^ blob[i]) * 16777619U;
+	}
+
+	return checksum;
+}
+
+/**
+ * \brief Checks if a state is below another one.
+ *
+ * \param[in] state    The hsm state.
+ * \param[in] ancestor The state above it.
+ *
+ * \return True if it is a descendant of ancestor, False otherwise.
+ */
+static bool snapshot_isBelow(const state_t* const state,
+                             const state_t* const ancestor)
+{
+	const state_t* aux   = state->itsParentState;
+	bool           found = false;
+
+	for (uint32_t i = 0U; (aux != NULL) && !found && (i < HSM_MAX_DEPTH);
+	     i++)
+	{
+		found = (aux == ancestor);
+		aux   = aux->itsParentState;
+	}
+
+	return found;
+}
+
+/**
+ * \brief Gets the size of the snapshot of a machine and its regions.
+ *
+ * \param[in] me The hierarchical state machine handle.
+ *
+ * \return The size in bytes, 0 if it can not be taken.
+ */
+static size_t snapshot_getBlobSize(const hsm_t* const me)
+{
+	size_t size = 0U;
+
+	if ((me->allStates != NULL) &&
+	    (me->allStatesSize < HSM_SNAPSHOT_STATE_NONE))
+	{
+		size = HSM_SNAPSHOT_HEADER_SIZE +
+		       ((size_t)me->allStatesSize * HSM_SNAPSHOT_RECORD_SIZE) +
+		       HSM_SNAPSHOT_CHECKSUM_SIZE;
+	}
+
+	/* The snapshots of the regions are nested in it */
+	for (const hsm_regions_t* regions = me->itsRegions;
+	     (size != 0U) && (regions != NULL);
+	     regions = regions->itsNext)
+	{
+		for (uint32_t i = 0U;
+		     (size != 0U) && (i < regions->itsRegionNum);
+		     i++)
+		{
+			const hsm_t* const region =
+			    regions->itsRegions[i].itsMachine;
+			const size_t regionSize = snapshot_getBlobSize(region);
+
+			size = (regionSize == 0U) ? 0U : (size + regionSize);
+		}
+	}
+
+	return size;
+}
+
+/**
+ * \brief Writes the snapshot of a machine and its regions.
+ *
+ * \param[in]  me   The hierarchical state machine handle.
+ * \param[out] blob The snapshot, \see snapshot_getBlobSize in size.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int snapshot_write(const hsm_t* const me, uint8_t* const blob)
+{
+	int errorCode = 0;
+
+	if (me->itsTransition != NULL)
+	{
+		/* In the middle of a transition of hsm_handleEvent */
+		errorCode = -1;
+	}
+
+	uint8_t* record = &blob[HSM_SNAPSHOT_HEADER_SIZE];
+
+	if (errorCode == 0)
+	{
+		for (uint32_t i = 0U; i < 4U; i++)
+		{
+			blob[i] = snapshot_magic[i];
+		}
+
+		snapshot_put16(&blob[4], HSM_SNAPSHOT_VERSION);
+		snapshot_put16(&blob[6], 0U);
+		snapshot_put32(&blob[8], me->allStatesSize);
+		snapshot_put16(&blob[12],
+		               hsm_getStateIndex(me, me->itsCurrentState));
+
+		for (uint32_t i = 0U; i < me->allStatesSize; i++)
+		{
+			const state_t* const state = me->allStates[i];
+			const uint32_t       history =
+			    hsm_getStateIndex(me, state->itsHistoryState);
+
+			record[0] = (uint8_t)state->itsMode;
+			snapshot_put16(&record[1],
+			               (history == HSM_STATE_INDEX_NONE)
+			                   ? HSM_SNAPSHOT_STATE_NONE
+			                   : history);
+			record = &record[HSM_SNAPSHOT_RECORD_SIZE];
+		}
+	}
+
+	/* Then the regions, in the order of the machine's list */
+	for (const hsm_regions_t* regions = me->itsRegions;
+	     (errorCode == 0) && (regions != NULL);
+	     regions = regions->itsNext)
+	{
+		for (uint32_t i = 0U;
+		     (errorCode == 0) && (i < regions->itsRegionNum);
+		     i++)
+		{
+			const hsm_t* const region =
+			    regions->itsRegions[i].itsMachine;
+
+			errorCode = snapshot_write(region, record);
+			record    = &record[snapshot_getBlobSize(region)];
+		}
+	}
+
+	if (errorCode == 0)
+	{
+		/* The checksum covers everything before it */
+		snapshot_put32(
+		    record,
+		    snapshot_getChecksum(blob, (size_t)(record - blob)));
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Checks the snapshot of a machine and its regions.
+ *
+ * \param[in] me   The hierarchical state machine handle.
+ * \param[in] blob The snapshot, \see snapshot_getBlobSize in size.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+static int snapshot_check(const hsm_t* const me, const uint8_t* const blob)
+{
+	int errorCode = 0;
+
+	/* Check the header */
+	const size_t checksumIndex =
+	    snapshot_getBlobSize(me) - HSM_SNAPSHOT_CHECKSUM_SIZE;
+
+	for (uint32_t i = 0U; i < 4U; i++)
+	{
+		if (blob[i] != snapshot_magic[i])
+		{
+			/* Not a snapshot */
+			errorCode = -1;
+		}
+	}
+
+	if ((snapshot_get16(&blob[4]) != HSM_SNAPSHOT_VERSION) ||
+	    (snapshot_get32(&blob[8]) != me->allStatesSize) ||
+	    (snapshot_get16(&blob[12]) >= me->allStatesSize) ||
+	    (snapshot_get32(&blob[checksumIndex]) !=
+	     snapshot_getChecksum(blob, checksumIndex)))
+	{
+		/* Not a snapshot of this machine */
+		errorCode = -1;
+	}
+
+	/* Check the states */
+	for (uint32_t i = 0U; (errorCode == 0) && (i < me->allStatesSize); i++)
+	{
+		const uint8_t* const record =
+		    &blob[HSM_SNAPSHOT_HEADER_SIZE +
+		          (i * HSM_SNAPSHOT_RECORD_SIZE)];
+		const uint32_t history = snapshot_get16(&record[1]);
+
+		if (record[0] > (uint8_t)HSM_ST_M_ERROR)
+		{
+			/* Unknown mode */
+			errorCode = -1;
+		}
+		else if (history == HSM_SNAPSHOT_STATE_NONE)
+		{
+			/* No history */
+		}
+		else if (history >= me->allStatesSize)
+		{
+			/* Not a state */
+			errorCode = -1;
+		}
+		else if (me->allStates[i]->itsHistory == HSM_HISTORY_DEEP)
+		{
+			if (!snapshot_isBelow(me->allStates[history],
+			                      me->allStates[i]))
+			{
+				/* Not below its deep history */
+				errorCode = -1;
+			}
+		}
+		else if (me->allStates[history]->itsParentState !=
+		         me->allStates[i])
+		{
+			/* Not a child */
+			errorCode = -1;
+		}
+		else
+		{
+			/* Valid */
+		}
+	}
+
+	/* Check the regions */
+	const uint8_t* nested =
+	    &blob[HSM_SNAPSHOT_HEADER_SIZE +
+	          ((size_t)me->allStatesSize * HSM_SNAPSHOT_RECORD_SIZE)];
+
+	for (const hsm_regions_t* regions = me->itsRegions;
+	     (errorCode == 0) && (regions != NULL);
+	     regions = regions->itsNext)
+	{
+		for (uint32_t i = 0U;
+		     (errorCode == 0) && (i < regions->itsRegionNum);
+		     i++)
+		{
+			const hsm_t* const region =
+			    regions->itsRegions[i].itsMachine;
+
+			errorCode = snapshot_check(region, nested);
+			nested    = &nested[snapshot_getBlobSize(region)];
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Restores a machine and its regions from a checked snapshot.
+ *
+ * \param[in,out] me   The hierarchical state machine handle.
+ * \param[in]     blob The snapshot, \see snapshot_check.
+ */
+static void snapshot_read(hsm_t* const me, const uint8_t* const blob)
+{
+	for (uint32_t i = 0U; i < me->allStatesSize; i++)
+	{
+		const uint8_t* const record =
+		    &blob[HSM_SNAPSHOT_HEADER_SIZE +
+		          (i * HSM_SNAPSHOT_RECORD_SIZE)];
+		const uint32_t history = snapshot_get16(&record[1]);
+		state_t* const state   = me->allStates[i];
+
+		state->itsMode         = (hsm_st_mode_t)record[0];
+		state->itsHistoryState = (history == HSM_SNAPSHOT_STATE_NONE)
+		                             ? NULL
+		                             : me->allStates[history];
+		state->itsActiveState  = NULL;
+	}
+
+	/* The active states are the ones entered */
+	for (uint32_t i = 0U; i < me->allStatesSize; i++)
+	{
+		state_t* const state = me->allStates[i];
+		// cppcheck-suppress misra-c2012-11.8
+		state_t* const parent = (state_t*)state->itsParentState;
+
+		if ((parent != NULL) && (state->itsMode != HSM_ST_M_ON_ENTRY))
+		{
+			parent->itsActiveState = state;
+		}
+	}
+
+	me->itsCurrentState = me->allStates[snapshot_get16(&blob[12])];
+	me->itsTransition   = NULL;
+	me->itsExitNum      = 0U;
+
+	/* The regions of the entered leaf are active, and restored */
+	const uint8_t* nested =
+	    &blob[HSM_SNAPSHOT_HEADER_SIZE +
+	          ((size_t)me->allStatesSize * HSM_SNAPSHOT_RECORD_SIZE)];
+
+	for (hsm_regions_t* regions = me->itsRegions; regions != NULL;
+	     regions                = regions->itsNext)
+	{
+		regions->itsActive =
+		    (regions->itsState == me->itsCurrentState) &&
+		    (me->itsCurrentState->itsMode == HSM_ST_M_DURING);
+
+		for (uint32_t i = 0U; i < regions->itsRegionNum; i++)
+		{
+			hsm_t* const region =
+			    regions->itsRegions[i].itsMachine;
+
+			snapshot_read(region, nested);
+			nested = &nested[snapshot_getBlobSize(region)];
+		}
+	}
+}
+
+// ############################################################################
+// ############################################################################
+// Function definitions
+
+/**
+ * \brief Gets the size of the snapshot of a machine.
+ *
+ * \param[in] me The hierarchical state machine handle.
+ *
+ * \return The size in bytes, 0 if it can not be taken.
+ */
+size_t hsm_snapshot_getSize(const hsm_t* const me)
+{
+	return (me != NULL) ? snapshot_getBlobSize(me) : 0U;
+}
+
+/**
+ * \brief Takes a snapshot of a machine.
+ *
+ * It is taken between transitions, not while \see hsm_handleEvent is in the
+ * middle of one.
+ *
+ * \param[in]  me   The hierarchical state machine handle.
+ * \param[out] blob The snapshot.
+ * \param[in]  size The size of blob, \see hsm_snapshot_getSize.
+ *
+ * \retval  1 The blob is too small.
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_snapshot(const hsm_t* const me,
+                 uint8_t* const     blob,
+                 const size_t       size)
+{
+	const size_t blobSize  = hsm_snapshot_getSize(me);
+	int          errorCode = 0;
+
+	/* Check valid input */
+	if ((blobSize == 0U) || (blob == NULL))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+	else if (me->itsTransition != NULL)
+	{
+		/* In the middle of a transition of hsm_handleEvent */
+		errorCode = -1;
+	}
+	else if (size < blobSize)
+	{
+		/* Too small */
+		errorCode = 1;
+	}
+	else
+	{
+		/* Valid */
+	}
+
+	if (errorCode == 0)
+	{
+		errorCode = snapshot_write(me, blob);
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Restores a machine from a snapshot.
+ *
+ * The machine must be built with the same state list as the one in the
+ * snapshot, and have the same regions. No action is executed, the machine
+ * is left as it was if the blob is not valid.
+ *
+ * \param[in,out] me   The hierarchical state machine handle.
+ * \param[in]     blob The snapshot.
+ * \param[in]     size The size of blob.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_restore(hsm_t* const         me,
+                const uint8_t* const blob,
+                const size_t         size)
+{
+	const size_t blobSize  = hsm_snapshot_getSize(me);
+	int          errorCode = 0;
+
+	/* Check valid input */
+	if ((blobSize == 0U) || (blob == NULL) || (size != blobSize))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	/* All of it is checked before anything is changed */
+	if (errorCode == 0)
+	{
+		errorCode = snapshot_check(me, blob);
+	}
+
+	if (errorCode == 0)
+	{
+		snapshot_read(me, blob);
+	}
+
+	return errorCode;
+}
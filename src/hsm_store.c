@@ -0,0 +1,569 @@
+// ############################################################################
+// ############################################################################
+// Code
+
+// ############################################################################
+// ############################################################################
+// Include files
+
+/* For ftruncate and msync */
+#define _GNU_SOURCE
+
+#include "hsm_store.h"
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ############################################################################
+// ############################################################################
+// Local definitions
+
+/**
+ * \brief The first bytes of a file, "HSMF" in the creator's byte order.
+ */
+#define HSM_STORE_MAGIC (0x464D5348U)
+
+/**
+ * \brief The size of the header, the records stay aligned after it.
+ */
+#define HSM_STORE_HEADER_SIZE (64U)
+
+/**
+ * \brief File header.
+ */
+typedef struct
+{
+	uint32_t itsMagic;       /**< HSM_STORE_MAGIC. */
+	uint16_t itsVersion;     /**< HSM_STORE_VERSION. */
+	uint16_t itsStateIdBits; /**< HSM_STATE_ID_BITS. */
+	uint32_t itsStateNum;    /**< The states of the definition. */
+	uint32_t itsHistoryNum;  /**< The history slots of the definition. */
+	uint32_t itsRecordSize;  /**< The state ids in a record. */
+	uint32_t itsRecordNum;   /**< The number of records. */
+	uint32_t itsFingerprint; /**< Hash of the definition's tree. */
+} store_header_t;
+
+// ############################################################################
+// ############################################################################
+// Local functions
+
+static uint32_t   store_hash(uint32_t             hash,
+                             const uint8_t* const bytes,
+                             const size_t         size);
+static uint32_t   store_getFingerprint(const hsm_def_t* const def);
+static hsm_inst_t store_getInst(const hsm_store_t* const me,
+                                const uint32_t           index);
+static void       store_setInst(hsm_store_t* const      me,
+                                const uint32_t          index,
+                                const hsm_inst_t* const inst);
+static bool       store_isValid(const hsm_store_t* const me,
+                                const uint32_t           index);
+static bool       store_check(const hsm_store_t* const me,
+                              const uint32_t           index);
+
+/**
+ * \brief Adds some bytes to an FNV-1a hash.
+ *
+ * \param[in] hash  The hash so far.
+ * \param[in] bytes The bytes.
+ * \param[in] size  The number of bytes.
+ *
+ * \return The hash.
+ */
+static uint32_t store_hash(uint32_t             hash,
+                           const uint8_t* const bytes,
+                           const size_t         size)
+{
+	for (size_t i = 0U; i < size; i++)
+	{
+		hash = (hash ^ bytes[i]) * 16777619U;
+	}
+
+	return hash;
+}
+
+/**
+ * \brief Hashes the tree of a definition.
+ *
+ * The parents, initial states, history slots and which of them keep a leaf
+ * decide what a record means.
+ *
+ * \param[in] def The definition.
+ *
+ * \return The fingerprint.
+ */
+static uint32_t store_getFingerprint(const hsm_def_t* const def)
+{
+	const size_t size = sizeof(hsm_state_id_t) * def->itsStateNum;
+	uint32_t     hash = 2166136261U;
+
+	hash = store_hash(hash, (const uint8_t*)def->itsParent, size);
+	hash = store_hash(hash, (const uint8_t*)def->itsInitial, size);
+	hash = store_hash(hash, (const uint8_t*)def->itsHistorySlot, size);
+
+	for (uint32_t i = 0U; i < def->itsStateNum; i++)
+	{
+		const uint8_t deep =
+		    (uint8_t)(def->itsActions[i] & HSM_DEF_HISTORY_DEEP);
+
+		hash = store_hash(hash, &deep, sizeof(deep));
+	}
+
+	return hash;
+}
+
+/**
+ * \brief Gets an instance of the store.
+ *
+ * \param[in] me    The store.
+ * \param[in] index The index of the instance.
+ *
+ * \return The instance, its history slots are in the record.
+ */
+static hsm_inst_t store_getInst(const hsm_store_t* const me,
+                                const uint32_t           index)
+{
+	hsm_state_id_t* const record =
+	    &me->itsRecords[(size_t)index * me->itsRecordSize];
+	hsm_inst_t inst;
+
+	inst.itsDef          = me->itsDef;
+	inst.itsHistory      = &record[2];
+	inst.itsCurrentState = record[0];
+	inst.itsMode         = (uint8_t)record[1];
+#if HSM_TRACE
+	/* The instance itself is a temporary, its record is not */
+	inst.itsTraceId = record;
+#endif
+
+	return inst;
+}
+
+/**
+ * \brief Stores an instance back to its record.
+ *
+ * \param[in,out] me    The store.
+ * \param[in]     index The index of the instance.
+ * \param[in]     inst  The instance.
+ */
+static void store_setInst(hsm_store_t* const      me,
+                          const uint32_t          index,
+                          const hsm_inst_t* const inst)
+{
+	hsm_state_id_t* const record =
+	    &me->itsRecords[(size_t)index * me->itsRecordSize];
+
+	record[0] = inst->itsCurrentState;
+	record[1] = inst->itsMode;
+}
+
+/**
+ * \brief Checks that a record holds states of the definition.
+ *
+ * Each history slot must hold a child of its state, or a state below it
+ * for a deep history, as the dispatch indexes the tables with them.
+ *
+ * \param[in] me    The store.
+ * \param[in] index The index of the instance.
+ *
+ * \return True if the record is valid.
+ */
+static bool store_isValid(const hsm_store_t* const me, const uint32_t index)
+{
+	const hsm_def_t* const      def = me->itsDef;
+	const hsm_state_id_t* const record =
+	    &me->itsRecords[(size_t)index * me->itsRecordSize];
+	bool valid = (record[0] < def->itsStateNum) &&
+	             (record[1] <= (hsm_state_id_t)HSM_ST_M_ERROR);
+
+	for (uint32_t i = 0U; valid && (i < def->itsStateNum); i++)
+	{
+		const hsm_state_id_t slot = def->itsHistorySlot[i];
+
+		if (slot != HSM_STATE_ID_NONE)
+		{
+			const hsm_state_id_t history = record[2U + slot];
+
+			if (history >= def->itsStateNum)
+			{
+				/* Not a state */
+				valid = false;
+			}
+			else if ((def->itsActions[i] & HSM_DEF_HISTORY_DEEP) ==
+			         0U)
+			{
+				valid = (def->itsParent[history] == i);
+			}
+			else
+			{
+				hsm_state_id_t aux = def->itsParent[history];
+
+				while ((aux != HSM_STATE_ID_NONE) &&
+				       (aux != i))
+				{
+					aux = def->itsParent[aux];
+				}
+
+				valid = (aux == i);
+			}
+		}
+	}
+
+	return valid;
+}
+
+/**
+ * \brief Checks a record the first time it is touched.
+ *
+ * The store writes only valid records, so a record is trusted afterwards.
+ *
+ * \param[in] me    The store.
+ * \param[in] index The index of the instance.
+ *
+ * \return True if the record is valid.
+ */
+static bool store_check(const hsm_store_t* const me, const uint32_t index)
+{
+	if ((me->itsChecked[index] == 0U) && store_isValid(me, index))
+	{
+		me->itsChecked[index] = 1U;
+	}
+
+	return (me->itsChecked[index] != 0U);
+}
+
+// ############################################################################
+// ############################################################################
+// Function definitions
+
+/**
+ * \brief Opens a store, creating it if the file is new or empty.
+ *
+ * An existing file must have been created for the same definition and
+ * number of instances. Its records are not read yet, each one is checked
+ * when it is first touched.
+ *
+ * \param[out] me        The store.
+ * \param[in]  def       The shared definition.
+ * \param[in]  path      The file.
+ * \param[in]  recordNum The number of instances.
+ *
+ * \retval  1 Created, every instance is reset.
+ * \retval  0 Opened, the instances are as they were left.
+ * \retval -1 Failure.
+ */
+int hsm_store_open(hsm_store_t* const     me,
+                   const hsm_def_t* const def,
+                   const char* const      path,
+                   const uint32_t         recordNum)
+{
+	int  errorCode = 0;
+	bool created   = false;
+
+	/* Check valid input */
+	if (me == NULL)
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+	else
+	{
+		/* Nothing is open yet */
+		me->itsMemory  = NULL;
+		me->itsChecked = NULL;
+		me->itsFile    = -1;
+
+		if ((def == NULL) || (def->itsStateNum == 0U) ||
+		    (path == NULL) || (recordNum == 0U))
+		{
+			/* Invalid input. */
+			errorCode = -1;
+		}
+	}
+
+	if (errorCode == 0)
+	{
+		struct stat status;
+
+		me->itsDef        = def;
+		me->itsRecordNum  = recordNum;
+		me->itsRecordSize = 2U + def->itsHistoryNum;
+		me->itsSize       = HSM_STORE_HEADER_SIZE +
+		              (sizeof(hsm_state_id_t) * me->itsRecordSize *
+		               (size_t)recordNum);
+		me->itsFile = open(path, O_RDWR | O_CREAT, 0644);
+
+		if ((me->itsFile < 0) || (fstat(me->itsFile, &status) != 0))
+		{
+			/* Can not open */
+			errorCode = -1;
+		}
+		else if (status.st_size == 0)
+		{
+			created   = true;
+			errorCode = ftruncate(me->itsFile, (off_t)me->itsSize);
+		}
+		else if ((size_t)status.st_size != me->itsSize)
+		{
+			/* Not the same number of instances */
+			errorCode = -1;
+		}
+		else
+		{
+			/* Existing */
+		}
+	}
+
+	if (errorCode == 0)
+	{
+		void* const memory = mmap(NULL,
+		                          me->itsSize,
+		                          PROT_READ | PROT_WRITE,
+		                          MAP_SHARED,
+		                          me->itsFile,
+		                          0);
+
+		if (memory == MAP_FAILED)
+		{
+			/* Can not map */
+			errorCode = -1;
+		}
+		else
+		{
+			me->itsMemory  = memory;
+			me->itsRecords = (hsm_state_id_t*)&(
+			    (uint8_t*)memory)[HSM_STORE_HEADER_SIZE];
+		}
+	}
+
+	if (errorCode == 0)
+	{
+		// cppcheck-suppress misra-c2012-21.3
+		me->itsChecked = (uint8_t*)calloc(recordNum, sizeof(uint8_t));
+
+		if (me->itsChecked == NULL)
+		{
+			/* Out of memory */
+			errorCode = -1;
+		}
+	}
+
+	if (errorCode == 0)
+	{
+		// cppcheck-suppress misra-c2012-11.5
+		store_header_t* const header = (store_header_t*)me->itsMemory;
+		const store_header_t  expected = {
+		     .itsMagic       = HSM_STORE_MAGIC,
+		     .itsVersion     = HSM_STORE_VERSION,
+		     .itsStateIdBits = HSM_STATE_ID_BITS,
+		     .itsStateNum    = def->itsStateNum,
+		     .itsHistoryNum  = def->itsHistoryNum,
+		     .itsRecordSize  = me->itsRecordSize,
+		     .itsRecordNum   = recordNum,
+		     .itsFingerprint = store_getFingerprint(def)};
+
+		if (created)
+		{
+			for (uint32_t i = 0U;
+			     (i < recordNum) && (errorCode == 0);
+			     i++)
+			{
+				errorCode = hsm_store_reset(me, i);
+			}
+
+			/* The header last, a torn creation is not valid */
+			*header = expected;
+		}
+		else if ((header->itsMagic != expected.itsMagic) ||
+		         (header->itsVersion != expected.itsVersion) ||
+		         (header->itsStateIdBits != expected.itsStateIdBits) ||
+		         (header->itsStateNum != expected.itsStateNum) ||
+		         (header->itsHistoryNum != expected.itsHistoryNum) ||
+		         (header->itsRecordSize != expected.itsRecordSize) ||
+		         (header->itsRecordNum != expected.itsRecordNum) ||
+		         (header->itsFingerprint != expected.itsFingerprint))
+		{
+			/* Not a store of this definition */
+			errorCode = -1;
+		}
+		else
+		{
+			/* The records are checked when first touched */
+		}
+	}
+
+	if (errorCode != 0)
+	{
+		hsm_store_close(me);
+	}
+
+	return (errorCode != 0) ? -1 : (created ? 1 : 0);
+}
+
+/**
+ * \brief Closes a store, the file keeps the instances.
+ *
+ * \param[in,out] me The store.
+ */
+void hsm_store_close(hsm_store_t* const me)
+{
+	if (me != NULL)
+	{
+		if (me->itsMemory != NULL)
+		{
+			(void)munmap(me->itsMemory, me->itsSize);
+			me->itsMemory = NULL;
+		}
+
+		// cppcheck-suppress misra-c2012-21.3
+		free(me->itsChecked);
+		me->itsChecked = NULL;
+
+		if (me->itsFile >= 0)
+		{
+			(void)close(me->itsFile);
+			me->itsFile = -1;
+		}
+	}
+}
+
+/**
+ * \brief Writes the instances to the file and waits for it.
+ *
+ * \param[in] me The store.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_store_sync(const hsm_store_t* const me)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (me->itsMemory == NULL))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		errorCode = msync(me->itsMemory, me->itsSize, MS_SYNC);
+	}
+
+	return (errorCode == 0) ? 0 : -1;
+}
+
+/**
+ * \brief Resets an instance of a store.
+ *
+ * Same as \see hsm_inst_reset.
+ *
+ * \param[in,out] me    The store.
+ * \param[in]     index The index of the instance.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_store_reset(hsm_store_t* const me, const uint32_t index)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (me->itsMemory == NULL) ||
+	    (index >= me->itsRecordNum))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		hsm_inst_t inst = store_getInst(me, index);
+
+		errorCode = hsm_inst_reset(&inst);
+		store_setInst(me, index, &inst);
+
+		/* Whatever it held before, it is valid now */
+		me->itsChecked[index] = (errorCode == 0) ? 1U : 0U;
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Dispatches an event to an instance of a store.
+ *
+ * Same as \see hsm_inst_dispatch, in place in the mapping. A record that
+ * does not hold states of the definition is not dispatched to, it is
+ * checked the first time only.
+ *
+ * \param[in,out] me    The store.
+ * \param[in]     index The index of the instance.
+ * \param[in]     event The event signal.
+ *
+ * \retval  1  No event signal given.
+ * \retval  0  Success.
+ * \retval -1 Failure.
+ */
+int hsm_store_dispatch(hsm_store_t* const       me,
+                       const uint32_t           index,
+                       const hsm_event_t* const event)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (me->itsMemory == NULL) ||
+	    (index >= me->itsRecordNum))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+	else if (!store_check(me, index))
+	{
+		/* Corrupt */
+		errorCode = -1;
+	}
+	else
+	{
+		/* Valid */
+	}
+
+	if (errorCode == 0)
+	{
+		hsm_inst_t inst = store_getInst(me, index);
+
+		errorCode = hsm_inst_dispatch(&inst, event);
+		store_setInst(me, index, &inst);
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Gets the current state of an instance of a store.
+ *
+ * \param[in] me    The store.
+ * \param[in] index The index of the instance.
+ *
+ * \return The current leaf state, NULL on failure.
+ */
+const state_t* hsm_store_getState(const hsm_store_t* const me,
+                                  const uint32_t           index)
+{
+	const state_t* state = NULL;
+
+	if ((me != NULL) && (me->itsMemory != NULL) &&
+	    (index < me->itsRecordNum) && store_check(me, index))
+	{
+		const hsm_inst_t inst = store_getInst(me, index);
+
+		state = hsm_inst_getState(&inst);
+	}
+
+	return state;
+}
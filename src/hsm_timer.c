@@ -0,0 +1,457 @@
+// ############################################################################
+// ############################################################################
+// Code
+
+// ############################################################################
+// ############################################################################
+// Include files
+
+#include "hsm_timer.h"
+
+#include <stdlib.h>
+
+// ############################################################################
+// ############################################################################
+// Local definitions
+
+#if (HSM_TIMER_SLOT_BITS * HSM_TIMER_LEVEL_NUM) >= 64U
+#	error "The timer wheel spans more than 64 bits of ticks"
+#endif
+
+/**
+ * \brief The number of slots of a level.
+ */
+#define HSM_TIMER_SLOT_NUM (1U << HSM_TIMER_SLOT_BITS)
+
+/**
+ * \brief The mask of a slot index.
+ */
+#define HSM_TIMER_SLOT_MASK (HSM_TIMER_SLOT_NUM - 1U)
+
+// ############################################################################
+// ############################################################################
+// Local functions
+
+static void timer_link(hsm_timer_t** const head, hsm_timer_t* const me);
+static void timer_unlink(hsm_timer_t* const me);
+static void timer_insert(hsm_wheel_t* const me, hsm_timer_t* const timer);
+static void wheel_cascade(hsm_wheel_t* const me, const uint32_t level);
+static int  wheel_tick(hsm_wheel_t* const me);
+static void timer_cancelBound(const state_t* const state);
+
+/**
+ * \brief Puts a timer first in a list.
+ *
+ * \param[in,out] head The list.
+ * \param[in,out] me   The timer.
+ */
+static void timer_link(hsm_timer_t** const head, hsm_timer_t* const me)
+{
+	me->itsNext = *head;
+	me->itsPrev = head;
+
+	if (me->itsNext != NULL)
+	{
+		me->itsNext->itsPrev = &me->itsNext;
+	}
+
+	*head = me;
+}
+
+/**
+ * \brief Takes a timer out of its list.
+ *
+ * \param[in,out] me The timer.
+ */
+static void timer_unlink(hsm_timer_t* const me)
+{
+	*me->itsPrev = me->itsNext;
+
+	if (me->itsNext != NULL)
+	{
+		me->itsNext->itsPrev = me->itsPrev;
+	}
+
+	me->itsNext = NULL;
+	me->itsPrev = NULL;
+}
+
+/**
+ * \brief Puts a timer in the slot of its deadline.
+ *
+ * The lowest level that reaches the deadline is used. A deadline beyond the
+ * wheel waits in the last slot of the top level.
+ *
+ * \param[in,out] me    The wheel.
+ * \param[in,out] timer The timer.
+ */
+static void timer_insert(hsm_wheel_t* const me, hsm_timer_t* const timer)
+{
+	const uint64_t delta = timer->itsDeadline - me->itsNow;
+	uint32_t       level = 0U;
+	uint64_t       index = 0U;
+
+	while ((level < (HSM_TIMER_LEVEL_NUM - 1U)) &&
+	       (delta >= (1ULL << ((level + 1U) * HSM_TIMER_SLOT_BITS))))
+	{
+		level++;
+	}
+
+	if (delta >= (1ULL << (HSM_TIMER_LEVEL_NUM * HSM_TIMER_SLOT_BITS)))
+	{
+		/* Too far, checked again at the end of the wheel */
+		index = (me->itsNow >> (level * HSM_TIMER_SLOT_BITS)) +
+		        HSM_TIMER_SLOT_MASK;
+	}
+	else
+	{
+		index = timer->itsDeadline >> (level * HSM_TIMER_SLOT_BITS);
+	}
+
+	timer_link(&me->itsSlots[level][index & HSM_TIMER_SLOT_MASK], timer);
+}
+
+/**
+ * \brief Moves the timers of the current slot of a level to the levels
+ * below.
+ *
+ * \param[in,out] me    The wheel.
+ * \param[in]     level The level.
+ */
+static void wheel_cascade(hsm_wheel_t* const me, const uint32_t level)
+{
+	const uint64_t index = (me->itsNow >> (level * HSM_TIMER_SLOT_BITS)) &
+	                       HSM_TIMER_SLOT_MASK;
+	hsm_timer_t* timer = me->itsSlots[level][index];
+
+	me->itsSlots[level][index] = NULL;
+
+	while (timer != NULL)
+	{
+		hsm_timer_t* const next = timer->itsNext;
+
+		timer_insert(me, timer);
+		timer = next;
+	}
+}
+
+/**
+ * \brief Moves the wheel one tick forward and fires the timers that expire.
+ *
+ * \param[in,out] me The wheel.
+ *
+ * \return The number of timers fired, -1 if a machine failed.
+ */
+static int wheel_tick(hsm_wheel_t* const me)
+{
+	int      firedNum  = 0;
+	int      errorCode = 0;
+	uint32_t level     = 1U;
+	bool     carry     = true;
+
+	me->itsNow++;
+
+	/* Refill the levels below on each wrap around */
+	while (carry && (level < HSM_TIMER_LEVEL_NUM))
+	{
+		carry = ((me->itsNow >> ((level - 1U) * HSM_TIMER_SLOT_BITS)) &
+		         HSM_TIMER_SLOT_MASK) == 0U;
+
+		if (carry)
+		{
+			wheel_cascade(me, level);
+		}
+
+		level++;
+	}
+
+	/* The timers may be cancelled or armed again while firing */
+	hsm_timer_t** const slot =
+	    &me->itsSlots[0][me->itsNow & HSM_TIMER_SLOT_MASK];
+	hsm_timer_t* fired = *slot;
+
+	*slot = NULL;
+
+	if (fired != NULL)
+	{
+		fired->itsPrev = &fired;
+	}
+
+	while (fired != NULL)
+	{
+		hsm_timer_t* const timer = fired;
+		const hsm_event_t  event = {.eventType = timer->itsEventType,
+		                            .data      = timer};
+
+		timer_unlink(timer);
+		me->itsArmedNum--;
+		firedNum++;
+
+		if (hsm_dispatch(timer->itsMachine, &event) != 0)
+		{
+			/* Fail, fire the others anyway */
+			errorCode = -1;
+		}
+	}
+
+	return (errorCode == 0) ? firedNum : -1;
+}
+
+/**
+ * \brief Cancels the timers bound to a state.
+ *
+ * \param[in] state The state.
+ */
+static void timer_cancelBound(const state_t* const state)
+{
+	for (hsm_timer_t* timer = state->itsTimers; timer != NULL;
+	     timer              = timer->itsBound)
+	{
+		hsm_timer_cancel(timer);
+	}
+}
+
+// ############################################################################
+// ############################################################################
+// Function definitions
+
+/**
+ * \brief Initializes a timer wheel.
+ *
+ * \param[out] me  The wheel.
+ * \param[in]  now The current tick.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_wheel_init(hsm_wheel_t* const me, const uint64_t now)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if (me == NULL)
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		me->itsNow      = now;
+		me->itsArmedNum = 0U;
+
+		for (uint32_t i = 0U; i < HSM_TIMER_LEVEL_NUM; i++)
+		{
+			for (uint32_t j = 0U; j < HSM_TIMER_SLOT_NUM; j++)
+			{
+				me->itsSlots[i][j] = NULL;
+			}
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Moves a wheel forward and fires the timers that expire.
+ *
+ * Each timer sends its event to its machine with \see hsm_dispatch. Call it
+ * every tick, ticks without armed timers are skipped.
+ *
+ * \param[in,out] me  The wheel.
+ * \param[in]     now The current tick.
+ *
+ * \return The number of timers fired, -1 on failure.
+ */
+int hsm_wheel_advance(hsm_wheel_t* const me, const uint64_t now)
+{
+	int firedNum = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (now < me->itsNow))
+	{
+		/* Invalid input. */
+		firedNum = -1;
+	}
+
+	while ((firedNum >= 0) && (me->itsNow < now))
+	{
+		if (me->itsArmedNum == 0U)
+		{
+			/* Nothing to fire */
+			me->itsNow = now;
+		}
+		else
+		{
+			const int tickNum = wheel_tick(me);
+
+			firedNum = (tickNum < 0) ? -1 : (firedNum + tickNum);
+		}
+	}
+
+	return firedNum;
+}
+
+/**
+ * \brief Initializes a timer.
+ *
+ * A timer bound to a state is cancelled when the machine exits the state. If
+ * it has a timeout it is also armed when the machine enters the state.
+ * The state must be one of the machine's. Bind it before the machine enters
+ * the state, it stays bound for the life of the machine.
+ *
+ * \param[out]    me        The timer.
+ * \param[in,out] wheel     The wheel it is armed in.
+ * \param[in,out] machine   The machine to notify.
+ * \param[in]     state     The state to bind it to, NULL for none.
+ * \param[in]     eventType The event sent on expiry.
+ * \param[in]     timeout   The ticks armed on entry, 0 for none.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_timer_init(hsm_timer_t* const   me,
+                   hsm_wheel_t* const   wheel,
+                   hsm_t* const         machine,
+                   const state_t* const state,
+                   const uint32_t       eventType,
+                   const uint64_t       timeout)
+{
+	const uint32_t index     = hsm_getStateIndex(machine, state);
+	int            errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (wheel == NULL) || (machine == NULL) ||
+	    ((state != NULL) && (index == HSM_STATE_INDEX_NONE)))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		me->itsWheel     = wheel;
+		me->itsMachine   = machine;
+		me->itsState     = state;
+		me->itsTimeout   = timeout;
+		me->itsEventType = eventType;
+		me->itsNext      = NULL;
+		me->itsPrev      = NULL;
+		me->itsDeadline  = 0U;
+		me->itsBound     = NULL;
+
+		if (state != NULL)
+		{
+			state_t* const aux = machine->allStates[index];
+
+			me->itsBound   = aux->itsTimers;
+			aux->itsTimers = me;
+		}
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Arms a timer, again if already armed.
+ *
+ * \param[in,out] me    The timer.
+ * \param[in]     ticks The ticks until it expires, at least one.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_timer_arm(hsm_timer_t* const me, const uint64_t ticks)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if (me == NULL)
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		hsm_wheel_t* const wheel = me->itsWheel;
+
+		hsm_timer_cancel(me);
+
+		me->itsDeadline = wheel->itsNow + ((ticks == 0U) ? 1U : ticks);
+		timer_insert(wheel, me);
+		wheel->itsArmedNum++;
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Cancels a timer, if armed.
+ *
+ * \param[in,out] me The timer.
+ */
+void hsm_timer_cancel(hsm_timer_t* const me)
+{
+	if ((me != NULL) && (me->itsPrev != NULL))
+	{
+		timer_unlink(me);
+		me->itsWheel->itsArmedNum--;
+	}
+}
+
+/**
+ * \brief Checks if a timer is armed.
+ *
+ * \param[in] me The timer.
+ *
+ * \retval true  It is armed.
+ * \retval false It is not armed.
+ */
+bool hsm_timer_isArmed(const hsm_timer_t* const me)
+{
+	return (me != NULL) && (me->itsPrev != NULL);
+}
+
+/**
+ * \brief Arms the timers bound to a state the machine entered.
+ *
+ * Each state keeps the list of its own timers, the others are not visited.
+ *
+ * \param[in] me    The hierarchical state machine handle.
+ * \param[in] state The state.
+ */
+void hsm_timer_enter(const hsm_t* const me, const state_t* const state)
+{
+	(void)me;
+
+	for (hsm_timer_t* timer = state->itsTimers; timer != NULL;
+	     timer              = timer->itsBound)
+	{
+		if (timer->itsTimeout != 0U)
+		{
+			(void)hsm_timer_arm(timer, timer->itsTimeout);
+		}
+	}
+}
+
+/**
+ * \brief Cancels the timers bound to a state the machine exited.
+ *
+ * \param[in] me    The hierarchical state machine handle.
+ * \param[in] state The state, NULL for all.
+ */
+void hsm_timer_exit(const hsm_t* const me, const state_t* const state)
+{
+	if (state != NULL)
+	{
+		timer_cancelBound(state);
+	}
+	else
+	{
+		for (uint32_t i = 0U; i < me->allStatesSize; i++)
+		{
+			timer_cancelBound(me->allStates[i]);
+		}
+	}
+}
@@ -0,0 +1,187 @@
+// ############################################################################
+// ############################################################################
+// Code
+
+// ############################################################################
+// ############################################################################
+// Include files
+
+/* For clock_gettime */
+#define _GNU_SOURCE
+
+#include "hsm_trace.h"
+
+#include <time.h>
+
+// ############################################################################
+// ############################################################################
+// Local definitions
+
+/* The ring of the calling thread, NULL if it does not trace */
+static __thread hsm_trace_t* trace_ring = NULL;
+
+// ############################################################################
+// ############################################################################
+// Function definitions
+
+/**
+ * \brief Initializes a trace ring buffer.
+ *
+ * \param[out] me       The ring.
+ * \param[in]  records  The records, capacity in size.
+ * \param[in]  capacity The number of records, a power of two.
+ *
+ * \retval  0 Success.
+ * \retval -1 Failure.
+ */
+int hsm_trace_init(hsm_trace_t* const        me,
+                   hsm_trace_record_t* const records,
+                   const uint32_t            capacity)
+{
+	int errorCode = 0;
+
+	/* Check valid input */
+	if ((me == NULL) || (records == NULL) || (capacity == 0U) ||
+	    (capacity > 0x80000000U) || ((capacity & (capacity - 1U)) != 0U))
+	{
+		/* Invalid input. */
+		errorCode = -1;
+	}
+
+	if (errorCode == 0)
+	{
+		me->itsRecords = records;
+		me->itsMask    = capacity - 1U;
+		me->itsHead    = 0U;
+		me->itsDropNum = 0U;
+		me->itsTail    = 0U;
+	}
+
+	return errorCode;
+}
+
+/**
+ * \brief Sets the ring that the calling thread writes to.
+ *
+ * A ring has one writer, attach it to a single thread at a time.
+ *
+ * \param[in] me The ring, NULL to stop tracing.
+ */
+void hsm_trace_attach(hsm_trace_t* const me)
+{
+	trace_ring = me;
+}
+
+/**
+ * \brief Writes a record to the ring of the calling thread.
+ *
+ * Wait-free. The record is dropped if the thread has no ring or the ring is
+ * full, the oldest records are never overwritten while being read.
+ *
+ * \param[in] machine   The machine's id: its address, or the address of
+ *                      its record for an instance of a fleet or a store.
+ * \param[in] eventType The event's type.
+ * \param[in] from      The state it left.
+ * \param[in] to        The state it is in now.
+ * \param[in] fromMode  The mode it left in.
+ * \param[in] toMode    The mode it is in now.
+ */
+void hsm_trace_write(const void* const machine,
+                     const uint32_t    eventType,
+                     const uint16_t    from,
+                     const uint16_t    to,
+                     const uint8_t     fromMode,
+                     const uint8_t     toMode)
+{
+	hsm_trace_t* const me = trace_ring;
+
+	if (me != NULL)
+	{
+		const uint32_t head = me->itsHead;
+
+		if ((head - __atomic_load_n(&me->itsTail, __ATOMIC_ACQUIRE)) >
+		    me->itsMask)
+		{
+			/* Full */
+			__atomic_store_n(&me->itsDropNum,
+			                 me->itsDropNum + 1U,
+			                 __ATOMIC_RELAXED);
+		}
+		else
+		{
+			hsm_trace_record_t* const record =
+			    &me->itsRecords[head & me->itsMask];
+			struct timespec now;
+
+			(void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+			*record = (hsm_trace_record_t){
+			    .itsTime = ((uint64_t)now.tv_sec * 1000000000U) +
+			               (uint64_t)now.tv_nsec,
+			    .itsMachine   = (uint64_t)(uintptr_t)machine,
+			    .itsEventType = eventType,
+			    .itsFrom      = from,
+			    .itsTo        = to,
+			    .itsFromMode  = fromMode,
+			    .itsToMode    = toMode,
+			    .itsPad       = {0U}};
+
+			/* Publish it */
+			__atomic_store_n(&me->itsHead,
+			                 head + 1U,
+			                 __ATOMIC_RELEASE);
+		}
+	}
+}
+
+/**
+ * \brief Takes the oldest records out of a ring.
+ *
+ * Safe to call from one thread while the attached thread writes.
+ *
+ * \param[in,out] me        The ring.
+ * \param[out]    records   The records.
+ * \param[in]     recordNum The size of records.
+ *
+ * \return The number of records taken.
+ */
+uint32_t hsm_trace_read(hsm_trace_t* const        me,
+                        hsm_trace_record_t* const records,
+                        const uint32_t            recordNum)
+{
+	uint32_t num = 0U;
+
+	/* Check valid input */
+	if ((me != NULL) && (records != NULL))
+	{
+		const uint32_t tail = me->itsTail;
+		const uint32_t head =
+		    __atomic_load_n(&me->itsHead, __ATOMIC_ACQUIRE);
+
+		num = ((head - tail) < recordNum) ? (head - tail) : recordNum;
+
+		for (uint32_t i = 0U; i < num; i++)
+		{
+			records[i] = me->itsRecords[(tail + i) & me->itsMask];
+		}
+
+		/* Give the records back */
+		__atomic_store_n(&me->itsTail, tail + num, __ATOMIC_RELEASE);
+	}
+
+	return num;
+}
+
+/**
+ * \brief Gets the number of records lost because the ring was full.
+ *
+ * \param[in] me The ring.
+ *
+ * \return The number of records lost.
+ */
+uint32_t hsm_trace_getDropNum(const hsm_trace_t* const me)
+{
+	return (me != NULL)
+	           ? __atomic_load_n(&me->itsDropNum, __ATOMIC_RELAXED)
+	           : 0U;
+}
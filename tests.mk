@@ -35,6 +35,9 @@ TEST_AS_SRCs  = $(shell find "src/" -name "*.[s|S]")
 TEST_C_SRCs   = $(filter-out %main.c,$(shell find "src/" -name "*.[c|C]"))
 TEST_CXX_SRCs = $(filter-out %main.cpp,$(shell find "src/" -name "*.cpp"))
 
+# The generator, without its main
+TEST_C_SRCs  += $(filter-out %main.c,$(shell find "apps/hsmgen/" -name "*.[c|C]"))
+
 ifdef PORT_NAME
   TEST_AS_SRCs  += $(shell find "port/posix/" -name "*.[s|S]")
   TEST_C_SRCs   += $(shell find "port/posix/" -name "*.[c|C]")
@@ -73,6 +76,33 @@ TEST_CFLAGS     += $(CFLAGS)
 TEST_CXXFLAGS   += $(CXXFLAGS)
 TEST_LDFLAGS    += $(LDFLAGS)
 
+#.................................................
+#    Variant
+#
+#    The instrumented variant compiles every optional feature in, so the
+#    tests under #if HSM_STATS, HSM_TRACE and HSM_EVENT_INLINE_SIZE run.
+#    The tsan variant runs the suite under ThreadSanitizer, for the workers
+#    of the regions, executor and queues:
+#
+#        make -f tests.mk TEST_VARIANT=tsan runCppUtest
+
+TEST_VARIANT ?=
+
+ifeq ($(TEST_VARIANT),instrumented)
+  TEST_OUTDIR    := $(TEST_OUTDIR)instrumented/
+  TEST_BIN       := $(BIN_OUTDIR)runTestsInstrumented
+  TEST_CPPFLAGS  += -DHSM_STATS=1\
+                    -DHSM_TRACE=1\
+                    -DHSM_EVENT_INLINE_SIZE=16U
+else ifeq ($(TEST_VARIANT),tsan)
+  TEST_OUTDIR    := $(TEST_OUTDIR)tsan/
+  TEST_BIN       := $(BIN_OUTDIR)runTestsTsan
+  TEST_CPPFLAGS  += -fsanitize=thread
+  TEST_LDFLAGS   += -fsanitize=thread
+else
+  TEST_BIN       := $(BIN_OUTDIR)runTests
+endif
+
 #.................................................
 #    Toolchain
 
@@ -93,8 +123,8 @@ TEST_LINK        ?= $(TEST_LD)     $^ -o $@ $(TEST_CPPFLAGS) $(TEST_LDFLAGS)
 
 ifdef TESTS_EXIST
 .PHONY: runCppUtest
-runCppUtest: $(BIN_OUTDIR)runTests
-	@$(ECHO_E) $(BLACK)"[TEST] "$(BLUE)"CppUTest"$(RESET)
+runCppUtest: $(TEST_BIN)
+	@$(ECHO_E) $(BLACK)"[TEST] "$(BLUE)"CppUTest $(TEST_VARIANT)"$(RESET)
 	@./$< -c
 else
 .PHONY: runCppUtest
@@ -104,7 +134,7 @@ runCppUtest:
 endif
 
 # Build test program
-$(BIN_OUTDIR)runTests: $(TEST_OBJS)
+$(TEST_BIN): $(TEST_OBJS)
 	@$(ECHO_NE) $(BLACK)"[TEST] "$(BLUE)"LD  "$(RESET)"$@ "
 	@$(MKDIR_P) $(dir $@)
 	@$(TEST_LINK) 2>&1 | $(TEE) $(@:%.to=%.terr) | $(XARGS_R0) $(ECHO_E) $(RED)"FAIL\n\n"$(RESET)
@@ -127,3 +127,24 @@ TEST(hsm_build, Should_InitializeInvalidHsmHandle_When_NothingGivenGiven)
 	POINTERS_EQUAL(NULL, me.allStates);
 	LONGS_EQUAL(0, me.allStatesSize);
 }
+
+TEST(hsm_build, Should_IndexStates_When_Built)
+{
+	state_t stranger = {.itsInitialState  = NULL,
+	                    .itsParentState   = NULL,
+	                    .onEntry          = NULL,
+	                    .during           = NULL,
+	                    .onExit           = NULL,
+	                    .itsTransition    = NULL,
+	                    .itsTransitionNum = 0};
+
+	/* Build hsm */
+	me = hsm_build(&parentState, stateList);
+
+	/* Check the indices */
+	LONGS_EQUAL(0, hsm_getStateIndex(&me, &parentState));
+	LONGS_EQUAL(1, hsm_getStateIndex(&me, &childState));
+	LONGS_EQUAL(HSM_STATE_INDEX_NONE, hsm_getStateIndex(&me, &stranger));
+	LONGS_EQUAL(HSM_STATE_INDEX_NONE, hsm_getStateIndex(&me, NULL));
+	LONGS_EQUAL(HSM_STATE_INDEX_NONE, hsm_getStateIndex(NULL, &childState));
+}
@@ -0,0 +1,219 @@
+#include "CppUTest/TestHarness.h"
+#include "hsm_def.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+digraph G {
+	graph [fontsize=10 fontname="Verdana" compound=true rankdir=LR];
+	node [shape=record fontsize=10 fontname="Verdana"];
+
+	subgraph cluster_root {
+		label = "root";
+
+		subgraph cluster_a {
+			label = "a";
+
+			subgraph cluster_a1 {
+				label = "a1";
+				"a11";
+			}
+		}
+
+		subgraph cluster_b {
+			label = "b";
+			"b1";
+		}
+	}
+
+	"a11" -> "b1" [ label = "GO" ];
+	"a1" -> "a1" [ label = "SELF" ];
+}
+*/
+
+enum
+{
+	EV_GO = 1U,
+	EV_SELF
+};
+
+static char trace[256];
+
+static bool onEntry(const state_t* me, const hsm_event_t* event)
+{
+	(void)event;
+	strcat(trace, me->itsName);
+	strcat(trace, ".entry ");
+	return true;
+}
+
+static bool onExit(const state_t* me, const hsm_event_t* event)
+{
+	(void)event;
+	strcat(trace, me->itsName);
+	strcat(trace, ".exit ");
+	return true;
+}
+
+extern state_t buildRoot;
+extern state_t buildA;
+extern state_t buildA1;
+extern state_t buildA11;
+extern state_t buildB;
+extern state_t buildB1;
+
+state_t buildRoot = {.itsInitialState  = &buildA,
+                     .itsParentState   = NULL,
+                     .onEntry          = onEntry,
+                     .during           = NULL,
+                     .onExit           = onExit,
+                     .itsTransition    = NULL,
+                     .itsTransitionNum = 0,
+                     .itsName          = "root"};
+
+state_t buildA = {.itsInitialState  = &buildA1,
+                  .itsParentState   = &buildRoot,
+                  .onEntry          = onEntry,
+                  .during           = NULL,
+                  .onExit           = onExit,
+                  .itsTransition    = NULL,
+                  .itsTransitionNum = 0,
+                  .itsName          = "a"};
+
+state_t buildA1 = {
+    .itsInitialState  = &buildA11,
+    .itsParentState   = &buildA,
+    .onEntry          = onEntry,
+    .during           = NULL,
+    .onExit           = onExit,
+    .itsTransition    = (hsm_transition_t[]){{NULL, NULL, &buildA1, EV_SELF}},
+    .itsTransitionNum = 1,
+    .itsName          = "a1"};
+
+state_t buildA11 = {
+    .itsInitialState  = NULL,
+    .itsParentState   = &buildA1,
+    .onEntry          = onEntry,
+    .during           = NULL,
+    .onExit           = onExit,
+    .itsTransition    = (hsm_transition_t[]){{NULL, NULL, &buildB1, EV_GO}},
+    .itsTransitionNum = 1,
+    .itsName          = "a11"};
+
+state_t buildB = {.itsInitialState  = &buildB1,
+                  .itsParentState   = &buildRoot,
+                  .onEntry          = onEntry,
+                  .during           = NULL,
+                  .onExit           = onExit,
+                  .itsTransition    = NULL,
+                  .itsTransitionNum = 0,
+                  .itsName          = "b"};
+
+state_t buildB1 = {.itsInitialState  = NULL,
+                   .itsParentState   = &buildB,
+                   .onEntry          = onEntry,
+                   .during           = NULL,
+                   .onExit           = onExit,
+                   .itsTransition    = NULL,
+                   .itsTransitionNum = 0,
+                   .itsName          = "b1"};
+
+static state_t* stateList[] =
+    {&buildRoot, &buildA, &buildA1, &buildA11, &buildB, &buildB1};
+
+TEST_GROUP(hsm_def_build)
+{
+	hsm_def_t      def;
+	hsm_inst_t     inst;
+	hsm_state_id_t history[3];
+
+	void setup()
+	{
+		CHECK_EQUAL(0, hsm_def_build(&def, &buildRoot, stateList));
+		CHECK_EQUAL(0, hsm_inst_init(&inst, &def, history));
+		trace[0] = '\0';
+	}
+
+	void teardown()
+	{
+		hsm_def_destroy(&def);
+	}
+
+	const hsm_def_transition_t* transitionOf(const state_t* state)
+	{
+		const hsm_state_id_t id = hsm_def_getId(&def, state);
+		return &def.itsTransitions[def.itsTransitionFirst[id]];
+	}
+
+	int dispatch(const uint32_t eventType)
+	{
+		hsm_event_t event = {eventType, NULL};
+		return hsm_inst_dispatch(&inst, &event);
+	}
+};
+
+TEST(hsm_def_build, Should_PrecomputePathToTop_When_Built)
+{
+	const hsm_state_id_t a11   = hsm_def_getId(&def, &buildA11);
+	const uint32_t       first = def.itsPathFirst[a11];
+
+	LONGS_EQUAL(4, def.itsPathFirst[a11 + 1U] - first);
+	LONGS_EQUAL(a11, def.itsPaths[first]);
+	LONGS_EQUAL(hsm_def_getId(&def, &buildA1), def.itsPaths[first + 1U]);
+	LONGS_EQUAL(hsm_def_getId(&def, &buildA), def.itsPaths[first + 2U]);
+	LONGS_EQUAL(hsm_def_getId(&def, &buildRoot), def.itsPaths[first + 3U]);
+}
+
+TEST(hsm_def_build, Should_PrecomputeLcaAndEntries_When_Built)
+{
+	const hsm_def_transition_t* const go = transitionOf(&buildA11);
+
+	LONGS_EQUAL(hsm_def_getId(&def, &buildRoot), go->itsLca);
+	LONGS_EQUAL(1, go->itsLcaLevel);
+	LONGS_EQUAL(2, go->itsEntryNum);
+	LONGS_EQUAL(hsm_def_getId(&def, &buildB),
+	            def.itsEntries[go->itsEntryFirst]);
+	LONGS_EQUAL(hsm_def_getId(&def, &buildB1),
+	            def.itsEntries[go->itsEntryFirst + 1U]);
+}
+
+TEST(hsm_def_build, Should_ExitAndReEnter_When_SelfTransition)
+{
+	const hsm_def_transition_t* const self = transitionOf(&buildA1);
+
+	LONGS_EQUAL(hsm_def_getId(&def, &buildA), self->itsLca);
+	LONGS_EQUAL(2, self->itsLcaLevel);
+	LONGS_EQUAL(1, self->itsEntryNum);
+
+	CHECK_EQUAL(0, dispatch(EV_SELF));
+	STRCMP_EQUAL("root.entry a.entry a1.entry a11.entry "
+	             "a11.exit a1.exit a1.entry a11.entry ",
+	             trace);
+}
+
+TEST(hsm_def_build, Should_ExitUpToLca_When_CrossingBranches)
+{
+	CHECK_EQUAL(0, dispatch(EV_GO));
+	STRCMP_EQUAL("root.entry a.entry a1.entry a11.entry "
+	             "a11.exit a1.exit a.exit b.entry b1.entry ",
+	             trace);
+	POINTERS_EQUAL(&buildB1, hsm_inst_getState(&inst));
+}
+
+TEST(hsm_def_build, Should_GiveError_When_TooManyStates)
+{
+	const uint32_t  num = HSM_STATE_ID_NONE;
+	const state_t** allStates =
+	    (const state_t**)malloc(num * sizeof(allStates[0]));
+	hsm_def_t big;
+
+	for (uint32_t i = 0U; i < num; i++)
+	{
+		allStates[i] = &buildB1;
+	}
+
+	CHECK_EQUAL(HSM_STATE_ID_BITS / 8, (int)sizeof(hsm_state_id_t));
+	CHECK_EQUAL(-1, _hsm_def_build(&big, &buildRoot, allStates, num));
+	free(allStates);
+}
@@ -0,0 +1,354 @@
+#include "CppUTest/TestHarness.h"
+#include "hsm_def.h"
+
+#include <stdlib.h>
+
+/*
+digraph G {
+	graph [fontsize=10 fontname="Verdana" compound=true rankdir=LR];
+	node [shape=record fontsize=10 fontname="Verdana"];
+
+	subgraph cluster_0 {
+		label = "on";
+		"cluster0_dummy" [ label = "", style = invis ];
+		"cluster0_dummy" -> "idle"
+		"idle" -> "running" [ label = "START" ];
+		"running" -> "idle" [ label = "STOP [allowStop]" ];
+		"running" -> "running" [ label = "TICK / count" ];
+	}
+
+	"on" -> "idle" [ label = "RESET" ];
+}
+*/
+
+enum
+{
+	EV_NONE = HSM_EVENT_ANY,
+	EV_START,
+	EV_STOP,
+	EV_TICK,
+	EV_RESET,
+	EV_NUM
+};
+
+static bool     allowStop;
+static uint32_t tickCount;
+
+static bool stopGuard(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	(void)event;
+	return allowStop;
+}
+
+static void tickAction(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	(void)event;
+	tickCount++;
+}
+
+extern state_t compileOn;
+extern state_t compileIdle;
+extern state_t compileRunning;
+
+state_t compileOn = {
+    .itsInitialState = &compileIdle,
+    .itsParentState  = NULL,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, NULL, &compileIdle, EV_RESET}},
+    .itsTransitionNum = 1};
+
+state_t compileIdle = {
+    .itsInitialState = NULL,
+    .itsParentState  = &compileOn,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, NULL, &compileRunning, EV_START}},
+    .itsTransitionNum = 1};
+
+state_t compileRunning = {
+    .itsInitialState = NULL,
+    .itsParentState  = &compileOn,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, tickAction, NULL, EV_TICK},
+                             {stopGuard, NULL, &compileIdle, EV_STOP}},
+    .itsTransitionNum = 2};
+
+/* A trigger out of the table's range */
+static state_t compileInvalid = {
+    .itsInitialState  = NULL,
+    .itsParentState   = NULL,
+    .onEntry          = NULL,
+    .during           = NULL,
+    .onExit           = NULL,
+    .itsTransition    = (hsm_transition_t[]){{NULL, NULL, NULL, EV_NUM}},
+    .itsTransitionNum = 1};
+
+static state_t* stateList[] = {&compileOn, &compileIdle, &compileRunning};
+
+static state_t* invalidStateList[] = {&compileInvalid};
+
+TEST_GROUP(hsm_def_compile)
+{
+	hsm_def_t      def;
+	hsm_inst_t     inst;
+	hsm_state_id_t history[1];
+	hsm_t          legacy;
+	bool           useLegacy;
+
+	void setup()
+	{
+		CHECK_EQUAL(0, hsm_def_build(&def, &compileOn, stateList));
+
+		allowStop = false;
+		tickCount = 0U;
+		useLegacy = false;
+	}
+
+	void teardown()
+	{
+		hsm_def_destroy(&def);
+	}
+
+	const state_t* dispatch(const uint32_t eventType)
+	{
+		hsm_event_t event = {eventType, NULL};
+
+		if (useLegacy)
+		{
+			CHECK_EQUAL(0, hsm_dispatch(&legacy, &event));
+			return legacy.itsCurrentState;
+		}
+
+		CHECK_EQUAL(0, hsm_inst_dispatch(&inst, &event));
+		return hsm_inst_getState(&inst);
+	}
+
+	void runSequence()
+	{
+		/* Enters on.idle, then START */
+		POINTERS_EQUAL(&compileRunning, dispatch(EV_START));
+
+		/* Internal transition */
+		POINTERS_EQUAL(&compileRunning, dispatch(EV_TICK));
+		LONGS_EQUAL(1, tickCount);
+
+		/* Guarded */
+		POINTERS_EQUAL(&compileRunning, dispatch(EV_STOP));
+		allowStop = true;
+		POINTERS_EQUAL(&compileIdle, dispatch(EV_STOP));
+
+		/* Not handled */
+		POINTERS_EQUAL(&compileIdle, dispatch(EV_STOP));
+		POINTERS_EQUAL(&compileIdle, dispatch(EV_NONE));
+		POINTERS_EQUAL(&compileIdle, dispatch(42U));
+
+		/* Inherited from the parent */
+		POINTERS_EQUAL(&compileRunning, dispatch(EV_START));
+		POINTERS_EQUAL(&compileIdle, dispatch(EV_RESET));
+		LONGS_EQUAL(1, tickCount);
+	}
+};
+
+TEST(hsm_def_compile, Should_GiveError_When_InvalidInput)
+{
+	CHECK_EQUAL(-1, hsm_def_compile(NULL, EV_NUM));
+	CHECK_EQUAL(-1, hsm_def_compile(&def, 0U));
+}
+
+TEST(hsm_def_compile, Should_GiveError_When_TriggerOutOfRange)
+{
+	hsm_def_t aux;
+
+	CHECK_EQUAL(0, hsm_def_build(&aux, &compileInvalid, invalidStateList));
+	CHECK_EQUAL(-1, hsm_def_compile(&aux, EV_NUM));
+	CHECK_EQUAL(0, hsm_def_compile(&aux, EV_NUM + 1U));
+	hsm_def_destroy(&aux);
+}
+
+TEST(hsm_def_compile, Should_GiveError_When_TableTooLarge)
+{
+	/* The cells of the 3 states wrap around a uint32_t */
+	CHECK_EQUAL(-1, hsm_def_compile(&def, (UINT32_MAX / 2U) + 1U));
+	POINTERS_EQUAL(NULL, def.itsTable);
+
+	CHECK_EQUAL(0, hsm_inst_init(&inst, &def, history));
+	runSequence();
+}
+
+TEST(hsm_def_compile, Should_ListInheritedTransitions_When_Compiled)
+{
+	CHECK_EQUAL(0, hsm_def_compile(&def, EV_NUM));
+
+	/* running checks its STOP and then the RESET of on */
+	const uint32_t running = hsm_def_getId(&def, &compileRunning);
+	const uint32_t reset   = (running * EV_NUM) + EV_RESET;
+	const uint32_t stop    = (running * EV_NUM) + EV_STOP;
+
+	LONGS_EQUAL(1, def.itsTable[stop + 1U] - def.itsTable[stop]);
+	LONGS_EQUAL(1, def.itsTable[reset + 1U] - def.itsTable[reset]);
+	LONGS_EQUAL(0, def.itsTable[running * EV_NUM + 1U] -
+	                   def.itsTable[running * EV_NUM]);
+}
+
+TEST(hsm_def_compile, Should_DispatchEvents_When_NotCompiled)
+{
+	CHECK_EQUAL(0, hsm_inst_init(&inst, &def, history));
+	runSequence();
+}
+
+TEST(hsm_def_compile, Should_DispatchEvents_When_Compiled)
+{
+	CHECK_EQUAL(0, hsm_def_compile(&def, EV_NUM));
+	CHECK_EQUAL(0, hsm_inst_init(&inst, &def, history));
+	runSequence();
+}
+
+TEST(hsm_def_compile, Should_DispatchEvents_When_Legacy)
+{
+	legacy    = hsm_build(&compileOn, stateList);
+	useLegacy = true;
+	runSequence();
+}
+
+TEST(hsm_def_compile, Should_GiveError_When_LegacyTableInvalid)
+{
+	hsm_t aux = hsm_build(&compileInvalid, invalidStateList);
+
+	legacy = hsm_build(&compileOn, stateList);
+
+	CHECK_EQUAL(-1, hsm_table_init(NULL, EV_NUM));
+	CHECK_EQUAL(-1, hsm_table_init(&legacy, 0U));
+	CHECK_EQUAL(-1, hsm_table_init(&legacy, (UINT32_MAX / 2U) + 1U));
+	CHECK_EQUAL(-1, hsm_table_init(&aux, EV_NUM));
+	POINTERS_EQUAL(NULL, aux.itsTable);
+	CHECK_EQUAL(0, hsm_table_init(&aux, EV_NUM + 1U));
+	hsm_table_destroy(&aux);
+	POINTERS_EQUAL(NULL, aux.itsTable);
+
+	/* Only once */
+	CHECK_EQUAL(0, hsm_table_init(&legacy, EV_NUM));
+	CHECK_EQUAL(-1, hsm_table_init(&legacy, EV_NUM));
+	hsm_table_destroy(&legacy);
+}
+
+TEST(hsm_def_compile, Should_ListInheritedTransitions_When_LegacyCompiled)
+{
+	legacy = hsm_build(&compileOn, stateList);
+	CHECK_EQUAL(0, hsm_table_init(&legacy, EV_NUM));
+
+	/* running checks its STOP and then the RESET of on */
+	const hsm_table_t* const table = legacy.itsTable;
+	const uint32_t reset = (compileRunning.itsIndex * EV_NUM) + EV_RESET;
+	const uint32_t stop  = (compileRunning.itsIndex * EV_NUM) + EV_STOP;
+
+	LONGS_EQUAL(1, table->itsFirst[stop + 1U] - table->itsFirst[stop]);
+	POINTERS_EQUAL(&compileRunning,
+	               table->itsSources[table->itsFirst[stop]]);
+	LONGS_EQUAL(1, table->itsFirst[reset + 1U] - table->itsFirst[reset]);
+	POINTERS_EQUAL(&compileOn, table->itsSources[table->itsFirst[reset]]);
+
+	hsm_table_destroy(&legacy);
+}
+
+TEST(hsm_def_compile, Should_PrecomputePaths_When_LegacyCompiled)
+{
+	legacy = hsm_build(&compileOn, stateList);
+	CHECK_EQUAL(0, hsm_table_init(&legacy, EV_NUM));
+
+	const hsm_table_t* const table = legacy.itsTable;
+	const hsm_table_path_t*  reset =
+	    &table->itsPaths[table->itsPathFirst[compileOn.itsIndex]];
+	const hsm_table_path_t* tick =
+	    &table->itsPaths[table->itsPathFirst[compileRunning.itsIndex]];
+	const hsm_table_path_t* stop = &tick[1];
+
+	/* RESET leaves on and enters it again, down to idle */
+	POINTERS_EQUAL(NULL, reset->itsLca);
+	LONGS_EQUAL(2, reset->itsEntryNum);
+	POINTERS_EQUAL(&compileIdle, table->itsEntries[reset->itsEntryFirst]);
+	POINTERS_EQUAL(&compileOn,
+	               table->itsEntries[reset->itsEntryFirst + 1U]);
+	LONGS_EQUAL(1, reset->itsExitNum);
+
+	/* TICK is internal */
+	LONGS_EQUAL(0, tick->itsEntryNum);
+	LONGS_EQUAL(0, tick->itsExitNum);
+
+	/* STOP stays in on */
+	POINTERS_EQUAL(&compileOn, stop->itsLca);
+	LONGS_EQUAL(1, stop->itsEntryNum);
+	POINTERS_EQUAL(&compileIdle, table->itsEntries[stop->itsEntryFirst]);
+	LONGS_EQUAL(1, stop->itsExitNum);
+
+	hsm_table_destroy(&legacy);
+}
+
+TEST(hsm_def_compile, Should_DispatchEvents_When_LegacyCompiled)
+{
+	legacy    = hsm_build(&compileOn, stateList);
+	useLegacy = true;
+	CHECK_EQUAL(0, hsm_table_init(&legacy, EV_NUM));
+	runSequence();
+	hsm_table_destroy(&legacy);
+}
+
+TEST(hsm_def_compile, Should_StepAsBefore_When_LegacyCompiled)
+{
+	static const uint32_t eventNum = 7U;
+	static const uint32_t stepNum  = 4U;
+
+	const uint32_t events[eventNum] = {
+	    EV_START, EV_TICK, EV_STOP, EV_RESET, EV_START, EV_RESET, 42U};
+	const state_t* states[2][eventNum * stepNum];
+	uint32_t       tickCounts[2];
+	bool           started = false;
+
+	allowStop = true;
+
+	/* Micro steps only check the current state's own transitions */
+	for (uint32_t run = 0U; run < 2U; run++)
+	{
+		legacy    = hsm_build(&compileOn, stateList);
+		tickCount = 0U;
+
+		if (run == 1U)
+		{
+			CHECK_EQUAL(0, hsm_table_init(&legacy, EV_NUM));
+		}
+
+		for (uint32_t i = 0U; i < eventNum; i++)
+		{
+			hsm_event_t event = {events[i], NULL};
+
+			for (uint32_t j = 0U; j < stepNum; j++)
+			{
+				CHECK_EQUAL(0,
+				            hsm_handleEvent(&legacy, &event));
+				states[run][(i * stepNum) + j] =
+				    legacy.itsCurrentState;
+			}
+		}
+
+		tickCounts[run] = tickCount;
+		hsm_table_destroy(&legacy);
+	}
+
+	LONGS_EQUAL(tickCounts[0], tickCounts[1]);
+
+	for (uint32_t i = 0U; i < (eventNum * stepNum); i++)
+	{
+		POINTERS_EQUAL(states[0][i], states[1][i]);
+		started = started || (states[0][i] == &compileRunning);
+	}
+	CHECK(started);
+}
@@ -0,0 +1,221 @@
+#include "CppUTest/TestHarness.h"
+#include "hsm.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+digraph G {
+	graph [fontsize=10 fontname="Verdana" compound=true rankdir=LR];
+	node [shape=record fontsize=10 fontname="Verdana"];
+
+	subgraph cluster_0 {
+		label = "topA";
+		"cluster0_dummy" [ label = "", style = invis ];
+		"cluster0_dummy" -> "subA1"
+		"subA1" -> "subA2"
+	}
+
+	subgraph cluster_1 {
+		label = "topB";
+		"cluster1_dummy" [ label = "", style = invis ];
+		"cluster1_dummy" -> "subB1"
+	}
+
+	"subA2" -> "subB1";
+	"subB1" -> "subA1";
+}
+*/
+
+static char trace[256];
+
+static void traceAppend(const char* name, const char* what)
+{
+	strcat(trace, name);
+	strcat(trace, what);
+}
+
+static bool onEntry(const state_t* me, const hsm_event_t* event)
+{
+	(void)event;
+	traceAppend(me->itsName, ".entry ");
+	return true;
+}
+
+static bool during(const state_t* me, const hsm_event_t* event)
+{
+	(void)event;
+	traceAppend(me->itsName, ".during ");
+	return true;
+}
+
+static bool onExit(const state_t* me, const hsm_event_t* event)
+{
+	(void)event;
+	traceAppend(me->itsName, ".exit ");
+	return true;
+}
+
+static void action(const state_t* me, const hsm_event_t* event)
+{
+	(void)event;
+	traceAppend(me->itsName, ".action ");
+}
+
+extern state_t dispatchTopA;
+extern state_t dispatchSubA1;
+extern state_t dispatchSubA2;
+extern state_t dispatchTopB;
+extern state_t dispatchSubB1;
+
+state_t dispatchTopA = {.itsInitialState  = &dispatchSubA1,
+                        .itsParentState   = NULL,
+                        .onEntry          = onEntry,
+                        .during           = during,
+                        .onExit           = onExit,
+                        .itsTransition    = NULL,
+                        .itsTransitionNum = 0,
+                        .itsName          = "topA"};
+
+state_t dispatchSubA1 = {
+    .itsInitialState  = NULL,
+    .itsParentState   = &dispatchTopA,
+    .onEntry          = onEntry,
+    .during           = during,
+    .onExit           = onExit,
+    .itsTransition    = (hsm_transition_t[]){{NULL, action, &dispatchSubA2}},
+    .itsTransitionNum = 1,
+    .itsName          = "subA1"};
+
+state_t dispatchSubA2 = {
+    .itsInitialState  = NULL,
+    .itsParentState   = &dispatchTopA,
+    .onEntry          = onEntry,
+    .during           = during,
+    .onExit           = onExit,
+    .itsTransition    = (hsm_transition_t[]){{NULL, action, &dispatchSubB1}},
+    .itsTransitionNum = 1,
+    .itsName          = "subA2"};
+
+state_t dispatchTopB = {.itsInitialState  = &dispatchSubB1,
+                        .itsParentState   = NULL,
+                        .onEntry          = onEntry,
+                        .during           = during,
+                        .onExit           = onExit,
+                        .itsTransition    = NULL,
+                        .itsTransitionNum = 0,
+                        .itsName          = "topB"};
+
+state_t dispatchSubB1 = {
+    .itsInitialState  = NULL,
+    .itsParentState   = &dispatchTopB,
+    .onEntry          = onEntry,
+    .during           = during,
+    .onExit           = onExit,
+    .itsTransition    = (hsm_transition_t[]){{NULL, action, &dispatchSubA1}},
+    .itsTransitionNum = 1,
+    .itsName          = "subB1"};
+
+static state_t* stateList[] = {&dispatchTopA,
+                               &dispatchSubA1,
+                               &dispatchSubA2,
+                               &dispatchTopB,
+                               &dispatchSubB1};
+
+TEST_GROUP(hsm_dispatch)
+{
+	hsm_t       me; //Hierachical state machine under test
+	hsm_event_t event;
+
+	void setup()
+	{
+		/* Build hsm */
+		me       = hsm_build(&dispatchTopA, stateList);
+		trace[0] = '\0';
+
+		event.eventType = 0U;
+		event.data      = NULL;
+	}
+
+	void teardown()
+	{
+		//
+	}
+};
+
+TEST(hsm_dispatch, Should_GiveError_When_InvalidHandle)
+{
+	/* Dispatch */
+	const int err = hsm_dispatch(NULL, &event);
+
+	/* Check */
+	CHECK_EQUAL(-1, err);
+}
+
+TEST(hsm_dispatch, Should_Know_When_NoEventProvided)
+{
+	/* Dispatch */
+	const int err = hsm_dispatch(&me, NULL);
+
+	/* Check */
+	CHECK_EQUAL(1, err);
+}
+
+TEST(hsm_dispatch, Should_EnterInitialStateAndTransition_When_FirstEvent)
+{
+	/* Dispatch */
+	const int err = hsm_dispatch(&me, &event);
+
+	/* Check */
+	CHECK_EQUAL(0, err);
+	STRCMP_EQUAL("topA.entry subA1.entry topA.during subA1.during "
+	             "subA1.exit subA1.action subA2.entry ",
+	             trace);
+	POINTERS_EQUAL(&dispatchSubA2, me.itsCurrentState);
+	LONGS_EQUAL(HSM_ST_M_DURING, dispatchTopA.itsMode);
+	LONGS_EQUAL(HSM_ST_M_ON_ENTRY, dispatchSubA1.itsMode);
+	LONGS_EQUAL(HSM_ST_M_DURING, dispatchSubA2.itsMode);
+	POINTERS_EQUAL(&dispatchSubA2, dispatchTopA.itsHistoryState);
+}
+
+TEST(hsm_dispatch, Should_ExitUpToCommonAncestor_When_LeavingParent)
+{
+	/* Go to subA2 */
+	CHECK_EQUAL(0, hsm_dispatch(&me, &event));
+	trace[0] = '\0';
+
+	/* Dispatch */
+	const int err = hsm_dispatch(&me, &event);
+
+	/* Check */
+	CHECK_EQUAL(0, err);
+	STRCMP_EQUAL("topA.during subA2.during subA2.exit topA.exit "
+	             "subA2.action topB.entry subB1.entry ",
+	             trace);
+	POINTERS_EQUAL(&dispatchSubB1, me.itsCurrentState);
+	LONGS_EQUAL(HSM_ST_M_ON_ENTRY, dispatchTopA.itsMode);
+	LONGS_EQUAL(HSM_ST_M_ON_ENTRY, dispatchSubA2.itsMode);
+	LONGS_EQUAL(HSM_ST_M_DURING, dispatchTopB.itsMode);
+	LONGS_EQUAL(HSM_ST_M_DURING, dispatchSubB1.itsMode);
+}
+
+TEST(hsm_dispatch, Should_StartOver_When_Reset)
+{
+	/* Go to subB1 */
+	CHECK_EQUAL(0, hsm_dispatch(&me, &event));
+	CHECK_EQUAL(0, hsm_dispatch(&me, &event));
+
+	/* Reset */
+	CHECK_EQUAL(0, hsm_reset(&me));
+	trace[0] = '\0';
+
+	/* Dispatch */
+	const int err = hsm_dispatch(&me, &event);
+
+	/* Check */
+	CHECK_EQUAL(0, err);
+	STRCMP_EQUAL("topA.entry subA1.entry topA.during subA1.during "
+	             "subA1.exit subA1.action subA2.entry ",
+	             trace);
+	POINTERS_EQUAL(&dispatchSubA2, me.itsCurrentState);
+}
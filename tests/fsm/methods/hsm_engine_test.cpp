@@ -0,0 +1,285 @@
+#include "CppUTest/TestHarness.h"
+#include "hsm.hpp"
+
+#include <string.h>
+
+/*
+digraph G {
+	graph [fontsize=10 fontname="Verdana" compound=true rankdir=LR];
+	node [shape=record fontsize=10 fontname="Verdana"];
+
+	subgraph cluster_root {
+		label = "root";
+
+		subgraph cluster_on {
+			label = "on";
+			"idle" -> "running" [ label = "START" ];
+			"running" -> "running" [ label = "TICK / count" ];
+			"running" -> "idle" [ label = "STOP [ allowed ]" ];
+		}
+
+		"off" -> "broken" [ label = "BREAK" ];
+	}
+
+	"on" -> "off" [ label = "OFF" ];
+	"off" -> "on" [ label = "ON" ];
+}
+*/
+
+enum
+{
+	EV_NONE = HSM_EVENT_ANY,
+	EV_START,
+	EV_TICK,
+	EV_STOP,
+	EV_OFF,
+	EV_ON,
+	EV_BREAK,
+	EV_NUM
+};
+
+static char     trace[256];
+static uint32_t tickCount;
+static bool     isStopAllowed;
+
+static bool onEntry(const state_t* me, const hsm_event_t* event)
+{
+	(void)event;
+	strcat(trace, me->itsName);
+	strcat(trace, ".entry ");
+	return true;
+}
+
+static bool during(const state_t* me, const hsm_event_t* event)
+{
+	(void)event;
+	strcat(trace, me->itsName);
+	strcat(trace, ".during ");
+	return true;
+}
+
+static bool onExit(const state_t* me, const hsm_event_t* event)
+{
+	(void)event;
+	strcat(trace, me->itsName);
+	strcat(trace, ".exit ");
+	return true;
+}
+
+static bool fail(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	(void)event;
+	return false;
+}
+
+static bool isAllowed(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	(void)event;
+	return isStopAllowed;
+}
+
+static void countTick(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	(void)event;
+	tickCount++;
+}
+
+struct engineRoot;
+struct engineOn;
+struct engineIdle;
+struct engineRunning;
+struct engineOff;
+struct engineBroken;
+
+struct engineRoot : hsm::state<void, engineOn>
+{
+	static constexpr const char* name = "root";
+
+	static bool onEntry(const state_t* me, const hsm_event_t* event)
+	{
+		return ::onEntry(me, event);
+	}
+};
+
+struct engineOn : hsm::state<engineRoot, engineIdle>
+{
+	static constexpr const char* name = "on";
+
+	static bool onEntry(const state_t* me, const hsm_event_t* event)
+	{
+		return ::onEntry(me, event);
+	}
+
+	static bool during(const state_t* me, const hsm_event_t* event)
+	{
+		return ::during(me, event);
+	}
+
+	static bool onExit(const state_t* me, const hsm_event_t* event)
+	{
+		return ::onExit(me, event);
+	}
+
+	using transitions = hsm::list<hsm::transition<EV_OFF, engineOff>>;
+};
+
+struct engineIdle : hsm::state<engineOn>
+{
+	static constexpr const char* name = "idle";
+
+	static bool onEntry(const state_t* me, const hsm_event_t* event)
+	{
+		return ::onEntry(me, event);
+	}
+
+	static bool onExit(const state_t* me, const hsm_event_t* event)
+	{
+		return ::onExit(me, event);
+	}
+
+	using transitions =
+	    hsm::list<hsm::transition<EV_START, engineRunning>>;
+};
+
+struct engineRunning : hsm::state<engineOn>
+{
+	static constexpr const char* name = "running";
+
+	static bool onEntry(const state_t* me, const hsm_event_t* event)
+	{
+		return ::onEntry(me, event);
+	}
+
+	static bool during(const state_t* me, const hsm_event_t* event)
+	{
+		return ::during(me, event);
+	}
+
+	static bool onExit(const state_t* me, const hsm_event_t* event)
+	{
+		return ::onExit(me, event);
+	}
+
+	using transitions =
+	    hsm::list<hsm::transition<EV_TICK, void, nullptr, countTick>,
+	              hsm::transition<EV_STOP, engineIdle, isAllowed>>;
+};
+
+struct engineOff : hsm::state<engineRoot>
+{
+	static constexpr const char* name = "off";
+
+	static bool onEntry(const state_t* me, const hsm_event_t* event)
+	{
+		return ::onEntry(me, event);
+	}
+
+	using transitions = hsm::list<hsm::transition<EV_ON, engineOn>,
+	                              hsm::transition<EV_BREAK, engineBroken>>;
+};
+
+struct engineBroken : hsm::state<engineRoot>
+{
+	static constexpr const char* name = "broken";
+
+	static constexpr auto onEntry = fail;
+};
+
+typedef hsm::machine<EV_NUM,
+                     engineRoot,
+                     engineRoot,
+                     engineOn,
+                     engineIdle,
+                     engineRunning,
+                     engineOff,
+                     engineBroken>
+    machine_t;
+
+TEST_GROUP(hsm_engine)
+{
+	hsm::instance<machine_t> reference;
+	hsm::engine<machine_t>   sys;
+
+	void setup()
+	{
+		tickCount     = 0U;
+		isStopAllowed = false;
+		CHECK_EQUAL(0, reference.reset());
+		CHECK_EQUAL(0, sys.reset());
+	}
+
+	/* Dispatches to both and checks they behave the same */
+	int dispatch(const uint32_t eventType)
+	{
+		hsm_event_t    event = {eventType, NULL};
+		char           expected[sizeof(trace)];
+		const uint32_t expectedTicks = tickCount;
+
+		trace[0] = '\0';
+		const int expectedCode = reference.dispatch(&event);
+		strcpy(expected, trace);
+
+		trace[0]  = '\0';
+		tickCount = expectedTicks;
+		const int errorCode = sys.dispatch(&event);
+
+		STRCMP_EQUAL(expected, trace);
+		CHECK_EQUAL(expectedCode, errorCode);
+		POINTERS_EQUAL(reference.getState(), sys.getState());
+
+		return errorCode;
+	}
+};
+
+TEST(hsm_engine, Should_BehaveAsInstance_When_Dispatching)
+{
+	CHECK_EQUAL(0, dispatch(EV_NONE));
+	STRCMP_EQUAL("root.entry on.entry idle.entry on.during ", trace);
+	POINTERS_EQUAL(machine_t::stateOf<engineIdle>, sys.getState());
+
+	CHECK_EQUAL(0, dispatch(EV_START));
+	STRCMP_EQUAL("on.during idle.exit running.entry ", trace);
+
+	CHECK_EQUAL(0, dispatch(EV_TICK));
+	STRCMP_EQUAL("on.during running.during ", trace);
+	POINTERS_EQUAL(machine_t::stateOf<engineRunning>, sys.getState());
+
+	/* Guarded */
+	CHECK_EQUAL(0, dispatch(EV_STOP));
+	POINTERS_EQUAL(machine_t::stateOf<engineRunning>, sys.getState());
+
+	isStopAllowed = true;
+	CHECK_EQUAL(0, dispatch(EV_STOP));
+	POINTERS_EQUAL(machine_t::stateOf<engineIdle>, sys.getState());
+
+	CHECK_EQUAL(0, dispatch(EV_START));
+
+	/* Inherited by running from on */
+	CHECK_EQUAL(0, dispatch(EV_OFF));
+	STRCMP_EQUAL(
+	    "on.during running.during running.exit on.exit off.entry ",
+	    trace);
+
+	/* Back to running through the history */
+	CHECK_EQUAL(0, dispatch(EV_ON));
+	STRCMP_EQUAL("on.entry running.entry ", trace);
+	POINTERS_EQUAL(machine_t::stateOf<engineRunning>, sys.getState());
+
+	/* No event signal given */
+	hsm_event_t* const none = NULL;
+	CHECK_EQUAL(1, sys.dispatch(none));
+}
+
+TEST(hsm_engine, Should_Fail_When_EntryFails)
+{
+	CHECK_EQUAL(0, dispatch(EV_NONE));
+	CHECK_EQUAL(0, dispatch(EV_OFF));
+	CHECK_EQUAL(-1, dispatch(EV_BREAK));
+
+	/* Left in the last state entered and stays failed */
+	POINTERS_EQUAL(machine_t::stateOf<engineRoot>, sys.getState());
+	CHECK_EQUAL(-1, dispatch(EV_ON));
+}
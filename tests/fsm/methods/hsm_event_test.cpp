@@ -0,0 +1,113 @@
+#include "CppUTest/TestHarness.h"
+#include "hsm_events.h"
+
+#include <string.h>
+
+/*
+digraph G {
+	graph [fontsize=10 fontname="Verdana" compound=true rankdir=LR];
+	node [shape=record fontsize=10 fontname="Verdana"];
+
+	"reading" -> "reading" [ label = "SAMPLE / readSample" ];
+}
+*/
+
+enum
+{
+	EV_SAMPLE = 1U
+};
+
+typedef struct
+{
+	uint32_t channel;
+	uint32_t value;
+} sample_t;
+
+static sample_t lastSample;
+
+static void readSample(const state_t* me, const hsm_event_t* event)
+{
+	const void* const data = hsm_event_getData(event);
+
+	(void)me;
+	(void)memcpy(&lastSample, data, sizeof(lastSample));
+}
+
+static state_t eventReading = {
+    .itsInitialState  = NULL,
+    .itsParentState   = NULL,
+    .onEntry          = NULL,
+    .during           = NULL,
+    .onExit           = NULL,
+    .itsTransition    = (hsm_transition_t[]){{NULL, readSample, NULL,
+                                              EV_SAMPLE}},
+    .itsTransitionNum = 1};
+
+static state_t* stateList[] = {&eventReading};
+
+TEST_GROUP(hsm_event)
+{
+	hsm_event_t event;
+	sample_t    sample;
+
+	void setup()
+	{
+		sample     = {3U, 42U};
+		lastSample = {0U, 0U};
+	}
+};
+
+TEST(hsm_event, Should_GiveError_When_InvalidInput)
+{
+	CHECK_EQUAL(-1, hsm_event_init(NULL, EV_SAMPLE, &sample, 8U));
+	CHECK_EQUAL(-1, hsm_event_init(&event, EV_SAMPLE, NULL, 8U));
+	CHECK_EQUAL(-1, hsm_event_init(&event, EV_SAMPLE, &sample, 0U));
+	POINTERS_EQUAL(NULL, hsm_event_getData(NULL));
+}
+
+TEST(hsm_event, Should_CopyPayload_When_ItFits)
+{
+	const int inlined =
+	    (sizeof(sample) <= HSM_EVENT_INLINE_SIZE) ? 0 : 1;
+
+	CHECK_EQUAL(
+	    inlined,
+	    hsm_event_init(&event, EV_SAMPLE, &sample, sizeof(sample)));
+	CHECK_EQUAL(EV_SAMPLE, event.eventType);
+
+	/* The copy does not follow the original */
+	sample.value = 7U;
+	CHECK_EQUAL((inlined == 0) ? 42U : 7U,
+	            ((const sample_t*)hsm_event_getData(&event))->value);
+}
+
+TEST(hsm_event, Should_PassPointer_When_PayloadTooLarge)
+{
+	uint8_t large[HSM_EVENT_INLINE_SIZE + 1U];
+
+	CHECK_EQUAL(1,
+	            hsm_event_init(&event, EV_SAMPLE, large, sizeof(large)));
+	POINTERS_EQUAL(large, event.data);
+	POINTERS_EQUAL(large, hsm_event_getData(&event));
+}
+
+TEST(hsm_event, Should_PassNothing_When_NoPayload)
+{
+	CHECK_EQUAL(0, hsm_event_init(&event, EV_SAMPLE, NULL, 0U));
+	POINTERS_EQUAL(NULL, event.data);
+}
+
+TEST(hsm_event, Should_KeepPayload_When_QueuedByValue)
+{
+	hsm_t             me = hsm_build(&eventReading, stateList);
+	hsm_events_t      events;
+	hsm_events_node_t nodes[2];
+
+	CHECK_EQUAL(0, hsm_events_init(&events, &me, nodes, 2U));
+	CHECK(hsm_event_init(&event, EV_SAMPLE, &sample, sizeof(sample)) >= 0);
+	CHECK_EQUAL(0, hsm_events_push(&events, &event, 0U));
+
+	CHECK_EQUAL(1, hsm_events_run(&events));
+	CHECK_EQUAL(3, lastSample.channel);
+	CHECK_EQUAL(42, lastSample.value);
+}
@@ -0,0 +1,199 @@
+#include "CppUTest/TestHarness.h"
+#include "hsm_events.h"
+
+/*
+digraph G {
+	graph [fontsize=10 fontname="Verdana" compound=true rankdir=LR];
+	node [shape=record fontsize=10 fontname="Verdana"];
+
+	"locked" -> "locked" [ label = "DATA / defer" ];
+	"locked" -> "locked" [ label = "RETRY" ];
+	"locked" -> "open" [ label = "UNLOCK" ];
+	"open" -> "open" [ label = "DATA / record" ];
+	"open" -> "locked" [ label = "LOCK" ];
+}
+*/
+
+enum
+{
+	EV_DATA = 1U,
+	EV_UNLOCK,
+	EV_LOCK,
+	EV_RETRY
+};
+
+#define EVENTS_CAPACITY (4U)
+
+static hsm_events_t events;
+static uintptr_t    recorded[16];
+static uint32_t     recordedNum;
+
+static void deferAction(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	CHECK_EQUAL(0, hsm_events_defer(&events, event, 1U));
+}
+
+static void recordAction(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	recorded[recordedNum] = (uintptr_t)event->data;
+	recordedNum++;
+}
+
+extern state_t eventsLocked;
+extern state_t eventsOpen;
+
+state_t eventsLocked = {
+    .itsInitialState = NULL,
+    .itsParentState  = NULL,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, deferAction, NULL, EV_DATA},
+                             {NULL, NULL, &eventsOpen, EV_UNLOCK},
+                             {NULL, NULL, &eventsLocked, EV_RETRY}},
+    .itsTransitionNum = 3};
+
+state_t eventsOpen = {
+    .itsInitialState = NULL,
+    .itsParentState  = NULL,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, recordAction, NULL, EV_DATA},
+                             {NULL, NULL, &eventsLocked, EV_LOCK}},
+    .itsTransitionNum = 2};
+
+static state_t* stateList[] = {&eventsLocked, &eventsOpen};
+
+TEST_GROUP(hsm_events)
+{
+	hsm_t             me;
+	hsm_events_node_t nodes[EVENTS_CAPACITY];
+
+	void setup()
+	{
+		me          = hsm_build(&eventsLocked, stateList);
+		recordedNum = 0U;
+		CHECK_EQUAL(
+		    0,
+		    hsm_events_init(&events, &me, nodes, EVENTS_CAPACITY));
+	}
+
+	int push(const uint32_t eventType,
+	         const uintptr_t data,
+	         const uint32_t priority)
+	{
+		hsm_event_t event = {eventType, (void*)data};
+		return hsm_events_push(&events, &event, priority);
+	}
+};
+
+TEST(hsm_events, Should_GiveError_When_InvalidInput)
+{
+	hsm_event_t event = {EV_DATA, NULL};
+
+	CHECK_EQUAL(-1, hsm_events_init(NULL, &me, nodes, EVENTS_CAPACITY));
+	CHECK_EQUAL(-1, hsm_events_init(&events, NULL, nodes, 1U));
+	CHECK_EQUAL(-1, hsm_events_init(&events, &me, NULL, 1U));
+	CHECK_EQUAL(-1, hsm_events_init(&events, &me, nodes, 0U));
+	CHECK_EQUAL(-1, hsm_events_push(NULL, &event, 0U));
+	CHECK_EQUAL(-1, hsm_events_push(&events, NULL, 0U));
+	CHECK_EQUAL(-1, hsm_events_push(&events, &event, HSM_PRIORITY_NUM));
+	CHECK_EQUAL(-1, hsm_events_defer(&events, &event, HSM_PRIORITY_NUM));
+	CHECK_EQUAL(-1, hsm_events_pop(&events, NULL));
+	CHECK_EQUAL(-1, hsm_events_run(NULL));
+	CHECK_EQUAL(0, hsm_events_recall(NULL));
+}
+
+TEST(hsm_events, Should_PopMostUrgentFirst_When_Pushed)
+{
+	hsm_event_t event;
+
+	CHECK_EQUAL(0, push(EV_DATA, 1U, 2U));
+	CHECK_EQUAL(0, push(EV_DATA, 2U, 0U));
+	CHECK_EQUAL(0, push(EV_DATA, 3U, 2U));
+	CHECK_EQUAL(0, push(EV_DATA, 4U, 0U));
+
+	/* Priority first, then in order */
+	CHECK_EQUAL(0, hsm_events_pop(&events, &event));
+	CHECK_EQUAL(2, (uintptr_t)event.data);
+	CHECK_EQUAL(0, hsm_events_pop(&events, &event));
+	CHECK_EQUAL(4, (uintptr_t)event.data);
+	CHECK_EQUAL(0, hsm_events_pop(&events, &event));
+	CHECK_EQUAL(1, (uintptr_t)event.data);
+	CHECK_EQUAL(0, hsm_events_pop(&events, &event));
+	CHECK_EQUAL(3, (uintptr_t)event.data);
+	CHECK_EQUAL(1, hsm_events_pop(&events, &event));
+}
+
+TEST(hsm_events, Should_DropEvent_When_Full)
+{
+	hsm_event_t event;
+
+	for (uint32_t i = 0U; i < EVENTS_CAPACITY; i++)
+	{
+		CHECK_EQUAL(0, push(EV_DATA, i, 3U));
+	}
+	CHECK_EQUAL(1, push(EV_DATA, 9U, 0U));
+
+	/* The nodes are given back */
+	CHECK_EQUAL(0, hsm_events_pop(&events, &event));
+	CHECK_EQUAL(0, push(EV_DATA, 9U, 0U));
+	CHECK_EQUAL(0, hsm_events_pop(&events, &event));
+	CHECK_EQUAL(9, (uintptr_t)event.data);
+}
+
+TEST(hsm_events, Should_RecallDeferredEvents_When_StateChanges)
+{
+	CHECK_EQUAL(0, push(EV_DATA, 1U, 1U));
+	CHECK_EQUAL(0, push(EV_DATA, 2U, 1U));
+	CHECK_EQUAL(0, push(EV_UNLOCK, 0U, 2U));
+	CHECK_EQUAL(5, hsm_events_run(&events));
+
+	/* Recalled once open, in order */
+	CHECK_EQUAL(2, recordedNum);
+	CHECK_EQUAL(1, recorded[0]);
+	CHECK_EQUAL(2, recorded[1]);
+	POINTERS_EQUAL(&eventsOpen, me.itsCurrentState);
+}
+
+TEST(hsm_events, Should_HandleRecalledFirst_When_SamePriority)
+{
+	CHECK_EQUAL(0, push(EV_DATA, 1U, 1U));
+	CHECK_EQUAL(0, push(EV_UNLOCK, 0U, 1U));
+	CHECK_EQUAL(0, push(EV_DATA, 2U, 1U));
+	CHECK_EQUAL(4, hsm_events_run(&events));
+
+	/* The deferred one goes before the newer one */
+	CHECK_EQUAL(2, recordedNum);
+	CHECK_EQUAL(1, recorded[0]);
+	CHECK_EQUAL(2, recorded[1]);
+}
+
+TEST(hsm_events, Should_KeepDeferredEvents_When_StateDoesNotChange)
+{
+	CHECK_EQUAL(0, push(EV_DATA, 1U, 0U));
+	CHECK_EQUAL(1, hsm_events_run(&events));
+
+	CHECK_EQUAL(0, recordedNum);
+	CHECK_EQUAL(1, events.itsDeferredNum);
+	CHECK_EQUAL(1, hsm_events_recall(&events));
+	CHECK_EQUAL(0, events.itsDeferredNum);
+}
+
+TEST(hsm_events, Should_RecallDeferredEvents_When_SelfTransition)
+{
+	CHECK_EQUAL(0, push(EV_DATA, 1U, 0U));
+	CHECK_EQUAL(0, push(EV_RETRY, 0U, 1U));
+
+	/* Deferred, locked again and deferred again */
+	CHECK_EQUAL(3, hsm_events_run(&events));
+
+	CHECK_EQUAL(0, recordedNum);
+	CHECK_EQUAL(1, events.itsDeferredNum);
+	POINTERS_EQUAL(&eventsLocked, me.itsCurrentState);
+}
@@ -0,0 +1,261 @@
+#include "CppUTest/TestHarness.h"
+#include "hsm_exec.h"
+
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+digraph G {
+	graph [fontsize=10 fontname="Verdana" compound=true rankdir=LR];
+	node [shape=record fontsize=10 fontname="Verdana"];
+
+	"counting" -> "counting" [ label = "COUNT / count" ];
+}
+*/
+
+enum
+{
+	EV_COUNT = 1U
+};
+
+#define WORKER_NUM     (4U)
+#define ACTOR_NUM      (64U)
+#define ACTOR_CAPACITY (16U)
+#define ACTOR_POSTS    (200U)
+#define STEAL_TRIES    (1000000U)
+
+typedef struct
+{
+	uint32_t count;
+	uint32_t busy;
+	uint32_t overlapNum;
+} counter_t;
+
+/* If set, the actions hold their worker until another one steals */
+static const hsm_exec_t* stealExec;
+
+static uint64_t getStealNum(const hsm_exec_t* const exec)
+{
+	uint64_t stealNum = 0U;
+
+	for (uint32_t i = 0U; i < exec->itsWorkerNum; i++)
+	{
+		stealNum += __atomic_load_n(&exec->itsWorkers[i].itsStealNum,
+		                            __ATOMIC_RELAXED);
+	}
+
+	return stealNum;
+}
+
+static void countAction(const state_t* me, const hsm_event_t* event)
+{
+	counter_t* const counter = (counter_t*)event->data;
+
+	(void)me;
+
+	for (uint32_t i = 0U; (stealExec != NULL) && (i < STEAL_TRIES) &&
+	                      (getStealNum(stealExec) == 0U);
+	     i++)
+	{
+		(void)sched_yield();
+	}
+
+	/* Never dispatched by two workers at once */
+	if (__atomic_exchange_n(&counter->busy, 1U, __ATOMIC_ACQ_REL) != 0U)
+	{
+		counter->overlapNum++;
+	}
+	counter->count++;
+	__atomic_store_n(&counter->busy, 0U, __ATOMIC_RELEASE);
+}
+
+static state_t execCounting = {
+    .itsInitialState  = NULL,
+    .itsParentState   = NULL,
+    .onEntry          = NULL,
+    .during           = NULL,
+    .onExit           = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, countAction, NULL, EV_COUNT}},
+    .itsTransitionNum = 1};
+
+static state_t* stateList[] = {&execCounting};
+
+TEST_GROUP(hsm_exec)
+{
+	hsm_def_t        def;
+	hsm_exec_t       exec;
+	hsm_worker_t     workers[WORKER_NUM];
+	hsm_inst_t       insts[ACTOR_NUM];
+	hsm_t            machines[ACTOR_NUM];
+	hsm_actor_t      actors[ACTOR_NUM];
+	hsm_queue_slot_t slots[ACTOR_NUM][ACTOR_CAPACITY];
+	counter_t        counters[ACTOR_NUM];
+
+	void setup()
+	{
+		CHECK_EQUAL(0, hsm_def_build(&def, &execCounting, stateList));
+		CHECK_EQUAL(0, hsm_exec_init(&exec, workers, WORKER_NUM));
+		memset(counters, 0, sizeof(counters));
+		stealExec = NULL;
+	}
+
+	void teardown()
+	{
+		hsm_exec_destroy(&exec);
+		hsm_def_destroy(&def);
+	}
+
+	void initActors(const bool sameWorker)
+	{
+		for (uint32_t i = 0U; i < ACTOR_NUM; i++)
+		{
+			const uint32_t w = sameWorker ? 0U : (i % WORKER_NUM);
+
+			CHECK_EQUAL(0, hsm_inst_init(&insts[i], &def, NULL));
+			CHECK_EQUAL(0,
+			            hsm_actor_init(&actors[i],
+			                           &exec,
+			                           w,
+			                           &insts[i],
+			                           slots[i],
+			                           ACTOR_CAPACITY));
+		}
+	}
+
+	void postAll()
+	{
+		for (uint32_t post = 0U; post < ACTOR_POSTS; post++)
+		{
+			for (uint32_t i = 0U; i < ACTOR_NUM; i++)
+			{
+				hsm_event_t event = {EV_COUNT, &counters[i]};
+
+				while (hsm_actor_post(&actors[i], &event) == 1)
+				{
+					/* Full, retry */
+					(void)sched_yield();
+				}
+			}
+		}
+	}
+
+	void checkCounters(const uint32_t expected)
+	{
+		for (uint32_t i = 0U; i < ACTOR_NUM; i++)
+		{
+			CHECK_EQUAL(expected, counters[i].count);
+			CHECK_EQUAL(0, counters[i].overlapNum);
+		}
+	}
+};
+
+TEST(hsm_exec, Should_GiveError_When_InvalidInput)
+{
+	hsm_inst_t       inst;
+	hsm_t            machine = hsm_build(&execCounting, stateList);
+	hsm_actor_t      actor;
+	hsm_event_t      event = {EV_COUNT, NULL};
+	hsm_queue_slot_t slot[1];
+
+	CHECK_EQUAL(0, hsm_inst_init(&inst, &def, NULL));
+
+	CHECK_EQUAL(-1, hsm_exec_init(NULL, workers, WORKER_NUM));
+	CHECK_EQUAL(-1, hsm_exec_init(&exec, NULL, WORKER_NUM));
+	CHECK_EQUAL(-1, hsm_exec_init(&exec, workers, 0U));
+	CHECK_EQUAL(-1, hsm_exec_start(NULL));
+	CHECK_EQUAL(-1, hsm_exec_stop(NULL));
+	CHECK_EQUAL(-1, hsm_actor_init(NULL, &exec, 0U, &inst, slot, 1U));
+	CHECK_EQUAL(-1, hsm_actor_init(&actor, NULL, 0U, &inst, slot, 1U));
+	CHECK_EQUAL(
+	    -1,
+	    hsm_actor_init(&actor, &exec, WORKER_NUM, &inst, slot, 1U));
+	CHECK_EQUAL(-1, hsm_actor_init(&actor, &exec, 0U, NULL, slot, 1U));
+	CHECK_EQUAL(-1,
+	            hsm_actor_initMachine(
+	                &actor, &exec, WORKER_NUM, &machine, slot, 1U));
+	CHECK_EQUAL(-1,
+	            hsm_actor_initMachine(&actor, &exec, 0U, NULL, slot, 1U));
+	CHECK_EQUAL(-1, hsm_actor_post(NULL, &event));
+}
+
+TEST(hsm_exec, Should_DispatchPostedEvents_When_Stopped)
+{
+	hsm_event_t event;
+
+	initActors(false);
+
+	/* Posted before the workers start */
+	for (uint32_t i = 0U; i < ACTOR_NUM; i++)
+	{
+		event.eventType = EV_COUNT;
+		event.data      = &counters[i];
+		CHECK_EQUAL(0, hsm_actor_post(&actors[i], &event));
+	}
+
+	CHECK_EQUAL(0, hsm_exec_start(&exec));
+	CHECK_EQUAL(0, hsm_exec_stop(&exec));
+	checkCounters(1U);
+}
+
+TEST(hsm_exec, Should_DispatchEveryEvent_When_Running)
+{
+	initActors(false);
+
+	CHECK_EQUAL(0, hsm_exec_start(&exec));
+	postAll();
+	CHECK_EQUAL(0, hsm_exec_stop(&exec));
+	checkCounters(ACTOR_POSTS);
+}
+
+TEST(hsm_exec, Should_DispatchEveryEvent_When_MachineActors)
+{
+	for (uint32_t i = 0U; i < ACTOR_NUM; i++)
+	{
+		machines[i] = hsm_build(&execCounting, stateList);
+		CHECK_EQUAL(0,
+		            hsm_actor_initMachine(&actors[i],
+		                                  &exec,
+		                                  i % WORKER_NUM,
+		                                  &machines[i],
+		                                  slots[i],
+		                                  ACTOR_CAPACITY));
+	}
+
+	CHECK_EQUAL(0, hsm_exec_start(&exec));
+	postAll();
+	CHECK_EQUAL(0, hsm_exec_stop(&exec));
+	checkCounters(ACTOR_POSTS);
+}
+
+TEST(hsm_exec, Should_StealActors_When_AllHaveSameAffinity)
+{
+	uint64_t runNum = 0U;
+
+	initActors(true);
+	stealExec = &exec;
+
+	CHECK_EQUAL(0, hsm_exec_start(&exec));
+	postAll();
+	CHECK_EQUAL(0, hsm_exec_stop(&exec));
+	checkCounters(ACTOR_POSTS);
+
+	/* All of them are of the first worker, the others ran some */
+	CHECK(getStealNum(&exec) > 0U);
+	CHECK_EQUAL(0U, workers[0].itsStealNum);
+
+	for (uint32_t i = 1U; i < WORKER_NUM; i++)
+	{
+		CHECK_EQUAL(workers[i].itsRunNum, workers[i].itsStealNum);
+		runNum += workers[i].itsRunNum;
+	}
+	CHECK(runNum > 0U);
+	stealExec = NULL;
+
+	/* Restarts */
+	CHECK_EQUAL(0, hsm_exec_start(&exec));
+	postAll();
+	CHECK_EQUAL(0, hsm_exec_stop(&exec));
+	checkCounters(2U * ACTOR_POSTS);
+}
@@ -0,0 +1,229 @@
+#include "CppUTest/TestHarness.h"
+#include "hsm_fleet.h"
+#include "hsm_trace.h"
+
+#include <stdlib.h>
+
+/*
+digraph G {
+	graph [fontsize=10 fontname="Verdana" compound=true rankdir=LR];
+	node [shape=record fontsize=10 fontname="Verdana"];
+
+	subgraph cluster_0 {
+		label = "on";
+		"cluster0_dummy" [ label = "", style = invis ];
+		"cluster0_dummy" -> "idle"
+		"idle" -> "running" [ label = "START" ];
+		"running" -> "running" [ label = "TICK / count" ];
+	}
+}
+*/
+
+enum
+{
+	EV_NONE = HSM_EVENT_ANY,
+	EV_START,
+	EV_TICK,
+	EV_NUM
+};
+
+#define INST_NUM (100U)
+
+static uint32_t tickCount;
+static uint32_t duringCount;
+
+static void tickAction(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	(void)event;
+	tickCount++;
+}
+
+static bool countDuring(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	(void)event;
+	duringCount++;
+	return true;
+}
+
+extern state_t fleetOn;
+extern state_t fleetIdle;
+extern state_t fleetRunning;
+
+state_t fleetOn = {.itsInitialState  = &fleetIdle,
+                   .itsParentState   = NULL,
+                   .onEntry          = NULL,
+                   .during           = NULL,
+                   .onExit           = NULL,
+                   .itsTransition    = NULL,
+                   .itsTransitionNum = 0};
+
+state_t fleetIdle = {
+    .itsInitialState = NULL,
+    .itsParentState  = &fleetOn,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, NULL, &fleetRunning, EV_START}},
+    .itsTransitionNum = 1};
+
+state_t fleetRunning = {
+    .itsInitialState = NULL,
+    .itsParentState  = &fleetOn,
+    .onEntry         = NULL,
+    .during          = countDuring,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, tickAction, NULL, EV_TICK}},
+    .itsTransitionNum = 1};
+
+static state_t* stateList[] = {&fleetOn, &fleetIdle, &fleetRunning};
+
+TEST_GROUP(hsm_fleet)
+{
+	hsm_def_t   def;
+	hsm_fleet_t fleet;
+
+	void setup()
+	{
+		CHECK_EQUAL(0, hsm_def_build(&def, &fleetOn, stateList));
+		fleet.itsMemory = NULL;
+		tickCount       = 0U;
+		duringCount     = 0U;
+	}
+
+	void teardown()
+	{
+		hsm_fleet_destroy(&fleet);
+		hsm_def_destroy(&def);
+	}
+
+	void runSequence()
+	{
+		hsm_event_t event = {EV_NONE, NULL};
+
+		CHECK_EQUAL(0, hsm_fleet_init(&fleet, &def, INST_NUM));
+
+		/* Enters all of them */
+		CHECK_EQUAL(0, hsm_fleet_broadcast(&fleet, &event));
+		POINTERS_EQUAL(&fleetIdle, hsm_fleet_getState(&fleet, 0U));
+
+		/* Start every other one */
+		event.eventType = EV_START;
+		for (uint32_t i = 0U; i < INST_NUM; i += 2U)
+		{
+			CHECK_EQUAL(0, hsm_fleet_dispatch(&fleet, i, &event));
+		}
+		POINTERS_EQUAL(&fleetRunning, hsm_fleet_getState(&fleet, 0U));
+		POINTERS_EQUAL(&fleetIdle, hsm_fleet_getState(&fleet, 1U));
+		LONGS_EQUAL(0, duringCount);
+
+		/* Only the running ones count */
+		event.eventType = EV_TICK;
+		CHECK_EQUAL(0, hsm_fleet_broadcast(&fleet, &event));
+		LONGS_EQUAL(INST_NUM / 2U, tickCount);
+		LONGS_EQUAL(INST_NUM / 2U, duringCount);
+
+		/* Starts the rest */
+		event.eventType = EV_START;
+		CHECK_EQUAL(0, hsm_fleet_broadcast(&fleet, &event));
+		for (uint32_t i = 0U; i < INST_NUM; i++)
+		{
+			POINTERS_EQUAL(&fleetRunning,
+			               hsm_fleet_getState(&fleet, i));
+		}
+	}
+};
+
+TEST(hsm_fleet, Should_GiveError_When_InvalidInput)
+{
+	hsm_event_t event = {EV_TICK, NULL};
+
+	CHECK_EQUAL(-1, hsm_fleet_init(NULL, &def, INST_NUM));
+	CHECK_EQUAL(-1, hsm_fleet_init(&fleet, NULL, INST_NUM));
+	CHECK_EQUAL(-1, hsm_fleet_init(&fleet, &def, 0U));
+	CHECK_EQUAL(-1, hsm_fleet_broadcast(&fleet, &event));
+
+	CHECK_EQUAL(0, hsm_fleet_init(&fleet, &def, INST_NUM));
+	CHECK_EQUAL(-1, hsm_fleet_broadcast(NULL, &event));
+	CHECK_EQUAL(-1, hsm_fleet_broadcast(&fleet, NULL));
+	CHECK_EQUAL(-1, hsm_fleet_dispatch(&fleet, INST_NUM, &event));
+	POINTERS_EQUAL(NULL, hsm_fleet_getState(&fleet, INST_NUM));
+}
+
+TEST(hsm_fleet, Should_MarkActiveInstances_When_Compiled)
+{
+	hsm_event_t event = {EV_NONE, NULL};
+
+	CHECK_EQUAL(0, hsm_def_compile(&def, EV_NUM));
+	CHECK_EQUAL(0, hsm_fleet_init(&fleet, &def, INST_NUM));
+	CHECK_EQUAL(0, hsm_fleet_broadcast(&fleet, &event));
+
+	/* Idle does nothing on TICK */
+	event.eventType = EV_TICK;
+	CHECK_EQUAL(0, hsm_fleet_broadcast(&fleet, &event));
+	LONGS_EQUAL(0, fleet.itsActive[0]);
+
+	/* Running has a during action */
+	event.eventType = EV_START;
+	CHECK_EQUAL(0, hsm_fleet_dispatch(&fleet, 0U, &event));
+	event.eventType = 42U;
+	CHECK_EQUAL(0, hsm_fleet_broadcast(&fleet, &event));
+	LONGS_EQUAL(1, fleet.itsActive[0]);
+	LONGS_EQUAL(0, fleet.itsActive[1]);
+}
+
+TEST(hsm_fleet, Should_BroadcastEvents_When_NotCompiled)
+{
+	runSequence();
+}
+
+TEST(hsm_fleet, Should_BroadcastEvents_When_Compiled)
+{
+	CHECK_EQUAL(0, hsm_def_compile(&def, EV_NUM));
+	runSequence();
+}
+
+#if HSM_TRACE
+
+TEST(hsm_fleet, Should_TraceDistinctMachines_When_Dispatched)
+{
+	hsm_trace_t        ring;
+	hsm_trace_record_t records[4];
+	hsm_event_t        event = {EV_NONE, NULL};
+
+	CHECK_EQUAL(0, hsm_fleet_init(&fleet, &def, INST_NUM));
+	CHECK_EQUAL(0, hsm_fleet_dispatch(&fleet, 0U, &event));
+	CHECK_EQUAL(0, hsm_fleet_dispatch(&fleet, 1U, &event));
+
+	CHECK_EQUAL(0, hsm_trace_init(&ring, records, 4U));
+	hsm_trace_attach(&ring);
+	event.eventType = EV_START;
+	CHECK_EQUAL(0, hsm_fleet_dispatch(&fleet, 0U, &event));
+	CHECK_EQUAL(0, hsm_fleet_dispatch(&fleet, 1U, &event));
+	CHECK_EQUAL(0, hsm_fleet_dispatch(&fleet, 0U, &event));
+	hsm_trace_attach(NULL);
+
+	/* The START of each, the second one of the first is not taken */
+	hsm_trace_record_t out[4];
+
+	LONGS_EQUAL(2, hsm_trace_read(&ring, out, 4U));
+	CHECK(out[0].itsMachine != out[1].itsMachine);
+
+	/* The same instance keeps its id */
+	const uint64_t first = out[0].itsMachine;
+
+	CHECK_EQUAL(0, hsm_fleet_reset(&fleet));
+	event.eventType = EV_NONE;
+	CHECK_EQUAL(0, hsm_fleet_dispatch(&fleet, 0U, &event));
+	hsm_trace_attach(&ring);
+	event.eventType = EV_START;
+	CHECK_EQUAL(0, hsm_fleet_dispatch(&fleet, 0U, &event));
+	hsm_trace_attach(NULL);
+	LONGS_EQUAL(1, hsm_trace_read(&ring, out, 4U));
+	CHECK_EQUAL(first, out[0].itsMachine);
+}
+
+#endif /* HSM_TRACE */
@@ -28,6 +28,49 @@ state_t secondState = {.itsInitialState = NULL,
 
 static state_t* stateList[] = {&firstState, &secondState};
 
+enum
+{
+	EV_GO = 1U,
+	EV_STOP,
+	EV_PING
+};
+
+static uint32_t pingNum;
+
+static void ping(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	(void)event;
+	pingNum++;
+}
+
+extern state_t idleState;
+extern state_t busyState;
+
+/* Goes on GO, counts an internal PING */
+state_t idleState = {
+    .itsInitialState = NULL,
+    .itsParentState  = NULL,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition   = (hsm_transition_t[]){{NULL, NULL, &busyState, EV_GO},
+                                            {NULL, ping, NULL, EV_PING}},
+    .itsTransitionNum = 2};
+
+/* Goes back on STOP, the second transition is not counted */
+state_t busyState = {
+    .itsInitialState = NULL,
+    .itsParentState  = NULL,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition = (hsm_transition_t[]){{NULL, NULL, &idleState, EV_STOP},
+                                          {NULL, NULL, &idleState, EV_GO}},
+    .itsTransitionNum = 1};
+
+static state_t* eventList[] = {&idleState, &busyState};
+
 TEST_GROUP(hsm_handleEvent)
 {
 	hsm_t       me; //Hierachical state machine under test
@@ -62,3 +105,47 @@ TEST(hsm_handleEvent, Should_Know_When_NoEventProvided)
 	/* Check */
 	CHECK_EQUAL(1, err);
 }
+
+TEST(hsm_handleEvent, Should_TakeTransition_When_EventMatches)
+{
+	hsm_t             sys  = hsm_build(&idleState, eventList);
+	const hsm_event_t go   = {EV_GO, NULL};
+	const hsm_event_t stop = {EV_STOP, NULL};
+	const hsm_event_t pi   = {EV_PING, NULL};
+
+	pingNum = 0U;
+
+	/* Entry and during */
+	CHECK_EQUAL(0, hsm_handleEvent(&sys, &stop));
+	CHECK_EQUAL(0, hsm_handleEvent(&sys, &stop));
+	LONGS_EQUAL(HSM_ST_M_CHECKING_GUARD, idleState.itsMode);
+
+	/* Not a trigger */
+	CHECK_EQUAL(0, hsm_handleEvent(&sys, &stop));
+	POINTERS_EQUAL(&idleState, sys.itsCurrentState);
+	LONGS_EQUAL(HSM_ST_M_CHECKING_GUARD, idleState.itsMode);
+
+	/* Internal, its action only */
+	CHECK_EQUAL(0, hsm_handleEvent(&sys, &pi));
+	CHECK_EQUAL(1U, pingNum);
+	LONGS_EQUAL(HSM_ST_M_CHECKING_GUARD, idleState.itsMode);
+
+	CHECK_EQUAL(0, hsm_handleEvent(&sys, &go));
+	LONGS_EQUAL(HSM_ST_M_ON_EXIT, idleState.itsMode);
+	CHECK_EQUAL(0, hsm_handleEvent(&sys, &stop));
+	POINTERS_EQUAL(&busyState, sys.itsCurrentState);
+	LONGS_EQUAL(HSM_ST_M_ON_ENTRY, busyState.itsMode);
+
+	/* Only itsTransitionNum transitions count */
+	for (uint32_t i = 0U; i < 4U; i++)
+	{
+		CHECK_EQUAL(0, hsm_handleEvent(&sys, &go));
+	}
+	POINTERS_EQUAL(&busyState, sys.itsCurrentState);
+	LONGS_EQUAL(HSM_ST_M_CHECKING_GUARD, busyState.itsMode);
+
+	CHECK_EQUAL(0, hsm_handleEvent(&sys, &stop));
+	CHECK_EQUAL(0, hsm_handleEvent(&sys, &stop));
+	POINTERS_EQUAL(&idleState, sys.itsCurrentState);
+	LONGS_EQUAL(HSM_ST_M_ON_ENTRY, idleState.itsMode);
+}
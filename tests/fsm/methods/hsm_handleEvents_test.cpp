@@ -0,0 +1,114 @@
+#include "CppUTest/TestHarness.h"
+#include "hsm.h"
+
+#include <stdlib.h>
+
+static bool failEntry;
+
+static bool failingEntry(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	(void)event;
+	return !failEntry;
+}
+
+extern state_t batchFirst;
+extern state_t batchSecond;
+
+/* Initial state */
+state_t batchFirst = {.itsInitialState = NULL,
+                      .itsParentState  = NULL,
+                      .onEntry         = NULL,
+                      .during          = NULL,
+                      .onExit          = NULL,
+                      .itsTransition =
+                          (hsm_transition_t[]){{NULL, NULL, &batchSecond}},
+                      .itsTransitionNum = 1};
+
+/* Next state */
+state_t batchSecond = {.itsInitialState = NULL,
+                       .itsParentState  = NULL,
+                       .onEntry         = failingEntry,
+                       .during          = NULL,
+                       .onExit          = NULL,
+                       .itsTransition =
+                           (hsm_transition_t[]){{NULL, NULL, &batchFirst}},
+                       .itsTransitionNum = 1};
+
+static state_t* stateList[] = {&batchFirst, &batchSecond};
+
+TEST_GROUP(hsm_handleEvents)
+{
+	hsm_t       me; //Hierachical state machine under test
+	hsm_event_t events[8];
+	size_t      doneNum;
+
+	void setup()
+	{
+		/* Build hsm */
+		me = hsm_build(&batchFirst, stateList);
+
+		for (size_t i = 0U; i < 8U; i++)
+		{
+			events[i].eventType = 0U;
+			events[i].data      = NULL;
+		}
+
+		failEntry = false;
+		doneNum   = 42U;
+	}
+
+	void teardown()
+	{
+		//
+	}
+};
+
+TEST(hsm_handleEvents, Should_GiveError_When_InvalidInput)
+{
+	CHECK_EQUAL(-1, hsm_handleEvents(NULL, events, 8U, &doneNum));
+	CHECK_EQUAL(0, doneNum);
+	CHECK_EQUAL(-1, hsm_handleEvents(&me, NULL, 8U, &doneNum));
+}
+
+TEST(hsm_handleEvents, Should_DoNothing_When_NoEvents)
+{
+	CHECK_EQUAL(0, hsm_handleEvents(&me, NULL, 0U, &doneNum));
+	CHECK_EQUAL(0, doneNum);
+	POINTERS_EQUAL(&batchFirst, me.itsCurrentState);
+}
+
+TEST(hsm_handleEvents, Should_MatchSingleEvents_When_Batched)
+{
+	hsm_t single = hsm_build(&batchFirst, stateList);
+
+	/* One by one */
+	for (size_t i = 0U; i < 4U; i++)
+	{
+		CHECK_EQUAL(0, hsm_handleEvent(&single, &events[i]));
+	}
+	POINTERS_EQUAL(&batchSecond, single.itsCurrentState);
+
+	/* Batch */
+	CHECK_EQUAL(0, hsm_reset(&me));
+	CHECK_EQUAL(0, hsm_handleEvents(&me, events, 4U, &doneNum));
+	CHECK_EQUAL(4, doneNum);
+	POINTERS_EQUAL(&batchSecond, me.itsCurrentState);
+	CHECK_EQUAL(HSM_ST_M_ON_ENTRY, me.itsCurrentState->itsMode);
+	CHECK_EQUAL(HSM_ST_M_ON_ENTRY, batchFirst.itsMode);
+}
+
+TEST(hsm_handleEvents, Should_ReportFailedEvent_When_Failing)
+{
+	failEntry = true;
+
+	/* The fifth event enters the second state */
+	CHECK_EQUAL(-1, hsm_handleEvents(&me, events, 8U, &doneNum));
+	CHECK_EQUAL(4, doneNum);
+	POINTERS_EQUAL(&batchSecond, me.itsCurrentState);
+
+	/* Resumes from the failed event */
+	failEntry = false;
+	CHECK_EQUAL(0, hsm_handleEvents(&me, &events[4], 4U, NULL));
+	POINTERS_EQUAL(&batchFirst, me.itsCurrentState);
+}
@@ -0,0 +1,467 @@
+#include "CppUTest/TestHarness.h"
+#include "hsm.hpp"
+#include "hsm_snapshot.h"
+
+#include <string.h>
+
+/*
+digraph G {
+	graph [fontsize=10 fontname="Verdana" compound=true rankdir=LR];
+	node [shape=record fontsize=10 fontname="Verdana"];
+
+	subgraph cluster_conn {
+		label = "conn (deep)";
+
+		subgraph cluster_link {
+			label = "link (shallow)";
+			"linkDown" -> "linkUp" [ label = "NEXT" ];
+		}
+
+		subgraph cluster_ready {
+			label = "ready (none)";
+			"readyIdle" -> "readyBusy" [ label = "NEXT" ];
+		}
+	}
+
+	"off" -> "conn" [ label = "ON" ];
+	"conn" -> "off" [ label = "OFF" ];
+	"link" -> "ready" [ label = "GO" ];
+	"ready" -> "link" [ label = "BACK" ];
+}
+*/
+
+enum
+{
+	EV_START = 1U,
+	EV_ON,
+	EV_OFF,
+	EV_NEXT,
+	EV_GO,
+	EV_BACK,
+	EV_NUM
+};
+
+static char trace[256];
+
+static bool onEntry(const state_t* me, const hsm_event_t* event)
+{
+	(void)event;
+	strcat(trace, me->itsName);
+	strcat(trace, ".entry ");
+	return true;
+}
+
+extern state_t histOff;
+extern state_t histConn;
+extern state_t histLink;
+extern state_t histLinkDown;
+extern state_t histLinkUp;
+extern state_t histReady;
+extern state_t histReadyIdle;
+extern state_t histReadyBusy;
+
+state_t histOff = {
+    .itsInitialState = NULL,
+    .itsParentState  = NULL,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition = (hsm_transition_t[]){{NULL, NULL, &histConn, EV_ON}},
+    .itsTransitionNum = 1,
+    .itsName          = "off"};
+
+state_t histConn = {
+    .itsInitialState = &histLink,
+    .itsParentState  = NULL,
+    .onEntry         = onEntry,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition = (hsm_transition_t[]){{NULL, NULL, &histOff, EV_OFF}},
+    .itsTransitionNum = 1,
+    .itsHistory       = HSM_HISTORY_DEEP,
+    .itsName          = "conn"};
+
+state_t histLink = {
+    .itsInitialState = &histLinkDown,
+    .itsParentState  = &histConn,
+    .onEntry         = onEntry,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, NULL, &histReady, EV_GO}},
+    .itsTransitionNum = 1,
+    .itsHistory       = HSM_HISTORY_SHALLOW,
+    .itsName          = "link"};
+
+state_t histLinkDown = {
+    .itsInitialState = NULL,
+    .itsParentState  = &histLink,
+    .onEntry         = onEntry,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, NULL, &histLinkUp, EV_NEXT}},
+    .itsTransitionNum = 1,
+    .itsName          = "linkDown"};
+
+state_t histLinkUp = {.itsInitialState  = NULL,
+                      .itsParentState   = &histLink,
+                      .onEntry          = onEntry,
+                      .during           = NULL,
+                      .onExit           = NULL,
+                      .itsTransition    = NULL,
+                      .itsTransitionNum = 0,
+                      .itsName          = "linkUp"};
+
+state_t histReady = {
+    .itsInitialState = &histReadyIdle,
+    .itsParentState  = &histConn,
+    .onEntry         = onEntry,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, NULL, &histLink, EV_BACK}},
+    .itsTransitionNum = 1,
+    .itsHistory       = HSM_HISTORY_NONE,
+    .itsName          = "ready"};
+
+state_t histReadyIdle = {
+    .itsInitialState = NULL,
+    .itsParentState  = &histReady,
+    .onEntry         = onEntry,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, NULL, &histReadyBusy, EV_NEXT}},
+    .itsTransitionNum = 1,
+    .itsName          = "readyIdle"};
+
+state_t histReadyBusy = {.itsInitialState  = NULL,
+                         .itsParentState   = &histReady,
+                         .onEntry          = onEntry,
+                         .during           = NULL,
+                         .onExit           = NULL,
+                         .itsTransition    = NULL,
+                         .itsTransitionNum = 0,
+                         .itsName          = "readyBusy"};
+
+static state_t* stateList[] = {&histOff,
+                               &histConn,
+                               &histLink,
+                               &histLinkDown,
+                               &histLinkUp,
+                               &histReady,
+                               &histReadyIdle,
+                               &histReadyBusy};
+
+/* The same chart, generated at compile time */
+template <typename Parent, typename Initial = void>
+struct traced : hsm::state<Parent, Initial>
+{
+	static bool onEntry(const state_t* me, const hsm_event_t* event)
+	{
+		return ::onEntry(me, event);
+	}
+};
+
+struct genOff;
+struct genConn;
+struct genLink;
+struct genLinkDown;
+struct genLinkUp;
+struct genReady;
+struct genReadyIdle;
+struct genReadyBusy;
+
+struct genOff : hsm::state<>
+{
+	static constexpr const char* name = "off";
+
+	using transitions = hsm::list<hsm::transition<EV_ON, genConn>>;
+};
+
+struct genConn : traced<void, genLink>
+{
+	static constexpr hsm_history_t history = HSM_HISTORY_DEEP;
+	static constexpr const char*   name    = "conn";
+
+	using transitions = hsm::list<hsm::transition<EV_OFF, genOff>>;
+};
+
+struct genLink : traced<genConn, genLinkDown>
+{
+	static constexpr const char* name = "link";
+
+	using transitions = hsm::list<hsm::transition<EV_GO, genReady>>;
+};
+
+struct genLinkDown : traced<genLink>
+{
+	static constexpr const char* name = "linkDown";
+
+	using transitions = hsm::list<hsm::transition<EV_NEXT, genLinkUp>>;
+};
+
+struct genLinkUp : traced<genLink>
+{
+	static constexpr const char* name = "linkUp";
+};
+
+struct genReady : traced<genConn, genReadyIdle>
+{
+	static constexpr hsm_history_t history = HSM_HISTORY_NONE;
+	static constexpr const char*   name    = "ready";
+
+	using transitions = hsm::list<hsm::transition<EV_BACK, genLink>>;
+};
+
+struct genReadyIdle : traced<genReady>
+{
+	static constexpr const char* name = "readyIdle";
+
+	using transitions =
+	    hsm::list<hsm::transition<EV_NEXT, genReadyBusy>>;
+};
+
+struct genReadyBusy : traced<genReady>
+{
+	static constexpr const char* name = "readyBusy";
+};
+
+typedef hsm::machine<EV_NUM,
+                     genOff,
+                     genOff,
+                     genConn,
+                     genLink,
+                     genLinkDown,
+                     genLinkUp,
+                     genReady,
+                     genReadyIdle,
+                     genReadyBusy>
+    machine_t;
+
+TEST_GROUP(hsm_history)
+{
+	hsm_t          me;
+	hsm_def_t      def;
+	hsm_inst_t     inst;
+	hsm_state_id_t history[2];
+
+	hsm::instance<machine_t> sys;
+
+	void setup()
+	{
+		me = hsm_build(&histOff, stateList);
+		CHECK_EQUAL(0, hsm_def_build(&def, &histOff, stateList));
+		CHECK_EQUAL(0, hsm_inst_init(&inst, &def, history));
+		CHECK_EQUAL(0, sys.reset());
+		trace[0] = '\0';
+	}
+
+	void teardown()
+	{
+		hsm_def_destroy(&def);
+	}
+
+	/* The same events to all three, with the same trace from each */
+	void dispatch(const uint32_t eventType, const char* const expected)
+	{
+		hsm_event_t event = {eventType, NULL};
+
+		trace[0] = '\0';
+		CHECK(hsm_dispatch(&me, &event) >= 0);
+		STRCMP_EQUAL(expected, trace);
+
+		trace[0] = '\0';
+		CHECK(hsm_inst_dispatch(&inst, &event) >= 0);
+		STRCMP_EQUAL(expected, trace);
+
+		trace[0] = '\0';
+		CHECK(sys.dispatch(&event) >= 0);
+		STRCMP_EQUAL(expected, trace);
+	}
+
+	void checkState(const state_t* const state)
+	{
+		POINTERS_EQUAL(state, me.itsCurrentState);
+		POINTERS_EQUAL(state, hsm_inst_getState(&inst));
+		STRCMP_EQUAL(state->itsName, sys.getState()->itsName);
+	}
+};
+
+TEST(hsm_history, Should_GiveSlots_When_ShallowOrDeep)
+{
+	const hsm_def_t& generated = machine_t::def;
+
+	LONGS_EQUAL(2, def.itsHistoryNum);
+	LONGS_EQUAL(2, generated.itsHistoryNum);
+
+	for (uint32_t i = 0U; i < def.itsStateNum; i++)
+	{
+		LONGS_EQUAL(def.itsHistorySlot[i],
+		            generated.itsHistorySlot[i]);
+		LONGS_EQUAL(def.itsActions[i], generated.itsActions[i]);
+	}
+
+	LONGS_EQUAL(HSM_STATE_ID_NONE,
+	            def.itsHistorySlot[hsm_def_getId(&def, &histReady)]);
+	CHECK((def.itsActions[hsm_def_getId(&def, &histConn)] &
+	       HSM_DEF_HISTORY_DEEP) != 0U);
+}
+
+TEST(hsm_history, Should_ResumeLeaf_When_DeepReentered)
+{
+	dispatch(EV_START, "");
+	dispatch(EV_ON, "conn.entry link.entry linkDown.entry ");
+	dispatch(EV_NEXT, "linkUp.entry ");
+	dispatch(EV_OFF, "");
+
+	/* Kept as a leaf, not a child */
+	POINTERS_EQUAL(&histLinkUp, histConn.itsHistoryState);
+
+	dispatch(EV_ON, "conn.entry link.entry linkUp.entry ");
+	checkState(&histLinkUp);
+}
+
+TEST(hsm_history, Should_ResumeChild_When_ShallowReentered)
+{
+	dispatch(EV_START, "");
+	dispatch(EV_ON, "conn.entry link.entry linkDown.entry ");
+	dispatch(EV_NEXT, "linkUp.entry ");
+	dispatch(EV_GO, "ready.entry readyIdle.entry ");
+	dispatch(EV_BACK, "link.entry linkUp.entry ");
+	checkState(&histLinkUp);
+}
+
+TEST(hsm_history, Should_EnterInitial_When_NoHistory)
+{
+	dispatch(EV_START, "");
+	dispatch(EV_ON, "conn.entry link.entry linkDown.entry ");
+	dispatch(EV_GO, "ready.entry readyIdle.entry ");
+	dispatch(EV_NEXT, "readyBusy.entry ");
+	dispatch(EV_BACK, "link.entry linkDown.entry ");
+	dispatch(EV_GO, "ready.entry readyIdle.entry ");
+	checkState(&histReadyIdle);
+}
+
+TEST(hsm_history, Should_RestoreWholeConfiguration_When_DeepAboveNone)
+{
+	dispatch(EV_START, "");
+	dispatch(EV_ON, "conn.entry link.entry linkDown.entry ");
+	dispatch(EV_GO, "ready.entry readyIdle.entry ");
+	dispatch(EV_NEXT, "readyBusy.entry ");
+	dispatch(EV_OFF, "");
+
+	/* The deep history wins over the one below it */
+	dispatch(EV_ON, "conn.entry ready.entry readyBusy.entry ");
+	checkState(&histReadyBusy);
+}
+
+TEST(hsm_history, Should_ForgetHistory_When_Reset)
+{
+	dispatch(EV_START, "");
+	dispatch(EV_ON, "conn.entry link.entry linkDown.entry ");
+	dispatch(EV_NEXT, "linkUp.entry ");
+	dispatch(EV_OFF, "");
+
+	CHECK_EQUAL(0, hsm_reset(&me));
+	CHECK_EQUAL(0, hsm_inst_reset(&inst));
+	CHECK_EQUAL(0, sys.reset());
+
+	dispatch(EV_START, "");
+	dispatch(EV_ON, "conn.entry link.entry linkDown.entry ");
+}
+
+TEST(hsm_history, Should_RestoreDeepLeaf_When_FromSnapshot)
+{
+	uint8_t           blob[64];
+	const hsm_event_t on = {EV_ON, NULL};
+
+	CHECK(hsm_snapshot_getSize(&me) <= sizeof(blob));
+
+	dispatch(EV_START, "");
+	dispatch(EV_ON, "conn.entry link.entry linkDown.entry ");
+	dispatch(EV_NEXT, "linkUp.entry ");
+	dispatch(EV_OFF, "");
+	CHECK_EQUAL(0, hsm_snapshot(&me, blob, sizeof(blob)));
+
+	CHECK_EQUAL(0, hsm_reset(&me));
+	CHECK_EQUAL(0,
+	            hsm_restore(&me, blob, hsm_snapshot_getSize(&me)));
+
+	trace[0] = '\0';
+	CHECK_EQUAL(0, hsm_dispatch(&me, &on));
+	STRCMP_EQUAL("conn.entry link.entry linkUp.entry ", trace);
+}
+
+/*
+ * The micro steps, on a chart whose parent does not remember
+ */
+
+extern state_t stepTopA;
+extern state_t stepSubA1;
+extern state_t stepSubA2;
+extern state_t stepTopB;
+extern state_t stepSubB1;
+
+state_t stepTopA = {.itsInitialState  = &stepSubA1,
+                    .itsParentState   = NULL,
+                    .onEntry          = NULL,
+                    .during           = NULL,
+                    .onExit           = NULL,
+                    .itsTransition    = NULL,
+                    .itsTransitionNum = 0,
+                    .itsHistory       = HSM_HISTORY_NONE};
+
+state_t stepSubA1 = {
+    .itsInitialState  = NULL,
+    .itsParentState   = &stepTopA,
+    .onEntry          = NULL,
+    .during           = NULL,
+    .onExit           = NULL,
+    .itsTransition    = (hsm_transition_t[]){{NULL, NULL, &stepSubA2, 0U}},
+    .itsTransitionNum = 1};
+
+state_t stepSubA2 = {
+    .itsInitialState  = NULL,
+    .itsParentState   = &stepTopA,
+    .onEntry          = NULL,
+    .during           = NULL,
+    .onExit           = NULL,
+    .itsTransition    = (hsm_transition_t[]){{NULL, NULL, &stepSubB1, 0U}},
+    .itsTransitionNum = 1};
+
+state_t stepTopB = {.itsInitialState  = &stepSubB1,
+                    .itsParentState   = NULL,
+                    .onEntry          = NULL,
+                    .during           = NULL,
+                    .onExit           = NULL,
+                    .itsTransition    = NULL,
+                    .itsTransitionNum = 0};
+
+state_t stepSubB1 = {
+    .itsInitialState  = NULL,
+    .itsParentState   = &stepTopB,
+    .onEntry          = NULL,
+    .during           = NULL,
+    .onExit           = NULL,
+    .itsTransition    = (hsm_transition_t[]){{NULL, NULL, &stepSubA1, 0U}},
+    .itsTransitionNum = 1};
+
+static state_t* stepList[] = {
+    &stepTopA, &stepSubA1, &stepSubA2, &stepTopB, &stepSubB1};
+
+TEST(hsm_history, Should_StepIntoActiveChild_When_NotRemembered)
+{
+	hsm_t step = hsm_build(&stepTopA, stepList);
+
+	/* Enter, then subA1 to subA2, then back down from topA */
+	for (uint32_t i = 0U; i < 9U; i++)
+	{
+		CHECK_EQUAL(1, hsm_handleEvent(&step, NULL));
+	}
+
+	POINTERS_EQUAL(&stepSubA2, step.itsCurrentState);
+	LONGS_EQUAL(HSM_ST_M_DURING, stepSubA2.itsMode);
+	POINTERS_EQUAL(&stepSubA1, stepTopA.itsHistoryState);
+}
@@ -0,0 +1,206 @@
+#include "CppUTest/TestHarness.h"
+#include "hsm_def.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+digraph G {
+	graph [fontsize=10 fontname="Verdana" compound=true rankdir=LR];
+	node [shape=record fontsize=10 fontname="Verdana"];
+
+	subgraph cluster_0 {
+		label = "topA";
+		"cluster0_dummy" [ label = "", style = invis ];
+		"cluster0_dummy" -> "subA1"
+		"subA1" -> "subA2"
+	}
+
+	subgraph cluster_1 {
+		label = "topB";
+		"cluster1_dummy" [ label = "", style = invis ];
+		"cluster1_dummy" -> "subB1"
+	}
+
+	"subA2" -> "subB1";
+	"subB1" -> "subA1";
+}
+*/
+
+static char trace[256];
+
+static bool onEntry(const state_t* me, const hsm_event_t* event)
+{
+	(void)event;
+	strcat(trace, me->itsName);
+	strcat(trace, ".entry ");
+	return true;
+}
+
+static bool onExit(const state_t* me, const hsm_event_t* event)
+{
+	(void)event;
+	strcat(trace, me->itsName);
+	strcat(trace, ".exit ");
+	return true;
+}
+
+extern state_t instTopA;
+extern state_t instSubA1;
+extern state_t instSubA2;
+extern state_t instTopB;
+extern state_t instSubB1;
+
+state_t instTopA = {.itsInitialState  = &instSubA1,
+                    .itsParentState   = NULL,
+                    .onEntry          = onEntry,
+                    .during           = NULL,
+                    .onExit           = onExit,
+                    .itsTransition    = NULL,
+                    .itsTransitionNum = 0,
+                    .itsName          = "topA"};
+
+state_t instSubA1 = {.itsInitialState = NULL,
+                     .itsParentState  = &instTopA,
+                     .onEntry         = onEntry,
+                     .during          = NULL,
+                     .onExit          = onExit,
+                     .itsTransition =
+                         (hsm_transition_t[]){{NULL, NULL, &instSubA2}},
+                     .itsTransitionNum = 1,
+                     .itsName          = "subA1"};
+
+state_t instSubA2 = {.itsInitialState = NULL,
+                     .itsParentState  = &instTopA,
+                     .onEntry         = onEntry,
+                     .during          = NULL,
+                     .onExit          = onExit,
+                     .itsTransition =
+                         (hsm_transition_t[]){{NULL, NULL, &instSubB1}},
+                     .itsTransitionNum = 1,
+                     .itsName          = "subA2"};
+
+state_t instTopB = {.itsInitialState  = &instSubB1,
+                    .itsParentState   = NULL,
+                    .onEntry          = onEntry,
+                    .during           = NULL,
+                    .onExit           = onExit,
+                    .itsTransition    = NULL,
+                    .itsTransitionNum = 0,
+                    .itsName          = "topB"};
+
+state_t instSubB1 = {.itsInitialState = NULL,
+                     .itsParentState  = &instTopB,
+                     .onEntry         = onEntry,
+                     .during          = NULL,
+                     .onExit          = onExit,
+                     .itsTransition =
+                         (hsm_transition_t[]){{NULL, NULL, &instSubA1}},
+                     .itsTransitionNum = 1,
+                     .itsName          = "subB1"};
+
+static state_t* stateList[] = {&instTopA,
+                               &instSubA1,
+                               &instSubA2,
+                               &instTopB,
+                               &instSubB1};
+
+static state_t* missingStateList[] = {&instTopA, &instSubA1, &instSubA2};
+
+TEST_GROUP(hsm_inst_dispatch)
+{
+	hsm_def_t      def;
+	hsm_inst_t     first;
+	hsm_inst_t     second;
+	hsm_state_id_t firstHistory[2];
+	hsm_state_id_t secondHistory[2];
+	hsm_event_t    event;
+
+	void setup()
+	{
+		/* Build the shared definition */
+		CHECK_EQUAL(0, hsm_def_build(&def, &instTopA, stateList));
+		LONGS_EQUAL(2, def.itsHistoryNum);
+
+		/* Two instances on it */
+		CHECK_EQUAL(0, hsm_inst_init(&first, &def, firstHistory));
+		CHECK_EQUAL(0, hsm_inst_init(&second, &def, secondHistory));
+
+		trace[0]        = '\0';
+		event.eventType = 0U;
+		event.data      = NULL;
+	}
+
+	void teardown()
+	{
+		hsm_def_destroy(&def);
+	}
+};
+
+TEST(hsm_inst_dispatch, Should_FailToBuild_When_InitialStateIsNotTop)
+{
+	hsm_def_t aux;
+
+	CHECK_EQUAL(-1, hsm_def_build(&aux, &instSubA1, stateList));
+}
+
+TEST(hsm_inst_dispatch, Should_FailToBuild_When_TargetStateIsMissing)
+{
+	hsm_def_t aux;
+
+	CHECK_EQUAL(-1, hsm_def_build(&aux, &instTopA, missingStateList));
+}
+
+TEST(hsm_inst_dispatch, Should_GiveError_When_InvalidHandle)
+{
+	CHECK_EQUAL(-1, hsm_inst_dispatch(NULL, &event));
+}
+
+TEST(hsm_inst_dispatch, Should_Know_When_NoEventProvided)
+{
+	CHECK_EQUAL(1, hsm_inst_dispatch(&first, NULL));
+}
+
+TEST(hsm_inst_dispatch, Should_RunInstancesIndependently_When_SharingDef)
+{
+	/* First instance goes to subB1 */
+	CHECK_EQUAL(0, hsm_inst_dispatch(&first, &event));
+	CHECK_EQUAL(0, hsm_inst_dispatch(&first, &event));
+	STRCMP_EQUAL("topA.entry subA1.entry subA1.exit subA2.entry "
+	             "subA2.exit topA.exit topB.entry subB1.entry ",
+	             trace);
+	POINTERS_EQUAL(&instSubB1, hsm_inst_getState(&first));
+
+	/* Second instance is untouched */
+	trace[0] = '\0';
+	LONGS_EQUAL(HSM_ST_M_ON_ENTRY, second.itsMode);
+	CHECK_EQUAL(0, hsm_inst_dispatch(&second, &event));
+	STRCMP_EQUAL("topA.entry subA1.entry subA1.exit subA2.entry ", trace);
+	POINTERS_EQUAL(&instSubA2, hsm_inst_getState(&second));
+	POINTERS_EQUAL(&instSubB1, hsm_inst_getState(&first));
+
+	/* The shared states were not written */
+	LONGS_EQUAL(HSM_ST_M_ON_ENTRY, instTopA.itsMode);
+	LONGS_EQUAL(HSM_ST_M_ON_ENTRY, instTopB.itsMode);
+}
+
+TEST(hsm_inst_dispatch, Should_KeepHistoryPerInstance_When_ReEntering)
+{
+	/* subA1 -> subA2 -> subB1 -> subA1 */
+	CHECK_EQUAL(0, hsm_inst_dispatch(&first, &event));
+	CHECK_EQUAL(0, hsm_inst_dispatch(&first, &event));
+	CHECK_EQUAL(0, hsm_inst_dispatch(&first, &event));
+	POINTERS_EQUAL(&instSubA1, hsm_inst_getState(&first));
+
+	/* Histories */
+	const hsm_state_id_t topA = hsm_def_getId(&def, &instTopA);
+	LONGS_EQUAL(hsm_def_getId(&def, &instSubA1),
+	            firstHistory[def.itsHistorySlot[topA]]);
+	LONGS_EQUAL(hsm_def_getId(&def, &instSubA1),
+	            secondHistory[def.itsHistorySlot[topA]]);
+
+	/* Reset */
+	CHECK_EQUAL(0, hsm_inst_reset(&first));
+	POINTERS_EQUAL(&instTopA, hsm_inst_getState(&first));
+	LONGS_EQUAL(HSM_ST_M_ON_ENTRY, first.itsMode);
+}
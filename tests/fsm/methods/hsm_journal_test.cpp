@@ -0,0 +1,330 @@
+#include "CppUTest/TestHarness.h"
+#include "hsm_journal.h"
+#include "hsm_snapshot.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+digraph G {
+	graph [fontsize=10 fontname="Verdana" compound=true rankdir=LR];
+	node [shape=record fontsize=10 fontname="Verdana"];
+
+	subgraph cluster_top {
+		label = "top";
+
+		subgraph cluster_a {
+			label = "a";
+			"a1";
+			"a2";
+		}
+
+		"b";
+		"broken";
+	}
+
+	"a1" -> "a2" [ label = "NEXT" ];
+	"a" -> "b" [ label = "LEAVE" ];
+	"b" -> "a" [ label = "BACK" ];
+	"b" -> "broken" [ label = "BREAK" ];
+}
+*/
+
+enum
+{
+	EV_START = 1U,
+	EV_NEXT,
+	EV_LEAVE,
+	EV_BACK,
+	EV_BREAK
+};
+
+/* Records the buffer takes before it is written */
+#define RECORD_NUM (4U)
+
+extern state_t journalTop;
+extern state_t journalA;
+extern state_t journalA1;
+extern state_t journalA2;
+extern state_t journalB;
+extern state_t journalBroken;
+
+/* If broken can not be entered */
+static bool brokenFails;
+
+static bool brokenEntry(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	(void)event;
+	return !brokenFails;
+}
+
+state_t journalTop = {.itsInitialState  = &journalA,
+                      .itsParentState   = NULL,
+                      .onEntry          = NULL,
+                      .during           = NULL,
+                      .onExit           = NULL,
+                      .itsTransition    = NULL,
+                      .itsTransitionNum = 0};
+
+state_t journalA = {
+    .itsInitialState = &journalA1,
+    .itsParentState  = &journalTop,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, NULL, &journalB, EV_LEAVE}},
+    .itsTransitionNum = 1};
+
+state_t journalA1 = {
+    .itsInitialState = NULL,
+    .itsParentState  = &journalA,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, NULL, &journalA2, EV_NEXT}},
+    .itsTransitionNum = 1};
+
+state_t journalA2 = {.itsInitialState  = NULL,
+                     .itsParentState   = &journalA,
+                     .onEntry          = NULL,
+                     .during           = NULL,
+                     .onExit           = NULL,
+                     .itsTransition    = NULL,
+                     .itsTransitionNum = 0};
+
+state_t journalB = {
+    .itsInitialState = NULL,
+    .itsParentState  = &journalTop,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, NULL, &journalA, EV_BACK},
+                             {NULL, NULL, &journalBroken, EV_BREAK}},
+    .itsTransitionNum = 2};
+
+state_t journalBroken = {.itsInitialState  = NULL,
+                         .itsParentState   = &journalTop,
+                         .onEntry          = brokenEntry,
+                         .during           = NULL,
+                         .onExit           = NULL,
+                         .itsTransition    = NULL,
+                         .itsTransitionNum = 0};
+
+static state_t* stateList[] = {&journalTop,
+                               &journalA,
+                               &journalA1,
+                               &journalA2,
+                               &journalB,
+                               &journalBroken};
+
+TEST_GROUP(hsm_journal)
+{
+	hsm_t                me;
+	hsm_journal_t        journal;
+	uint8_t              buffer[RECORD_NUM * sizeof(hsm_journal_record_t)];
+	hsm_journal_record_t records[RECORD_NUM];
+	uint8_t              blob[64];
+	char                 path[32];
+
+	void setup()
+	{
+		me          = hsm_build(&journalTop, stateList);
+		brokenFails = true;
+
+		snprintf(path, sizeof(path), "/tmp/hsm_journal_XXXXXX");
+		const int file = mkstemp(path);
+		CHECK(file >= 0);
+		close(file);
+
+		/* The snapshot the replays start from */
+		CHECK_EQUAL(0, hsm_snapshot(&me, blob, sizeof(blob)));
+		CHECK_EQUAL(0,
+		            hsm_journal_open(&journal,
+		                             path,
+		                             buffer,
+		                             sizeof(buffer)));
+		hsm_journal_attach(&me, &journal);
+	}
+
+	void teardown()
+	{
+		hsm_journal_attach(&me, NULL);
+		(void)hsm_journal_close(&journal);
+		unlink(path);
+	}
+
+	int dispatch(const uint32_t eventType)
+	{
+		hsm_event_t event = {eventType, NULL};
+		return hsm_dispatch(&me, &event);
+	}
+
+	long getFileSize()
+	{
+		struct stat status;
+		CHECK_EQUAL(0, stat(path, &status));
+		return (long)status.st_size;
+	}
+
+	void restore()
+	{
+		CHECK_EQUAL(0, hsm_journal_close(&journal));
+		hsm_journal_attach(&me, NULL);
+		CHECK_EQUAL(0, hsm_reset(&me));
+		CHECK_EQUAL(0,
+		            hsm_restore(&me, blob, hsm_snapshot_getSize(&me)));
+	}
+
+	int replay(uint64_t* const doneNum)
+	{
+		return hsm_journal_replay(&me,
+		                          path,
+		                          records,
+		                          RECORD_NUM,
+		                          doneNum);
+	}
+};
+
+TEST(hsm_journal, Should_GiveError_When_InvalidInput)
+{
+	uint64_t doneNum = 1U;
+
+	const size_t size = sizeof(buffer);
+
+	CHECK_EQUAL(-1, hsm_journal_open(NULL, path, buffer, size));
+	CHECK_EQUAL(-1, hsm_journal_open(&journal, NULL, buffer, size));
+	CHECK_EQUAL(-1, hsm_journal_open(&journal, path, NULL, size));
+	CHECK_EQUAL(-1, hsm_journal_open(&journal, path, buffer, 1U));
+	CHECK_EQUAL(-1, hsm_journal_flush(NULL));
+	CHECK_EQUAL(0U, hsm_journal_getRecordNum(NULL));
+
+	CHECK_EQUAL(-1,
+	            hsm_journal_replay(NULL, path, records, RECORD_NUM, NULL));
+	CHECK_EQUAL(-1,
+	            hsm_journal_replay(&me, NULL, records, RECORD_NUM, NULL));
+	CHECK_EQUAL(-1, hsm_journal_replay(&me, path, NULL, RECORD_NUM, NULL));
+	CHECK_EQUAL(-1, hsm_journal_replay(&me, path, records, 0U, NULL));
+
+	/* Nothing written yet, not even the header */
+	CHECK_EQUAL(-1, replay(&doneNum));
+	CHECK_EQUAL(0U, doneNum);
+}
+
+TEST(hsm_journal, Should_WriteWholeBuffers_When_Recording)
+{
+	CHECK_EQUAL(0, dispatch(EV_START));
+	CHECK_EQUAL(0, dispatch(EV_NEXT));
+	CHECK_EQUAL(2U, hsm_journal_getRecordNum(&journal));
+
+	/* Collected in the buffer */
+	CHECK_EQUAL(0, getFileSize());
+
+	/* The buffer holds the header and 3 records */
+	CHECK_EQUAL(0, dispatch(EV_LEAVE));
+	CHECK_EQUAL(0, dispatch(EV_BACK));
+	CHECK(getFileSize() > 0);
+
+	CHECK_EQUAL(0, hsm_journal_flush(&journal));
+	CHECK_EQUAL(8 + (4 * (long)sizeof(hsm_journal_record_t)),
+	            getFileSize());
+}
+
+TEST(hsm_journal, Should_ReachSameStates_When_DispatchReplayed)
+{
+	uint64_t doneNum = 0U;
+
+	for (uint32_t i = 0U; i < 3U; i++)
+	{
+		CHECK_EQUAL(0, dispatch(EV_START));
+		CHECK_EQUAL(0, dispatch(EV_NEXT));
+		CHECK_EQUAL(0, dispatch(EV_LEAVE));
+		CHECK_EQUAL(0, dispatch(EV_BACK));
+	}
+	POINTERS_EQUAL(&journalA2, me.itsCurrentState);
+
+	restore();
+	POINTERS_EQUAL(&journalTop, me.itsCurrentState);
+
+	CHECK_EQUAL(0, replay(&doneNum));
+	CHECK_EQUAL(12U, doneNum);
+	POINTERS_EQUAL(&journalA2, me.itsCurrentState);
+}
+
+TEST(hsm_journal, Should_ReachSameStates_When_StepsReplayed)
+{
+	hsm_event_t event   = {EV_NEXT, NULL};
+	uint64_t    doneNum = 0U;
+
+	/* Enter the states and a1 to a2 */
+	for (uint32_t i = 0U; i < 8U; i++)
+	{
+		CHECK_EQUAL(0, hsm_handleEvent(&me, &event));
+	}
+	CHECK_EQUAL(1, hsm_handleEvent(&me, NULL));
+	const state_t* const state = me.itsCurrentState;
+	const hsm_st_mode_t  mode  = state->itsMode;
+
+	restore();
+
+	CHECK_EQUAL(0, replay(&doneNum));
+	CHECK_EQUAL(9U, doneNum);
+	POINTERS_EQUAL(state, me.itsCurrentState);
+	CHECK_EQUAL(mode, me.itsCurrentState->itsMode);
+}
+
+TEST(hsm_journal, Should_StopAtDivergence_When_NotFromSnapshot)
+{
+	uint64_t doneNum = 0U;
+
+	CHECK_EQUAL(0, dispatch(EV_START));
+	CHECK_EQUAL(0, dispatch(EV_NEXT));
+	CHECK_EQUAL(0, hsm_journal_close(&journal));
+	hsm_journal_attach(&me, NULL);
+
+	/* Replayed from b, where a1 and a2 are not reached */
+	CHECK_EQUAL(0, dispatch(EV_LEAVE));
+
+	CHECK_EQUAL(1, replay(&doneNum));
+	CHECK_EQUAL(0U, doneNum);
+}
+
+TEST(hsm_journal, Should_FailAgain_When_FailedEventReplayed)
+{
+	uint64_t doneNum = 0U;
+
+	CHECK_EQUAL(0, dispatch(EV_START));
+	CHECK_EQUAL(0, dispatch(EV_LEAVE));
+	CHECK_EQUAL(-1, dispatch(EV_BREAK));
+	CHECK_EQUAL(3U, hsm_journal_getRecordNum(&journal));
+	const state_t* const state = me.itsCurrentState;
+	const hsm_st_mode_t  mode  = state->itsMode;
+
+	restore();
+
+	CHECK_EQUAL(0, replay(&doneNum));
+	CHECK_EQUAL(3U, doneNum);
+	POINTERS_EQUAL(state, me.itsCurrentState);
+	CHECK_EQUAL(mode, me.itsCurrentState->itsMode);
+}
+
+TEST(hsm_journal, Should_StopAtDivergence_When_FailedEventHandled)
+{
+	uint64_t doneNum = 0U;
+
+	CHECK_EQUAL(0, dispatch(EV_START));
+	CHECK_EQUAL(0, dispatch(EV_LEAVE));
+	CHECK_EQUAL(-1, dispatch(EV_BREAK));
+
+	restore();
+
+	/* It does not fail this time */
+	brokenFails = false;
+	CHECK_EQUAL(1, replay(&doneNum));
+	CHECK_EQUAL(2U, doneNum);
+}
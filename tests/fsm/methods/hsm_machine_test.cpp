@@ -0,0 +1,261 @@
+#include "CppUTest/TestHarness.h"
+#include "hsm.hpp"
+
+#include <string.h>
+
+/*
+digraph G {
+	graph [fontsize=10 fontname="Verdana" compound=true rankdir=LR];
+	node [shape=record fontsize=10 fontname="Verdana"];
+
+	subgraph cluster_root {
+		label = "root";
+
+		subgraph cluster_on {
+			label = "on";
+			"idle" -> "running" [ label = "START" ];
+			"running" -> "running" [ label = "TICK / count" ];
+		}
+
+		"off";
+	}
+
+	"on" -> "off" [ label = "OFF" ];
+	"off" -> "on" [ label = "ON" ];
+}
+*/
+
+enum
+{
+	EV_NONE = HSM_EVENT_ANY,
+	EV_START,
+	EV_TICK,
+	EV_OFF,
+	EV_ON,
+	EV_NUM
+};
+
+static char     trace[256];
+static uint32_t tickCount;
+
+static bool onEntry(const state_t* me, const hsm_event_t* event)
+{
+	(void)event;
+	strcat(trace, me->itsName);
+	strcat(trace, ".entry ");
+	return true;
+}
+
+static bool onExit(const state_t* me, const hsm_event_t* event)
+{
+	(void)event;
+	strcat(trace, me->itsName);
+	strcat(trace, ".exit ");
+	return true;
+}
+
+static void countTick(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	(void)event;
+	tickCount++;
+}
+
+struct machineRoot;
+struct machineOn;
+struct machineIdle;
+struct machineRunning;
+struct machineOff;
+
+struct machineRoot : hsm::state<void, machineOn>
+{
+	static constexpr const char* name = "root";
+};
+
+struct machineOn : hsm::state<machineRoot, machineIdle>
+{
+	static constexpr const char* name = "on";
+
+	static bool onExit(const state_t* me, const hsm_event_t* event)
+	{
+		return ::onExit(me, event);
+	}
+
+	using transitions = hsm::list<hsm::transition<EV_OFF, machineOff>>;
+};
+
+struct machineIdle : hsm::state<machineOn>
+{
+	static constexpr const char* name = "idle";
+
+	static bool onEntry(const state_t* me, const hsm_event_t* event)
+	{
+		return ::onEntry(me, event);
+	}
+
+	using transitions =
+	    hsm::list<hsm::transition<EV_START, machineRunning>>;
+};
+
+struct machineRunning : hsm::state<machineOn>
+{
+	static constexpr const char* name = "running";
+
+	static bool onEntry(const state_t* me, const hsm_event_t* event)
+	{
+		return ::onEntry(me, event);
+	}
+
+	using transitions = hsm::list<
+	    hsm::transition<EV_TICK, void, nullptr, countTick>>;
+};
+
+struct machineOff : hsm::state<machineRoot>
+{
+	static constexpr const char* name = "off";
+
+	using transitions = hsm::list<hsm::transition<EV_ON, machineOn>>;
+};
+
+typedef hsm::machine<EV_NUM,
+                     machineRoot,
+                     machineRoot,
+                     machineOn,
+                     machineIdle,
+                     machineRunning,
+                     machineOff>
+    machine_t;
+
+TEST_GROUP(hsm_machine)
+{
+	hsm::instance<machine_t> sys;
+
+	void setup()
+	{
+		trace[0]  = '\0';
+		tickCount = 0U;
+		CHECK_EQUAL(0, sys.reset());
+	}
+
+	int dispatch(const uint32_t eventType)
+	{
+		hsm_event_t event = {eventType, NULL};
+
+		return sys.dispatch(&event);
+	}
+};
+
+TEST(hsm_machine, Should_GenerateSameTables_As_Build)
+{
+	hsm_def_t        def;
+	const hsm_def_t& generated = machine_t::def;
+
+	CHECK_EQUAL(0,
+	            _hsm_def_build(&def,
+	                           machine_t::stateOf<machineRoot>,
+	                           machine_t::stateList,
+	                           machine_t::stateNum));
+	CHECK_EQUAL(0, hsm_def_compile(&def, EV_NUM));
+
+	LONGS_EQUAL(def.itsStateNum, generated.itsStateNum);
+	LONGS_EQUAL(def.itsTransitionNum, generated.itsTransitionNum);
+	LONGS_EQUAL(def.itsHistoryNum, generated.itsHistoryNum);
+	LONGS_EQUAL(def.itsInitialState, generated.itsInitialState);
+
+	for (uint32_t i = 0U; i < def.itsStateNum; i++)
+	{
+		LONGS_EQUAL(def.itsParent[i], generated.itsParent[i]);
+		LONGS_EQUAL(def.itsInitial[i], generated.itsInitial[i]);
+		LONGS_EQUAL(def.itsHistorySlot[i],
+		            generated.itsHistorySlot[i]);
+		LONGS_EQUAL(def.itsActions[i], generated.itsActions[i]);
+	}
+
+	for (uint32_t i = 0U; i <= def.itsStateNum; i++)
+	{
+		LONGS_EQUAL(def.itsTransitionFirst[i],
+		            generated.itsTransitionFirst[i]);
+		LONGS_EQUAL(def.itsPathFirst[i], generated.itsPathFirst[i]);
+	}
+
+	for (uint32_t i = 0U; i < def.itsPathFirst[def.itsStateNum]; i++)
+	{
+		LONGS_EQUAL(def.itsPaths[i], generated.itsPaths[i]);
+	}
+
+	for (uint32_t i = 0U; i < def.itsTransitionNum; i++)
+	{
+		const hsm_def_transition_t* const a = &def.itsTransitions[i];
+		const hsm_def_transition_t* const b =
+		    &generated.itsTransitions[i];
+
+		POINTERS_EQUAL(a->itsTransition, b->itsTransition);
+		LONGS_EQUAL(a->itsSource, b->itsSource);
+		LONGS_EQUAL(a->itsTarget, b->itsTarget);
+		LONGS_EQUAL(a->itsLca, b->itsLca);
+		LONGS_EQUAL(a->itsLcaLevel, b->itsLcaLevel);
+		LONGS_EQUAL(a->itsEntryNum, b->itsEntryNum);
+		LONGS_EQUAL(a->itsEntryFirst, b->itsEntryFirst);
+
+		for (uint32_t j = 0U; j < a->itsEntryNum; j++)
+		{
+			const uint32_t k = a->itsEntryFirst + j;
+
+			LONGS_EQUAL(def.itsEntries[k],
+			            generated.itsEntries[k]);
+		}
+	}
+
+	const uint32_t cellNum = def.itsStateNum * EV_NUM;
+
+	for (uint32_t i = 0U; i <= cellNum; i++)
+	{
+		LONGS_EQUAL(def.itsTable[i], generated.itsTable[i]);
+	}
+
+	for (uint32_t i = 0U; i < def.itsTable[cellNum]; i++)
+	{
+		LONGS_EQUAL(def.itsCandidates[i], generated.itsCandidates[i]);
+	}
+
+	for (uint32_t i = 0U; i < cellNum; i++)
+	{
+		LONGS_EQUAL(def.itsActive[i], generated.itsActive[i]);
+	}
+
+	hsm_def_destroy(&def);
+}
+
+TEST(hsm_machine, Should_NotNeedBuild_When_Generated)
+{
+	POINTERS_EQUAL(NULL, machine_t::def.itsMemory);
+	POINTERS_EQUAL(NULL, machine_t::def.itsPathMemory);
+	POINTERS_EQUAL(NULL, machine_t::def.itsTableMemory);
+	LONGS_EQUAL(2, machine_t::historyNum);
+	LONGS_EQUAL(2, machine_t::id<machineIdle>);
+}
+
+TEST(hsm_machine, Should_Dispatch_When_Generated)
+{
+	CHECK_EQUAL(0, dispatch(EV_NONE));
+	STRCMP_EQUAL("idle.entry ", trace);
+	POINTERS_EQUAL(machine_t::stateOf<machineIdle>, sys.getState());
+
+	CHECK_EQUAL(0, dispatch(EV_START));
+	POINTERS_EQUAL(machine_t::stateOf<machineRunning>, sys.getState());
+
+	CHECK_EQUAL(0, dispatch(EV_TICK));
+	LONGS_EQUAL(1, tickCount);
+
+	/* Inherited by running from on */
+	trace[0] = '\0';
+	CHECK_EQUAL(0, dispatch(EV_OFF));
+	STRCMP_EQUAL("on.exit ", trace);
+	POINTERS_EQUAL(machine_t::stateOf<machineOff>, sys.getState());
+
+	/* Back to running through the history */
+	trace[0] = '\0';
+	CHECK_EQUAL(0, dispatch(EV_ON));
+	STRCMP_EQUAL("running.entry ", trace);
+	POINTERS_EQUAL(machine_t::stateOf<machineRunning>, sys.getState());
+}
@@ -0,0 +1,168 @@
+#include "CppUTest/TestHarness.h"
+#include "hsm_pool.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#define POOL_BLOCK_NUM (8U)
+#define WORKER_NUM     (4U)
+#define WORKER_ALLOCS  (10000U)
+
+static hsm_pool_t pool;
+static uint32_t   errorNum;
+
+static void* worker(void* arg)
+{
+	const uint32_t   id = (uint32_t)(uintptr_t)arg;
+	hsm_pool_cache_t cache;
+
+	hsm_pool_attach(&cache, &pool);
+
+	for (uint32_t i = 0U; i < WORKER_ALLOCS; i++)
+	{
+		uint32_t* data = (uint32_t*)hsm_pool_alloc(&pool);
+
+		while (data == NULL)
+		{
+			/* Empty, retry */
+			(void)sched_yield();
+			data = (uint32_t*)hsm_pool_alloc(&pool);
+		}
+
+		/* Nobody else owns it */
+		*data = id;
+		hsm_pool_retain(data);
+		hsm_pool_release(data);
+
+		if ((hsm_pool_getRefNum(data) != 1U) || (*data != id))
+		{
+			(void)__atomic_fetch_add(&errorNum,
+			                         1U,
+			                         __ATOMIC_RELAXED);
+		}
+
+		hsm_pool_release(data);
+	}
+
+	hsm_pool_attach(NULL, NULL);
+
+	return NULL;
+}
+
+TEST_GROUP(hsm_pool)
+{
+	void* blocks[POOL_BLOCK_NUM];
+
+	void setup()
+	{
+		CHECK_EQUAL(0, hsm_pool_init(&pool, 24U, POOL_BLOCK_NUM));
+	}
+
+	void teardown()
+	{
+		hsm_pool_attach(NULL, NULL);
+		hsm_pool_destroy(&pool);
+	}
+
+	void allocAll()
+	{
+		for (uint32_t i = 0U; i < POOL_BLOCK_NUM; i++)
+		{
+			blocks[i] = hsm_pool_alloc(&pool);
+			CHECK(blocks[i] != NULL);
+		}
+		POINTERS_EQUAL(NULL, hsm_pool_alloc(&pool));
+	}
+
+	void releaseAll()
+	{
+		for (uint32_t i = 0U; i < POOL_BLOCK_NUM; i++)
+		{
+			hsm_pool_release(blocks[i]);
+		}
+	}
+};
+
+TEST(hsm_pool, Should_GiveError_When_InvalidInput)
+{
+	CHECK_EQUAL(-1, hsm_pool_init(NULL, 24U, POOL_BLOCK_NUM));
+	CHECK_EQUAL(-1, hsm_pool_init(&pool, 0U, POOL_BLOCK_NUM));
+	CHECK_EQUAL(-1, hsm_pool_init(&pool, 24U, 0U));
+	POINTERS_EQUAL(NULL, hsm_pool_alloc(NULL));
+	CHECK_EQUAL(0, hsm_pool_getRefNum(NULL));
+}
+
+TEST(hsm_pool, Should_GiveAlignedBlocks_When_Allocated)
+{
+	allocAll();
+
+	for (uint32_t i = 0U; i < POOL_BLOCK_NUM; i++)
+	{
+		CHECK_EQUAL(0, (uintptr_t)blocks[i] % 16U);
+		CHECK_EQUAL(1, hsm_pool_getRefNum(blocks[i]));
+
+		/* No overlap */
+		for (uint32_t j = 0U; j < i; j++)
+		{
+			const intptr_t gap =
+			    (intptr_t)blocks[i] - (intptr_t)blocks[j];
+
+			CHECK((gap >= 24) || (gap <= -24));
+		}
+	}
+
+	releaseAll();
+}
+
+TEST(hsm_pool, Should_Recycle_When_LastOwnerReleases)
+{
+	allocAll();
+
+	hsm_pool_retain(blocks[0]);
+	hsm_pool_release(blocks[0]);
+	POINTERS_EQUAL(NULL, hsm_pool_alloc(&pool));
+
+	hsm_pool_release(blocks[0]);
+	POINTERS_EQUAL(blocks[0], hsm_pool_alloc(&pool));
+
+	releaseAll();
+}
+
+TEST(hsm_pool, Should_GiveBlocksBack_When_CacheDetached)
+{
+	hsm_pool_cache_t cache;
+
+	hsm_pool_attach(&cache, &pool);
+	allocAll();
+	releaseAll();
+
+	/* The cache holds them until detached */
+	CHECK_EQUAL(POOL_BLOCK_NUM, cache.itsNum);
+	hsm_pool_attach(NULL, NULL);
+
+	allocAll();
+	releaseAll();
+}
+
+TEST(hsm_pool, Should_LoseNoBlock_When_SharedByThreads)
+{
+	pthread_t threads[WORKER_NUM];
+
+	errorNum = 0U;
+
+	for (uintptr_t i = 0U; i < WORKER_NUM; i++)
+	{
+		CHECK_EQUAL(
+		    0,
+		    pthread_create(&threads[i], NULL, worker, (void*)i));
+	}
+
+	for (uint32_t i = 0U; i < WORKER_NUM; i++)
+	{
+		CHECK_EQUAL(0, pthread_join(threads[i], NULL));
+	}
+	CHECK_EQUAL(0, errorNum);
+
+	allocAll();
+	releaseAll();
+}
@@ -0,0 +1,205 @@
+#include "CppUTest/TestHarness.h"
+#include "hsm_queue.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+
+/*
+digraph G {
+	graph [fontsize=10 fontname="Verdana" compound=true rankdir=LR];
+	node [shape=record fontsize=10 fontname="Verdana"];
+
+	"counting" -> "counting" [ label = "COUNT / count" ];
+}
+*/
+
+enum
+{
+	EV_COUNT = 1U
+};
+
+#define QUEUE_CAPACITY (8U)
+#define PRODUCER_NUM   (4U)
+#define PRODUCER_POSTS (10000U)
+
+static uint32_t countSum;
+static uint32_t countNum;
+
+static void countAction(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	countSum += (uint32_t)(uintptr_t)event->data;
+	countNum++;
+}
+
+static state_t queueCounting = {
+    .itsInitialState  = NULL,
+    .itsParentState   = NULL,
+    .onEntry          = NULL,
+    .during           = NULL,
+    .onExit           = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, countAction, NULL, EV_COUNT}},
+    .itsTransitionNum = 1};
+
+static state_t* stateList[] = {&queueCounting};
+
+static hsm_queue_t queue;
+
+static void* producer(void* arg)
+{
+	(void)arg;
+
+	for (uintptr_t i = 1U; i <= PRODUCER_POSTS; i++)
+	{
+		hsm_event_t event = {EV_COUNT, (void*)i};
+
+		while (hsm_post(&queue, &event) == 1)
+		{
+			/* Full, retry */
+			(void)sched_yield();
+		}
+	}
+
+	return NULL;
+}
+
+TEST_GROUP(hsm_queue)
+{
+	hsm_def_t        def;
+	hsm_inst_t       inst;
+	hsm_queue_slot_t slots[QUEUE_CAPACITY];
+
+	void setup()
+	{
+		CHECK_EQUAL(0, hsm_def_build(&def, &queueCounting, stateList));
+		CHECK_EQUAL(0, hsm_inst_init(&inst, &def, NULL));
+		CHECK_EQUAL(
+		    0,
+		    hsm_queue_init(&queue, &inst, slots, QUEUE_CAPACITY));
+
+		countSum = 0U;
+		countNum = 0U;
+	}
+
+	void teardown()
+	{
+		hsm_def_destroy(&def);
+	}
+
+	int post(const uintptr_t value)
+	{
+		hsm_event_t event = {EV_COUNT, (void*)value};
+		return hsm_post(&queue, &event);
+	}
+};
+
+TEST(hsm_queue, Should_GiveError_When_InvalidInput)
+{
+	hsm_event_t event = {EV_COUNT, NULL};
+
+	CHECK_EQUAL(-1, hsm_queue_init(NULL, &inst, slots, QUEUE_CAPACITY));
+	CHECK_EQUAL(-1, hsm_queue_init(&queue, NULL, slots, QUEUE_CAPACITY));
+	CHECK_EQUAL(-1, hsm_queue_init(&queue, &inst, NULL, QUEUE_CAPACITY));
+	CHECK_EQUAL(-1, hsm_queue_init(&queue, &inst, slots, 0U));
+	CHECK_EQUAL(-1, hsm_queue_init(&queue, &inst, slots, 6U));
+	CHECK_EQUAL(-1, hsm_post(NULL, &event));
+	CHECK_EQUAL(-1, hsm_post(&queue, NULL));
+	CHECK_EQUAL(-1, hsm_run(NULL));
+}
+
+TEST(hsm_queue, Should_DispatchNothing_When_Empty)
+{
+	CHECK_EQUAL(0, hsm_run(&queue));
+	CHECK_EQUAL(0, countNum);
+}
+
+TEST(hsm_queue, Should_DispatchInOrder_When_Posted)
+{
+	CHECK_EQUAL(0, post(1U));
+	CHECK_EQUAL(0, post(2U));
+	CHECK_EQUAL(0, post(3U));
+	CHECK_EQUAL(0, countNum);
+
+	CHECK_EQUAL(3, hsm_run(&queue));
+	CHECK_EQUAL(3, countNum);
+	CHECK_EQUAL(6, countSum);
+}
+
+TEST(hsm_queue, Should_DropEvent_When_Full)
+{
+	for (uint32_t i = 0U; i < QUEUE_CAPACITY; i++)
+	{
+		CHECK_EQUAL(0, post(1U));
+	}
+	CHECK_EQUAL(1, post(100U));
+
+	CHECK_EQUAL(QUEUE_CAPACITY, hsm_run(&queue));
+	CHECK_EQUAL(QUEUE_CAPACITY, countSum);
+
+	/* Room again after running, across the wrap around */
+	for (uint32_t i = 0U; i < (QUEUE_CAPACITY + 3U); i++)
+	{
+		CHECK_EQUAL(0, post(1U));
+		CHECK_EQUAL(1, hsm_run(&queue));
+	}
+	CHECK_EQUAL((2U * QUEUE_CAPACITY) + 3U, countNum);
+}
+
+TEST(hsm_queue, Should_DispatchToMachine_When_InitMachine)
+{
+	hsm_t machine = hsm_build(&queueCounting, stateList);
+
+	CHECK_EQUAL(
+	    -1,
+	    hsm_queue_initMachine(NULL, &machine, slots, QUEUE_CAPACITY));
+	CHECK_EQUAL(
+	    -1,
+	    hsm_queue_initMachine(&queue, NULL, slots, QUEUE_CAPACITY));
+	CHECK_EQUAL(
+	    0,
+	    hsm_queue_initMachine(&queue, &machine, slots, QUEUE_CAPACITY));
+
+	CHECK_EQUAL(0, post(1U));
+	CHECK_EQUAL(0, post(2U));
+
+	CHECK_EQUAL(2, hsm_run(&queue));
+	CHECK_EQUAL(2, countNum);
+	CHECK_EQUAL(3, countSum);
+	POINTERS_EQUAL(&queueCounting, machine.itsCurrentState);
+}
+
+TEST(hsm_queue, Should_DispatchEveryEvent_When_ManyProducers)
+{
+	pthread_t threads[PRODUCER_NUM];
+	uint32_t  expectedNum = PRODUCER_NUM * PRODUCER_POSTS;
+
+	for (uint32_t i = 0U; i < PRODUCER_NUM; i++)
+	{
+		CHECK_EQUAL(0,
+		            pthread_create(&threads[i], NULL, producer, NULL));
+	}
+
+	while (countNum < expectedNum)
+	{
+		const int eventNum = hsm_run(&queue);
+
+		CHECK(eventNum >= 0);
+		if (eventNum == 0)
+		{
+			(void)sched_yield();
+		}
+	}
+
+	for (uint32_t i = 0U; i < PRODUCER_NUM; i++)
+	{
+		CHECK_EQUAL(0, pthread_join(threads[i], NULL));
+	}
+
+	CHECK_EQUAL(0, hsm_run(&queue));
+	CHECK_EQUAL(expectedNum, countNum);
+	CHECK_EQUAL(PRODUCER_NUM *
+	                ((PRODUCER_POSTS * (PRODUCER_POSTS + 1U)) / 2U),
+	            countSum);
+}
@@ -0,0 +1,410 @@
+#include "CppUTest/TestHarness.h"
+#include "hsm_region.h"
+#include "hsm_journal.h"
+#include "hsm_snapshot.h"
+#include "hsm_timer.h"
+
+/*
+digraph G {
+	graph [fontsize=10 fontname="Verdana" compound=true rankdir=LR];
+	node [shape=record fontsize=10 fontname="Verdana"];
+
+	subgraph cluster_ortho {
+		label = "ortho";
+
+		subgraph cluster_toggle {
+			label = "toggle";
+			"off";
+			"on";
+		}
+
+		subgraph cluster_counter {
+			label = "counter";
+			"counting";
+		}
+	}
+
+	"idle" -> "ortho" [ label = "GO" ];
+	"ortho" -> "idle" [ label = "STOP" ];
+	"off" -> "on" [ label = "FLIP" ];
+	"on" -> "off" [ label = "FLIP" ];
+	"counting" -> "counting" [ label = "FLIP / count" ];
+}
+*/
+
+enum
+{
+	EV_START = 1U,
+	EV_GO,
+	EV_STOP,
+	EV_FLIP
+};
+
+#define FLIP_NUM (1000U)
+
+static uint32_t toggleEntryNum;
+static uint32_t toggleExitNum;
+static uint32_t countNum;
+
+static bool toggleEntry(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	(void)event;
+	toggleEntryNum++;
+	return true;
+}
+
+static bool toggleExit(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	(void)event;
+	toggleExitNum++;
+	return true;
+}
+
+static void count(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	(void)event;
+	countNum++;
+}
+
+extern state_t regionIdle;
+extern state_t regionOrtho;
+extern state_t regionToggle;
+extern state_t regionOff;
+extern state_t regionOn;
+extern state_t regionCounting;
+
+state_t regionIdle = {
+    .itsInitialState = NULL,
+    .itsParentState  = NULL,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, NULL, &regionOrtho, EV_GO}},
+    .itsTransitionNum = 1};
+
+state_t regionOrtho = {
+    .itsInitialState = NULL,
+    .itsParentState  = NULL,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, NULL, &regionIdle, EV_STOP}},
+    .itsTransitionNum = 1};
+
+state_t regionToggle = {.itsInitialState  = &regionOff,
+                        .itsParentState   = NULL,
+                        .onEntry          = toggleEntry,
+                        .during           = NULL,
+                        .onExit           = toggleExit,
+                        .itsTransition    = NULL,
+                        .itsTransitionNum = 0};
+
+state_t regionOff = {
+    .itsInitialState = NULL,
+    .itsParentState  = &regionToggle,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, NULL, &regionOn, EV_FLIP}},
+    .itsTransitionNum = 1};
+
+state_t regionOn = {
+    .itsInitialState = NULL,
+    .itsParentState  = &regionToggle,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, NULL, &regionOff, EV_FLIP}},
+    .itsTransitionNum = 1};
+
+state_t regionCounting = {
+    .itsInitialState = NULL,
+    .itsParentState  = NULL,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition   = (hsm_transition_t[]){{NULL, count, NULL, EV_FLIP}},
+    .itsTransitionNum = 1};
+
+static state_t* stateList[]   = {&regionIdle, &regionOrtho};
+static state_t* toggleList[]  = {&regionToggle, &regionOff, &regionOn};
+static state_t* counterList[] = {&regionCounting};
+
+TEST_GROUP(hsm_region)
+{
+	hsm_t         me;
+	hsm_t         toggle;
+	hsm_t         counter;
+	hsm_region_t  regionList[2];
+	hsm_regions_t regions;
+	pthread_t     threads[2];
+
+	void setup()
+	{
+		me      = hsm_build(&regionIdle, stateList);
+		toggle  = hsm_build(&regionToggle, toggleList);
+		counter = hsm_build(&regionCounting, counterList);
+
+		toggleEntryNum = 0U;
+		toggleExitNum  = 0U;
+		countNum       = 0U;
+
+		regionList[0] = (hsm_region_t){&toggle, true};
+		regionList[1] = (hsm_region_t){&counter, true};
+		CHECK_EQUAL(0,
+		            hsm_regions_init(&regions,
+		                             &me,
+		                             &regionOrtho,
+		                             regionList,
+		                             2U));
+	}
+
+	void teardown()
+	{
+		hsm_regions_destroy(&regions);
+		POINTERS_EQUAL(NULL, me.itsRegions);
+	}
+
+	int dispatch(const uint32_t eventType)
+	{
+		hsm_event_t event = {eventType, NULL};
+		return hsm_dispatch(&me, &event);
+	}
+
+	void flip()
+	{
+		CHECK_EQUAL(0, dispatch(EV_START));
+		CHECK_EQUAL(0, dispatch(EV_GO));
+
+		for (uint32_t i = 0U; i < FLIP_NUM; i++)
+		{
+			CHECK(dispatch(EV_FLIP) >= 0);
+		}
+
+		POINTERS_EQUAL(&regionOrtho, me.itsCurrentState);
+		POINTERS_EQUAL(&regionOff, toggle.itsCurrentState);
+		CHECK_EQUAL(FLIP_NUM, countNum);
+	}
+};
+
+TEST(hsm_region, Should_GiveError_When_InvalidInput)
+{
+	hsm_regions_t other;
+
+	CHECK_EQUAL(-1,
+	            hsm_regions_init(NULL, &me, &regionOrtho, regionList, 2U));
+	CHECK_EQUAL(-1,
+	            hsm_regions_init(
+	                &other, NULL, &regionOrtho, regionList, 2U));
+	CHECK_EQUAL(-1, hsm_regions_init(&other, &me, NULL, regionList, 2U));
+	CHECK_EQUAL(-1,
+	            hsm_regions_init(&other, &me, &regionOrtho, NULL, 2U));
+	CHECK_EQUAL(-1,
+	            hsm_regions_init(
+	                &other, &me, &regionOrtho, regionList, 0U));
+
+	/* Not a leaf */
+	CHECK_EQUAL(-1,
+	            hsm_regions_init(
+	                &other, &toggle, &regionToggle, regionList, 2U));
+
+	CHECK_EQUAL(-1, hsm_regions_start(NULL, threads, 2U));
+	CHECK_EQUAL(-1, hsm_regions_start(&regions, NULL, 2U));
+	CHECK_EQUAL(-1, hsm_regions_start(&regions, threads, 0U));
+	CHECK_EQUAL(-1, hsm_regions_stop(NULL));
+	CHECK_FALSE(hsm_regions_isActive(NULL));
+	CHECK_EQUAL(-1, hsm_enter(NULL, NULL));
+	CHECK_EQUAL(-1, hsm_exit(NULL, NULL));
+}
+
+TEST(hsm_region, Should_EnterRegions_When_StateEntered)
+{
+	CHECK_EQUAL(0, dispatch(EV_START));
+	CHECK_FALSE(hsm_regions_isActive(&regions));
+	CHECK_EQUAL(0U, toggleEntryNum);
+
+	CHECK_EQUAL(0, dispatch(EV_GO));
+	CHECK(hsm_regions_isActive(&regions));
+	CHECK_EQUAL(1U, toggleEntryNum);
+	POINTERS_EQUAL(&regionOff, toggle.itsCurrentState);
+	LONGS_EQUAL(HSM_ST_M_DURING, regionOff.itsMode);
+	POINTERS_EQUAL(&regionCounting, counter.itsCurrentState);
+	LONGS_EQUAL(HSM_ST_M_DURING, regionCounting.itsMode);
+}
+
+TEST(hsm_region, Should_GiveEventToAllRegions_When_Dispatched)
+{
+	CHECK_EQUAL(0, dispatch(EV_START));
+
+	/* Not active yet */
+	CHECK(dispatch(EV_FLIP) >= 0);
+	CHECK_EQUAL(0U, countNum);
+
+	CHECK_EQUAL(0, dispatch(EV_GO));
+	CHECK(dispatch(EV_FLIP) >= 0);
+	POINTERS_EQUAL(&regionOn, toggle.itsCurrentState);
+	CHECK_EQUAL(1U, countNum);
+
+	CHECK(dispatch(EV_FLIP) >= 0);
+	POINTERS_EQUAL(&regionOff, toggle.itsCurrentState);
+	CHECK_EQUAL(2U, countNum);
+}
+
+TEST(hsm_region, Should_ExitAndResume_When_StateLeftAndReentered)
+{
+	CHECK_EQUAL(0, dispatch(EV_START));
+	CHECK_EQUAL(0, dispatch(EV_GO));
+	CHECK(dispatch(EV_FLIP) >= 0);
+
+	CHECK_EQUAL(0, dispatch(EV_STOP));
+	POINTERS_EQUAL(&regionIdle, me.itsCurrentState);
+	CHECK_FALSE(hsm_regions_isActive(&regions));
+	CHECK_EQUAL(1U, toggleExitNum);
+	LONGS_EQUAL(HSM_ST_M_ON_ENTRY, regionOn.itsMode);
+
+	/* Left alone while the state is not active */
+	CHECK(dispatch(EV_FLIP) >= 0);
+	CHECK_EQUAL(1U, countNum);
+
+	/* Back to where it was, through its history */
+	CHECK_EQUAL(0, dispatch(EV_GO));
+	CHECK_EQUAL(2U, toggleEntryNum);
+	POINTERS_EQUAL(&regionOn, toggle.itsCurrentState);
+	LONGS_EQUAL(HSM_ST_M_DURING, regionOn.itsMode);
+}
+
+TEST(hsm_region, Should_ResetRegions_When_MachineReset)
+{
+	CHECK_EQUAL(0, dispatch(EV_START));
+	CHECK_EQUAL(0, dispatch(EV_GO));
+	CHECK(dispatch(EV_FLIP) >= 0);
+
+	CHECK_EQUAL(0, hsm_reset(&me));
+	CHECK_FALSE(hsm_regions_isActive(&regions));
+	LONGS_EQUAL(HSM_ST_M_ON_ENTRY, regionOn.itsMode);
+
+	CHECK_EQUAL(0, dispatch(EV_START));
+	CHECK_EQUAL(0, dispatch(EV_GO));
+	POINTERS_EQUAL(&regionOff, toggle.itsCurrentState);
+}
+
+TEST(hsm_region, Should_GiveSameResults_When_RunOnWorkers)
+{
+	CHECK_EQUAL(0, hsm_regions_start(&regions, threads, 2U));
+	CHECK_EQUAL(-1, hsm_regions_start(&regions, threads, 2U));
+
+	flip();
+
+	CHECK_EQUAL(0, hsm_regions_stop(&regions));
+}
+
+TEST(hsm_region, Should_GiveSameResults_When_SomeNotThreadSafe)
+{
+	regionList[0].itsThreadSafe = false;
+	hsm_regions_destroy(&regions);
+	CHECK_EQUAL(0,
+	            hsm_regions_init(
+	                &regions, &me, &regionOrtho, regionList, 2U));
+	CHECK_EQUAL(0, hsm_regions_start(&regions, threads, 1U));
+
+	flip();
+}
+
+TEST(hsm_region, Should_GiveError_When_ThreadSafeRegionShared)
+{
+	hsm_wheel_t   wheel;
+	hsm_timer_t   timer;
+	hsm_journal_t journal;
+
+	/* A timer bound to a state of a thread safe region */
+	CHECK_EQUAL(0, hsm_wheel_init(&wheel, 0U));
+	CHECK_EQUAL(0,
+	            hsm_timer_init(
+	                &timer, &wheel, &toggle, &regionOn, EV_FLIP, 1U));
+	CHECK_EQUAL(-1, hsm_regions_start(&regions, threads, 2U));
+	POINTERS_EQUAL(NULL, regions.itsThreads);
+
+	/* A journal attached to one */
+	toggle = hsm_build(&regionToggle, toggleList);
+	hsm_journal_attach(&counter, &journal);
+	CHECK_EQUAL(-1, hsm_regions_start(&regions, threads, 2U));
+	hsm_journal_attach(&counter, NULL);
+
+	/* The same below a region */
+	hsm_t         inner = hsm_build(&regionCounting, counterList);
+	hsm_region_t  innerList[1] = {{&inner, true}};
+	hsm_regions_t innerRegions;
+
+	counter = hsm_build(&regionCounting, counterList);
+	CHECK_EQUAL(0,
+	            hsm_regions_init(
+	                &innerRegions, &toggle, &regionOn, innerList, 1U));
+	hsm_journal_attach(&inner, &journal);
+	CHECK_EQUAL(-1, hsm_regions_start(&regions, threads, 2U));
+	hsm_regions_destroy(&innerRegions);
+
+	/* Left on the calling thread it is not reached by the workers */
+	CHECK_EQUAL(0,
+	            hsm_timer_init(
+	                &timer, &wheel, &toggle, &regionOn, EV_FLIP, 1U));
+	regionList[0].itsThreadSafe = false;
+	hsm_regions_destroy(&regions);
+	CHECK_EQUAL(0,
+	            hsm_regions_init(
+	                &regions, &me, &regionOrtho, regionList, 2U));
+	CHECK_EQUAL(0, hsm_regions_start(&regions, threads, 2U));
+
+	flip();
+	CHECK_FALSE(hsm_timer_isArmed(&timer));
+}
+
+TEST(hsm_region, Should_RestoreRegions_When_Restored)
+{
+	uint8_t      inOrtho[256];
+	uint8_t      inIdle[256];
+	const size_t size = hsm_snapshot_getSize(&me);
+
+	CHECK(size <= sizeof(inOrtho));
+	CHECK(size > hsm_snapshot_getSize(&toggle));
+
+	CHECK_EQUAL(0, dispatch(EV_START));
+	CHECK_EQUAL(0, dispatch(EV_GO));
+	CHECK(dispatch(EV_FLIP) >= 0);
+	CHECK_EQUAL(0, hsm_snapshot(&me, inOrtho, sizeof(inOrtho)));
+	CHECK_EQUAL(0, dispatch(EV_STOP));
+	CHECK_EQUAL(0, hsm_snapshot(&me, inIdle, sizeof(inIdle)));
+
+	/* Into the state, its regions handle the events again */
+	CHECK_EQUAL(0, hsm_restore(&me, inOrtho, size));
+	POINTERS_EQUAL(&regionOrtho, me.itsCurrentState);
+	CHECK(hsm_regions_isActive(&regions));
+	POINTERS_EQUAL(&regionOn, toggle.itsCurrentState);
+	LONGS_EQUAL(HSM_ST_M_DURING, regionOn.itsMode);
+	CHECK(dispatch(EV_FLIP) >= 0);
+	POINTERS_EQUAL(&regionOff, toggle.itsCurrentState);
+	CHECK_EQUAL(2U, countNum);
+
+	/* Out of it, they are left alone */
+	CHECK_EQUAL(0, hsm_restore(&me, inIdle, size));
+	POINTERS_EQUAL(&regionIdle, me.itsCurrentState);
+	CHECK_FALSE(hsm_regions_isActive(&regions));
+	CHECK(dispatch(EV_FLIP) >= 0);
+	CHECK_EQUAL(2U, countNum);
+
+	/* And resume from the restored history */
+	CHECK_EQUAL(0, dispatch(EV_GO));
+	CHECK(hsm_regions_isActive(&regions));
+	POINTERS_EQUAL(&regionOn, toggle.itsCurrentState);
+
+	/* A corrupt snapshot of a region is rejected */
+	inOrtho[size - 8U] ^= 0xFFU;
+	CHECK_EQUAL(-1, hsm_restore(&me, inOrtho, size));
+	POINTERS_EQUAL(&regionOrtho, me.itsCurrentState);
+}
@@ -0,0 +1,216 @@
+#include "CppUTest/TestHarness.h"
+#include "hsm_snapshot.h"
+
+/*
+digraph G {
+	graph [fontsize=10 fontname="Verdana" compound=true rankdir=LR];
+	node [shape=record fontsize=10 fontname="Verdana"];
+
+	subgraph cluster_top {
+		label = "top";
+
+		subgraph cluster_a {
+			label = "a";
+			"a1";
+			"a2";
+		}
+
+		"b";
+	}
+
+	"a1" -> "a2" [ label = "NEXT" ];
+	"a" -> "b" [ label = "LEAVE" ];
+	"b" -> "a" [ label = "BACK" ];
+}
+*/
+
+enum
+{
+	EV_START = 1U,
+	EV_NEXT,
+	EV_LEAVE,
+	EV_BACK
+};
+
+extern state_t snapTop;
+extern state_t snapA;
+extern state_t snapA1;
+extern state_t snapA2;
+extern state_t snapB;
+
+state_t snapTop = {.itsInitialState  = &snapA,
+                   .itsParentState   = NULL,
+                   .onEntry          = NULL,
+                   .during           = NULL,
+                   .onExit           = NULL,
+                   .itsTransition    = NULL,
+                   .itsTransitionNum = 0};
+
+state_t snapA = {
+    .itsInitialState  = &snapA1,
+    .itsParentState   = &snapTop,
+    .onEntry          = NULL,
+    .during           = NULL,
+    .onExit           = NULL,
+    .itsTransition    = (hsm_transition_t[]){{NULL, NULL, &snapB, EV_LEAVE}},
+    .itsTransitionNum = 1};
+
+state_t snapA1 = {
+    .itsInitialState  = NULL,
+    .itsParentState   = &snapA,
+    .onEntry          = NULL,
+    .during           = NULL,
+    .onExit           = NULL,
+    .itsTransition    = (hsm_transition_t[]){{NULL, NULL, &snapA2, EV_NEXT}},
+    .itsTransitionNum = 1};
+
+state_t snapA2 = {.itsInitialState  = NULL,
+                  .itsParentState   = &snapA,
+                  .onEntry          = NULL,
+                  .during           = NULL,
+                  .onExit           = NULL,
+                  .itsTransition    = NULL,
+                  .itsTransitionNum = 0};
+
+state_t snapB = {
+    .itsInitialState  = NULL,
+    .itsParentState   = &snapTop,
+    .onEntry          = NULL,
+    .during           = NULL,
+    .onExit           = NULL,
+    .itsTransition    = (hsm_transition_t[]){{NULL, NULL, &snapA, EV_BACK}},
+    .itsTransitionNum = 1};
+
+static state_t* stateList[] = {&snapTop, &snapA, &snapA1, &snapA2, &snapB};
+
+TEST_GROUP(hsm_snapshot)
+{
+	hsm_t   me;
+	uint8_t blob[64];
+	size_t  blobSize;
+
+	void setup()
+	{
+		me       = hsm_build(&snapTop, stateList);
+		blobSize = hsm_snapshot_getSize(&me);
+
+		/* Leave a with a2 in its history */
+		CHECK_EQUAL(0, dispatch(EV_START));
+		CHECK_EQUAL(0, dispatch(EV_NEXT));
+		CHECK_EQUAL(0, dispatch(EV_LEAVE));
+		POINTERS_EQUAL(&snapB, me.itsCurrentState);
+	}
+
+	int dispatch(const uint32_t eventType)
+	{
+		hsm_event_t event = {eventType, NULL};
+		return hsm_dispatch(&me, &event);
+	}
+
+	/* The FNV-1a checksum of an edited blob */
+	void seal()
+	{
+		const size_t size     = blobSize - 4U;
+		uint32_t     checksum = 2166136261U;
+
+		for (size_t i = 0U; i < size; i++)
+		{
+			checksum = (checksum ^ blob[i]) * 16777619U;
+		}
+
+		for (size_t i = 0U; i < 4U; i++)
+		{
+			blob[size + i] = (uint8_t)(checksum >> (8U * i));
+		}
+	}
+};
+
+TEST(hsm_snapshot, Should_GiveError_When_InvalidInput)
+{
+	CHECK_EQUAL(0, hsm_snapshot_getSize(NULL));
+	CHECK_EQUAL(-1, hsm_snapshot(NULL, blob, sizeof(blob)));
+	CHECK_EQUAL(-1, hsm_snapshot(&me, NULL, sizeof(blob)));
+	CHECK_EQUAL(1, hsm_snapshot(&me, blob, blobSize - 1U));
+	CHECK_EQUAL(0, hsm_snapshot(&me, blob, sizeof(blob)));
+	CHECK_EQUAL(-1, hsm_restore(NULL, blob, blobSize));
+	CHECK_EQUAL(-1, hsm_restore(&me, NULL, blobSize));
+	CHECK_EQUAL(-1, hsm_restore(&me, blob, blobSize + 1U));
+
+	/* In the middle of a transition of the micro steps */
+	me.itsTransition = snapA1.itsTransition;
+	CHECK_EQUAL(-1, hsm_snapshot(&me, blob, sizeof(blob)));
+}
+
+TEST(hsm_snapshot, Should_WriteCompactBlob_When_Taken)
+{
+	CHECK_EQUAL(14U + (5U * 3U) + 4U, blobSize);
+	CHECK_EQUAL(0, hsm_snapshot(&me, blob, sizeof(blob)));
+
+	MEMCMP_EQUAL("HSMS", blob, 4U);
+	CHECK_EQUAL(HSM_SNAPSHOT_VERSION, blob[4]);
+	CHECK_EQUAL(5, blob[8]);
+
+	/* The current state is b, a remembers a2 */
+	CHECK_EQUAL(4, blob[12]);
+	CHECK_EQUAL(HSM_ST_M_DURING, blob[14 + (4 * 3)]);
+	CHECK_EQUAL(HSM_ST_M_ON_ENTRY, blob[14 + (1 * 3)]);
+	CHECK_EQUAL(3, blob[14 + (1 * 3) + 1]);
+}
+
+TEST(hsm_snapshot, Should_ResumeWhereItWas_When_Restored)
+{
+	CHECK_EQUAL(0, hsm_snapshot(&me, blob, sizeof(blob)));
+	CHECK_EQUAL(0, hsm_reset(&me));
+	POINTERS_EQUAL(&snapA1, snapA.itsHistoryState);
+
+	CHECK_EQUAL(0, hsm_restore(&me, blob, blobSize));
+	POINTERS_EQUAL(&snapB, me.itsCurrentState);
+	CHECK_EQUAL(HSM_ST_M_DURING, snapTop.itsMode);
+	CHECK_EQUAL(HSM_ST_M_DURING, snapB.itsMode);
+	CHECK_EQUAL(HSM_ST_M_ON_ENTRY, snapA.itsMode);
+	POINTERS_EQUAL(&snapA2, snapA.itsHistoryState);
+
+	/* Back through the restored history */
+	CHECK_EQUAL(0, dispatch(EV_BACK));
+	POINTERS_EQUAL(&snapA2, me.itsCurrentState);
+}
+
+TEST(hsm_snapshot, Should_KeepMachine_When_BlobCorrupted)
+{
+	CHECK_EQUAL(0, hsm_snapshot(&me, blob, sizeof(blob)));
+	CHECK_EQUAL(0, hsm_reset(&me));
+
+	blob[12] ^= 1U;
+	CHECK_EQUAL(-1, hsm_restore(&me, blob, blobSize));
+	POINTERS_EQUAL(&snapTop, me.itsCurrentState);
+	POINTERS_EQUAL(&snapA1, snapA.itsHistoryState);
+}
+
+TEST(hsm_snapshot, Should_GiveError_When_ShallowHistoryNotAChild)
+{
+	CHECK_EQUAL(0, hsm_snapshot(&me, blob, sizeof(blob)));
+
+	/* Top is shallow, a2 is below a */
+	blob[14 + (0 * 3) + 1] = 3U;
+	seal();
+	CHECK_EQUAL(-1, hsm_restore(&me, blob, blobSize));
+
+	/* A child */
+	blob[14 + (0 * 3) + 1] = 1U;
+	seal();
+	CHECK_EQUAL(0, hsm_restore(&me, blob, blobSize));
+}
+
+TEST(hsm_snapshot, Should_ForgetActiveStates_When_NotRestored)
+{
+	CHECK_EQUAL(0, hsm_snapshot(&me, blob, sizeof(blob)));
+
+	/* Into a2 */
+	CHECK_EQUAL(0, dispatch(EV_BACK));
+	POINTERS_EQUAL(&snapA2, snapA.itsActiveState);
+
+	/* Back in b, a is not active */
+	CHECK_EQUAL(0, hsm_restore(&me, blob, blobSize));
+	POINTERS_EQUAL(&snapB, snapTop.itsActiveState);
+	POINTERS_EQUAL(NULL, snapA.itsActiveState);
+}
@@ -0,0 +1,180 @@
+#include "CppUTest/TestHarness.h"
+#include "hsm.h"
+
+#if HSM_STATS
+
+/*
+digraph G {
+	graph [fontsize=10 fontname="Verdana" compound=true rankdir=LR];
+	node [shape=record fontsize=10 fontname="Verdana"];
+
+	subgraph cluster_top {
+		label = "top";
+		"idle";
+		"busy";
+	}
+
+	"idle" -> "busy" [ label = "GO [ isAllowed ] / act" ];
+	"idle" -> "idle" [ label = "PING" ];
+	"busy" -> "idle" [ label = "GO" ];
+}
+*/
+
+enum
+{
+	EV_GO = 1U,
+	EV_PING
+};
+
+static bool isTrue(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	(void)event;
+	return true;
+}
+
+static bool isAllowed(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	(void)event;
+	return true;
+}
+
+static void act(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	(void)event;
+}
+
+extern state_t statsTop;
+extern state_t statsIdle;
+extern state_t statsBusy;
+
+state_t statsTop = {.itsInitialState  = &statsIdle,
+                    .itsParentState   = NULL,
+                    .onEntry          = NULL,
+                    .during           = isTrue,
+                    .onExit           = NULL,
+                    .itsTransition    = NULL,
+                    .itsTransitionNum = 0,
+                    .itsName          = "top"};
+
+state_t statsIdle = {
+    .itsInitialState = NULL,
+    .itsParentState  = &statsTop,
+    .onEntry         = isTrue,
+    .during          = NULL,
+    .onExit          = isTrue,
+    .itsTransition =
+        (hsm_transition_t[]){{isAllowed, act, &statsBusy, EV_GO},
+                             {NULL, NULL, NULL, EV_PING}},
+    .itsTransitionNum = 2,
+    .itsName          = "idle"};
+
+state_t statsBusy = {
+    .itsInitialState  = NULL,
+    .itsParentState   = &statsTop,
+    .onEntry          = NULL,
+    .during           = NULL,
+    .onExit           = NULL,
+    .itsTransition    = (hsm_transition_t[]){{NULL, NULL, &statsIdle, EV_GO}},
+    .itsTransitionNum = 1,
+    .itsName          = "busy"};
+
+static state_t* stateList[] = {&statsTop, &statsIdle, &statsBusy};
+
+TEST_GROUP(hsm_stats)
+{
+	hsm_t me;
+
+	void setup()
+	{
+		me = hsm_build(&statsTop, stateList);
+		CHECK_EQUAL(0, hsm_stats_init(&me));
+	}
+
+	void teardown()
+	{
+		hsm_stats_destroy(&me);
+	}
+
+	int dispatch(const uint32_t eventType)
+	{
+		hsm_event_t event = {eventType, NULL};
+		return hsm_dispatch(&me, &event);
+	}
+
+	const hsm_state_stats_t* statsOf(const state_t* state)
+	{
+		return hsm_stats_getState(&me, state);
+	}
+
+	uint64_t getLatencyNum()
+	{
+		uint64_t num = 0U;
+
+		for (uint32_t i = 0U; i < HSM_STATS_BUCKET_NUM; i++)
+		{
+			num += hsm_stats_get(&me)->itsLatency[i];
+		}
+
+		return num;
+	}
+};
+
+TEST(hsm_stats, Should_GiveError_When_InvalidInput)
+{
+	CHECK_EQUAL(-1, hsm_stats_init(NULL));
+	CHECK_EQUAL(-1, hsm_stats_init(&me));
+	POINTERS_EQUAL(NULL, hsm_stats_get(NULL));
+	POINTERS_EQUAL(NULL, hsm_stats_getState(&me, NULL));
+}
+
+TEST(hsm_stats, Should_CountStatesAndTransitions_When_Dispatching)
+{
+	CHECK_EQUAL(0, dispatch(EV_PING));
+	CHECK_EQUAL(0, dispatch(EV_GO));
+	CHECK_EQUAL(0, dispatch(EV_GO));
+	CHECK_EQUAL(0, dispatch(EV_GO));
+
+	const hsm_state_stats_t* const top  = statsOf(&statsTop);
+	const hsm_state_stats_t* const idle = statsOf(&statsIdle);
+	const hsm_state_stats_t* const busy = statsOf(&statsBusy);
+
+	CHECK_EQUAL(1, top->itsEntryNum);
+	CHECK_EQUAL(0, top->itsExitNum);
+	CHECK_EQUAL(2, idle->itsEntryNum);
+	CHECK_EQUAL(2, idle->itsExitNum);
+	CHECK_EQUAL(3, idle->itsEventNum);
+	CHECK_EQUAL(1, busy->itsEventNum);
+
+	/* Fired transitions */
+	CHECK_EQUAL(2, idle->itsFireNum[0]);
+	CHECK_EQUAL(1, idle->itsFireNum[1]);
+	CHECK_EQUAL(1, busy->itsFireNum[0]);
+
+	CHECK_EQUAL(4, getLatencyNum());
+}
+
+TEST(hsm_stats, Should_StartOver_When_Reset)
+{
+	CHECK_EQUAL(0, dispatch(EV_GO));
+	hsm_stats_reset(&me);
+
+	const hsm_state_stats_t* const idle = statsOf(&statsIdle);
+
+	CHECK_EQUAL(0, idle->itsEntryNum);
+	CHECK_EQUAL(0, idle->itsFireNum[0]);
+	CHECK_EQUAL(0, getLatencyNum());
+}
+
+TEST(hsm_stats, Should_CountNothing_When_Destroyed)
+{
+	hsm_stats_destroy(&me);
+
+	CHECK_EQUAL(0, dispatch(EV_GO));
+	POINTERS_EQUAL(NULL, hsm_stats_get(&me));
+	POINTERS_EQUAL(NULL, statsIdle.itsStats);
+}
+
+#endif /* HSM_STATS */
@@ -0,0 +1,280 @@
+#include "CppUTest/TestHarness.h"
+#include "hsm_store.h"
+#include "hsm_trace.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/*
+digraph G {
+	graph [fontsize=10 fontname="Verdana" compound=true rankdir=LR];
+	node [shape=record fontsize=10 fontname="Verdana"];
+
+	subgraph cluster_0 {
+		label = "on";
+		"cluster0_dummy" [ label = "", style = invis ];
+		"cluster0_dummy" -> "idle"
+		"idle" -> "running" [ label = "START" ];
+		"running" -> "idle" [ label = "STOP" ];
+	}
+}
+*/
+
+enum
+{
+	EV_NONE = HSM_EVENT_ANY,
+	EV_START,
+	EV_STOP
+};
+
+#define INST_NUM (8U)
+
+extern state_t storeOn;
+extern state_t storeIdle;
+extern state_t storeRunning;
+
+state_t storeOn = {.itsInitialState  = &storeIdle,
+                   .itsParentState   = NULL,
+                   .onEntry          = NULL,
+                   .during           = NULL,
+                   .onExit           = NULL,
+                   .itsTransition    = NULL,
+                   .itsTransitionNum = 0};
+
+state_t storeIdle = {
+    .itsInitialState = NULL,
+    .itsParentState  = &storeOn,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, NULL, &storeRunning, EV_START}},
+    .itsTransitionNum = 1};
+
+state_t storeRunning = {
+    .itsInitialState = NULL,
+    .itsParentState  = &storeOn,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, NULL, &storeIdle, EV_STOP}},
+    .itsTransitionNum = 1};
+
+static state_t* stateList[] = {&storeOn, &storeIdle, &storeRunning};
+
+/* The same tree, with a deep history */
+extern state_t storeDeepOn;
+extern state_t storeDeepIdle;
+extern state_t storeDeepRunning;
+
+state_t storeDeepOn = {.itsInitialState  = &storeDeepIdle,
+                       .itsParentState   = NULL,
+                       .onEntry          = NULL,
+                       .during           = NULL,
+                       .onExit           = NULL,
+                       .itsTransition    = NULL,
+                       .itsTransitionNum = 0,
+                       .itsHistory       = HSM_HISTORY_DEEP};
+
+state_t storeDeepIdle = {.itsInitialState  = NULL,
+                         .itsParentState   = &storeDeepOn,
+                         .onEntry          = NULL,
+                         .during           = NULL,
+                         .onExit           = NULL,
+                         .itsTransition    = NULL,
+                         .itsTransitionNum = 0};
+
+state_t storeDeepRunning = {.itsInitialState  = NULL,
+                            .itsParentState   = &storeDeepOn,
+                            .onEntry          = NULL,
+                            .during           = NULL,
+                            .onExit           = NULL,
+                            .itsTransition    = NULL,
+                            .itsTransitionNum = 0};
+
+static state_t* deepList[] = {&storeDeepOn, &storeDeepIdle, &storeDeepRunning};
+
+TEST_GROUP(hsm_store)
+{
+	hsm_def_t   def;
+	hsm_store_t store;
+	char        path[32];
+
+	void setup()
+	{
+		CHECK_EQUAL(0, hsm_def_build(&def, &storeOn, stateList));
+
+		/* An empty file is a new store */
+		snprintf(path, sizeof(path), "/tmp/hsm_store_XXXXXX");
+		const int file = mkstemp(path);
+		CHECK(file >= 0);
+		close(file);
+	}
+
+	void teardown()
+	{
+		hsm_store_close(&store);
+		hsm_def_destroy(&def);
+		unlink(path);
+	}
+
+	int dispatch(const uint32_t index, const uint32_t eventType)
+	{
+		hsm_event_t event = {eventType, NULL};
+		return hsm_store_dispatch(&store, index, &event);
+	}
+};
+
+TEST(hsm_store, Should_GiveError_When_InvalidInput)
+{
+	CHECK_EQUAL(-1, hsm_store_open(NULL, &def, path, INST_NUM));
+	CHECK_EQUAL(-1, hsm_store_open(&store, NULL, path, INST_NUM));
+	CHECK_EQUAL(-1, hsm_store_open(&store, &def, NULL, INST_NUM));
+	CHECK_EQUAL(-1, hsm_store_open(&store, &def, path, 0U));
+	CHECK_EQUAL(-1, hsm_store_sync(&store));
+	CHECK_EQUAL(-1, dispatch(0U, EV_START));
+	POINTERS_EQUAL(NULL, hsm_store_getState(&store, 0U));
+
+	CHECK_EQUAL(1, hsm_store_open(&store, &def, path, INST_NUM));
+	CHECK_EQUAL(-1, dispatch(INST_NUM, EV_START));
+	CHECK_EQUAL(-1, hsm_store_reset(&store, INST_NUM));
+	POINTERS_EQUAL(NULL, hsm_store_getState(&store, INST_NUM));
+}
+
+TEST(hsm_store, Should_ResetAll_When_Created)
+{
+	CHECK_EQUAL(1, hsm_store_open(&store, &def, path, INST_NUM));
+
+	for (uint32_t i = 0U; i < INST_NUM; i++)
+	{
+		CHECK_EQUAL(0, dispatch(i, EV_NONE));
+		POINTERS_EQUAL(&storeIdle, hsm_store_getState(&store, i));
+	}
+}
+
+TEST(hsm_store, Should_Resume_When_Reopened)
+{
+	CHECK_EQUAL(1, hsm_store_open(&store, &def, path, INST_NUM));
+	for (uint32_t i = 0U; i < INST_NUM; i++)
+	{
+		CHECK_EQUAL(0, dispatch(i, EV_NONE));
+	}
+
+	/* Start every other one */
+	for (uint32_t i = 0U; i < INST_NUM; i += 2U)
+	{
+		CHECK_EQUAL(0, dispatch(i, EV_START));
+	}
+	CHECK_EQUAL(0, hsm_store_sync(&store));
+	hsm_store_close(&store);
+
+	CHECK_EQUAL(0, hsm_store_open(&store, &def, path, INST_NUM));
+	for (uint32_t i = 0U; i < INST_NUM; i++)
+	{
+		POINTERS_EQUAL(((i % 2U) == 0U) ? &storeRunning : &storeIdle,
+		               hsm_store_getState(&store, i));
+	}
+
+	/* Carries on from there */
+	CHECK_EQUAL(0, dispatch(0U, EV_STOP));
+	POINTERS_EQUAL(&storeIdle, hsm_store_getState(&store, 0U));
+	CHECK_EQUAL(0, hsm_store_reset(&store, 2U));
+	CHECK_EQUAL(0, dispatch(2U, EV_NONE));
+	POINTERS_EQUAL(&storeIdle, hsm_store_getState(&store, 2U));
+}
+
+TEST(hsm_store, Should_GiveError_When_NotTheSameStore)
+{
+	state_t*  otherList[] = {&storeOn, &storeRunning, &storeIdle};
+	hsm_def_t other;
+
+	CHECK_EQUAL(1, hsm_store_open(&store, &def, path, INST_NUM));
+	hsm_store_close(&store);
+
+	/* Another number of instances */
+	CHECK_EQUAL(-1, hsm_store_open(&store, &def, path, INST_NUM + 1U));
+
+	/* The same states in another order */
+	CHECK_EQUAL(0, hsm_def_build(&other, &storeOn, otherList));
+	CHECK_EQUAL(-1, hsm_store_open(&store, &other, path, INST_NUM));
+	hsm_def_destroy(&other);
+
+	/* The same tree with another history */
+	CHECK_EQUAL(0, hsm_def_build(&other, &storeDeepOn, deepList));
+	CHECK_EQUAL(-1, hsm_store_open(&store, &other, path, INST_NUM));
+	hsm_def_destroy(&other);
+
+	CHECK_EQUAL(0, hsm_store_open(&store, &def, path, INST_NUM));
+}
+
+TEST(hsm_store, Should_GiveError_When_RecordCorrupt)
+{
+	/* The second record, after a 64 byte header: state, mode, history */
+	const off_t          state   = 64 + (3 * sizeof(hsm_state_id_t));
+	const off_t          history = state + (2 * sizeof(hsm_state_id_t));
+	const hsm_state_id_t notAState = (hsm_state_id_t)3U;
+	const hsm_state_id_t notAChild = hsm_def_getId(&def, &storeOn);
+
+	CHECK_EQUAL(1, hsm_store_open(&store, &def, path, INST_NUM));
+	hsm_store_close(&store);
+
+	/* A current state that is not one, found when first touched */
+	int file = open(path, O_RDWR);
+	CHECK(file >= 0);
+	CHECK_EQUAL((ssize_t)sizeof(notAState),
+	            pwrite(file, &notAState, sizeof(notAState), state));
+	CHECK_EQUAL(0, hsm_store_open(&store, &def, path, INST_NUM));
+	CHECK_EQUAL(0, dispatch(0U, EV_NONE));
+	CHECK_EQUAL(-1, dispatch(1U, EV_NONE));
+	POINTERS_EQUAL(NULL, hsm_store_getState(&store, 1U));
+
+	/* A reset record is valid again */
+	CHECK_EQUAL(0, hsm_store_reset(&store, 1U));
+	CHECK_EQUAL(0, dispatch(1U, EV_NONE));
+	hsm_store_close(&store);
+
+	/* A history that is not a child of its state */
+	CHECK_EQUAL((ssize_t)sizeof(notAChild),
+	            pwrite(file, &notAChild, sizeof(notAChild), history));
+	CHECK_EQUAL(0, hsm_store_open(&store, &def, path, INST_NUM));
+	POINTERS_EQUAL(NULL, hsm_store_getState(&store, 1U));
+	CHECK_EQUAL(-1, dispatch(1U, EV_NONE));
+	close(file);
+}
+
+#if HSM_TRACE
+
+TEST(hsm_store, Should_TraceDistinctMachines_When_Dispatched)
+{
+	hsm_trace_t        ring;
+	hsm_trace_record_t records[4];
+	hsm_trace_record_t out[4];
+
+	CHECK_EQUAL(1, hsm_store_open(&store, &def, path, INST_NUM));
+	CHECK_EQUAL(0, dispatch(0U, EV_NONE));
+	CHECK_EQUAL(0, dispatch(1U, EV_NONE));
+
+	CHECK_EQUAL(0, hsm_trace_init(&ring, records, 4U));
+	hsm_trace_attach(&ring);
+	CHECK_EQUAL(0, dispatch(0U, EV_START));
+	CHECK_EQUAL(0, dispatch(1U, EV_START));
+	hsm_trace_attach(NULL);
+
+	/* Each record is its own machine */
+	LONGS_EQUAL(2, hsm_trace_read(&ring, out, 4U));
+	CHECK(out[0].itsMachine != out[1].itsMachine);
+
+	/* The same record keeps its id */
+	const uint64_t first = out[0].itsMachine;
+
+	hsm_trace_attach(&ring);
+	CHECK_EQUAL(0, dispatch(0U, EV_STOP));
+	hsm_trace_attach(NULL);
+	LONGS_EQUAL(1, hsm_trace_read(&ring, out, 4U));
+	CHECK_EQUAL(first, out[0].itsMachine);
+}
+
+#endif /* HSM_TRACE */
@@ -0,0 +1,218 @@
+#include "CppUTest/TestHarness.h"
+#include "hsm_timer.h"
+
+/*
+digraph G {
+	graph [fontsize=10 fontname="Verdana" compound=true rankdir=LR];
+	node [shape=record fontsize=10 fontname="Verdana"];
+
+	"waiting" -> "done" [ label = "TIMEOUT" ];
+	"waiting" -> "idle" [ label = "CANCEL" ];
+	"done" -> "waiting" [ label = "RESTART" ];
+	"idle" -> "idle" [ label = "TICK / recordTick" ];
+}
+*/
+
+enum
+{
+	EV_START = 1U,
+	EV_TIMEOUT,
+	EV_CANCEL,
+	EV_RESTART,
+	EV_TICK
+};
+
+#define TIMER_NUM (1000U)
+
+static hsm_wheel_t wheel;
+static uint64_t    tickAt[TIMER_NUM];
+static uint32_t    tickNum;
+
+static void recordTick(const state_t* me, const hsm_event_t* event)
+{
+	const hsm_timer_t* const timer = (const hsm_timer_t*)event->data;
+
+	(void)me;
+	tickAt[timer->itsDeadline % TIMER_NUM] = wheel.itsNow;
+	tickNum++;
+}
+
+extern state_t timerWaiting;
+extern state_t timerDone;
+extern state_t timerIdle;
+
+state_t timerWaiting = {
+    .itsInitialState = NULL,
+    .itsParentState  = NULL,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, NULL, &timerDone, EV_TIMEOUT},
+                             {NULL, NULL, &timerIdle, EV_CANCEL}},
+    .itsTransitionNum = 2};
+
+state_t timerDone = {
+    .itsInitialState  = NULL,
+    .itsParentState   = NULL,
+    .onEntry          = NULL,
+    .during           = NULL,
+    .onExit           = NULL,
+    .itsTransition    = (hsm_transition_t[]){{NULL, NULL, &timerWaiting,
+                                              EV_RESTART}},
+    .itsTransitionNum = 1};
+
+state_t timerIdle = {
+    .itsInitialState  = NULL,
+    .itsParentState   = NULL,
+    .onEntry          = NULL,
+    .during           = NULL,
+    .onExit           = NULL,
+    .itsTransition    = (hsm_transition_t[]){{NULL, recordTick, NULL,
+                                              EV_TICK}},
+    .itsTransitionNum = 1};
+
+static state_t* stateList[] = {&timerWaiting, &timerDone, &timerIdle};
+
+TEST_GROUP(hsm_timer)
+{
+	hsm_t       me;
+	hsm_timer_t timeout;
+
+	void setup()
+	{
+		me      = hsm_build(&timerWaiting, stateList);
+		tickNum = 0U;
+		CHECK_EQUAL(0, hsm_wheel_init(&wheel, 0U));
+		CHECK_EQUAL(0,
+		            hsm_timer_init(&timeout,
+		                           &wheel,
+		                           &me,
+		                           &timerWaiting,
+		                           EV_TIMEOUT,
+		                           50U));
+	}
+
+	int dispatch(const uint32_t eventType)
+	{
+		hsm_event_t event = {eventType, NULL};
+		return hsm_dispatch(&me, &event);
+	}
+};
+
+TEST(hsm_timer, Should_GiveError_When_InvalidInput)
+{
+	hsm_timer_t timer;
+
+	CHECK_EQUAL(-1, hsm_wheel_init(NULL, 0U));
+	CHECK_EQUAL(-1, hsm_wheel_advance(NULL, 1U));
+	CHECK_EQUAL(0, hsm_wheel_advance(&wheel, 10U));
+	CHECK_EQUAL(-1, hsm_wheel_advance(&wheel, 9U));
+	CHECK_EQUAL(-1, hsm_timer_init(NULL, &wheel, &me, NULL, EV_TICK, 0U));
+	CHECK_EQUAL(-1, hsm_timer_init(&timer, NULL, &me, NULL, EV_TICK, 0U));
+	CHECK_EQUAL(-1,
+	            hsm_timer_init(&timer, &wheel, NULL, NULL, EV_TICK, 0U));
+
+	/* Not one of its states */
+	state_t stranger = {.itsInitialState  = NULL,
+	                    .itsParentState   = NULL,
+	                    .onEntry          = NULL,
+	                    .during           = NULL,
+	                    .onExit           = NULL,
+	                    .itsTransition    = NULL,
+	                    .itsTransitionNum = 0};
+	CHECK_EQUAL(
+	    -1,
+	    hsm_timer_init(&timer, &wheel, &me, &stranger, EV_TICK, 0U));
+	CHECK_EQUAL(-1, hsm_timer_arm(NULL, 1U));
+	CHECK_FALSE(hsm_timer_isArmed(NULL));
+}
+
+TEST(hsm_timer, Should_Fire_When_StateTimesOut)
+{
+	/* Enter the initial state */
+	CHECK_EQUAL(0, dispatch(EV_START));
+	CHECK(hsm_timer_isArmed(&timeout));
+
+	CHECK_EQUAL(0, hsm_wheel_advance(&wheel, 49U));
+	POINTERS_EQUAL(&timerWaiting, me.itsCurrentState);
+	CHECK_EQUAL(1, hsm_wheel_advance(&wheel, 50U));
+	POINTERS_EQUAL(&timerDone, me.itsCurrentState);
+	CHECK_FALSE(hsm_timer_isArmed(&timeout));
+
+	/* Armed again on the next entry */
+	CHECK_EQUAL(0, dispatch(EV_RESTART));
+	CHECK_EQUAL(1, hsm_wheel_advance(&wheel, 100U));
+	POINTERS_EQUAL(&timerDone, me.itsCurrentState);
+}
+
+TEST(hsm_timer, Should_Cancel_When_StateExits)
+{
+	CHECK_EQUAL(0, dispatch(EV_START));
+	CHECK_EQUAL(0, dispatch(EV_CANCEL));
+	CHECK_FALSE(hsm_timer_isArmed(&timeout));
+
+	CHECK_EQUAL(0, hsm_wheel_advance(&wheel, 1000U));
+	POINTERS_EQUAL(&timerIdle, me.itsCurrentState);
+}
+
+TEST(hsm_timer, Should_Cancel_When_MachineReset)
+{
+	CHECK_EQUAL(0, dispatch(EV_START));
+	CHECK_EQUAL(0, hsm_reset(&me));
+	CHECK_FALSE(hsm_timer_isArmed(&timeout));
+}
+
+TEST(hsm_timer, Should_FireOnTime_When_SpanningLevels)
+{
+	static const uint64_t ticks[] = {
+	    1U, 63U, 64U, 65U, 4095U, 4096U, 4097U, 300000U, (1U << 24) + 5U};
+	const uint32_t timerNum = sizeof(ticks) / sizeof(ticks[0]);
+	hsm_timer_t    timers[sizeof(ticks) / sizeof(ticks[0])];
+
+	CHECK_EQUAL(0, dispatch(EV_CANCEL));
+
+	/* Not on a level boundary */
+	CHECK_EQUAL(0, hsm_wheel_advance(&wheel, 37U));
+
+	for (uint32_t i = 0U; i < timerNum; i++)
+	{
+		CHECK_EQUAL(0,
+		            hsm_timer_init(
+		                &timers[i], &wheel, &me, NULL, EV_TICK, 0U));
+		CHECK_EQUAL(0, hsm_timer_arm(&timers[i], ticks[i]));
+	}
+
+	CHECK_EQUAL((int)timerNum,
+	            hsm_wheel_advance(&wheel, 37U + (1U << 24) + 5U));
+
+	for (uint32_t i = 0U; i < timerNum; i++)
+	{
+		const uint64_t deadline = 37U + ticks[i];
+
+		CHECK_EQUAL(deadline, tickAt[deadline % TIMER_NUM]);
+	}
+}
+
+TEST(hsm_timer, Should_FireArmedOnly_When_ManyCancelled)
+{
+	static hsm_timer_t timers[TIMER_NUM];
+
+	CHECK_EQUAL(0, dispatch(EV_CANCEL));
+
+	for (uint32_t i = 0U; i < TIMER_NUM; i++)
+	{
+		CHECK_EQUAL(0,
+		            hsm_timer_init(
+		                &timers[i], &wheel, &me, NULL, EV_TICK, 0U));
+		CHECK_EQUAL(0, hsm_timer_arm(&timers[i], (i * 7919U) % 5000U));
+	}
+
+	for (uint32_t i = 0U; i < TIMER_NUM; i += 2U)
+	{
+		hsm_timer_cancel(&timers[i]);
+	}
+
+	CHECK_EQUAL(TIMER_NUM / 2U, hsm_wheel_advance(&wheel, 5000U));
+	CHECK_EQUAL(TIMER_NUM / 2U, tickNum);
+}
@@ -0,0 +1,146 @@
+#include "CppUTest/TestHarness.h"
+#include "hsm_trace.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#define TRACE_CAPACITY (8U)
+#define WRITER_RECORDS (10000U)
+
+static hsm_trace_t traceRing;
+
+static void* writer(void* arg)
+{
+	(void)arg;
+
+	/* Its own ring, not the one of the test's thread */
+	hsm_trace_attach(&traceRing);
+
+	for (uint32_t i = 0U; i < WRITER_RECORDS; i++)
+	{
+		uint32_t dropNum = hsm_trace_getDropNum(&traceRing);
+
+		hsm_trace_write(&traceRing, i, 1U, 2U, 3U, 1U);
+
+		while (hsm_trace_getDropNum(&traceRing) != dropNum)
+		{
+			/* Full, retry */
+			dropNum = hsm_trace_getDropNum(&traceRing);
+			(void)sched_yield();
+			hsm_trace_write(&traceRing, i, 1U, 2U, 3U, 1U);
+		}
+	}
+
+	return NULL;
+}
+
+TEST_GROUP(hsm_trace)
+{
+	hsm_trace_record_t records[TRACE_CAPACITY];
+	hsm_trace_record_t out[TRACE_CAPACITY];
+
+	void setup()
+	{
+		CHECK_EQUAL(
+		    0,
+		    hsm_trace_init(&traceRing, records, TRACE_CAPACITY));
+		hsm_trace_attach(&traceRing);
+	}
+
+	void teardown()
+	{
+		hsm_trace_attach(NULL);
+	}
+};
+
+TEST(hsm_trace, Should_GiveError_When_InvalidInput)
+{
+	CHECK_EQUAL(-1, hsm_trace_init(NULL, records, TRACE_CAPACITY));
+	CHECK_EQUAL(-1, hsm_trace_init(&traceRing, NULL, TRACE_CAPACITY));
+	CHECK_EQUAL(-1, hsm_trace_init(&traceRing, records, 0U));
+	CHECK_EQUAL(-1, hsm_trace_init(&traceRing, records, 6U));
+	CHECK_EQUAL(0, hsm_trace_read(NULL, out, TRACE_CAPACITY));
+	CHECK_EQUAL(0, hsm_trace_read(&traceRing, NULL, TRACE_CAPACITY));
+	CHECK_EQUAL(0, hsm_trace_getDropNum(NULL));
+}
+
+TEST(hsm_trace, Should_KeepFixedSizeRecords_When_Stored)
+{
+	CHECK_EQUAL(32, sizeof(hsm_trace_record_t));
+}
+
+TEST(hsm_trace, Should_ReadInOrder_When_Written)
+{
+	hsm_trace_write(&traceRing, 7U, 1U, 2U, 4U, 1U);
+	hsm_trace_write(&traceRing, 8U, 2U, HSM_TRACE_STATE_NONE, 3U, 5U);
+
+	CHECK_EQUAL(2, hsm_trace_read(&traceRing, out, TRACE_CAPACITY));
+	CHECK_EQUAL((uintptr_t)&traceRing, out[0].itsMachine);
+	CHECK_EQUAL(7, out[0].itsEventType);
+	CHECK_EQUAL(1, out[0].itsFrom);
+	CHECK_EQUAL(2, out[0].itsTo);
+	CHECK_EQUAL(4, out[0].itsFromMode);
+	CHECK_EQUAL(1, out[0].itsToMode);
+	CHECK_EQUAL(8, out[1].itsEventType);
+	CHECK_EQUAL(HSM_TRACE_STATE_NONE, out[1].itsTo);
+	CHECK(out[1].itsTime >= out[0].itsTime);
+
+	CHECK_EQUAL(0, hsm_trace_read(&traceRing, out, TRACE_CAPACITY));
+}
+
+TEST(hsm_trace, Should_WriteNothing_When_NotAttached)
+{
+	hsm_trace_attach(NULL);
+	hsm_trace_write(&traceRing, 7U, 1U, 2U, 4U, 1U);
+
+	CHECK_EQUAL(0, hsm_trace_read(&traceRing, out, TRACE_CAPACITY));
+	CHECK_EQUAL(0, hsm_trace_getDropNum(&traceRing));
+}
+
+TEST(hsm_trace, Should_DropRecord_When_Full)
+{
+	for (uint32_t i = 0U; i < (TRACE_CAPACITY + 2U); i++)
+	{
+		hsm_trace_write(&traceRing, i, 1U, 2U, 4U, 1U);
+	}
+	CHECK_EQUAL(2, hsm_trace_getDropNum(&traceRing));
+
+	/* The oldest are kept */
+	CHECK_EQUAL(3, hsm_trace_read(&traceRing, out, 3U));
+	CHECK_EQUAL(0, out[0].itsEventType);
+	CHECK_EQUAL(TRACE_CAPACITY - 3U,
+	            hsm_trace_read(&traceRing, out, TRACE_CAPACITY));
+	CHECK_EQUAL(TRACE_CAPACITY - 1U,
+	            out[TRACE_CAPACITY - 4U].itsEventType);
+}
+
+TEST(hsm_trace, Should_ReadEveryRecord_When_WrittenByAnotherThread)
+{
+	pthread_t thread;
+	uint32_t  readNum = 0U;
+
+	/* The writer attaches the ring to its own thread */
+	hsm_trace_attach(NULL);
+
+	CHECK_EQUAL(0, pthread_create(&thread, NULL, writer, NULL));
+
+	while (readNum < WRITER_RECORDS)
+	{
+		const uint32_t num =
+		    hsm_trace_read(&traceRing, out, TRACE_CAPACITY);
+
+		for (uint32_t i = 0U; i < num; i++)
+		{
+			CHECK_EQUAL(readNum, out[i].itsEventType);
+			readNum++;
+		}
+
+		if (num == 0U)
+		{
+			(void)sched_yield();
+		}
+	}
+
+	CHECK_EQUAL(0, pthread_join(thread, NULL));
+	CHECK_EQUAL(0, hsm_trace_read(&traceRing, out, TRACE_CAPACITY));
+}
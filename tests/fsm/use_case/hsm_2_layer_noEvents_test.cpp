@@ -84,7 +84,7 @@ state_t subA2 = {.itsInitialState = NULL,
                  .during          = NULL,
                  .onExit          = NULL,
                  .itsTransition   = (hsm_transition_t[]){{NULL, NULL, &subB1}},
-                 .itsTransitionNum = 0};
+                 .itsTransitionNum = 1};
 
 state_t topB = {.itsInitialState  = &subB1,
                 .itsParentState   = NULL,
@@ -0,0 +1,550 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C"
+{
+#include "../../apps/hsmgen/chart.h"
+#include "../../apps/hsmgen/emit.h"
+}
+
+#include "hsm_def.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * The chart of most tests, the states end up in this order:
+ * on, work, idle, running, paused, off
+ */
+static const char* const fullChart =
+    "digraph G {\n"
+    "\tsubgraph cluster_0 {\n"
+    "\t\tlabel = \"on\";\n"
+    "\t\tsubgraph cluster_1 {\n"
+    "\t\t\tlabel = \"work\";\n"
+    "\t\t\t\"idle\" -> \"running\" "
+    "[ label = \"START [ canStart ] / begin\" ];\n"
+    "\t\t\t\"running\" [ entry = \"enterRunning\", initial = \"true\" ];\n"
+    "\t\t\t\"running\" -> \"running\" [ label = \"TICK / count\" ];\n"
+    "\t\t}\n"
+    "\t\t\"running\" -> \"paused\" [ label = \"PAUSE\" ];\n"
+    "\t\t\"paused\" -> \"idle\" [ label = \"ANY\" ];\n"
+    "\t}\n"
+    "\t\"off\" -> \"on\" [ label = \"\" ];\n"
+    "\t\"on\" -> \"off\" [ label = \"STOP\" ];\n"
+    "}\n";
+
+enum
+{
+	GEN_ST_ON,
+	GEN_ST_WORK,
+	GEN_ST_IDLE,
+	GEN_ST_RUNNING,
+	GEN_ST_PAUSED,
+	GEN_ST_OFF,
+	GEN_ST_NUM
+};
+
+enum
+{
+	GEN_EV_ANY = HSM_EVENT_ANY,
+	GEN_EV_START,
+	GEN_EV_TICK,
+	GEN_EV_PAUSE,
+	GEN_EV_STOP,
+	GEN_EV_NUM
+};
+
+static bool genTrue(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	(void)event;
+	return true;
+}
+
+static void genNothing(const state_t* me, const hsm_event_t* event)
+{
+	(void)me;
+	(void)event;
+}
+
+/* The full chart by hand, only whether a function is there matters */
+extern state_t hsmgenOn;
+extern state_t hsmgenWork;
+extern state_t hsmgenIdle;
+extern state_t hsmgenRunning;
+extern state_t hsmgenPaused;
+extern state_t hsmgenOff;
+
+state_t hsmgenOn = {
+    .itsInitialState = &hsmgenWork,
+    .itsParentState  = NULL,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, NULL, &hsmgenOff, GEN_EV_STOP}},
+    .itsTransitionNum = 1};
+
+state_t hsmgenWork = {.itsInitialState  = &hsmgenRunning,
+                      .itsParentState   = &hsmgenOn,
+                      .onEntry          = NULL,
+                      .during           = NULL,
+                      .onExit           = NULL,
+                      .itsTransition    = NULL,
+                      .itsTransitionNum = 0};
+
+state_t hsmgenIdle = {
+    .itsInitialState = NULL,
+    .itsParentState  = &hsmgenWork,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition   = (hsm_transition_t[]){{genTrue,
+                                             genNothing,
+                                             &hsmgenRunning,
+                                             GEN_EV_START}},
+    .itsTransitionNum = 1};
+
+state_t hsmgenRunning = {
+    .itsInitialState = NULL,
+    .itsParentState  = &hsmgenWork,
+    .onEntry         = genTrue,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, genNothing, NULL, GEN_EV_TICK},
+                             {NULL, NULL, &hsmgenPaused, GEN_EV_PAUSE}},
+    .itsTransitionNum = 2};
+
+state_t hsmgenPaused = {
+    .itsInitialState = NULL,
+    .itsParentState  = &hsmgenOn,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, NULL, &hsmgenIdle, GEN_EV_ANY}},
+    .itsTransitionNum = 1};
+
+state_t hsmgenOff = {
+    .itsInitialState = NULL,
+    .itsParentState  = NULL,
+    .onEntry         = NULL,
+    .during          = NULL,
+    .onExit          = NULL,
+    .itsTransition =
+        (hsm_transition_t[]){{NULL, NULL, &hsmgenOn, GEN_EV_ANY}},
+    .itsTransitionNum = 1};
+
+static state_t* hsmgenStates[] = {&hsmgenOn,
+                                  &hsmgenWork,
+                                  &hsmgenIdle,
+                                  &hsmgenRunning,
+                                  &hsmgenPaused,
+                                  &hsmgenOff};
+
+TEST_GROUP(hsmgen)
+{
+	chart_t chart;
+	char    path[32];
+	char    output[40];
+	char    source[48];
+	char    header[48];
+	int     savedStderr;
+
+	void setup()
+	{
+		snprintf(path, sizeof(path), "/tmp/hsmgen_XXXXXX");
+		const int file = mkstemp(path);
+		CHECK(file >= 0);
+		close(file);
+
+		snprintf(output, sizeof(output), "%s_out", path);
+		snprintf(source, sizeof(source), "%s.c", output);
+		snprintf(header, sizeof(header), "%s.h", output);
+	}
+
+	void teardown()
+	{
+		unlink(path);
+		unlink(source);
+		unlink(header);
+	}
+
+	/* The errors of the failing tests are not printed */
+	void silence()
+	{
+		const int null = open("/dev/null", O_WRONLY);
+
+		CHECK(null >= 0);
+		fflush(stderr);
+		savedStderr = dup(STDERR_FILENO);
+		dup2(null, STDERR_FILENO);
+		close(null);
+	}
+
+	void restore()
+	{
+		fflush(stderr);
+		dup2(savedStderr, STDERR_FILENO);
+		close(savedStderr);
+	}
+
+	/* Reads the chart, returns chart_read's error code */
+	int read(const char* const dot)
+	{
+		writeChart(dot);
+		silence();
+		const int errorCode = chart_read(&chart, path);
+		restore();
+		return errorCode;
+	}
+
+	/* Reads a number of the source, or HSM_STATE_ID_NONE */
+	uint32_t readValue(const char** const cursor)
+	{
+		static const char none[] = "HSM_STATE_ID_NONE";
+		uint32_t          value  = HSM_STATE_ID_NONE;
+
+		if (strncmp(*cursor, none, sizeof(none) - 1U) == 0)
+		{
+			*cursor = &(*cursor)[sizeof(none) - 1U];
+		}
+		else
+		{
+			char* end = NULL;
+
+			value = (uint32_t)strtoul(*cursor, &end, 10);
+			CHECK(end != *cursor);
+			CHECK_EQUAL('U', *end);
+			*cursor = &end[1];
+		}
+
+		return value;
+	}
+
+	/* Checks that the source has a table with these values */
+	template <typename T>
+	void checkTable(const char* const text,
+	                const char* const name,
+	                const T* const    values,
+	                const uint32_t    num)
+	{
+		char key[CHART_NAME_SIZE];
+
+		snprintf(key, sizeof(key), " gen_%s[%u] = {", name, num);
+		const char* cursor = strstr(text, key);
+		CHECK(cursor != NULL);
+		cursor = &cursor[strlen(key)];
+
+		for (uint32_t i = 0U; i < num; i++)
+		{
+			cursor = &cursor[strspn(cursor, " \t\n")];
+			LONGS_EQUAL(values[i], readValue(&cursor));
+			CHECK_EQUAL(',', *cursor);
+			cursor++;
+		}
+
+		cursor = &cursor[strspn(cursor, " \t\n")];
+		CHECK_EQUAL('}', *cursor);
+	}
+
+	/* Checks a field of every definition's transition */
+	void checkField(const char* const text,
+	                const char* const field,
+	                const hsm_def_t&  def,
+	                uint32_t (*get)(const hsm_def_transition_t&))
+	{
+		const char* cursor = text;
+
+		for (uint32_t i = 0U; i < def.itsTransitionNum; i++)
+		{
+			cursor = strstr(cursor, field);
+			CHECK(cursor != NULL);
+			cursor = &cursor[strlen(field)];
+			LONGS_EQUAL(get(def.itsTransitions[i]),
+			            readValue(&cursor));
+		}
+
+		POINTERS_EQUAL(NULL, strstr(cursor, field));
+	}
+
+	void writeChart(const char* const dot)
+	{
+		FILE* const file = fopen(path, "w");
+		CHECK(file != NULL);
+		fputs(dot, file);
+		fclose(file);
+	}
+
+	/* Generates the chart and reads back the source */
+	char* generate(const char* const dot)
+	{
+		writeChart(dot);
+		CHECK_EQUAL(0, chart_read(&chart, path));
+		const int errorCode = emit_write(&chart, path, output, "gen");
+		chart_destroy(&chart);
+		CHECK_EQUAL(0, errorCode);
+
+		FILE* const file = fopen(source, "r");
+		CHECK(file != NULL);
+		fseek(file, 0, SEEK_END);
+		const long size = ftell(file);
+		fseek(file, 0, SEEK_SET);
+
+		char* const text = (char*)calloc((size_t)size + 1U, 1U);
+		CHECK_EQUAL((size_t)size, fread(text, 1U, (size_t)size, file));
+		fclose(file);
+		return text;
+	}
+};
+
+TEST(hsmgen, Should_KeepName_When_Plain)
+{
+	char* const text = generate("digraph G { A -> B [label=\"e\"]; }\n");
+
+	CHECK(strstr(text, ".itsName          = \"A\"") != NULL);
+	CHECK(strstr(text, ".itsName          = \"B\"") != NULL);
+	free(text);
+}
+
+TEST(hsmgen, Should_EscapeName_When_Quoted)
+{
+	char* const text = generate(
+	    "digraph G { \"A\\\"x\" -> \"B\\\\?\?/\" [label=\"e\"]; }\n");
+
+	CHECK(strstr(text, ".itsName          = \"A\\\"x\"") != NULL);
+	CHECK(strstr(text, ".itsName          = \"B\\\\\\?\\?/\"") != NULL);
+	free(text);
+}
+
+TEST(hsmgen, Should_NestStates_When_Clusters)
+{
+	CHECK_EQUAL(0, read(fullChart));
+	LONGS_EQUAL(GEN_ST_NUM, chart.itsStateNum);
+
+	/* Depth first, named by their labels */
+	STRCMP_EQUAL("on", chart.itsStates[GEN_ST_ON].itsName);
+	STRCMP_EQUAL("work", chart.itsStates[GEN_ST_WORK].itsName);
+	STRCMP_EQUAL("idle", chart.itsStates[GEN_ST_IDLE].itsName);
+	STRCMP_EQUAL("running", chart.itsStates[GEN_ST_RUNNING].itsName);
+	STRCMP_EQUAL("paused", chart.itsStates[GEN_ST_PAUSED].itsName);
+	STRCMP_EQUAL("off", chart.itsStates[GEN_ST_OFF].itsName);
+
+	LONGS_EQUAL(CHART_NONE, chart.itsStates[GEN_ST_ON].itsParent);
+	LONGS_EQUAL(GEN_ST_ON, chart.itsStates[GEN_ST_WORK].itsParent);
+	LONGS_EQUAL(GEN_ST_WORK, chart.itsStates[GEN_ST_IDLE].itsParent);
+	LONGS_EQUAL(GEN_ST_WORK, chart.itsStates[GEN_ST_RUNNING].itsParent);
+	LONGS_EQUAL(GEN_ST_ON, chart.itsStates[GEN_ST_PAUSED].itsParent);
+	LONGS_EQUAL(CHART_NONE, chart.itsStates[GEN_ST_OFF].itsParent);
+
+	/* A leaf has no initial state */
+	LONGS_EQUAL(GEN_ST_WORK, chart.itsStates[GEN_ST_ON].itsInitial);
+	LONGS_EQUAL(CHART_NONE, chart.itsStates[GEN_ST_PAUSED].itsInitial);
+	chart_destroy(&chart);
+}
+
+TEST(hsmgen, Should_TakeMarkedInitial_When_Initial)
+{
+	CHECK_EQUAL(0, read(fullChart));
+
+	/* Not the first child */
+	LONGS_EQUAL(GEN_ST_RUNNING, chart.itsStates[GEN_ST_WORK].itsInitial);
+	STRCMP_EQUAL("enterRunning", chart.itsStates[GEN_ST_RUNNING].itsEntry);
+	LONGS_EQUAL(GEN_ST_ON, chart.itsInitial);
+	chart_destroy(&chart);
+
+	/* Also at the top, and false is no marker */
+	CHECK_EQUAL(0,
+	            read("digraph G { A -> B [label=\"e\"]; "
+	                 "B [initial=true]; A [initial=false]; }\n"));
+	STRCMP_EQUAL("B", chart.itsStates[chart.itsInitial].itsName);
+	chart_destroy(&chart);
+}
+
+TEST(hsmgen, Should_SplitLabel_When_GuardAndAction)
+{
+	CHECK_EQUAL(0, read(fullChart));
+	LONGS_EQUAL(6, chart.itsTransitionNum);
+	LONGS_EQUAL(GEN_EV_NUM - 1, chart.itsEventNum);
+	STRCMP_EQUAL("START", chart.itsEvents[GEN_EV_START - 1]);
+
+	/* Grouped by source, the idle one is the second */
+	const chart_transition_t* const start = &chart.itsTransitions[1];
+
+	LONGS_EQUAL(GEN_ST_IDLE, start->itsSource);
+	LONGS_EQUAL(GEN_ST_RUNNING, start->itsTarget);
+	LONGS_EQUAL(GEN_EV_START, start->itsEvent);
+	STRCMP_EQUAL("canStart", start->itsGuard);
+	STRCMP_EQUAL("begin", start->itsAction);
+
+	/* Only an event */
+	const chart_transition_t* const pause = &chart.itsTransitions[3];
+
+	LONGS_EQUAL(GEN_EV_PAUSE, pause->itsEvent);
+	STRCMP_EQUAL("", pause->itsGuard);
+	STRCMP_EQUAL("", pause->itsAction);
+	chart_destroy(&chart);
+
+	/* Only a guard */
+	CHECK_EQUAL(0, read("digraph G { A -> B [label=\"[ ok ]\"]; }\n"));
+	LONGS_EQUAL(0, chart.itsTransitions[0].itsEvent);
+	STRCMP_EQUAL("ok", chart.itsTransitions[0].itsGuard);
+	STRCMP_EQUAL("", chart.itsTransitions[0].itsAction);
+	chart_destroy(&chart);
+}
+
+TEST(hsmgen, Should_BeInternal_When_SelfLoop)
+{
+	CHECK_EQUAL(0, read(fullChart));
+
+	const chart_transition_t* const tick = &chart.itsTransitions[2];
+
+	LONGS_EQUAL(GEN_ST_RUNNING, tick->itsSource);
+	LONGS_EQUAL(CHART_NONE, tick->itsTarget);
+	LONGS_EQUAL(GEN_EV_TICK, tick->itsEvent);
+	STRCMP_EQUAL("count", tick->itsAction);
+	chart_destroy(&chart);
+
+	char* const text = generate(fullChart);
+
+	CHECK(strstr(text, ".targetState = NULL") != NULL);
+	free(text);
+}
+
+TEST(hsmgen, Should_MatchAnyEvent_When_AnyOrEmpty)
+{
+	CHECK_EQUAL(0, read(fullChart));
+
+	/* ANY is no event of its own */
+	for (uint32_t i = 0U; i < chart.itsEventNum; i++)
+	{
+		CHECK(strcmp("ANY", chart.itsEvents[i]) != 0);
+	}
+
+	LONGS_EQUAL(GEN_ST_PAUSED, chart.itsTransitions[4].itsSource);
+	LONGS_EQUAL(0, chart.itsTransitions[4].itsEvent);
+	LONGS_EQUAL(GEN_ST_OFF, chart.itsTransitions[5].itsSource);
+	LONGS_EQUAL(0, chart.itsTransitions[5].itsEvent);
+	chart_destroy(&chart);
+
+	char* const text = generate(fullChart);
+
+	CHECK(strstr(text, ".eventType   = HSM_EVENT_ANY") != NULL);
+	free(text);
+}
+
+TEST(hsmgen, Should_GiveError_When_ParseError)
+{
+	static const char* const invalid[] = {
+	    "",
+	    "graph G { A -> B; }\n",
+	    "digraph G { A -> B;\n",
+	    "digraph G { }\n",
+	    "digraph G { A -> B; } C\n",
+	    "digraph G { A -> B -> C; }\n",
+	    "digraph G { A -> ; }\n",
+	    "digraph G { A -> B [label=\"e [ ok\"]; }\n",
+	    "digraph G { A -> B [label=\"1e\"]; }\n",
+	    "digraph G { A -> B [label=\"e / 2do\"]; }\n",
+	    "digraph G { A [entry=\"a b\"]; }\n",
+	    "digraph G { A [entry]; }\n",
+	    "digraph G { A -> B [label=\"e\"; }\n",
+	    "digraph G { subgraph cluster_0 { label=\"B\"; A; } "
+	    "B -> A; subgraph cluster_1 { label=\"A\"; } }\n",
+	    "digraph G { \"unterminated -> B; }\n"};
+
+	for (uint32_t i = 0U; i < (sizeof(invalid) / sizeof(invalid[0])); i++)
+	{
+		CHECK_EQUAL(-1, read(invalid[i]));
+		LONGS_EQUAL(0, chart.itsStateNum);
+	}
+
+	/* Valid DOT, but not valid C */
+	CHECK_EQUAL(0, read("digraph G { \"a b\" -> \"a_b\"; }\n"));
+	silence();
+	const int errorCode = emit_write(&chart, path, output, "gen");
+	restore();
+	chart_destroy(&chart);
+	CHECK_EQUAL(-1, errorCode);
+}
+
+static uint32_t getSource(const hsm_def_transition_t& transition)
+{
+	return transition.itsSource;
+}
+
+static uint32_t getTarget(const hsm_def_transition_t& transition)
+{
+	return transition.itsTarget;
+}
+
+static uint32_t getLca(const hsm_def_transition_t& transition)
+{
+	return transition.itsLca;
+}
+
+static uint32_t getEntryNum(const hsm_def_transition_t& transition)
+{
+	return transition.itsEntryNum;
+}
+
+static uint32_t getEntryFirst(const hsm_def_transition_t& transition)
+{
+	return transition.itsEntryFirst;
+}
+
+TEST(hsmgen, Should_EmitSameTables_When_BuiltAtRunTime)
+{
+	hsm_def_t def;
+
+	CHECK_EQUAL(0, hsm_def_build(&def, &hsmgenOn, hsmgenStates));
+	CHECK_EQUAL(0, hsm_def_compile(&def, GEN_EV_NUM));
+
+	char* const    text     = generate(fullChart);
+	const uint32_t stateNum = def.itsStateNum;
+	const uint32_t cellNum  = stateNum * def.itsEventTypeNum;
+	uint32_t       entryNum = 0U;
+
+	for (uint32_t i = 0U; i < def.itsTransitionNum; i++)
+	{
+		entryNum += def.itsTransitions[i].itsEntryNum;
+	}
+
+	LONGS_EQUAL(GEN_ST_NUM, stateNum);
+	checkTable(text, "parent", def.itsParent, stateNum);
+	checkTable(text, "initial", def.itsInitial, stateNum);
+	checkTable(text, "historySlot", def.itsHistorySlot, stateNum);
+	checkTable(text, "actions", def.itsActions, stateNum);
+	checkTable(text,
+	           "transitionFirst",
+	           def.itsTransitionFirst,
+	           stateNum + 1U);
+	checkTable(text, "pathFirst", def.itsPathFirst, stateNum + 1U);
+	checkTable(text,
+	           "paths",
+	           def.itsPaths,
+	           def.itsPathFirst[stateNum]);
+	checkTable(text, "entries", def.itsEntries, entryNum);
+	checkTable(text, "table", def.itsTable, cellNum + 1U);
+	checkTable(text,
+	           "candidates",
+	           def.itsCandidates,
+	           def.itsTable[cellNum]);
+	checkTable(text, "active", def.itsActive, cellNum);
+
+	checkField(text, ".itsSource     = ", def, getSource);
+	checkField(text, ".itsTarget     = ", def, getTarget);
+	checkField(text, ".itsLca        = ", def, getLca);
+	checkField(text, ".itsEntryNum   = ", def, getEntryNum);
+	checkField(text, ".itsEntryFirst = ", def, getEntryFirst);
+
+	CHECK(strstr(text, ".itsInitialState    = 0U,") != NULL);
+	CHECK(strstr(text, ".itsEventTypeNum    = GEN_EV_NUM,") != NULL);
+
+	free(text);
+	hsm_def_destroy(&def);
+}